@@ -808,6 +808,84 @@ in_dev_for_each_ifa_rtnl_test, [
 EXTRA_KCFLAGS="$tmp_flags"
 ]) # LN_HAVE_IN_DEV_FOR_EACH_IFA_RTNL
 
+#
+# LN_HAVE_SOCK_RECVMSG_ITER
+#
+# kernel 4.7 dropped the size argument of sock_recvmsg(), the
+# receive is driven by the iov_iter in the msghdr, which lets us
+# receive straight into the destination pages.
+#
+AC_DEFUN([LN_HAVE_SOCK_RECVMSG_ITER], [
+tmp_flags="$EXTRA_KCFLAGS"
+EXTRA_KCFLAGS="-Werror"
+LB_CHECK_COMPILE([if 'sock_recvmsg' takes an iov_iter msghdr],
+sock_recvmsg_iter, [
+	#include <linux/net.h>
+	#include <linux/socket.h>
+	#include <linux/uio.h>
+],[
+	struct msghdr msg = { 0 };
+	struct bio_vec bv = { 0 };
+
+	iov_iter_bvec(&msg.msg_iter, READ, &bv, 1, 0);
+	sock_recvmsg(NULL, &msg, 0);
+],[
+	AC_DEFINE(HAVE_SOCK_RECVMSG_ITER, 1,
+		['sock_recvmsg' takes an iov_iter msghdr])
+])
+EXTRA_KCFLAGS="$tmp_flags"
+]) # LN_HAVE_SOCK_RECVMSG_ITER
+
+#
+# LN_HAVE_MSGHDR_MSG_UBUF
+#
+# kernel 6.0 added struct msghdr::msg_ubuf so in-kernel senders
+# can pass MSG_ZEROCOPY with their own ubuf_info and get a
+# completion callback once the stack drops its page references.
+#
+AC_DEFUN([LN_HAVE_MSGHDR_MSG_UBUF], [
+tmp_flags="$EXTRA_KCFLAGS"
+EXTRA_KCFLAGS="-Werror"
+LB_CHECK_COMPILE([if 'struct msghdr' has 'msg_ubuf'],
+msghdr_msg_ubuf, [
+	#include <linux/socket.h>
+	#include <linux/skbuff.h>
+],[
+	struct ubuf_info uarg = { .flags = SKBFL_ZEROCOPY_FRAG };
+	struct msghdr msg = { .msg_ubuf = &uarg };
+
+	(void)msg;
+],[
+	AC_DEFINE(HAVE_MSGHDR_MSG_UBUF, 1,
+		['struct msghdr' has 'msg_ubuf'])
+])
+EXTRA_KCFLAGS="$tmp_flags"
+]) # LN_HAVE_MSGHDR_MSG_UBUF
+
+#
+# LN_HAVE_UBUF_INFO_OPS
+#
+# kernel 6.7 replaced ubuf_info::callback with a const
+# struct ubuf_info_ops holding the completion handler.
+#
+AC_DEFUN([LN_HAVE_UBUF_INFO_OPS], [
+tmp_flags="$EXTRA_KCFLAGS"
+EXTRA_KCFLAGS="-Werror"
+LB_CHECK_COMPILE([if 'struct ubuf_info_ops' exists],
+ubuf_info_ops, [
+	#include <linux/skbuff.h>
+],[
+	static const struct ubuf_info_ops ops = { .complete = NULL };
+	struct ubuf_info uarg = { .ops = &ops };
+
+	(void)uarg;
+],[
+	AC_DEFINE(HAVE_UBUF_INFO_OPS, 1,
+		['struct ubuf_info_ops' exists])
+])
+EXTRA_KCFLAGS="$tmp_flags"
+]) # LN_HAVE_UBUF_INFO_OPS
+
 #
 # LN_IB_DEVICE_OPS_EXISTS
 #
@@ -899,6 +977,8 @@ LN_EXPORT_KMAP_TO_PAGE
 LN_CONFIG_SK_DATA_READY
 # 4.x
 LN_CONFIG_SOCK_CREATE_KERN
+# 4.7
+LN_HAVE_SOCK_RECVMSG_ITER
 # 4.14
 LN_HAVE_HYPERVISOR_IS_TYPE
 LN_HAVE_ORACLE_OFED_EXTENSIONS
@@ -906,6 +986,10 @@ LN_HAVE_ORACLE_OFED_EXTENSIONS
 LN_CONFIG_SOCK_GETNAME
 # 5.3 and 4.18.0-193.el8
 LN_HAVE_IN_DEV_FOR_EACH_IFA_RTNL
+# 6.0
+LN_HAVE_MSGHDR_MSG_UBUF
+# 6.7
+LN_HAVE_UBUF_INFO_OPS
 ]) # LN_PROG_LINUX
 
 #
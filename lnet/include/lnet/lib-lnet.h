@@ -221,6 +221,47 @@ extern struct kmem_cache *lnet_small_mds_cachep; /* <= LNET_SMALL_MD_SIZE bytes
 extern struct kmem_cache *lnet_udsp_cachep;
 extern struct kmem_cache *lnet_rspt_cachep;
 extern struct kmem_cache *lnet_msg_cachep;
+extern unsigned int lnet_obj_cache_size;
+
+static inline void *
+lnet_obj_cache_get(struct lnet_obj_cache **caches, size_t size)
+{
+	struct lnet_obj_cache *oc;
+	struct llist_node *node;
+
+	if (caches == NULL)
+		return NULL;
+
+	oc = caches[lnet_cpt_current()];
+	/* never spin here, the slab is only a little slower */
+	if (llist_empty(&oc->oc_free) || !spin_trylock(&oc->oc_lock))
+		return NULL;
+	node = llist_del_first(&oc->oc_free);
+	spin_unlock(&oc->oc_lock);
+	if (node == NULL)
+		return NULL;
+
+	atomic_dec(&oc->oc_nfree);
+	memset(node, 0, size);
+	return node;
+}
+
+static inline bool
+lnet_obj_cache_put(struct lnet_obj_cache **caches, void *obj)
+{
+	struct lnet_obj_cache *oc;
+
+	if (caches == NULL)
+		return false;
+
+	oc = caches[lnet_cpt_current()];
+	if (atomic_inc_return(&oc->oc_nfree) > lnet_obj_cache_size) {
+		atomic_dec(&oc->oc_nfree);
+		return false;
+	}
+	llist_add((struct llist_node *)obj, &oc->oc_free);
+	return true;
+}
 
 static inline bool
 lnet_ni_set_status_locked(struct lnet_ni *ni, __u32 status)
@@ -302,6 +343,8 @@ lnet_md_free(struct lnet_libmd *md)
 	size = offsetof(struct lnet_libmd, md_kiov[md->md_niov]);
 
 	if (size <= LNET_SMALL_MD_SIZE) {
+		if (lnet_obj_cache_put(the_lnet.ln_md_cache, md))
+			return;
 		CDEBUG(D_MALLOC, "slab-freed 'md' at %p.\n", md);
 		kmem_cache_free(lnet_small_mds_cachep, md);
 	} else {
@@ -412,6 +455,54 @@ lnet_isrouter(struct lnet_peer_ni *lpni)
 	return lpni->lpni_peer_net->lpn_peer->lp_rtr_refcount != 0;
 }
 
+extern unsigned int lnet_rtt_threshold;
+
+/* # of seconds an RTT estimate stays good without a new sample */
+#define LNET_RTT_MAX_AGE	10
+/* largest payload sampled: the time to move bulk data isn't latency */
+#define LNET_RTT_SAMPLE_MAX	4096
+
+static inline __u32
+lnet_rtt_get(struct lnet_rtt *rtt)
+{
+	__u32 srtt = READ_ONCE(rtt->rtt_srtt);
+
+	/* a path we stopped using may have recovered since */
+	if (ktime_get_seconds() - READ_ONCE(rtt->rtt_stamp) > LNET_RTT_MAX_AGE)
+		return 0;
+
+	return srtt;
+}
+
+/*
+ * Returns 1 if \a rtt1 is lower than \a rtt2 by more than
+ * lnet_rtt_threshold percent, -1 for the reverse and 0 if they are
+ * close, unknown or latency based selection is disabled.
+ */
+static inline int
+lnet_rtt_compare(struct lnet_rtt *rtt1, struct lnet_rtt *rtt2)
+{
+	unsigned int pct = min(lnet_rtt_threshold, 99U);
+	__u64 r1;
+	__u64 r2;
+
+	if (pct == 0)
+		return 0;
+
+	r1 = lnet_rtt_get(rtt1);
+	r2 = lnet_rtt_get(rtt2);
+	if (r1 == 0 || r2 == 0)
+		return 0;
+
+	if (r1 * 100 < r2 * (100 - pct))
+		return 1;
+
+	if (r2 * 100 < r1 * (100 - pct))
+		return -1;
+
+	return 0;
+}
+
 static inline void
 lnet_ni_addref_locked(struct lnet_ni *ni, int cpt)
 {
@@ -451,7 +542,9 @@ lnet_msg_alloc(void)
 {
 	struct lnet_msg *msg;
 
-	msg = kmem_cache_zalloc(lnet_msg_cachep, GFP_NOFS);
+	msg = lnet_obj_cache_get(the_lnet.ln_msg_cache, sizeof(*msg));
+	if (msg == NULL)
+		msg = kmem_cache_zalloc(lnet_msg_cachep, GFP_NOFS);
 
 	return (msg);
 }
@@ -460,7 +553,8 @@ static inline void
 lnet_msg_free(struct lnet_msg *msg)
 {
 	LASSERT(!msg->msg_onactivelist);
-	kmem_cache_free(lnet_msg_cachep, msg);
+	if (!lnet_obj_cache_put(the_lnet.ln_msg_cache, msg))
+		kmem_cache_free(lnet_msg_cachep, msg);
 }
 
 static inline struct lnet_rsp_tracker *
@@ -606,12 +700,44 @@ extern unsigned int lnet_recovery_interval;
 extern unsigned int lnet_recovery_limit;
 extern unsigned int lnet_peer_discovery_disabled;
 extern unsigned int lnet_drop_asym_route;
+extern unsigned int lnet_coalesce_size;
+extern unsigned int lnet_large_mtu;
 extern unsigned int router_sensitivity_percentage;
 extern int alive_router_check_interval;
 extern int live_router_check_interval;
 extern int dead_router_check_interval;
 extern int portal_rotor;
 
+/* largest payload of a MD */
+static inline unsigned int
+lnet_max_payload(void)
+{
+	return lnet_large_mtu ? LNET_MTU_LARGE : LNET_MTU;
+}
+
+/* largest number of fragments of a MD */
+static inline unsigned int
+lnet_max_iov(void)
+{
+	return lnet_large_mtu ? LNET_MAX_IOV_LARGE : LNET_MAX_IOV;
+}
+
+/* largest payload of a message sent or received on @ni */
+static inline unsigned int
+lnet_ni_mtu(struct lnet_ni *ni)
+{
+	if (!lnet_large_mtu || ni->ni_mtu <= LNET_MTU)
+		return LNET_MTU;
+	return min_t(unsigned int, ni->ni_mtu, LNET_MTU_LARGE);
+}
+
+/* largest payload of a message @lpni accepts */
+static inline unsigned int
+lnet_peer_ni_mtu(struct lnet_peer_ni *lpni)
+{
+	return max_t(unsigned int, lpni->lpni_mtu, LNET_MTU);
+}
+
 void lnet_mt_event_handler(struct lnet_event *event);
 
 int lnet_notify(struct lnet_ni *ni, lnet_nid_t peer, bool alive, bool reset,
@@ -626,7 +752,7 @@ void lnet_move_route(struct lnet_route *route, struct lnet_peer *lp,
 void lnet_destroy_routes(void);
 int lnet_get_route(int idx, __u32 *net, __u32 *hops,
 		   lnet_nid_t *gateway, __u32 *alive, __u32 *priority,
-		   __u32 *sensitivity);
+		   __u32 *sensitivity, __u32 *rtt);
 int lnet_get_rtr_pool_cfg(int idx, struct lnet_ioctl_pool_cfg *pool_cfg);
 struct lnet_ni *lnet_get_next_ni_locked(struct lnet_net *mynet,
 					struct lnet_ni *prev);
@@ -638,6 +764,7 @@ extern int libcfs_ioctl_getdata(struct libcfs_ioctl_hdr **hdr_pp,
 extern int lnet_get_peer_list(__u32 *countp, __u32 *sizep,
 			      struct lnet_process_id __user *ids);
 extern void lnet_peer_ni_set_healthv(lnet_nid_t nid, int value, bool all);
+int lnet_get_peer_ni_rtt(struct lnet_ioctl_rtt *rtt);
 extern void lnet_peer_ni_add_to_recoveryq_locked(struct lnet_peer_ni *lpni,
 						 struct list_head *queue,
 						 time64_t now);
@@ -660,6 +787,7 @@ int  lnet_rtrpools_adjust(int tiny, int small, int large);
 int lnet_rtrpools_enable(void);
 void lnet_rtrpools_disable(void);
 void lnet_rtrpools_free(int keep_pools);
+void lnet_rtrpools_resize(void);
 void lnet_rtr_transfer_to_peer(struct lnet_peer *src,
 			       struct lnet_peer *target);
 struct lnet_remotenet *lnet_find_rnet_locked(__u32 net);
@@ -779,6 +907,9 @@ void lnet_handle_remote_failure_locked(struct lnet_peer_ni *lpni);
 
 void lnet_drop_message(struct lnet_ni *ni, int cpt, void *private,
 		       unsigned int nob, __u32 msg_type);
+void lnet_bundle_finalize(struct lnet_msg *msg, int status);
+void lnet_bundle_reserve(void);
+void lnet_bundle_reserve_free(void);
 void lnet_drop_delayed_msg_list(struct list_head *head, char *reason);
 void lnet_recv_delayed_msg_list(struct list_head *head);
 
@@ -46,6 +46,7 @@
 #include <linux/semaphore.h>
 #include <linux/types.h>
 #include <linux/kref.h>
+#include <linux/llist.h>
 #include <net/genetlink.h>
 
 #include <uapi/linux/lnet/lnet-nl.h>
@@ -74,6 +75,9 @@ int cfs_match_nid_net(struct lnet_nid *nid, u32 net,
 
 /** limit on the number of fragments in discontiguous MDs */
 #define LNET_MAX_IOV	256
+/** same limit when large messages are enabled, see lnet_large_mtu */
+#define LNET_MAX_IOV_LARGE	\
+	(LNET_MAX_IOV << (LNET_MTU_LARGE_BITS - LNET_MTU_BITS))
 
 /*
  * This is the maximum health value.
@@ -84,6 +88,7 @@ int cfs_match_nid_net(struct lnet_nid *nid, u32 net,
 
 /* forward refs */
 struct lnet_libmd;
+struct lnet_bundle;
 
 enum lnet_msg_hstatus {
 	LNET_MSG_STATUS_OK = 0,
@@ -136,6 +141,8 @@ struct lnet_msg {
 	 * has not completed.
 	 */
 	ktime_t			msg_deadline;
+	/* when the message was committed for sending */
+	ktime_t			msg_tx_start;
 
 	/* The message health status. */
 	enum lnet_msg_hstatus	msg_health_status;
@@ -147,6 +154,8 @@ struct lnet_msg {
 	int			msg_retry_count;
 	/* flag to indicate that we do not want to resend this message */
 	bool			msg_no_resend;
+	/* carrier of coalesced messages, sent or received */
+	struct lnet_bundle	*msg_bundle;
 
 	/* committed for sending */
 	unsigned int		msg_tx_committed:1;
@@ -175,6 +184,8 @@ struct lnet_msg {
 	unsigned int          msg_peerrtrcredit:1; /* taken a peer router credit */
 	unsigned int          msg_onactivelist:1; /* on the activelist */
 	unsigned int	      msg_rdma_get:1;
+	unsigned int	      msg_bundled:1;	  /* split out of a bundle */
+	unsigned int	      msg_carried:1;	  /* sent in a bundle */
 
 	struct lnet_peer_ni  *msg_txpeer;         /* peer I'm sending to */
 	struct lnet_peer_ni  *msg_rxpeer;         /* peer I received from */
@@ -232,7 +243,7 @@ struct lnet_libmd {
 	struct lnet_rsp_tracker *md_rspt_ptr;
 	lnet_handler_t		 md_handler;
 	struct lnet_handle_md	 md_bulk_handle;
-	struct bio_vec		 md_kiov[LNET_MAX_IOV];
+	struct bio_vec		 md_kiov[LNET_MAX_IOV_LARGE];
 };
 
 #define LNET_MD_FLAG_ZOMBIE	 BIT(0)
@@ -403,6 +414,14 @@ struct lnet_health_remote_stats {
 	atomic_t hlt_network_timeout;
 };
 
+/* smoothed round trip time of sends over a path, updated without locking */
+struct lnet_rtt {
+	/* EWMA of send completion times in usecs, 0 until the first sample */
+	__u32			rtt_srtt;
+	/* when the last sample was taken */
+	time64_t		rtt_stamp;
+};
+
 struct lnet_net {
 	/* chain on the ln_nets */
 	struct list_head	net_list;
@@ -543,6 +562,14 @@ struct lnet_ni {
 	/* the relative selection priority of this NI */
 	__u32			ni_sel_priority;
 
+	/* send completion latency over this NI */
+	struct lnet_rtt		ni_rtt;
+
+	/* largest payload the LND can send or receive on this NI, set by
+	 * the LND at startup. 0 means LNET_MTU
+	 */
+	unsigned int		ni_mtu;
+
 	/*
 	 * equivalent interface to use
 	 */
@@ -551,6 +578,8 @@ struct lnet_ni {
 };
 
 #define LNET_PROTO_PING_MATCHBITS	0x8000000000000000LL
+/* a PUT carrying several coalesced messages, see lnet_bundle_tx_locked() */
+#define LNET_PROTO_BUNDLE_MATCHBITS	0x4000000000000000LL
 
 /*
  * Descriptor of a ping info buffer: keep a separate indicator of the
@@ -649,6 +678,12 @@ struct lnet_peer_ni {
 	struct list_head	lpni_rtr_pref_nids;
 	/* The relative selection priority of this peer NI */
 	__u32			lpni_sel_priority;
+	/* send completion latency to this peer NI */
+	struct lnet_rtt		lpni_rtt;
+	/* largest payload the peer NI accepts, as reported by the peer.
+	 * 0 means LNET_MTU
+	 */
+	unsigned int		lpni_mtu;
 	/* number of preferred NIDs in lnpi_pref_nids */
 	__u32			lpni_pref_nnids;
 };
@@ -830,6 +865,10 @@ struct lnet_peer {
  * which is also configured by Lustre as the primary NID.
  */
 #define LNET_PEER_BAD_CONFIG		BIT(21)
+/* peer splits coalesced messages, LNET_PING_FEAT_COALESCE was set */
+#define LNET_PEER_COALESCE		BIT(22)
+/* peer accepts large messages, LNET_PING_FEAT_LARGE_MTU was set */
+#define LNET_PEER_LARGE_MTU		BIT(23)
 
 struct lnet_peer_net {
 	/* chain on lp_peer_nets */
@@ -856,6 +895,9 @@ struct lnet_peer_net {
 	/* relative peer net selection priority */
 	__u32			lpn_sel_priority;
 
+	/* send completion latency to the peer over this net */
+	struct lnet_rtt		lpn_rtt;
+
 	/* reference count */
 	atomic_t		lpn_refcount;
 };
@@ -907,6 +949,7 @@ struct lnet_route {
 	unsigned int		lr_priority;	/* route priority */
 	atomic_t		lr_alive;	/* cached route aliveness */
 	bool			lr_single_hop;  /* this route is single-hop */
+	struct lnet_rtt		lr_rtt;		/* latency to the gateway */
 };
 
 #define LNET_REMOTE_NETS_HASH_DEFAULT	(1U << 7)
@@ -944,6 +987,17 @@ struct lnet_rtrbufpool {
 	int			rbp_credits;
 	/* low water mark */
 	int			rbp_mincredits;
+	/* configured # buffers, floor for automatic resizing */
+	int			rbp_base_nbuffers;
+	/* low water mark since the last automatic resize pass */
+	int			rbp_resize_mincredits;
+	/* # consecutive resize passes the pool was mostly idle */
+	int			rbp_idle_passes;
+	/* # messages that had to wait for a buffer */
+	__u64			rbp_nblocked;
+	/* # times the pool was grown / shrunk automatically */
+	__u64			rbp_ngrow;
+	__u64			rbp_nshrink;
 };
 
 struct lnet_rtrbuf {
@@ -1052,6 +1106,16 @@ struct lnet_res_container {
 };
 
 /* message container */
+/* Recently freed objects of one kind kept for reuse on a CPT. Frees push
+ * without locking, allocations take oc_lock with a trylock since
+ * llist_del_first() needs its callers serialized. */
+struct lnet_obj_cache {
+	spinlock_t		oc_lock;
+	struct llist_head	oc_free;
+	/* # objects on oc_free */
+	atomic_t		oc_nfree;
+};
+
 struct lnet_msg_container {
 	int			msc_init;	/* initialized or not */
 	/* max # threads finalizing */
@@ -1151,6 +1215,9 @@ struct lnet {
 	struct cfs_percpt_lock		*ln_net_lock;
 	/* percpt message containers for active/finalizing/freed message */
 	struct lnet_msg_container	**ln_msg_containers;
+	/* percpt caches of freed messages and small MDs */
+	struct lnet_obj_cache		**ln_msg_cache;
+	struct lnet_obj_cache		**ln_md_cache;
 	struct lnet_counters		**ln_counters;
 	struct lnet_peer_table		**ln_peer_tables;
 	/* list of peer nis not on a local network */
@@ -1169,6 +1236,10 @@ struct lnet {
 	struct list_head		ln_msg_resend;
 	/* spin lock to protect the msg resend list */
 	spinlock_t			ln_msg_resend_lock;
+	/* bundles reserved for coalescing, see lnet_bundle_reserve() */
+	struct list_head		ln_bundles;
+	int				ln_nbundles;
+	spinlock_t			ln_bundle_lock;
 
 	/* remote networks with routes to them */
 	struct list_head		*ln_remote_nets_hash;
@@ -44,7 +44,7 @@ struct ksock_hello_msg {
 	__u64			kshm_src_incarnation; /* sender's incarnation */
 	__u64			kshm_dst_incarnation; /* destination's incarnation */
 	__u32			kshm_ctype;	/* SOCKLND_CONN_* */
-	__u32			kshm_nips;	/* always sent as zero */
+	__u32			kshm_nips;	/* 0, or 1 for KSOCK_HELLO_STRIPE */
 	__u32			kshm_ips[0];	/* deprecated */
 } __packed;
 
@@ -72,6 +72,24 @@ struct ksock_msg_hdr {
 
 #define KSOCK_MSG_NOOP		0xc0		/* empty */
 #define KSOCK_MSG_LNET		0xc1		/* lnet msg */
+#define KSOCK_MSG_STRIPE	0xc2		/* one stripe of a lnet msg */
+
+/* Sent by a V3 peer as the only entry of kshm_ips[] to say it can
+ * reassemble KSOCK_MSG_STRIPE; never a valid address and the same in
+ * either byte order
+ */
+#define KSOCK_HELLO_STRIPE	0xffffffff
+
+/* A large LNet message may be split into stripes sent on several
+ * connections to the same peer.  Every stripe carries the complete LNet
+ * header so whichever arrives first can be parsed; the receiver matches
+ * the rest by kss_cookie.
+ */
+struct ksock_stripe_hdr {
+	__u64			kss_cookie;	/* identifies the lnet msg */
+	__u32			kss_offset;	/* payload offset of stripe */
+	__u32			kss_nob;	/* payload bytes in stripe */
+} __packed;
 
 struct ksock_msg {
 	struct ksock_msg_hdr	ksm_kh;
@@ -84,6 +102,11 @@ struct ksock_msg {
 		 *      kshm_version >= KSOCK_PROTO_V4
 		 */
 		struct lnet_hdr_nid16 lnetmsg_nid16;
+		/* case ksm_kh.ksh_type == KSOCK_MSG_STRIPE */
+		struct {
+			struct lnet_hdr_nid4	ksms_lnetmsg;
+			struct ksock_stripe_hdr	ksms_stripe;
+		} __packed stripe;
 	} __packed ksm_u;
 } __packed;
 #define ksm_type ksm_kh.ksh_type
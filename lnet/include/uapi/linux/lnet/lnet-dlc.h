@@ -149,6 +149,7 @@ struct lnet_ioctl_config_data {
 			__u32 rtr_priority;
 			__u32 rtr_flags;
 			__u32 rtr_sensitivity;
+			__u32 rtr_rtt_us;
 		} cfg_route;
 		struct {
 			char net_intf[LNET_MAX_STR_LEN];
@@ -214,6 +215,14 @@ struct lnet_ioctl_peer_ni_hstats {
 	__u64 hlpni_next_ping;
 };
 
+/* round trip time estimate of a local or peer NI, 0 if unknown */
+struct lnet_ioctl_rtt {
+	struct libcfs_ioctl_hdr rtt_hdr;
+	lnet_nid_t rtt_nid;
+	enum lnet_health_type rtt_type:32;
+	__u32 rtt_us;
+};
+
 struct lnet_ioctl_element_msg_stats {
 	struct libcfs_ioctl_hdr im_hdr;
 	__u32 im_idx;
@@ -254,7 +254,7 @@ struct lnet_counters_common {
 struct lnet_ni_status {
 	lnet_nid_t ns_nid;
 	__u32      ns_status;
-	__u32      ns_unused;
+	__u32      ns_mtu;	/* max payload if LNET_PING_FEAT_LARGE_MTU */
 } __attribute__((packed));
 
 /*
@@ -267,6 +267,8 @@ struct lnet_ni_status {
 #define LNET_PING_FEAT_RTE_DISABLED	(1 << 2)        /* Routing enabled */
 #define LNET_PING_FEAT_MULTI_RAIL	(1 << 3)        /* Multi-Rail aware */
 #define LNET_PING_FEAT_DISCOVERY	(1 << 4)	/* Supports Discovery */
+#define LNET_PING_FEAT_COALESCE		(1 << 5)	/* Splits bundled msgs */
+#define LNET_PING_FEAT_LARGE_MTU	(1 << 6)	/* ns_mtu is valid */
 
 /*
  * All ping feature bits fit to hit the wire.
@@ -280,7 +282,9 @@ struct lnet_ni_status {
 					 LNET_PING_FEAT_NI_STATUS | \
 					 LNET_PING_FEAT_RTE_DISABLED | \
 					 LNET_PING_FEAT_MULTI_RAIL | \
-					 LNET_PING_FEAT_DISCOVERY)
+					 LNET_PING_FEAT_DISCOVERY | \
+					 LNET_PING_FEAT_COALESCE | \
+					 LNET_PING_FEAT_LARGE_MTU)
 
 struct lnet_ping_info {
 	__u32			pi_magic;
@@ -440,6 +440,12 @@ struct lnet_md {
 #define LNET_MTU_BITS	20
 #define LNET_MTU	(1 << LNET_MTU_BITS)
 
+/* Max payload of a message between peers which both advertise
+ * LNET_PING_FEAT_LARGE_MTU on all the NIs they may use. Such messages
+ * are never routed, router buffers stay LNET_MTU sized. */
+#define LNET_MTU_LARGE_BITS	24
+#define LNET_MTU_LARGE		(1 << LNET_MTU_LARGE_BITS)
+
 /**
  * Options for the MD structure. See struct lnet_md::options.
  */
@@ -40,9 +40,11 @@
 
 #define LST_FEAT_NONE		(0)
 #define LST_FEAT_BULK_LEN	(1 << 0)	/* enable variable page size */
+#define LST_FEAT_LATENCY	(1 << 1)	/* latency histogram, rr test */
 
 #define LST_FEATS_EMPTY		(LST_FEAT_NONE)
-#define LST_FEATS_MASK		(LST_FEAT_NONE | LST_FEAT_BULK_LEN)
+#define LST_FEATS_MASK		(LST_FEAT_NONE | LST_FEAT_BULK_LEN | \
+				 LST_FEAT_LATENCY)
 
 #define LST_NAME_SIZE		32		/* max name buffer length */
 
@@ -65,6 +67,7 @@
 #define LSTIO_TEST_ADD		0xC26		/* add test (to batch) */
 #define LSTIO_BATCH_QUERY	0xC27		/* query batch status */
 #define LSTIO_STAT_QUERY	0xC30		/* get stats */
+#define LSTIO_LAT_QUERY		0xC31		/* get latency histogram */
 
 /*
  * sparse kernel source annotations
@@ -452,7 +455,8 @@ struct lstio_stat_args {
 
 enum lst_test_type {
 	LST_TEST_BULK	= 1,
-	LST_TEST_PING	= 2
+	LST_TEST_PING	= 2,
+	LST_TEST_RR	= 3
 };
 
 /* create a test in a batch */
@@ -514,6 +518,15 @@ struct lst_test_ping_param {
 	int png_flags;		/* reserved flags */
 };
 
+/* max request/reply size of the request-reply test */
+#define LST_RR_SIZE_MAX		4096
+
+struct lst_test_rr_param {
+	int rr_req_size;	/* size (bytes) of request message */
+	int rr_rep_size;	/* size (bytes) of reply message */
+	int rr_flags;		/* reserved flags */
+};
+
 /* Both struct srpc_counters and struct sfw_counters are sent over the wire */
 struct srpc_counters {
 	__u32 errors;
@@ -534,4 +547,44 @@ struct sfw_counters {
 	__u32 ping_errors;
 } __attribute__((packed));
 
+/*
+ * RPC latency histogram, in microseconds. Buckets are log-linear: values
+ * below 2^LST_LAT_SUB_BITS have a bucket each, and every further power of
+ * two is split into 2^LST_LAT_SUB_BITS buckets, so the relative error of
+ * a bucket is at most 12.5%. The last bucket collects everything above
+ * ~8 seconds. The histogram is fetched from test nodes in
+ * chunks of LST_LAT_CHUNK buckets, see LSTIO_LAT_QUERY.
+ */
+#define LST_LAT_SUB_BITS	3
+#define LST_LAT_NBUCKETS	168
+#define LST_LAT_CHUNK		28
+
+static inline unsigned int lst_lat_bucket(__u64 usec)
+{
+	unsigned int msb;
+	unsigned int idx;
+
+	if (usec < (1 << LST_LAT_SUB_BITS))
+		return usec;
+
+	msb = 63 - __builtin_clzll(usec);
+	idx = ((msb - LST_LAT_SUB_BITS + 1) << LST_LAT_SUB_BITS) +
+	      ((usec >> (msb - LST_LAT_SUB_BITS)) &
+	       ((1 << LST_LAT_SUB_BITS) - 1));
+
+	return idx < LST_LAT_NBUCKETS ? idx : LST_LAT_NBUCKETS - 1;
+}
+
+/* lowest latency (usec) which falls into bucket @idx */
+static inline __u64 lst_lat_bucket_floor(unsigned int idx)
+{
+	unsigned int sub = idx & ((1 << LST_LAT_SUB_BITS) - 1);
+
+	if (idx < (1 << LST_LAT_SUB_BITS))
+		return idx;
+
+	return (__u64)(sub | (1 << LST_LAT_SUB_BITS)) <<
+	       ((idx >> LST_LAT_SUB_BITS) - 1);
+}
+
 #endif
@@ -31,6 +31,8 @@
 #ifndef __UAPI_LNET_SOCKLND_H__
 #define __UAPI_LNET_SOCKLND_H__
 
+#include <linux/types.h>
+
 #define SOCKLND_CONN_NONE     (-1)
 #define SOCKLND_CONN_ANY	0
 #define SOCKLND_CONN_CONTROL	1
@@ -40,4 +42,18 @@
 
 #define SOCKLND_CONN_ACK	SOCKLND_CONN_BULK_IN
 
+/* Per-connection payload accounting, copied to ioc_pbuf1 by
+ * IOC_LIBCFS_GET_CONN when the caller supplies a large enough buffer.
+ */
+struct ksock_conn_stats {
+	__u64	kcs_tx_zc_bytes;	/* payload sent zero-copy */
+	__u64	kcs_tx_zc_copied;	/* zero-copy payload the stack copied */
+	__u64	kcs_tx_copy_bytes;	/* payload copied into the socket */
+	__u64	kcs_rx_bytes;		/* payload received into pages */
+	__u64	kcs_tx_stripes;		/* message stripes queued */
+	__u64	kcs_rx_stripes;		/* message stripes received */
+	__u64	kcs_tx_zc_msgs;		/* txs sent with MSG_ZEROCOPY */
+	__u64	kcs_tx_zc_done;		/* MSG_ZEROCOPY txs completed */
+};
+
 #endif
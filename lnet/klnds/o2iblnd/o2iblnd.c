@@ -741,6 +741,7 @@ kiblnd_create_conn(struct kib_peer_ni *peer_ni, struct rdma_cm_id *cmid,
 #ifdef HAVE_IB_CQ_INIT_ATTR
 	struct ib_cq_init_attr  cq_attr = {};
 #endif
+	struct kib_srq		*srq = NULL;
 	struct kib_conn	*conn;
 	struct ib_cq		*cq;
 	unsigned long		flags;
@@ -869,6 +870,15 @@ kiblnd_create_conn(struct kib_peer_ni *peer_ni, struct rdma_cm_id *cmid,
 	init_qp_attr.send_cq = cq;
 	init_qp_attr.recv_cq = cq;
 
+	/* a queue created before an HCA failover can't serve this conn */
+	if (net->ibn_srq != NULL) {
+		srq = net->ibn_srq[cpt];
+		if (srq->srq_srq == NULL || srq->srq_hdev != conn->ibc_hdev)
+			srq = NULL;
+		else
+			init_qp_attr.srq = srq->srq_srq;
+	}
+
 	if (peer_ni->ibp_queue_depth_mod &&
 	    peer_ni->ibp_queue_depth_mod < peer_ni->ibp_queue_depth) {
 		conn->ibc_queue_depth = peer_ni->ibp_queue_depth_mod;
@@ -882,7 +892,7 @@ kiblnd_create_conn(struct kib_peer_ni *peer_ni, struct rdma_cm_id *cmid,
 		 * the maximum work requests for the device is maxed out
 		 */
 		init_qp_attr.cap.max_send_wr = kiblnd_send_wrs(conn);
-		init_qp_attr.cap.max_recv_wr = IBLND_RECV_WRS(conn);
+		init_qp_attr.cap.max_recv_wr = srq ? 0 : IBLND_RECV_WRS(conn);
 		rc = rdma_create_qp(cmid, conn->ibc_hdev->ibh_pd,
 				    &init_qp_attr);
 		if (rc != -ENOMEM || conn->ibc_queue_depth < 2)
@@ -912,6 +922,14 @@ kiblnd_create_conn(struct kib_peer_ni *peer_ni, struct rdma_cm_id *cmid,
 		peer_ni->ibp_queue_depth_mod = conn->ibc_queue_depth;
 	}
 
+	if (srq != NULL) {
+		/* receives land in the CPT's shared queue, the conn only
+		 * owns a buffer from its completion until its repost */
+		conn->ibc_srq = srq;
+		atomic_set(&conn->ibc_refcount, 1);	/* caller's ref */
+		goto init_done;
+	}
+
 	LIBCFS_CPT_ALLOC(conn->ibc_rxs, lnet_cpt_table(), cpt,
 			 IBLND_RX_MSGS(conn) * sizeof(struct kib_rx));
 	if (conn->ibc_rxs == NULL) {
@@ -959,6 +977,7 @@ kiblnd_create_conn(struct kib_peer_ni *peer_ni, struct rdma_cm_id *cmid,
                 }
         }
 
+init_done:
         /* Init successful! */
         LASSERT (state == IBLND_CONN_ACTIVE_CONNECT ||
                  state == IBLND_CONN_PASSIVE_WAIT);
@@ -975,6 +994,25 @@ kiblnd_create_conn(struct kib_peer_ni *peer_ni, struct rdma_cm_id *cmid,
         return NULL;
 }
 
+/* shared buffers that completed after the last ref went must go back to the
+ * queue, not vanish with the CQ */
+static void
+kiblnd_srq_drain_cq(struct kib_conn *conn)
+{
+	struct kib_rx *rx;
+	struct ib_wc wc;
+
+	while (ib_poll_cq(conn->ibc_cq, 1, &wc) > 0) {
+		if (kiblnd_wreqid2type(wc.wr_id) != IBLND_WID_RX)
+			continue;
+
+		rx = kiblnd_wreqid2ptr(wc.wr_id);
+		LASSERT(rx->rx_srq == conn->ibc_srq);
+		atomic_dec(&rx->rx_srq->srq_nposted);
+		kiblnd_srq_post_rx(rx);
+	}
+}
+
 void
 kiblnd_destroy_conn(struct kib_conn *conn)
 {
@@ -1010,6 +1048,9 @@ kiblnd_destroy_conn(struct kib_conn *conn)
 	if (cmid != NULL && cmid->qp != NULL)
 		rdma_destroy_qp(cmid);
 
+	if (conn->ibc_srq != NULL && conn->ibc_cq != NULL)
+		kiblnd_srq_drain_cq(conn);
+
 	if (conn->ibc_cq)
 		ib_destroy_cq(conn->ibc_cq);
 
@@ -1170,6 +1211,8 @@ kiblnd_ctl(struct lnet_ni *ni, unsigned int cmd, void *arg)
 		else
 			data->ioc_u32[0] =
 			ib_mtu_enum_to_int(conn->ibc_cmid->route.path_rec->mtu);
+		data->ioc_u64[0] = READ_ONCE(conn->ibc_poll_hits);
+		data->ioc_u32[1] = atomic_read(&conn->ibc_rdma_lkey);
 		kiblnd_conn_decref(conn);
 		break;
         }
@@ -1293,6 +1336,462 @@ kiblnd_map_rx_descs(struct kib_conn *conn)
 	}
 }
 
+static void kiblnd_srq_queue_work(struct kib_srq *srq, bool grow);
+
+int
+kiblnd_srq_post_rx(struct kib_rx *rx)
+{
+	struct kib_srq *srq = rx->rx_srq;
+	struct kib_srq_chunk *chunk = rx->rx_srq_chunk;
+	struct ib_recv_wr *bad_wrq = NULL;
+	bool reap;
+	int rc = 0;
+
+	rx->rx_conn = NULL;
+
+	spin_lock(&srq->srq_lock);
+	if (chunk->srqc_retired) {
+		/* shrinking, it stays out of the queue until it's freed */
+		rx->rx_nob = 0;
+		goto idle;
+	}
+	spin_unlock(&srq->srq_lock);
+
+	rx->rx_sge.lkey = srq->srq_lkey;
+	rx->rx_sge.addr = rx->rx_msgaddr;
+	rx->rx_sge.length = IBLND_MSG_SIZE;
+
+	rx->rx_wrq.next = NULL;
+	rx->rx_wrq.sg_list = &rx->rx_sge;
+	rx->rx_wrq.num_sge = 1;
+	rx->rx_wrq.wr_id = kiblnd_ptr2wreqid(rx, IBLND_WID_RX);
+
+	rx->rx_nob = -1;			/* flag posted */
+	atomic_inc(&srq->srq_nposted);
+
+	/* NB rx may complete on another CPU as soon as it's posted */
+#ifdef HAVE_IB_POST_SEND_RECV_CONST
+	rc = ib_post_srq_recv(srq->srq_srq, &rx->rx_wrq,
+			      (const struct ib_recv_wr **)&bad_wrq);
+#else
+	rc = ib_post_srq_recv(srq->srq_srq, &rx->rx_wrq, &bad_wrq);
+#endif
+	if (likely(rc == 0))
+		return 0;
+
+	CERROR("%s: can't post shared rx on CPT %d: %d\n",
+	       libcfs_nidstr(&srq->srq_net->ibn_ni->ni_nid),
+	       srq->srq_cpt, rc);
+	atomic_dec(&srq->srq_nposted);
+	rx->rx_nob = 0;
+	spin_lock(&srq->srq_lock);
+idle:
+	chunk->srqc_nidle++;
+	reap = chunk->srqc_retired && chunk->srqc_nidle == chunk->srqc_nrx;
+	spin_unlock(&srq->srq_lock);
+
+	/* the last one back frees the chunk */
+	if (reap)
+		kiblnd_srq_queue_work(srq, false);
+
+	return rc;
+}
+
+/* hand @srq to connd to grow it (limit event) or to reap retired chunks */
+static void
+kiblnd_srq_queue_work(struct kib_srq *srq, bool grow)
+{
+	unsigned long flags;
+
+	spin_lock_irqsave(&kiblnd_data.kib_connd_lock, flags);
+	if (!srq->srq_shutdown) {
+		if (grow)
+			srq->srq_grow_pending = 1;
+		else
+			srq->srq_reap_pending = 1;
+
+		if (!srq->srq_queued) {
+			srq->srq_queued = 1;
+			list_add_tail(&srq->srq_list,
+				      &kiblnd_data.kib_connd_srqs);
+			wake_up(&kiblnd_data.kib_connd_waitq);
+		}
+	}
+	spin_unlock_irqrestore(&kiblnd_data.kib_connd_lock, flags);
+}
+
+static void
+kiblnd_srq_event(struct ib_event *event, void *arg)
+{
+	struct kib_srq *srq = arg;
+
+	switch (event->event) {
+	case IB_EVENT_SRQ_LIMIT_REACHED:
+		/* running short of posted buffers, connd adds some more */
+		kiblnd_srq_queue_work(srq, true);
+		return;
+
+	default:
+		CERROR("%s: async SRQ event type %d on CPT %d\n",
+		       libcfs_nidstr(&srq->srq_net->ibn_ni->ni_nid),
+		       event->event, srq->srq_cpt);
+		return;
+	}
+}
+
+static void
+kiblnd_srq_arm(struct kib_srq *srq)
+{
+	struct ib_srq_attr attr = {};
+	int rc;
+
+	/* ask for IB_EVENT_SRQ_LIMIT_REACHED once 3/4 of the buffers are
+	 * in use.  The limit disarms itself when it fires. */
+	attr.srq_limit = max(srq->srq_nrx / 4, 1);
+	rc = ib_modify_srq(srq->srq_srq, &attr, IB_SRQ_LIMIT);
+	if (rc != 0)
+		CWARN("%s: can't arm SRQ limit on CPT %d: %d\n",
+		      libcfs_nidstr(&srq->srq_net->ibn_ni->ni_nid),
+		      srq->srq_cpt, rc);
+}
+
+static void
+kiblnd_srq_free_chunk(struct kib_srq *srq, struct kib_srq_chunk *chunk)
+{
+	struct kib_rx *rx;
+	int i;
+
+	for (i = 0; i < chunk->srqc_nrx; i++) {
+		rx = &chunk->srqc_rxs[i];
+
+		kiblnd_dma_unmap_single(srq->srq_hdev->ibh_ibdev,
+					KIBLND_UNMAP_ADDR(rx, rx_msgunmap,
+							  rx->rx_msgaddr),
+					IBLND_MSG_SIZE, DMA_FROM_DEVICE);
+	}
+
+	kiblnd_free_pages(chunk->srqc_pages);
+	CFS_FREE_PTR_ARRAY(chunk->srqc_rxs, chunk->srqc_nrx);
+	LIBCFS_FREE(chunk, sizeof(*chunk));
+}
+
+static int
+kiblnd_srq_add_rxs(struct kib_srq *srq, int nrx)
+{
+	struct ib_device *ibdev = srq->srq_hdev->ibh_ibdev;
+	struct kib_srq_chunk *chunk;
+	struct kib_rx *rx;
+	struct page *pg;
+	bool reap;
+	int npages;
+	int pg_off;
+	int ipg;
+	int rc;
+	int i;
+
+	LIBCFS_CPT_ALLOC(chunk, lnet_cpt_table(), srq->srq_cpt,
+			 sizeof(*chunk));
+	if (chunk == NULL)
+		return -ENOMEM;
+
+	LIBCFS_CPT_ALLOC(chunk->srqc_rxs, lnet_cpt_table(), srq->srq_cpt,
+			 nrx * sizeof(struct kib_rx));
+	if (chunk->srqc_rxs == NULL) {
+		LIBCFS_FREE(chunk, sizeof(*chunk));
+		return -ENOMEM;
+	}
+
+	npages = (nrx * IBLND_MSG_SIZE + PAGE_SIZE - 1) / PAGE_SIZE;
+	rc = kiblnd_alloc_pages(&chunk->srqc_pages, srq->srq_cpt, npages);
+	if (rc != 0) {
+		CFS_FREE_PTR_ARRAY(chunk->srqc_rxs, nrx);
+		LIBCFS_FREE(chunk, sizeof(*chunk));
+		return rc;
+	}
+
+	chunk->srqc_nrx = nrx;
+
+	for (pg_off = ipg = i = 0; i < nrx; i++) {
+		pg = chunk->srqc_pages->ibp_pages[ipg];
+		rx = &chunk->srqc_rxs[i];
+
+		rx->rx_srq = srq;
+		rx->rx_srq_chunk = chunk;
+		rx->rx_msg = (struct kib_msg *)(((char *)page_address(pg)) + pg_off);
+
+		rx->rx_msgaddr = kiblnd_dma_map_single(ibdev, rx->rx_msg,
+						       IBLND_MSG_SIZE,
+						       DMA_FROM_DEVICE);
+		LASSERT(!kiblnd_dma_mapping_error(ibdev, rx->rx_msgaddr));
+		KIBLND_UNMAP_ADDR_SET(rx, rx_msgunmap, rx->rx_msgaddr);
+
+		pg_off += IBLND_MSG_SIZE;
+		LASSERT(pg_off <= PAGE_SIZE);
+
+		if (pg_off == PAGE_SIZE) {
+			pg_off = 0;
+			ipg++;
+			LASSERT(ipg <= npages);
+		}
+	}
+
+	spin_lock(&srq->srq_lock);
+	list_add_tail(&chunk->srqc_list, &srq->srq_chunks);
+	srq->srq_nrx += nrx;
+	spin_unlock(&srq->srq_lock);
+
+	/* descs that fail to post stay idle until the chunk is freed */
+	for (i = 0; i < nrx; i++) {
+		rc = kiblnd_srq_post_rx(&chunk->srqc_rxs[i]);
+		if (rc != 0)
+			break;
+	}
+
+	if (i < nrx) {
+		spin_lock(&srq->srq_lock);
+		chunk->srqc_nidle += nrx - i - 1;
+		reap = chunk->srqc_retired &&
+		       chunk->srqc_nidle == chunk->srqc_nrx;
+		spin_unlock(&srq->srq_lock);
+
+		if (reap)
+			kiblnd_srq_queue_work(srq, false);
+	}
+
+	return rc;
+}
+
+/* called for each buffer a conn takes off the queue.  Once the queue has
+ * kept more buffers posted than it needed for a whole srq_shrink_interval,
+ * the newest chunk is retired: its buffers leave the queue as they're
+ * consumed and connd frees it when the last one is back.  The initial chunk
+ * is never retired, and only one chunk is retired at a time. */
+void
+kiblnd_srq_check_shrink(struct kib_srq *srq, int nposted)
+{
+	int interval = *kiblnd_tunables.kib_srq_shrink_interval;
+	time64_t now = ktime_get_seconds();
+	struct kib_srq_chunk *chunk;
+	int nrx = 0;
+
+	if (interval <= 0)
+		return;
+
+	spin_lock(&srq->srq_lock);
+	srq->srq_min_posted = min(srq->srq_min_posted, nposted);
+	if (now < srq->srq_shrink_check + interval) {
+		spin_unlock(&srq->srq_lock);
+		return;
+	}
+
+	chunk = list_last_entry(&srq->srq_chunks, struct kib_srq_chunk,
+				srqc_list);
+	if (srq->srq_nretired == 0 &&
+	    chunk != list_first_entry(&srq->srq_chunks, struct kib_srq_chunk,
+				      srqc_list) &&
+	    srq->srq_min_posted - chunk->srqc_nrx >=
+	    (srq->srq_nrx - chunk->srqc_nrx) / 2) {
+		/* half the rest would still have been spare */
+		chunk->srqc_retired = true;
+		nrx = chunk->srqc_nrx;
+		srq->srq_nrx -= nrx;
+		srq->srq_nretired += nrx;
+	}
+	srq->srq_min_posted = nposted;
+	srq->srq_shrink_check = now;
+	spin_unlock(&srq->srq_lock);
+
+	if (nrx == 0)
+		return;
+
+	CDEBUG(D_NET, "%s: shrinking shared receive queue of CPT %d by %d buffers to %d\n",
+	       libcfs_nidstr(&srq->srq_net->ibn_ni->ni_nid), srq->srq_cpt,
+	       nrx, srq->srq_nrx);
+
+	/* connd re-arms the limit for the smaller queue */
+	kiblnd_srq_queue_work(srq, false);
+}
+
+/* free the retired chunks whose buffers have all come back */
+static void
+kiblnd_srq_reap(struct kib_srq *srq)
+{
+	struct kib_srq_chunk *chunk;
+	struct kib_srq_chunk *tmp;
+	LIST_HEAD(zombies);
+
+	spin_lock(&srq->srq_lock);
+	list_for_each_entry_safe(chunk, tmp, &srq->srq_chunks, srqc_list) {
+		if (chunk->srqc_retired &&
+		    chunk->srqc_nidle == chunk->srqc_nrx) {
+			list_move(&chunk->srqc_list, &zombies);
+			srq->srq_nretired -= chunk->srqc_nrx;
+		}
+	}
+	spin_unlock(&srq->srq_lock);
+
+	while ((chunk = list_first_entry_or_null(&zombies,
+						 struct kib_srq_chunk,
+						 srqc_list)) != NULL) {
+		list_del(&chunk->srqc_list);
+		CDEBUG(D_NET, "%s: freed %d buffers of shared receive queue of CPT %d\n",
+		       libcfs_nidstr(&srq->srq_net->ibn_ni->ni_nid),
+		       chunk->srqc_nrx, srq->srq_cpt);
+		kiblnd_srq_free_chunk(srq, chunk);
+	}
+}
+
+/* called by connd when the queue's limit event fired */
+static void
+kiblnd_srq_grow(struct kib_srq *srq)
+{
+	const char *nidstr = libcfs_nidstr(&srq->srq_net->ibn_ni->ni_nid);
+	int nrx;
+	int rc;
+
+	/* double up to the cap, the rate buffers are consumed at between
+	 * two limit events is what sizes the queue.  Retired buffers may
+	 * still be posted, so they count against the cap too. */
+	spin_lock(&srq->srq_lock);
+	nrx = min(srq->srq_nrx,
+		  srq->srq_max - srq->srq_nrx - srq->srq_nretired);
+	/* it needed all it had, don't shrink it again straight away */
+	srq->srq_min_posted = 0;
+	srq->srq_shrink_check = ktime_get_seconds();
+	spin_unlock(&srq->srq_lock);
+
+	if (nrx <= 0) {
+		/* stay disarmed, peers ride out bursts on RNR retries */
+		CWARN("%s: shared receive queue of CPT %d is at its limit of %d buffers, consider increasing srq_max_size\n",
+		      nidstr, srq->srq_cpt, srq->srq_nrx);
+		return;
+	}
+
+	rc = kiblnd_srq_add_rxs(srq, nrx);
+	if (rc != 0)
+		CWARN("%s: can't add %d buffers to shared receive queue of CPT %d: %d\n",
+		      nidstr, nrx, srq->srq_cpt, rc);
+
+	CDEBUG(D_NET, "%s: shared receive queue of CPT %d has %d buffers, %d posted\n",
+	       nidstr, srq->srq_cpt, srq->srq_nrx,
+	       atomic_read(&srq->srq_nposted));
+
+	kiblnd_srq_arm(srq);
+}
+
+/* connd's work on @srq: @grow when the limit event fired, @reap when
+ * chunks were retired or the last buffer of one came back */
+void
+kiblnd_srq_work(struct kib_srq *srq, bool grow, bool reap)
+{
+	if (reap)
+		kiblnd_srq_reap(srq);
+
+	if (grow)
+		kiblnd_srq_grow(srq);		/* re-arms */
+	else if (reap)
+		kiblnd_srq_arm(srq);
+}
+
+static void
+kiblnd_srq_fini(struct kib_srq *srq)
+{
+	struct kib_srq_chunk *chunk;
+	unsigned long flags;
+
+	if (srq->srq_hdev == NULL)	/* never initialised */
+		return;
+
+	spin_lock_irqsave(&kiblnd_data.kib_connd_lock, flags);
+	srq->srq_shutdown = 1;
+	if (srq->srq_queued && !list_empty(&srq->srq_list)) {
+		list_del_init(&srq->srq_list);
+		srq->srq_queued = 0;
+	}
+	spin_unlock_irqrestore(&kiblnd_data.kib_connd_lock, flags);
+
+	/* connd may be growing or reaping it right now */
+	wait_var_event(srq, !srq->srq_queued);
+
+	/* all the conns are gone, so are their QPs */
+	if (srq->srq_srq != NULL)
+		ib_destroy_srq(srq->srq_srq);
+
+	while ((chunk = list_first_entry_or_null(&srq->srq_chunks,
+						 struct kib_srq_chunk,
+						 srqc_list)) != NULL) {
+		list_del(&chunk->srqc_list);
+		kiblnd_srq_free_chunk(srq, chunk);
+	}
+
+	kiblnd_hdev_decref(srq->srq_hdev);
+	srq->srq_hdev = NULL;
+}
+
+static void
+kiblnd_srq_init(struct kib_net *net, struct kib_srq *srq, int cpt)
+{
+	const char *nidstr = libcfs_nidstr(&net->ibn_ni->ni_nid);
+	struct ib_srq_init_attr attr = {};
+	struct kib_hca_dev *hdev;
+	struct ib_srq *ibsrq;
+	unsigned long flags;
+	int rc;
+
+	read_lock_irqsave(&kiblnd_data.kib_global_lock, flags);
+	hdev = net->ibn_dev->ibd_hdev;
+	kiblnd_hdev_addref_locked(hdev);
+	read_unlock_irqrestore(&kiblnd_data.kib_global_lock, flags);
+
+	srq->srq_net = net;
+	srq->srq_hdev = hdev;
+	srq->srq_cpt = cpt;
+	atomic_set(&srq->srq_nposted, 0);
+	spin_lock_init(&srq->srq_lock);
+	INIT_LIST_HEAD(&srq->srq_chunks);
+	INIT_LIST_HEAD(&srq->srq_list);
+	srq->srq_min_posted = INT_MAX;
+	srq->srq_shrink_check = ktime_get_seconds();
+#ifdef HAVE_IB_GET_DMA_MR
+	srq->srq_lkey = hdev->ibh_mrs->lkey;
+#else
+	srq->srq_lkey = hdev->ibh_pd->local_dma_lkey;
+#endif
+	srq->srq_max = *kiblnd_tunables.kib_srq_max_size;
+	if (hdev->ibh_max_srq_wr > 0)
+		srq->srq_max = min(srq->srq_max, hdev->ibh_max_srq_wr);
+
+	attr.event_handler = kiblnd_srq_event;
+	attr.srq_context = srq;
+	attr.attr.max_wr = srq->srq_max;
+	attr.attr.max_sge = 1;
+
+	/* failing here isn't fatal: conns of this CPT just post their own
+	 * receive buffers as they always did */
+	ibsrq = ib_create_srq(hdev->ibh_pd, &attr);
+	if (IS_ERR(ibsrq)) {
+		CWARN("%s: can't create shared receive queue for CPT %d, using per-connection buffers: %ld\n",
+		      nidstr, cpt, PTR_ERR(ibsrq));
+		return;
+	}
+	srq->srq_srq = ibsrq;
+
+	rc = kiblnd_srq_add_rxs(srq, min(*kiblnd_tunables.kib_srq_size,
+					 srq->srq_max));
+	if (rc != 0 && srq->srq_nrx == 0) {
+		CWARN("%s: can't fill shared receive queue for CPT %d, using per-connection buffers: %d\n",
+		      nidstr, cpt, rc);
+		ib_destroy_srq(ibsrq);
+		srq->srq_srq = NULL;
+		return;
+	}
+
+	kiblnd_srq_arm(srq);
+
+	CDEBUG(D_NET, "%s: shared receive queue for CPT %d: %d buffers, max %d\n",
+	       nidstr, cpt, srq->srq_nrx, srq->srq_max);
+}
+
 static void
 kiblnd_unmap_tx_pool(struct kib_tx_pool *tpo)
 {
@@ -2384,6 +2883,14 @@ kiblnd_net_fini_pools(struct kib_net *net)
 		cfs_percpt_free(net->ibn_fmr_ps);
 		net->ibn_fmr_ps = NULL;
 	}
+
+	if (net->ibn_srq != NULL) {
+		cfs_cpt_for_each(i, lnet_cpt_table())
+			kiblnd_srq_fini(net->ibn_srq[i]);
+
+		cfs_percpt_free(net->ibn_srq);
+		net->ibn_srq = NULL;
+	}
 }
 
 static int
@@ -2479,6 +2986,22 @@ kiblnd_net_init_pools(struct kib_net *net, struct lnet_ni *ni, __u32 *cpts,
 		}
 	}
 
+	if (!*kiblnd_tunables.kib_use_srq)
+		return 0;
+
+	net->ibn_srq = cfs_percpt_alloc(lnet_cpt_table(),
+					sizeof(struct kib_srq));
+	if (net->ibn_srq == NULL) {
+		CERROR("Failed to allocate shared receive queue array\n");
+		rc = -ENOMEM;
+		goto failed;
+	}
+
+	for (i = 0; i < ncpts; i++) {
+		cpt = (cpts == NULL) ? i : cpts[i];
+		kiblnd_srq_init(net, net->ibn_srq[cpt], cpt);
+	}
+
 	return 0;
  failed:
 	kiblnd_net_fini_pools(net);
@@ -2601,6 +3124,7 @@ kiblnd_hdev_get_attr(struct kib_hca_dev *hdev)
 
 	hdev->ibh_mr_size = dev_attr->max_mr_size;
 	hdev->ibh_max_qp_wr = dev_attr->max_qp_wr;
+	hdev->ibh_max_srq_wr = dev_attr->max_srq_wr;
 
 	/* Setup device Memory Registration capabilities */
 #ifdef HAVE_FMR_POOL_API
@@ -3106,6 +3630,7 @@ kiblnd_base_startup(struct net *ns)
 	spin_lock_init(&kiblnd_data.kib_connd_lock);
 	INIT_LIST_HEAD(&kiblnd_data.kib_connd_conns);
 	INIT_LIST_HEAD(&kiblnd_data.kib_connd_waits);
+	INIT_LIST_HEAD(&kiblnd_data.kib_connd_srqs);
 	INIT_LIST_HEAD(&kiblnd_data.kib_connd_zombies);
 	INIT_LIST_HEAD(&kiblnd_data.kib_reconn_list);
 	INIT_LIST_HEAD(&kiblnd_data.kib_reconn_wait);
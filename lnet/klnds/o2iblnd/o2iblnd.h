@@ -117,6 +117,18 @@ struct kib_tunables {
 	int		 *kib_nscheds;
 	int		 *kib_wrq_sge;		/* # sg elements per wrq */
 	int		 *kib_use_fastreg_gaps; /* enable discontiguous fastreg fragment support */
+	/* send RDMA from the PD local DMA lkey, no per-transfer registration */
+	int		 *kib_use_local_dma_lkey;
+	/* receive into a shared queue per CPT instead of per-conn buffers */
+	int		 *kib_use_srq;
+	/* initial # of buffers in each shared receive queue */
+	int		 *kib_srq_size;
+	/* # of buffers a shared receive queue may grow to */
+	int		 *kib_srq_max_size;
+	/* secs a shared receive queue must be oversized before it shrinks */
+	int		 *kib_srq_shrink_interval;
+	/* max usecs to busy poll an idle CQ before re-arming it */
+	int		 *kib_busy_poll;
 };
 
 extern struct kib_tunables  kiblnd_tunables;
@@ -151,6 +163,8 @@ extern struct kib_tunables  kiblnd_tunables;
 
 /* max size of queued messages (inc hdr) */
 #define IBLND_MSG_SIZE              (4<<10)
+/* RNR NAKs are retried forever, see kiblnd_rnr_retry_count() */
+#define IBLND_RNR_RETRY_INFINITE	7
 /* max # of fragments supported. + 1 for unaligned case */
 #define IBLND_MAX_RDMA_FRAGS        (LNET_MAX_IOV + 1)
 
@@ -220,6 +234,7 @@ struct kib_hca_dev {
 	__u64                ibh_page_mask;     /* page mask of current HCA */
 	__u64                ibh_mr_size;       /* size of MR */
 	int		     ibh_max_qp_wr;     /* maximum work requests size */
+	int		     ibh_max_srq_wr;    /* maximum SRQ work requests */
 #ifdef HAVE_IB_GET_DMA_MR
 	struct ib_mr        *ibh_mrs;           /* global MR */
 #endif
@@ -409,11 +424,52 @@ struct kib_net {
 
 	struct kib_tx_poolset	**ibn_tx_ps;	/* tx pool-set */
 	struct kib_fmr_poolset	**ibn_fmr_ps;	/* fmr pool-set */
+	struct kib_srq		**ibn_srq;	/* shared rx queues */
 
 	struct kib_dev		*ibn_dev;	/* underlying IB device */
 	struct lnet_ni          *ibn_ni;        /* LNet interface */
 };
 
+struct kib_srq_chunk {
+	/* chain on kib_srq::srq_chunks */
+	struct list_head	srqc_list;
+	/* the rx descs */
+	struct kib_rx		*srqc_rxs;
+	/* premapped rx msg pages */
+	struct kib_pages	*srqc_pages;
+	/* # rx descs */
+	int			srqc_nrx;
+	/* # rx descs neither posted nor held by a conn */
+	int			srqc_nidle;
+	/* being shrunk away: rx descs aren't reposted */
+	bool			srqc_retired;
+};
+
+/* receive buffers shared by all the connections of one CPT */
+struct kib_srq {
+	struct kib_net		*srq_net;	/* owner */
+	struct kib_hca_dev	*srq_hdev;	/* HCA the queue lives on */
+	struct ib_srq		*srq_srq;	/* NULL if not in use */
+	int			srq_cpt;	/* CPT of the buffers */
+	__u32			srq_lkey;	/* lkey of the buffers */
+	int			srq_max;	/* # rx descs allowed */
+	atomic_t		srq_nposted;	/* # rx descs posted */
+	/* serialises the chunks and the shrink accounting below */
+	spinlock_t		srq_lock;
+	int			srq_nrx;	/* # rx descs in service */
+	int			srq_nretired;	/* # rx descs being freed */
+	struct list_head	srq_chunks;	/* rx descs, per growth */
+	/* fewest rx descs posted since srq_shrink_check */
+	int			srq_min_posted;
+	time64_t		srq_shrink_check;
+	/* chain on kib_connd_srqs, protected by kib_connd_lock */
+	struct list_head	srq_list;
+	unsigned int		srq_queued:1;	/* on/in connd */
+	unsigned int		srq_grow_pending:1;
+	unsigned int		srq_reap_pending:1;
+	unsigned int		srq_shutdown:1;
+};
+
 #define KIB_THREAD_SHIFT		16
 #define KIB_THREAD_ID(cpt, tid)		((cpt) << KIB_THREAD_SHIFT | (tid))
 #define KIB_THREAD_CPT(id)		((id) >> KIB_THREAD_SHIFT)
@@ -431,6 +487,8 @@ struct kib_sched_info {
 	/* max allowed scheduler threads */
 	int			ibs_nthreads_max;
 	int			ibs_cpt;	/* CPT id */
+	/* current busy poll time in ns, adapts to traffic on this CPT */
+	s64			ibs_poll_ns;
 };
 
 struct kib_data {
@@ -458,6 +516,8 @@ struct kib_data {
 	struct list_head	kib_reconn_wait;
 	/* connections wait for completion */
 	struct list_head	kib_connd_waits;
+	/* shared receive queues running low on buffers */
+	struct list_head	kib_connd_srqs;
 	/*
 	 * The second that peers are pulled out from \a kib_reconn_wait
 	 * for reconnection.
@@ -480,6 +540,10 @@ struct kib_rx {					/* receive message */
 	struct list_head	rx_list;
 	/* owning conn */
 	struct kib_conn	       *rx_conn;
+	/* shared receive queue, NULL if owned by rx_conn */
+	struct kib_srq	       *rx_srq;
+	/* growth of rx_srq the rx desc belongs to */
+	struct kib_srq_chunk   *rx_srq_chunk;
 	/* # bytes received (-1 while posted) */
 	int			rx_nob;
 	/* message buffer (host vaddr) */
@@ -546,6 +610,8 @@ struct kib_tx {					/* transmit message */
 	__u64			*tx_pages;
 	/* gaps in fragments */
 	bool			tx_gaps;
+	/* local RDMA source is addressed by the PD local DMA lkey */
+	bool			tx_src_lkey;
 	/* FMR */
 	struct kib_fmr		tx_fmr;
 				/* dma direction */
@@ -602,6 +668,12 @@ struct kib_conn {
 	unsigned int		ibc_scheduled:1;
 	/* CQ callback fired */
 	unsigned int		ibc_ready:1;
+	/* when busy polling of the empty CQ started, 0 when not polling */
+	ktime_t			ibc_poll_start;
+	/* # completions found by busy polling */
+	__u64			ibc_poll_hits;
+	/* # RDMAs sent from the PD local DMA lkey */
+	atomic_t		ibc_rdma_lkey;
 	/* time of last send */
 	ktime_t			ibc_last_send;
 	/** link chain for kiblnd_check_conns only */
@@ -626,6 +698,8 @@ struct kib_conn {
 	struct kib_rx		*ibc_rxs;
 	/* premapped rx msg pages */
 	struct kib_pages	*ibc_rx_pages;
+	/* shared receive queue instead of the above */
+	struct kib_srq		*ibc_srq;
 
 	/* CM id */
 	struct rdma_cm_id	*ibc_cmid;
@@ -943,6 +1017,18 @@ kiblnd_wreqid2type (__u64 wreqid)
         return (wreqid & IBLND_WID_MASK);
 }
 
+/* RNR retries the peer does when sending to this conn.  A shared receive
+ * queue can run dry for a moment while connd grows it; the peer's credits
+ * don't cover that, so it has to keep retrying rather than drop the QP. */
+static inline int
+kiblnd_rnr_retry_count(struct kib_conn *conn)
+{
+	if (conn->ibc_srq != NULL)
+		return IBLND_RNR_RETRY_INFINITE;
+
+	return *kiblnd_tunables.kib_rnr_retry_count;
+}
+
 static inline void
 kiblnd_set_conn_state(struct kib_conn *conn, int state)
 {
@@ -1155,6 +1241,9 @@ void kiblnd_pack_msg(struct lnet_ni *ni, struct kib_msg *msg, int version,
 		     int credits, lnet_nid_t dstnid, __u64 dststamp);
 int kiblnd_unpack_msg(struct kib_msg *msg, int nob);
 int kiblnd_post_rx(struct kib_rx *rx, int credit);
+int kiblnd_srq_post_rx(struct kib_rx *rx);
+void kiblnd_srq_check_shrink(struct kib_srq *srq, int nposted);
+void kiblnd_srq_work(struct kib_srq *srq, bool grow, bool reap);
 
 int kiblnd_send(struct lnet_ni *ni, void *private, struct lnet_msg *lntmsg);
 int kiblnd_recv(struct lnet_ni *ni, void *private, struct lnet_msg *lntmsg,
@@ -137,6 +137,7 @@ kiblnd_get_idle_tx(struct lnet_ni *ni, lnet_nid_t target)
         LASSERT (tx->tx_nfrags == 0);
 
 	tx->tx_gaps = false;
+	tx->tx_src_lkey = false;
 	tx->tx_hstatus = LNET_MSG_STATUS_OK;
 
         return tx;
@@ -149,6 +150,10 @@ kiblnd_drop_rx(struct kib_rx *rx)
 	struct kib_sched_info *sched = conn->ibc_sched;
 	unsigned long flags;
 
+	/* a shared buffer goes back to its queue, not to waste */
+	if (rx->rx_srq != NULL)
+		kiblnd_srq_post_rx(rx);
+
 	spin_lock_irqsave(&sched->ibs_lock, flags);
 	LASSERT(conn->ibc_nrx > 0);
 	conn->ibc_nrx--;
@@ -173,6 +178,29 @@ kiblnd_post_rx(struct kib_rx *rx, int credit)
 	LASSERT (credit == IBLND_POSTRX_NO_CREDIT ||
 		 credit == IBLND_POSTRX_PEER_CREDIT ||
 		 credit == IBLND_POSTRX_RSRVD_CREDIT);
+
+	if (rx->rx_srq != NULL) {
+		/* repost before returning the credit the peer spent on it,
+		 * and don't touch rx after that */
+		LASSERT(rx->rx_nob >= 0);	/* not posted */
+		kiblnd_conn_addref(conn);
+		kiblnd_drop_rx(rx);
+
+		if (credit != IBLND_POSTRX_NO_CREDIT &&
+		    conn->ibc_state == IBLND_CONN_ESTABLISHED) {
+			spin_lock(&conn->ibc_lock);
+			if (credit == IBLND_POSTRX_PEER_CREDIT)
+				conn->ibc_outstanding_credits++;
+			else
+				conn->ibc_reserved_credits++;
+			kiblnd_check_sends_locked(conn);
+			spin_unlock(&conn->ibc_lock);
+		}
+
+		kiblnd_conn_decref(conn);
+		return 0;
+	}
+
 #ifdef HAVE_IB_GET_DMA_MR
 	LASSERT(mr != NULL);
 
@@ -742,6 +770,21 @@ static int kiblnd_map_tx(struct lnet_ni *ni, struct kib_tx *tx,
 	}
 #endif
 
+	/*
+	 * The local source of an RDMA write is only accessed by the local
+	 * HCA, so the PD local DMA lkey covers it without registration.
+	 * This saves a FastReg/FMR map and invalidate for each bulk sent,
+	 * e.g. for every OSS read. kiblnd_init_rdma() still registers the
+	 * source if it turns out too fragmented for the peer's sink.
+	 * Bulk buffers are not pre-registered with the LND by their users:
+	 * the lkey covers any DMA-mapped page, pooled or not.
+	 */
+	if (rd == tx->tx_rd && *kiblnd_tunables.kib_use_local_dma_lkey) {
+		rd->rd_key = hdev->ibh_pd->local_dma_lkey;
+		tx->tx_src_lkey = true;
+		return 0;
+	}
+
 	if (net->ibn_fmr_ps != NULL)
 		return kiblnd_fmr_map_tx(net, tx, rd, nob);
 
@@ -1148,6 +1191,20 @@ kiblnd_init_tx_msg(struct lnet_ni *ni, struct kib_tx *tx, int type,
 	tx->tx_nwrq++;
 }
 
+/*
+ * Upper bound of the work requests needed to RDMA \a srcrd into \a dstrd:
+ * one per destination fragment, plus one each time a work request runs
+ * out of scatter/gather elements.
+ */
+static int
+kiblnd_rdma_wrs(struct kib_rdma_desc *srcrd, struct kib_rdma_desc *dstrd)
+{
+	int nsge = srcrd->rd_nfrags + dstrd->rd_nfrags - 1;
+
+	return dstrd->rd_nfrags +
+	       DIV_ROUND_UP(nsge, *kiblnd_tunables.kib_wrq_sge);
+}
+
 static int
 kiblnd_init_rdma(struct kib_conn *conn, struct kib_tx *tx, int type,
 		 int resid, struct kib_rdma_desc *dstrd, u64 dstcookie)
@@ -1166,6 +1223,24 @@ kiblnd_init_rdma(struct kib_conn *conn, struct kib_tx *tx, int type,
 	LASSERT(tx->tx_nwrq == 0 && tx->tx_nsge == 0);
 	LASSERT(type == IBLND_MSG_GET_DONE || type == IBLND_MSG_PUT_DONE);
 
+	if (tx->tx_src_lkey &&
+	    kiblnd_rdma_wrs(srcrd, dstrd) > conn->ibc_max_frags) {
+		struct kib_net *net = conn->ibc_peer->ibp_ni->ni_data;
+
+		/* too many fragments to send from the lkey, register them */
+		CDEBUG(D_NET, "register %d src frags for %d dst frags to %s\n",
+		       srcrd->rd_nfrags, dstrd->rd_nfrags,
+		       libcfs_nid2str(conn->ibc_peer->ibp_nid));
+		tx->tx_src_lkey = false;
+		rc = -EINVAL;
+		if (net->ibn_fmr_ps != NULL)
+			rc = kiblnd_fmr_map_tx(net, tx, srcrd,
+					       kiblnd_rd_size(srcrd));
+		if (rc < 0)
+			goto out;
+		rc = resid;
+	}
+
 	for (srcidx = dstidx = wrq_sge = sge_nob = 0;
 	     resid > 0; resid -= sge_nob) {
 		int	prev = dstidx;
@@ -1236,8 +1311,11 @@ kiblnd_init_rdma(struct kib_conn *conn, struct kib_tx *tx, int type,
 		tx->tx_nsge++;
 	}
 
+out:
 	if (rc < 0)	/* no RDMA if completing with failure */
 		tx->tx_nwrq = tx->tx_nsge = 0;
+	else if (tx->tx_src_lkey)
+		atomic_inc(&conn->ibc_rdma_lkey);
 
         ibmsg->ibm_u.completion.ibcm_status = rc;
         ibmsg->ibm_u.completion.ibcm_cookie = dstcookie;
@@ -1655,7 +1733,13 @@ kiblnd_send(struct lnet_ni *ni, void *private, struct lnet_msg *lntmsg)
 	       payload_nob, payload_niov, libcfs_idstr(target));
 
 	LASSERT (payload_nob == 0 || payload_niov > 0);
-	LASSERT (payload_niov <= LNET_MAX_IOV);
+	/* The frags may describe a large MD, but o2iblnd leaves ni_mtu at
+	 * LNET_MTU, so LNet never sends more than that through it. Only the
+	 * frags covering payload_nob are mapped, and they fit the LNET_MAX_IOV
+	 * sized tx page and FMR arrays.
+	 */
+	LASSERT(payload_niov <= LNET_MAX_IOV_LARGE);
+	LASSERTF(payload_nob <= LNET_MTU, "payload_nob %u\n", payload_nob);
 
 	/* Thread context */
 	LASSERT (!in_interrupt());
@@ -2690,7 +2774,7 @@ kiblnd_passive_connect(struct rdma_cm_id *cmid, void *priv, int priv_nob)
 	cp.initiator_depth     = 0;
 	cp.flow_control        = 1;
 	cp.retry_count         = *kiblnd_tunables.kib_retry_count;
-	cp.rnr_retry_count     = *kiblnd_tunables.kib_rnr_retry_count;
+	cp.rnr_retry_count     = kiblnd_rnr_retry_count(conn);
 
 	CDEBUG(D_NET, "Accept %s\n", libcfs_nid2str(nid));
 
@@ -3108,7 +3192,7 @@ kiblnd_active_connect(struct rdma_cm_id *cmid)
         cp.initiator_depth     = 0;
         cp.flow_control        = 1;
         cp.retry_count         = *kiblnd_tunables.kib_retry_count;
-        cp.rnr_retry_count     = *kiblnd_tunables.kib_rnr_retry_count;
+        cp.rnr_retry_count     = kiblnd_rnr_retry_count(conn);
 
         LASSERT(cmid->context == (void *)conn);
         LASSERT(conn->ibc_cmid == cmid);
@@ -3471,6 +3555,7 @@ kiblnd_connd (void *arg)
 	wait_queue_entry_t wait;
 	unsigned long flags;
 	struct kib_conn *conn;
+	struct kib_srq *srq;
 	int timeout;
 	int i;
 	bool dropped_lock;
@@ -3565,6 +3650,31 @@ kiblnd_connd (void *arg)
 			spin_lock_irqsave(lock, flags);
 		}
 
+		srq = list_first_entry_or_null(&kiblnd_data.kib_connd_srqs,
+					       struct kib_srq, srq_list);
+		if (srq) {
+			bool grow = srq->srq_grow_pending;
+			bool reap = srq->srq_reap_pending;
+
+			list_del_init(&srq->srq_list);
+			srq->srq_grow_pending = 0;
+			srq->srq_reap_pending = 0;
+			spin_unlock_irqrestore(lock, flags);
+			dropped_lock = true;
+
+			kiblnd_srq_work(srq, grow, reap);
+
+			spin_lock_irqsave(lock, flags);
+			if ((srq->srq_grow_pending || srq->srq_reap_pending) &&
+			    !srq->srq_shutdown) {
+				list_add_tail(&srq->srq_list,
+					      &kiblnd_data.kib_connd_srqs);
+			} else {
+				srq->srq_queued = 0;
+				wake_up_var(srq);
+			}
+		}
+
 		conn = list_first_entry_or_null(&kiblnd_data.kib_connd_waits,
 						struct kib_conn, ibc_list);
 		if (conn) {
@@ -3672,9 +3782,31 @@ kiblnd_qp_event(struct ib_event *event, void *arg)
 	}
 }
 
+/* a shared buffer belongs to the conn it completed on until it's reposted,
+ * just like one the conn posted itself */
 static void
-kiblnd_complete (struct ib_wc *wc)
+kiblnd_srq_attach_rx(struct kib_conn *conn, struct kib_rx *rx)
 {
+	struct kib_sched_info *sched = conn->ibc_sched;
+	unsigned long flags;
+
+	LASSERT(rx->rx_srq == conn->ibc_srq);
+
+	kiblnd_srq_check_shrink(rx->rx_srq,
+				atomic_dec_return(&rx->rx_srq->srq_nposted));
+	rx->rx_conn = conn;
+	kiblnd_conn_addref(conn);
+
+	spin_lock_irqsave(&sched->ibs_lock, flags);
+	conn->ibc_nrx++;
+	spin_unlock_irqrestore(&sched->ibs_lock, flags);
+}
+
+static void
+kiblnd_complete(struct kib_conn *conn, struct ib_wc *wc)
+{
+	struct kib_rx *rx;
+
 	switch (kiblnd_wreqid2type(wc->wr_id)) {
 	default:
 		LBUG();
@@ -3700,10 +3832,12 @@ kiblnd_complete (struct ib_wc *wc)
                 kiblnd_tx_complete(kiblnd_wreqid2ptr(wc->wr_id), wc->status);
                 return;
 
-        case IBLND_WID_RX:
-                kiblnd_rx_complete(kiblnd_wreqid2ptr(wc->wr_id), wc->status,
-                                   wc->byte_len);
-                return;
+	case IBLND_WID_RX:
+		rx = kiblnd_wreqid2ptr(wc->wr_id);
+		if (rx->rx_srq != NULL)
+			kiblnd_srq_attach_rx(conn, rx);
+		kiblnd_rx_complete(rx, wc->status, wc->byte_len);
+		return;
         }
 }
 
@@ -3714,10 +3848,14 @@ kiblnd_cq_completion(struct ib_cq *cq, void *arg)
 	 * reached 0.  Since fundamentally I'm racing with scheduler threads
 	 * consuming my CQ I could be called after all completions have
 	 * occurred.  But in this case, ibc_nrx == 0 && ibc_nsends_posted == 0
-	 * and this CQ is about to be destroyed so I NOOP. */
+	 * and this CQ is about to be destroyed so I NOOP.  A conn receiving
+	 * into a shared queue owns no buffers between messages, so it is
+	 * only scheduled if it still has a ref; kiblnd_destroy_conn() gives
+	 * back whatever it didn't reap. */
 	struct kib_conn	*conn = arg;
 	struct kib_sched_info *sched = conn->ibc_sched;
 	unsigned long flags;
+	bool schedule_conn = false;
 
 	LASSERT(cq == conn->ibc_cq);
 
@@ -3725,10 +3863,18 @@ kiblnd_cq_completion(struct ib_cq *cq, void *arg)
 
 	conn->ibc_ready = 1;
 
-	if (!conn->ibc_scheduled &&
-	    (conn->ibc_nrx > 0 ||
-	     conn->ibc_nsends_posted > 0)) {
-		kiblnd_conn_addref(conn); /* +1 ref for sched_conns */
+	if (!conn->ibc_scheduled) {
+		if (conn->ibc_srq != NULL) {
+			/* +1 ref for sched_conns */
+			schedule_conn = atomic_inc_not_zero(&conn->ibc_refcount);
+		} else if (conn->ibc_nrx > 0 ||
+			   conn->ibc_nsends_posted > 0) {
+			kiblnd_conn_addref(conn); /* +1 ref for sched_conns */
+			schedule_conn = true;
+		}
+	}
+
+	if (schedule_conn) {
 		conn->ibc_scheduled = 1;
 		list_add_tail(&conn->ibc_sched_list, &sched->ibs_conns);
 
@@ -3748,6 +3894,68 @@ kiblnd_cq_event(struct ib_event *event, void *arg)
                libcfs_nid2str(conn->ibc_peer->ibp_nid), event->event);
 }
 
+/*
+ * Busy polling: rather than re-arming the CQ of a conn as soon as it is
+ * empty, keep polling it for a while, so that a completion arriving soon
+ * after is reaped without an interrupt and a scheduler wakeup. The polling
+ * time adapts on each CPT: it doubles, up to busy_poll, when polling finds
+ * a completion and halves, down to 1/16th of it, when it expires in vain.
+ */
+#define IBLND_BUSY_POLL_BACKOFF	4
+
+static s64
+kiblnd_busy_poll_ns(struct kib_sched_info *sched, s64 max_ns)
+{
+	s64 ns = READ_ONCE(sched->ibs_poll_ns);
+
+	if (ns <= 0 || ns > max_ns)
+		ns = max_ns;
+	return max(ns, max_ns >> IBLND_BUSY_POLL_BACKOFF);
+}
+
+/* polling of conn found a completion */
+static void
+kiblnd_busy_poll_hit(struct kib_sched_info *sched, struct kib_conn *conn)
+{
+	s64 max_ns = (s64)*kiblnd_tunables.kib_busy_poll * NSEC_PER_USEC;
+
+	conn->ibc_poll_start = 0;
+	conn->ibc_poll_hits++;
+	if (max_ns > 0)
+		WRITE_ONCE(sched->ibs_poll_ns,
+			   min(kiblnd_busy_poll_ns(sched, max_ns) * 2,
+			       max_ns));
+}
+
+/* the CQ of conn is empty, returns true to poll it again before re-arming */
+static bool
+kiblnd_busy_poll(struct kib_sched_info *sched, struct kib_conn *conn)
+{
+	s64 max_ns = (s64)*kiblnd_tunables.kib_busy_poll * NSEC_PER_USEC;
+	ktime_t now;
+	s64 ns;
+
+	if (max_ns <= 0 || conn->ibc_state != IBLND_CONN_ESTABLISHED) {
+		conn->ibc_poll_start = 0;
+		return false;
+	}
+
+	now = ktime_get();
+	if (ktime_to_ns(conn->ibc_poll_start) == 0) {
+		conn->ibc_poll_start = now;
+		return true;
+	}
+
+	ns = kiblnd_busy_poll_ns(sched, max_ns);
+	if (ktime_to_ns(ktime_sub(now, conn->ibc_poll_start)) < ns)
+		return true;
+
+	/* idle, back off */
+	conn->ibc_poll_start = 0;
+	WRITE_ONCE(sched->ibs_poll_ns, ns / 2);
+	return false;
+}
+
 int
 kiblnd_scheduler(void *arg)
 {
@@ -3796,6 +4004,19 @@ kiblnd_scheduler(void *arg)
 			wc.wr_id = IBLND_WID_INVAL;
 
 			rc = ib_poll_cq(conn->ibc_cq, 1, &wc);
+			if (rc > 0 && ktime_to_ns(conn->ibc_poll_start) != 0)
+				kiblnd_busy_poll_hit(sched, conn);
+
+			if (rc == 0 && kiblnd_busy_poll(sched, conn)) {
+				/* poll again later, still holding the
+				 * kib_sched_conns ref and without waking
+				 * another scheduler */
+				spin_lock_irqsave(&sched->ibs_lock, flags);
+				list_add_tail(&conn->ibc_sched_list,
+					      &sched->ibs_conns);
+				continue;
+			}
+
 			if (rc == 0) {
 				rc = ib_req_notify_cq(conn->ibc_cq,
 						      IB_CQ_NEXT_COMP);
@@ -3853,7 +4074,7 @@ kiblnd_scheduler(void *arg)
 
 			if (rc != 0) {
 				spin_unlock_irqrestore(&sched->ibs_lock, flags);
-				kiblnd_complete(&wc);
+				kiblnd_complete(conn, &wc);
 
 				spin_lock_irqsave(&sched->ibs_lock, flags);
 			}
@@ -113,6 +113,30 @@ static int use_fastreg_gaps;
 module_param(use_fastreg_gaps, int, 0444);
 MODULE_PARM_DESC(use_fastreg_gaps, "Enable discontiguous fastreg fragment support. Expect performance drop");
 
+static int use_local_dma_lkey = 1;
+module_param(use_local_dma_lkey, int, 0444);
+MODULE_PARM_DESC(use_local_dma_lkey, "Send RDMA from the local DMA lkey instead of registering the source buffer of each transfer");
+
+static int use_srq;
+module_param(use_srq, int, 0444);
+MODULE_PARM_DESC(use_srq, "Receive into a shared receive queue per CPT instead of per-connection buffers");
+
+static int srq_size = 512;
+module_param(srq_size, int, 0444);
+MODULE_PARM_DESC(srq_size, "Initial # of buffers in each shared receive queue");
+
+static int srq_max_size = 16384;
+module_param(srq_max_size, int, 0444);
+MODULE_PARM_DESC(srq_max_size, "Maximum # of buffers each shared receive queue grows to");
+
+static int srq_shrink_interval = 60;
+module_param(srq_shrink_interval, int, 0644);
+MODULE_PARM_DESC(srq_shrink_interval, "Seconds a shared receive queue must keep more buffers than it needs before it shrinks (0 never shrinks)");
+
+static int busy_poll;
+module_param(busy_poll, int, 0644);
+MODULE_PARM_DESC(busy_poll, "Max microseconds schedulers busy poll an idle completion queue before re-arming it (0 disables)");
+
 /*
  * map_on_demand is a flag used to determine if we can use FMR or FastReg.
  * This is applicable for kernels which support global memory regions. For
@@ -198,6 +222,12 @@ struct kib_tunables kiblnd_tunables = {
 	.kib_nscheds		    = &nscheds,
 	.kib_wrq_sge		    = &wrq_sge,
 	.kib_use_fastreg_gaps       = &use_fastreg_gaps,
+	.kib_use_local_dma_lkey	    = &use_local_dma_lkey,
+	.kib_use_srq		    = &use_srq,
+	.kib_srq_size		    = &srq_size,
+	.kib_srq_max_size	    = &srq_max_size,
+	.kib_srq_shrink_interval    = &srq_shrink_interval,
+	.kib_busy_poll		    = &busy_poll,
 };
 
 static struct lnet_ioctl_config_o2iblnd_tunables default_tunables;
@@ -328,5 +358,10 @@ kiblnd_tunables_init(void)
 	default_tunables.lnd_fmr_cache = fmr_cache;
 	default_tunables.lnd_ntx = ntx;
 	default_tunables.lnd_conns_per_peer = conns_per_peer;
+
+	if (srq_size < 1)
+		srq_size = 1;
+	if (srq_max_size < srq_size)
+		srq_max_size = srq_size;
 	return 0;
 }
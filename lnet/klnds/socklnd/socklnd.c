@@ -186,6 +186,7 @@ ksocknal_create_peer(struct lnet_ni *ni, struct lnet_processid *id)
 	INIT_LIST_HEAD(&peer_ni->ksnp_conns);
 	INIT_LIST_HEAD(&peer_ni->ksnp_tx_queue);
 	INIT_LIST_HEAD(&peer_ni->ksnp_zc_req_list);
+	INIT_LIST_HEAD(&peer_ni->ksnp_rx_stripes);
 	spin_lock_init(&peer_ni->ksnp_lock);
 
 	return peer_ni;
@@ -205,6 +206,7 @@ ksocknal_destroy_peer(struct ksock_peer_ni *peer_ni)
 	LASSERT(peer_ni->ksnp_conn_cb == NULL);
 	LASSERT(list_empty(&peer_ni->ksnp_tx_queue));
 	LASSERT(list_empty(&peer_ni->ksnp_zc_req_list));
+	LASSERT(list_empty(&peer_ni->ksnp_rx_stripes));
 
 	LIBCFS_FREE(peer_ni, sizeof(*peer_ni));
 
@@ -893,6 +895,7 @@ ksocknal_create_conn(struct lnet_ni *ni, struct ksock_conn_cb *conn_cb,
 	conn->ksnc_rx_ready = 0;
 	conn->ksnc_rx_scheduled = 0;
 
+	INIT_LIST_HEAD(&conn->ksnc_rx_stripe_list);
 	INIT_LIST_HEAD(&conn->ksnc_tx_queue);
 	conn->ksnc_tx_ready = 0;
 	conn->ksnc_tx_scheduled = 0;
@@ -939,6 +942,12 @@ ksocknal_create_conn(struct lnet_ni *ni, struct ksock_conn_cb *conn_cb,
 #endif
 		}
 
+		/* offer to reassemble striped messages */
+		if (conn->ksnc_proto == &ksocknal_protocol_v3x) {
+			hello->kshm_nips = 1;
+			hello->kshm_ips[0] = KSOCK_HELLO_STRIPE;
+		}
+
 		rc = ksocknal_send_hello(ni, conn, &peerid.nid, hello);
 		if (rc != 0)
 			goto failed_1;
@@ -954,6 +963,11 @@ ksocknal_create_conn(struct lnet_ni *ni, struct ksock_conn_cb *conn_cb,
 	if (rc < 0)
 		goto failed_1;
 
+	/* a passive peer only echoes the offer if I made it */
+	conn->ksnc_stripe = conn->ksnc_proto == &ksocknal_protocol_v3x &&
+			    hello->kshm_nips == 1 &&
+			    hello->kshm_ips[0] == KSOCK_HELLO_STRIPE;
+
 	LASSERT(rc == 0 || active);
 	LASSERT(conn->ksnc_proto != NULL);
 	LASSERT(!LNET_NID_IS_ANY(&peerid.nid));
@@ -1137,6 +1151,10 @@ ksocknal_create_conn(struct lnet_ni *ni, struct ksock_conn_cb *conn_cb,
 	ksocknal_new_packet(conn, 0);
 
 	conn->ksnc_zc_capable = ksocknal_lib_zc_capable(conn);
+#ifdef HAVE_MSGHDR_MSG_UBUF
+	conn->ksnc_zc_msg = conn->ksnc_zc_capable &&
+			    *ksocknal_tunables.ksnd_tx_zerocopy;
+#endif
 
 	/* Take packets blocking for this connection. */
 	list_for_each_entry_safe(tx, txtmp, &peer_ni->ksnp_tx_queue, tx_list) {
@@ -1165,6 +1183,10 @@ ksocknal_create_conn(struct lnet_ni *ni, struct ksock_conn_cb *conn_cb,
 
 	if (!active) {
 		hello->kshm_nips = 0;
+		if (conn->ksnc_stripe) {
+			hello->kshm_nips = 1;
+			hello->kshm_ips[0] = KSOCK_HELLO_STRIPE;
+		}
 		rc = ksocknal_send_hello(ni, conn, &peerid.nid, hello);
 	}
 
@@ -1503,9 +1525,18 @@ void
 ksocknal_destroy_conn(struct ksock_conn *conn)
 {
 	time64_t last_rcv;
+	bool last_conn;
 
 	/* Final coup-de-grace of the reaper */
-	CDEBUG(D_NET, "connection %p\n", conn);
+	CDEBUG(D_NET, "connection %p tx zc %lld/zc copied %lld/copied %lld rx %lld stripes tx %lld/rx %lld zc msgs %lld/done %lld\n",
+	       conn, (s64)atomic64_read(&conn->ksnc_tx_zc_bytes),
+	       (s64)atomic64_read(&conn->ksnc_tx_zc_copied),
+	       (s64)atomic64_read(&conn->ksnc_tx_copy_bytes),
+	       (s64)atomic64_read(&conn->ksnc_rx_bytes),
+	       (s64)atomic64_read(&conn->ksnc_tx_stripes),
+	       (s64)atomic64_read(&conn->ksnc_rx_stripes),
+	       (s64)atomic64_read(&conn->ksnc_tx_zc_msgs),
+	       (s64)atomic64_read(&conn->ksnc_tx_zc_done));
 
 	LASSERT(refcount_read(&conn->ksnc_conn_refcount) == 0);
 	LASSERT(refcount_read(&conn->ksnc_sock_refcount) == 0);
@@ -1526,6 +1557,10 @@ ksocknal_destroy_conn(struct ksock_conn *conn)
 		       &conn->ksnc_peeraddr,
 		       conn->ksnc_rx_nob_wanted, conn->ksnc_rx_nob_left,
 		       ktime_get_seconds() - last_rcv);
+		if (conn->ksnc_rx_stripe) {
+			ksocknal_rx_stripe_done(conn, -EIO);
+			break;
+		}
 		if (conn->ksnc_lnet_msg)
 			conn->ksnc_lnet_msg->msg_health_status =
 				LNET_MSG_STATUS_REMOTE_ERROR;
@@ -1545,6 +1580,11 @@ ksocknal_destroy_conn(struct ksock_conn *conn)
 			       &conn->ksnc_peeraddr,
 			       conn->ksnc_proto->pro_version);
 		break;
+	case SOCKNAL_RX_STRIPE_HEADER:
+		CERROR("Incomplete receive of stripe header from %s, ip %pISp, with error\n",
+		       libcfs_idstr(&conn->ksnc_peer->ksnp_id),
+		       &conn->ksnc_peeraddr);
+		break;
 	case SOCKNAL_RX_SLOP:
 		if (conn->ksnc_rx_started)
 			CERROR("Incomplete receive of slops from %s, ip %pISp, with error\n",
@@ -1556,6 +1596,13 @@ ksocknal_destroy_conn(struct ksock_conn *conn)
 		break;
 	}
 
+	/* nothing can complete striped messages once all conns are gone */
+	read_lock(&ksocknal_data.ksnd_global_lock);
+	last_conn = list_empty(&conn->ksnc_peer->ksnp_conns);
+	read_unlock(&ksocknal_data.ksnd_global_lock);
+	if (last_conn)
+		ksocknal_rx_stripes_expire(conn->ksnc_peer, true);
+
 	ksocknal_peer_decref(conn->ksnc_peer);
 
 	LIBCFS_FREE(conn, sizeof(*conn));
@@ -1856,6 +1903,34 @@ ksocknal_ctl(struct lnet_ni *ni, unsigned int cmd, void *arg)
 		data->ioc_u32[4] = conn->ksnc_scheduler->kss_cpt;
                 data->ioc_u32[5] = rxmem;
                 data->ioc_u32[6] = conn->ksnc_peer->ksnp_id.pid;
+
+		if (data->ioc_pbuf1 &&
+		    data->ioc_plen1 >= sizeof(struct ksock_conn_stats)) {
+			struct ksock_conn_stats stats = {
+				.kcs_tx_zc_bytes =
+					atomic64_read(&conn->ksnc_tx_zc_bytes),
+				.kcs_tx_zc_copied =
+					atomic64_read(&conn->ksnc_tx_zc_copied),
+				.kcs_tx_copy_bytes =
+					atomic64_read(&conn->ksnc_tx_copy_bytes),
+				.kcs_rx_bytes =
+					atomic64_read(&conn->ksnc_rx_bytes),
+				.kcs_tx_stripes =
+					atomic64_read(&conn->ksnc_tx_stripes),
+				.kcs_rx_stripes =
+					atomic64_read(&conn->ksnc_rx_stripes),
+				.kcs_tx_zc_msgs =
+					atomic64_read(&conn->ksnc_tx_zc_msgs),
+				.kcs_tx_zc_done =
+					atomic64_read(&conn->ksnc_tx_zc_done),
+			};
+
+			if (copy_to_user(data->ioc_pbuf1, &stats,
+					 sizeof(stats))) {
+				ksocknal_conn_decref(conn);
+				return -EFAULT;
+			}
+		}
                 ksocknal_conn_decref(conn);
                 return 0;
         }
@@ -2136,6 +2211,7 @@ ksocknal_base_shutdown(void)
 				LASSERT(list_empty(&sched->kss_tx_conns));
 				LASSERT(list_empty(&sched->kss_rx_conns));
 				LASSERT(list_empty(&sched->kss_zombie_noop_txs));
+				LASSERT(list_empty(&sched->kss_zc_done_txs));
 				LASSERT(sched->kss_nconns == 0);
 			}
 		}
@@ -2237,6 +2313,7 @@ ksocknal_base_startup(void)
 		INIT_LIST_HEAD(&sched->kss_rx_conns);
 		INIT_LIST_HEAD(&sched->kss_tx_conns);
 		INIT_LIST_HEAD(&sched->kss_zombie_noop_txs);
+		INIT_LIST_HEAD(&sched->kss_zc_done_txs);
 		init_waitqueue_head(&sched->kss_waitq);
         }
 
@@ -2519,6 +2596,8 @@ ksocknal_startup(struct lnet_ni *ni)
 	}
 
 	ni->ni_dev_cpt = ifaces[i].li_cpt;
+	/* payload frags are sent and received LNET_MAX_IOV at a time */
+	ni->ni_mtu = LNET_MTU_LARGE;
 	sa = (void *)&ksi->ksni_addr;
 	memset(sa, 0, sizeof(*sa));
 	sa->sin_family = AF_INET;
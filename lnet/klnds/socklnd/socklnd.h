@@ -92,6 +92,8 @@ struct ksock_sched {
 	struct list_head kss_tx_conns;
 	/* zombie noop tx list */
 	struct list_head kss_zombie_noop_txs;
+	/* MSG_ZEROCOPY txs released by the network stack */
+	struct list_head kss_zc_done_txs;
 	/* where scheduler sleeps */
 	wait_queue_head_t kss_waitq;
 	/* # connections assigned to this scheduler */
@@ -102,6 +104,8 @@ struct ksock_sched {
 	int kss_nthreads;
 	/* CPT id */
 	int kss_cpt;
+	/* current busy poll time in ns, adapts to traffic on this CPT */
+	s64 kss_poll_ns;
 };
 
 #define KSOCK_CPT_SHIFT			16
@@ -148,6 +152,9 @@ struct ksock_tunables {
         unsigned int     *ksnd_zc_min_payload;  /* minimum zero copy payload size */
         int              *ksnd_zc_recv;         /* enable ZC receive (for Chelsio TOE) */
         int              *ksnd_zc_recv_min_nfrags; /* minimum # of fragments to enable ZC receive */
+	int		 *ksnd_tx_zerocopy;	/* MSG_ZEROCOPY bulk sends */
+	int		 *ksnd_stripe_min;	/* smallest striped payload */
+	int		 *ksnd_busy_poll;	/* max usecs to spin before sleep */
         int              *ksnd_irq_affinity;    /* enable IRQ affinity? */
 #ifdef SOCKNAL_BACKOFF
         int              *ksnd_backoff_init;    /* initial TCP backoff */
@@ -254,6 +261,14 @@ struct ksock_conn;				/* forward ref */
 struct ksock_conn_cb;				/* forward ref */
 struct ksock_proto;				/* forward ref */
 
+/* the LNet message behind the stripes of one KSOCK_MSG_STRIPE send */
+struct ksock_tx_stripe {
+	refcount_t		ksts_refcount;	/* # stripes in flight */
+	struct lnet_msg		*ksts_lnetmsg;	/* for lnet_finalize() */
+	int			ksts_rc;	/* first error */
+	enum lnet_msg_hstatus	ksts_hstatus;	/* worst health status */
+};
+
 struct ksock_tx {			/* transmit packet */
 	struct list_head tx_list;	/* queue on conn for transmission etc */
 	struct list_head tx_zc_list;	/* queue on peer_ni for ZC request */
@@ -266,9 +281,16 @@ struct ksock_tx {			/* transmit packet */
 	unsigned short	tx_zc_capable:1; /* payload is large enough for ZC */
 	unsigned short	tx_zc_checked:1; /* Have I checked if I should ZC? */
 	unsigned short	tx_nonblk:1;	/* it's a non-blocking ACK */
+	unsigned short	tx_zc_msg:1;	/* sent with MSG_ZEROCOPY */
+	unsigned char	tx_zc_copied;	/* stack copied MSG_ZEROCOPY pages */
+	int		tx_zc_nob;	/* # payload bytes sent MSG_ZEROCOPY */
+#ifdef HAVE_MSGHDR_MSG_UBUF
+	struct ubuf_info tx_zc_ubuf;	/* MSG_ZEROCOPY completion */
+#endif
 	struct bio_vec *tx_kiov;	/* packet page frags */
 	struct ksock_conn *tx_conn;	/* owning conn */
 	struct lnet_msg	*tx_lnetmsg;	/* lnet message for lnet_finalize() */
+	struct ksock_tx_stripe *tx_stripe; /* finalize via stripe if set */
 	time64_t	tx_deadline;	/* when (in secs) tx times out */
 	struct ksock_msg tx_msg;	/* socklnd message buffer */
 	int		tx_desc_size;	/* size of this descriptor */
@@ -280,7 +302,8 @@ struct ksock_tx {			/* transmit packet */
 #define KSOCK_NOOP_TX_SIZE  ((int)offsetof(struct ksock_tx, tx_payload[0]))
 
 /* space for the rx frag descriptors; we either read a single contiguous
- * header, or up to LNET_MAX_IOV frags of payload of either type. */
+ * header, or up to LNET_MAX_IOV frags of payload of either type. A larger
+ * payload is read in several such parts, see ksocknal_rx_kiov_fill(). */
 union ksock_rxiovspace {
 	struct kvec	iov[LNET_MAX_IOV];
 	struct bio_vec	kiov[LNET_MAX_IOV];
@@ -292,6 +315,28 @@ union ksock_rxiovspace {
 #define SOCKNAL_RX_PARSE_WAIT   4               /* waiting to be told to read the body */
 #define SOCKNAL_RX_LNET_PAYLOAD 5               /* reading lnet payload (to deliver here) */
 #define SOCKNAL_RX_SLOP         6               /* skipping body */
+#define SOCKNAL_RX_STRIPE_HEADER 7		/* reading stripe header */
+
+/* reassembly of a lnet message received as KSOCK_MSG_STRIPE, protected
+ * by ksnp_lock of the peer_ni it is queued on
+ */
+struct ksock_rx_stripe {
+	struct list_head	ksrs_list;	/* on ksnp_rx_stripes */
+	__u64			ksrs_cookie;	/* sender's kss_cookie */
+	int			ksrs_nattached;	/* # conns receiving stripes */
+	unsigned int		ksrs_ready:1;	/* delivery info is set */
+	int			ksrs_error;	/* first error */
+	unsigned int		ksrs_nob_left;	/* payload bytes to go */
+	time64_t		ksrs_deadline;	/* give up waiting after */
+	struct list_head	ksrs_waiting;	/* conns waiting for ready */
+	/* what ksocknal_recv() was given for the whole message */
+	struct lnet_msg		*ksrs_lnetmsg;
+	struct bio_vec		*ksrs_kiov;
+	unsigned int		ksrs_niov;
+	unsigned int		ksrs_offset;
+	unsigned int		ksrs_mlen;
+	unsigned int		ksrs_rlen;
+};
 
 struct ksock_conn {
 	struct ksock_peer_ni	*ksnc_peer;		/* owning peer_ni */
@@ -314,6 +359,9 @@ struct ksock_conn {
 	unsigned int		ksnc_closing:1;		/* being shut down */
 	unsigned int		ksnc_flip:1;		/* flip or not, only for V2.x */
 	unsigned int		ksnc_zc_capable:1;	/* enable to ZC */
+	unsigned int		ksnc_zc_msg:1;		/* ZC by MSG_ZEROCOPY */
+	unsigned int		ksnc_stripe:1;		/* peer reassembles
+							 * KSOCK_MSG_STRIPE */
 	const struct ksock_proto *ksnc_proto; /* protocol for the connection */
 
 	/* READER */
@@ -332,9 +380,14 @@ struct ksock_conn {
 	int                   ksnc_rx_nkiov;    /* # page frags */
 	struct bio_vec       *ksnc_rx_kiov;     /* the page frags */
 	union ksock_rxiovspace	ksnc_rx_iov_space;/* space for frag descriptors */
+	int			ksnc_rx_src_niov; /* # payload frags */
+	struct bio_vec	       *ksnc_rx_src_kiov; /* payload frags */
+	unsigned int		ksnc_rx_src_offset; /* next part in them */
 	__u32                 ksnc_rx_csum;     /* partial checksum for incoming
 						 * data */
 	struct lnet_msg      *ksnc_lnet_msg;    /* rx lnet_finalize arg*/
+	struct ksock_rx_stripe *ksnc_rx_stripe; /* stripe being received */
+	struct list_head	ksnc_rx_stripe_list; /* on ksrs_waiting */
 	struct ksock_msg	ksnc_msg;	/* incoming message buffer:
 						 * V2.x message takes the
 						 * whole struct
@@ -362,9 +415,20 @@ struct ksock_conn {
 	int			ksnc_tx_scheduled;
 	/* time stamp of the last posted TX */
 	time64_t		ksnc_tx_last_post;
+
+	/* -- STATS -- see struct ksock_conn_stats */
+	atomic64_t		ksnc_tx_zc_bytes;
+	atomic64_t		ksnc_tx_zc_copied;
+	atomic64_t		ksnc_tx_copy_bytes;
+	atomic64_t		ksnc_rx_bytes;
+	atomic64_t		ksnc_tx_stripes;
+	atomic64_t		ksnc_rx_stripes;
+	atomic64_t		ksnc_tx_zc_msgs;
+	atomic64_t		ksnc_tx_zc_done;
 };
 
 #define SOCKNAL_CONN_COUNT_MAX_BITS	8	/* max conn count bits */
+#define SOCKNAL_STRIPE_MAX		16	/* max # conns to stripe over */
 
 struct ksock_conn_cb {
 	struct list_head	ksnr_connd_list;/* chain on ksnr_connd_routes */
@@ -408,6 +472,9 @@ struct ksock_peer_ni {
 	spinlock_t		ksnp_lock;	/* serialize, g_lock unsafe */
 	/* zero copy requests wait for ACK  */
 	struct list_head	ksnp_zc_req_list;
+	/* large messages being reassembled from stripes */
+	struct list_head	ksnp_rx_stripes;
+	__u64			ksnp_stripe_next_cookie; /* for tx stripes */
 	time64_t		ksnp_send_keepalive; /* time to send keepalive */
 	struct lnet_ni		*ksnp_ni;	/* which network */
 	int			ksnp_n_passive_ips; /* # of... */
@@ -623,6 +690,9 @@ extern void ksocknal_free_tx(struct ksock_tx *tx);
 extern struct ksock_tx *ksocknal_alloc_tx_noop(__u64 cookie, int nonblk);
 extern void ksocknal_next_tx_carrier(struct ksock_conn *conn);
 extern void ksocknal_queue_tx_locked(struct ksock_tx *tx, struct ksock_conn *conn);
+extern void ksocknal_rx_stripe_done(struct ksock_conn *conn, int error);
+extern void ksocknal_rx_stripes_expire(struct ksock_peer_ni *peer_ni,
+				       bool all);
 extern void ksocknal_txlist_done(struct lnet_ni *ni, struct list_head *txlist,
 				 int error);
 #define ksocknal_thread_start(fn, data, namefmt, arg...)		\
@@ -653,6 +723,13 @@ extern void ksocknal_read_callback(struct ksock_conn *conn);
 extern void ksocknal_write_callback(struct ksock_conn *conn);
 
 extern int ksocknal_lib_zc_capable(struct ksock_conn *conn);
+#ifdef HAVE_MSGHDR_MSG_UBUF
+extern void ksocknal_lib_zc_init(struct ksock_tx *tx);
+extern void ksocknal_lib_zc_put(struct ksock_tx *tx);
+#else
+static inline void ksocknal_lib_zc_init(struct ksock_tx *tx) {}
+static inline void ksocknal_lib_zc_put(struct ksock_tx *tx) {}
+#endif
 extern void ksocknal_lib_save_callback(struct socket *sock, struct ksock_conn *conn);
 extern void ksocknal_lib_set_callback(struct socket *sock,  struct ksock_conn *conn);
 extern void ksocknal_lib_reset_callback(struct socket *sock,
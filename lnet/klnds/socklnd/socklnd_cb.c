@@ -59,6 +59,8 @@ ksocknal_alloc_tx(int type, int size)
 	tx->tx_zc_aborted = 0;
 	tx->tx_zc_capable = 0;
 	tx->tx_zc_checked = 0;
+	tx->tx_zc_msg = 0;
+	tx->tx_stripe = NULL;
 	tx->tx_hstatus = LNET_MSG_STATUS_OK;
 	tx->tx_desc_size  = size;
 
@@ -341,6 +343,40 @@ ksocknal_recv_kiov(struct ksock_conn *conn, struct page **rx_scratch_pgs,
 	return 1;
 }
 
+/* Describe in ksnc_rx_iov_space the next part of the payload still wanted.
+ * A payload of more than LNET_MAX_IOV frags is received in several parts.
+ */
+static void
+ksocknal_rx_kiov_fill(struct ksock_conn *conn)
+{
+	struct bio_vec *src = conn->ksnc_rx_src_kiov;
+	unsigned int offset = conn->ksnc_rx_src_offset;
+	unsigned int wanted = conn->ksnc_rx_nob_wanted;
+	int nsrc = conn->ksnc_rx_src_niov;
+	unsigned int nob = 0;
+	int i;
+
+	LASSERT(wanted > 0 && nsrc > 0);
+	while (offset >= src->bv_len) {
+		offset -= src->bv_len;
+		src++;
+		nsrc--;
+		LASSERT(nsrc > 0);
+	}
+
+	for (i = 0; i < nsrc && i < LNET_MAX_IOV && nob < wanted; i++)
+		nob += src[i].bv_len - (i == 0 ? offset : 0);
+	nob = min(nob, wanted);
+
+	conn->ksnc_rx_kiov = conn->ksnc_rx_iov_space.kiov;
+	conn->ksnc_rx_nkiov = lnet_extract_kiov(LNET_MAX_IOV,
+						conn->ksnc_rx_kiov,
+						nsrc, src, offset, nob);
+	conn->ksnc_rx_src_niov = nsrc;
+	conn->ksnc_rx_src_kiov = src;
+	conn->ksnc_rx_src_offset = offset + nob;
+}
+
 static int
 ksocknal_receive(struct ksock_conn *conn, struct page **rx_scratch_pgs,
 		 struct kvec *scratch_iov)
@@ -362,11 +398,15 @@ ksocknal_receive(struct ksock_conn *conn, struct page **rx_scratch_pgs,
 	}
 
 	for (;;) {
-		if (conn->ksnc_rx_niov != 0)
+		if (conn->ksnc_rx_niov != 0) {
 			rc = ksocknal_recv_iov(conn, scratch_iov);
-		else
+		} else {
+			/* next part of a large payload */
+			if (conn->ksnc_rx_nkiov == 0)
+				ksocknal_rx_kiov_fill(conn);
 			rc = ksocknal_recv_kiov(conn, rx_scratch_pgs,
 						 scratch_iov);
+		}
 
 		if (rc <= 0) {
 			/* error/EOF or partial receive */
@@ -391,10 +431,29 @@ ksocknal_receive(struct ksock_conn *conn, struct page **rx_scratch_pgs,
 	RETURN(rc);
 }
 
+static void
+ksocknal_tx_stripe_done(struct ksock_tx_stripe *stripe, int rc,
+			enum lnet_msg_hstatus hstatus)
+{
+	struct lnet_msg *lnetmsg = stripe->ksts_lnetmsg;
+
+	/* the first stripe to fail decides how the message completes */
+	if (rc != 0 && cmpxchg(&stripe->ksts_rc, 0, rc) == 0)
+		stripe->ksts_hstatus = hstatus;
+
+	if (!refcount_dec_and_test(&stripe->ksts_refcount))
+		return;
+
+	lnetmsg->msg_health_status = stripe->ksts_hstatus;
+	lnet_finalize(lnetmsg, stripe->ksts_rc);
+	LIBCFS_FREE(stripe, sizeof(*stripe));
+}
+
 void
 ksocknal_tx_done(struct lnet_ni *ni, struct ksock_tx *tx, int rc)
 {
 	struct lnet_msg *lnetmsg = tx->tx_lnetmsg;
+	struct ksock_tx_stripe *stripe = tx->tx_stripe;
 	enum lnet_msg_hstatus hstatus = tx->tx_hstatus;
 
 	LASSERT(ni != NULL || tx->tx_conn != NULL);
@@ -409,7 +468,10 @@ ksocknal_tx_done(struct lnet_ni *ni, struct ksock_tx *tx, int rc)
 		ksocknal_conn_decref(tx->tx_conn);
 
 	ksocknal_free_tx(tx);
-	if (lnetmsg != NULL) { /* KSOCK_MSG_NOOP go without lnetmsg */
+	if (stripe) {
+		/* one of several stripes of lnetmsg */
+		ksocknal_tx_stripe_done(stripe, rc, hstatus);
+	} else if (lnetmsg != NULL) { /* KSOCK_MSG_NOOP go without lnetmsg */
 		lnetmsg->msg_health_status = hstatus;
 		lnet_finalize(lnetmsg, rc);
 	}
@@ -478,6 +540,17 @@ ksocknal_check_zc_req(struct ksock_tx *tx)
             !conn->ksnc_zc_capable)
                 return;
 
+	if (conn->ksnc_zc_msg) {
+		/* MSG_ZEROCOPY: the network stack tells us when it has
+		 * released the pages, no ZC-ACK is needed from the peer_ni.
+		 * This ref is dropped by ksocknal_zc_txlist_done() */
+		ksocknal_tx_addref(tx);
+		ksocknal_lib_zc_init(tx);
+		tx->tx_zc_msg = 1;
+		atomic64_inc(&conn->ksnc_tx_zc_msgs);
+		return;
+	}
+
         /* assign cookie and queue tx to pending list, it will be released when
          * a matching ack is received. See ksocknal_handle_zcack() */
 
@@ -511,6 +584,13 @@ ksocknal_uncheck_zc_req(struct ksock_tx *tx)
 
 	tx->tx_zc_checked = 0;
 
+	if (tx->tx_zc_msg) {
+		/* skbs already queued keep the tx until they are freed */
+		tx->tx_zc_msg = 0;
+		ksocknal_lib_zc_put(tx);
+		return;
+	}
+
 	spin_lock(&peer_ni->ksnp_lock);
 
 	if (tx->tx_msg.ksm_zc_cookies[0] == 0) {
@@ -551,6 +631,10 @@ ksocknal_process_transmit(struct ksock_conn *conn, struct ksock_tx *tx,
 		/* Sent everything OK */
 		LASSERT(rc == 0);
 
+		/* drop the sender's hold on the MSG_ZEROCOPY completion */
+		if (tx->tx_zc_msg)
+			ksocknal_lib_zc_put(tx);
+
 		return 0;
 	}
 
@@ -972,6 +1056,154 @@ ksocknal_launch_packet(struct lnet_ni *ni, struct ksock_tx *tx,
         return (-EHOSTUNREACH);
 }
 
+/* Connections a large message can be striped over.  Called holding
+ * ksnd_global_lock.
+ */
+static int
+ksocknal_stripe_conns_locked(struct ksock_peer_ni *peer_ni,
+			     struct ksock_conn **conns)
+{
+	struct ksock_conn *conn;
+	int n = 0;
+
+	/* leave it to the normal path while connections are missing */
+	if (ksocknal_find_connectable_conn_cb_locked(peer_ni))
+		return 0;
+
+	list_for_each_entry(conn, &peer_ni->ksnp_conns, ksnc_list) {
+		if (!conn->ksnc_stripe ||
+		    conn->ksnc_type != SOCKLND_CONN_BULK_OUT)
+			continue;
+
+		conns[n++] = conn;
+		if (n == SOCKNAL_STRIPE_MAX)
+			break;
+	}
+
+	return n;
+}
+
+/* Send the payload of lntmsg as KSOCK_MSG_STRIPE messages spread over all
+ * the bulk connections to the peer_ni, so a single large PUT or GET reply
+ * isn't limited to what one TCP stream can do.  Returns -EAGAIN if the
+ * message should go the normal way instead.
+ */
+static int
+ksocknal_send_striped(struct lnet_ni *ni, struct lnet_msg *lntmsg)
+{
+	struct ksock_conn *conns[SOCKNAL_STRIPE_MAX];
+	struct ksock_tx *txs[SOCKNAL_STRIPE_MAX];
+	struct ksock_tx_stripe *stripe;
+	struct ksock_peer_ni *peer_ni;
+	struct ksock_conn *conn;
+	unsigned int payload_nob = lntmsg->msg_len;
+	unsigned int stripe_nob;
+	unsigned int offset;
+	rwlock_t *g_lock = &ksocknal_data.ksnd_global_lock;
+	unsigned int start;
+	int desc_size;
+	int nstripes;
+	int nconns;
+	__u64 cookie;
+	int i;
+
+	read_lock(g_lock);
+	peer_ni = ksocknal_find_peer_locked(ni, &lntmsg->msg_target);
+	nconns = peer_ni ? ksocknal_stripe_conns_locked(peer_ni, conns) : 0;
+	read_unlock(g_lock);
+
+	if (nconns < 2)
+		return -EAGAIN;
+
+	stripe_nob = round_up(DIV_ROUND_UP(payload_nob, nconns), PAGE_SIZE);
+	nstripes = DIV_ROUND_UP(payload_nob, stripe_nob);
+	if (nstripes < 2)
+		return -EAGAIN;
+
+	LIBCFS_ALLOC(stripe, sizeof(*stripe));
+	if (!stripe)
+		return -EAGAIN;
+
+	refcount_set(&stripe->ksts_refcount, nstripes);
+	stripe->ksts_lnetmsg = lntmsg;
+	stripe->ksts_rc = 0;
+	stripe->ksts_hstatus = LNET_MSG_STATUS_OK;
+
+	desc_size = offsetof(struct ksock_tx, tx_payload[lntmsg->msg_niov]);
+
+	for (i = 0, offset = 0; i < nstripes; i++, offset += stripe_nob) {
+		struct ksock_stripe_hdr *sh;
+		unsigned int nob = min(stripe_nob, payload_nob - offset);
+		struct ksock_tx *tx;
+
+		tx = ksocknal_alloc_tx(KSOCK_MSG_STRIPE, desc_size);
+		if (!tx)
+			goto failed;
+		txs[i] = tx;
+
+		tx->tx_conn = NULL;
+		tx->tx_lnetmsg = lntmsg;
+		tx->tx_stripe = stripe;
+
+		tx->tx_niov = 1;
+		tx->tx_kiov = tx->tx_payload;
+		tx->tx_nkiov = lnet_extract_kiov(lntmsg->msg_niov, tx->tx_kiov,
+						 lntmsg->msg_niov,
+						 lntmsg->msg_kiov,
+						 lntmsg->msg_offset + offset,
+						 nob);
+
+		if (nob >= *ksocknal_tunables.ksnd_zc_min_payload)
+			tx->tx_zc_capable = 1;
+
+		tx->tx_msg.ksm_csum = 0;
+		tx->tx_msg.ksm_type = KSOCK_MSG_STRIPE;
+		tx->tx_msg.ksm_zc_cookies[0] = 0;
+		tx->tx_msg.ksm_zc_cookies[1] = 0;
+
+		sh = &tx->tx_msg.ksm_u.stripe.ksms_stripe;
+		sh->kss_offset = offset;
+		sh->kss_nob = nob;
+	}
+
+	/* connections may have come or gone while I allocated */
+	read_lock(g_lock);
+	peer_ni = ksocknal_find_peer_locked(ni, &lntmsg->msg_target);
+	nconns = peer_ni ? ksocknal_stripe_conns_locked(peer_ni, conns) : 0;
+	if (nconns == 0) {
+		read_unlock(g_lock);
+		goto failed;
+	}
+
+	spin_lock(&peer_ni->ksnp_lock);
+	cookie = ++peer_ni->ksnp_stripe_next_cookie;
+	spin_unlock(&peer_ni->ksnp_lock);
+
+	CDEBUG(D_NET, "striping %u bytes to %s as %d x %u over %d conns\n",
+	       payload_nob, libcfs_idstr(&lntmsg->msg_target), nstripes,
+	       stripe_nob, nconns);
+
+	/* start each message on the next connection, so messages with fewer
+	 * stripes than connections don't all pile up on the first ones
+	 */
+	start = (unsigned int)cookie % nconns;
+	for (i = 0; i < nstripes; i++) {
+		txs[i]->tx_msg.ksm_u.stripe.ksms_stripe.kss_cookie = cookie;
+		conn = conns[(start + i) % nconns];
+		atomic64_inc(&conn->ksnc_tx_stripes);
+		ksocknal_queue_tx_locked(txs[i], conn);
+	}
+	read_unlock(g_lock);
+
+	return 0;
+
+failed:
+	while (--i >= 0)
+		ksocknal_free_tx(txs[i]);
+	LIBCFS_FREE(stripe, sizeof(*stripe));
+	return -EAGAIN;
+}
+
 int
 ksocknal_send(struct lnet_ni *ni, void *private, struct lnet_msg *lntmsg)
 {
@@ -995,9 +1227,18 @@ ksocknal_send(struct lnet_ni *ni, void *private, struct lnet_msg *lntmsg)
 	       payload_nob, payload_niov, libcfs_idstr(target));
 
 	LASSERT (payload_nob == 0 || payload_niov > 0);
-	LASSERT (payload_niov <= LNET_MAX_IOV);
+	LASSERT (payload_niov <= LNET_MAX_IOV_LARGE);
 	LASSERT (!in_interrupt ());
 
+	/* don't add allocations for messages sent to free memory */
+	if (*ksocknal_tunables.ksnd_stripe_min > 0 &&
+	    payload_nob >= *ksocknal_tunables.ksnd_stripe_min &&
+	    !lntmsg->msg_vmflush) {
+		rc = ksocknal_send_striped(ni, lntmsg);
+		if (rc != -EAGAIN)
+			return rc;
+	}
+
 	desc_size = offsetof(struct ksock_tx,
 			     tx_payload[payload_niov]);
 
@@ -1138,6 +1379,328 @@ ksocknal_new_packet(struct ksock_conn *conn, int nob_to_skip)
         return (0);
 }
 
+static void
+ksocknal_rx_setup(struct ksock_conn *conn, struct lnet_msg *msg,
+		  unsigned int niov, struct bio_vec *kiov,
+		  unsigned int offset, unsigned int mlen, unsigned int rlen)
+{
+	conn->ksnc_lnet_msg = msg;
+	conn->ksnc_rx_nob_wanted = mlen;
+	conn->ksnc_rx_nob_left   = rlen;
+
+	if (mlen == 0) {
+		conn->ksnc_rx_nkiov = 0;
+		conn->ksnc_rx_kiov = NULL;
+		conn->ksnc_rx_iov = conn->ksnc_rx_iov_space.iov;
+		conn->ksnc_rx_niov = 0;
+	} else {
+		conn->ksnc_rx_niov = 0;
+		conn->ksnc_rx_iov  = NULL;
+		conn->ksnc_rx_src_niov = niov;
+		conn->ksnc_rx_src_kiov = kiov;
+		conn->ksnc_rx_src_offset = offset;
+		ksocknal_rx_kiov_fill(conn);
+	}
+
+	LASSERT(mlen >=
+		lnet_iov_nob(conn->ksnc_rx_niov, conn->ksnc_rx_iov) +
+		lnet_kiov_nob(conn->ksnc_rx_nkiov, conn->ksnc_rx_kiov));
+}
+
+/* Let a conn blocked in SOCKNAL_RX_PARSE{,_WAIT} read its payload */
+static void
+ksocknal_rx_resume(struct ksock_conn *conn)
+{
+	struct ksock_sched *sched = conn->ksnc_scheduler;
+
+        LASSERT (conn->ksnc_rx_scheduled);
+
+	spin_lock_bh(&sched->kss_lock);
+
+	switch (conn->ksnc_rx_state) {
+	case SOCKNAL_RX_PARSE_WAIT:
+		list_add_tail(&conn->ksnc_rx_list, &sched->kss_rx_conns);
+		wake_up(&sched->kss_waitq);
+		LASSERT(conn->ksnc_rx_ready);
+		break;
+
+        case SOCKNAL_RX_PARSE:
+                /* scheduler hasn't noticed I'm parsing yet */
+                break;
+        }
+
+        conn->ksnc_rx_state = SOCKNAL_RX_LNET_PAYLOAD;
+
+	spin_unlock_bh(&sched->kss_lock);
+	ksocknal_conn_decref(conn);
+}
+
+/* Receive the part of the stripe in conn->ksnc_msg that falls inside the
+ * mlen bytes LNet wants; skip the rest as for a truncated message.
+ */
+static void
+ksocknal_rx_stripe_setup(struct ksock_conn *conn)
+{
+	struct ksock_stripe_hdr *sh = &conn->ksnc_msg.ksm_u.stripe.ksms_stripe;
+	struct ksock_rx_stripe *rs = conn->ksnc_rx_stripe;
+	unsigned int nob = 0;
+
+	LASSERT(rs->ksrs_ready);
+
+	if (sh->kss_offset < rs->ksrs_mlen)
+		nob = min(sh->kss_nob, rs->ksrs_mlen - sh->kss_offset);
+
+	/* NB the stripe finalizes rs, not ksnc_lnet_msg */
+	ksocknal_rx_setup(conn, NULL, rs->ksrs_niov, rs->ksrs_kiov,
+			  rs->ksrs_offset + sh->kss_offset, nob, sh->kss_nob);
+}
+
+/* Tell the stripes of rs waiting for lnet_parse() where their payload
+ * goes, or to skip it if msg is NULL.
+ */
+static void
+ksocknal_rx_stripe_ready(struct ksock_conn *conn, struct lnet_msg *msg,
+			 unsigned int niov, struct bio_vec *kiov,
+			 unsigned int offset, unsigned int mlen, int error)
+{
+	struct ksock_rx_stripe *rs = conn->ksnc_rx_stripe;
+	struct ksock_peer_ni *peer_ni = conn->ksnc_peer;
+	struct ksock_conn *waiter;
+	struct ksock_conn *tmp;
+	LIST_HEAD(waiting);
+
+	spin_lock(&peer_ni->ksnp_lock);
+
+	LASSERT(!rs->ksrs_ready);
+	rs->ksrs_lnetmsg = msg;
+	rs->ksrs_niov = niov;
+	rs->ksrs_kiov = kiov;
+	rs->ksrs_offset = offset;
+	rs->ksrs_mlen = mlen;
+	if (error != 0 && rs->ksrs_error == 0)
+		rs->ksrs_error = error;
+	rs->ksrs_ready = 1;
+	list_splice_init(&rs->ksrs_waiting, &waiting);
+
+	spin_unlock(&peer_ni->ksnp_lock);
+
+	list_for_each_entry_safe(waiter, tmp, &waiting, ksnc_rx_stripe_list) {
+		list_del_init(&waiter->ksnc_rx_stripe_list);
+		ksocknal_rx_stripe_setup(waiter);
+		ksocknal_rx_resume(waiter);
+	}
+}
+
+static void
+ksocknal_rx_stripe_finalize(struct ksock_rx_stripe *rs)
+{
+	LASSERT(rs->ksrs_nattached == 0);
+	LASSERT(list_empty(&rs->ksrs_waiting));
+
+	if (rs->ksrs_error != 0 && rs->ksrs_lnetmsg)
+		rs->ksrs_lnetmsg->msg_health_status =
+			LNET_MSG_STATUS_REMOTE_ERROR;
+	lnet_finalize(rs->ksrs_lnetmsg, rs->ksrs_error);
+
+	LIBCFS_FREE(rs, sizeof(*rs));
+}
+
+/* conn is done with its stripe, successfully or not */
+void
+ksocknal_rx_stripe_done(struct ksock_conn *conn, int error)
+{
+	struct ksock_stripe_hdr *sh = &conn->ksnc_msg.ksm_u.stripe.ksms_stripe;
+	struct ksock_rx_stripe *rs = conn->ksnc_rx_stripe;
+	struct ksock_peer_ni *peer_ni = conn->ksnc_peer;
+	bool last;
+
+	conn->ksnc_rx_stripe = NULL;
+
+	spin_lock(&peer_ni->ksnp_lock);
+
+	if (error != 0 && rs->ksrs_error == 0)
+		rs->ksrs_error = error;
+	rs->ksrs_nattached--;
+	rs->ksrs_nob_left -= sh->kss_nob;
+	rs->ksrs_deadline = ktime_get_seconds() + ksocknal_timeout();
+
+	last = rs->ksrs_nob_left == 0;
+	if (last)
+		list_del(&rs->ksrs_list);
+
+	spin_unlock(&peer_ni->ksnp_lock);
+
+	if (last)
+		ksocknal_rx_stripe_finalize(rs);
+}
+
+static struct ksock_rx_stripe *
+ksocknal_find_rx_stripe_locked(struct ksock_peer_ni *peer_ni, __u64 cookie)
+{
+	struct ksock_rx_stripe *rs;
+
+	list_for_each_entry(rs, &peer_ni->ksnp_rx_stripes, ksrs_list) {
+		if (rs->ksrs_cookie == cookie)
+			return rs;
+	}
+
+	return NULL;
+}
+
+/* Attach conn to the message its stripe belongs to and set the next rx
+ * state: SOCKNAL_RX_LNET_HEADER if this is the first stripe of it to
+ * arrive, SOCKNAL_RX_LNET_PAYLOAD if lnet_parse() has already said where
+ * the payload goes or SOCKNAL_RX_PARSE to wait until it has.
+ */
+static int
+ksocknal_rx_stripe_start(struct ksock_conn *conn)
+{
+	struct ksock_stripe_hdr *sh = &conn->ksnc_msg.ksm_u.stripe.ksms_stripe;
+	struct _lnet_hdr_nid4 *lhdr =
+		(void *)&conn->ksnc_msg.ksm_u.stripe.ksms_lnetmsg;
+	struct ksock_peer_ni *peer_ni = conn->ksnc_peer;
+	struct ksock_rx_stripe *rs;
+	struct ksock_rx_stripe *new = NULL;
+	unsigned int rlen = le32_to_cpu(lhdr->payload_length);
+	bool ready;
+
+	if (conn->ksnc_flip) {
+		__swab64s(&sh->kss_cookie);
+		__swab32s(&sh->kss_offset);
+		__swab32s(&sh->kss_nob);
+	}
+
+	if (sh->kss_nob == 0 ||
+	    (__u64)sh->kss_offset + sh->kss_nob > rlen) {
+		CERROR("%s: bad stripe %llu: %u+%u of %u\n",
+		       libcfs_idstr(&peer_ni->ksnp_id), sh->kss_cookie,
+		       sh->kss_offset, sh->kss_nob, rlen);
+		return -EPROTO;
+	}
+
+	atomic64_inc(&conn->ksnc_rx_stripes);
+
+	spin_lock(&peer_ni->ksnp_lock);
+	rs = ksocknal_find_rx_stripe_locked(peer_ni, sh->kss_cookie);
+	if (!rs) {
+		spin_unlock(&peer_ni->ksnp_lock);
+
+		LIBCFS_ALLOC(new, sizeof(*new));
+		if (!new)
+			return -ENOMEM;
+
+		new->ksrs_cookie = sh->kss_cookie;
+		new->ksrs_nob_left = rlen;
+		new->ksrs_rlen = rlen;
+		INIT_LIST_HEAD(&new->ksrs_waiting);
+
+		spin_lock(&peer_ni->ksnp_lock);
+		rs = ksocknal_find_rx_stripe_locked(peer_ni, sh->kss_cookie);
+		if (!rs) {
+			rs = new;
+			list_add_tail(&rs->ksrs_list,
+				      &peer_ni->ksnp_rx_stripes);
+		}
+	}
+
+	if (rs->ksrs_rlen != rlen || sh->kss_nob > rs->ksrs_nob_left) {
+		spin_unlock(&peer_ni->ksnp_lock);
+		if (new && rs != new)
+			LIBCFS_FREE(new, sizeof(*new));
+		CERROR("%s: stripe %llu: %u+%u doesn't match message of %u\n",
+		       libcfs_idstr(&peer_ni->ksnp_id), sh->kss_cookie,
+		       sh->kss_offset, sh->kss_nob, rlen);
+		return -EPROTO;
+	}
+
+	rs->ksrs_nattached++;
+	rs->ksrs_deadline = ktime_get_seconds() + ksocknal_timeout();
+	conn->ksnc_rx_stripe = rs;
+
+	ready = rs->ksrs_ready;
+	if (rs == new) {
+		/* first to arrive: parse the LNet header */
+		conn->ksnc_rx_state = SOCKNAL_RX_LNET_HEADER;
+	} else if (!ready) {
+		conn->ksnc_rx_state = SOCKNAL_RX_PARSE;
+		ksocknal_conn_addref(conn);     /* ++ref while waiting */
+		list_add_tail(&conn->ksnc_rx_stripe_list, &rs->ksrs_waiting);
+	}
+
+	spin_unlock(&peer_ni->ksnp_lock);
+
+	if (rs == new)
+		return 0;
+
+	if (new)
+		LIBCFS_FREE(new, sizeof(*new));
+
+	if (ready) {
+		ksocknal_rx_stripe_setup(conn);
+		conn->ksnc_rx_state = SOCKNAL_RX_LNET_PAYLOAD;
+	}
+
+	return 0;
+}
+
+static bool
+ksocknal_rx_stripes_stale(struct ksock_peer_ni *peer_ni)
+{
+	time64_t now = ktime_get_seconds();
+	struct ksock_rx_stripe *rs;
+	bool stale = false;
+
+	if (list_empty(&peer_ni->ksnp_rx_stripes))
+		return false;
+
+	spin_lock(&peer_ni->ksnp_lock);
+	list_for_each_entry(rs, &peer_ni->ksnp_rx_stripes, ksrs_list) {
+		if (rs->ksrs_nattached == 0 && now >= rs->ksrs_deadline) {
+			stale = true;
+			break;
+		}
+	}
+	spin_unlock(&peer_ni->ksnp_lock);
+
+	return stale;
+}
+
+/* Fail striped messages that no connection is receiving any more: those
+ * whose missing stripes haven't started to arrive before the deadline, or
+ * all of them if the peer_ni has no connections left.
+ */
+void
+ksocknal_rx_stripes_expire(struct ksock_peer_ni *peer_ni, bool all)
+{
+	time64_t now = ktime_get_seconds();
+	struct ksock_rx_stripe *rs;
+	struct ksock_rx_stripe *tmp;
+	LIST_HEAD(stale);
+
+	spin_lock(&peer_ni->ksnp_lock);
+	list_for_each_entry_safe(rs, tmp, &peer_ni->ksnp_rx_stripes,
+				 ksrs_list) {
+		if (rs->ksrs_nattached > 0 ||
+		    (!all && now < rs->ksrs_deadline))
+			continue;
+
+		list_move_tail(&rs->ksrs_list, &stale);
+	}
+	spin_unlock(&peer_ni->ksnp_lock);
+
+	while ((rs = list_first_entry_or_null(&stale, struct ksock_rx_stripe,
+					      ksrs_list)) != NULL) {
+		list_del(&rs->ksrs_list);
+
+		CNETERR("%s: %u of %u bytes of striped message %llu never arrived\n",
+			libcfs_idstr(&peer_ni->ksnp_id), rs->ksrs_nob_left,
+			rs->ksrs_rlen, rs->ksrs_cookie);
+		if (rs->ksrs_error == 0)
+			rs->ksrs_error = -ETIMEDOUT;
+		ksocknal_rx_stripe_finalize(rs);
+	}
+}
+
 static int
 ksocknal_process_receive(struct ksock_conn *conn,
 			 struct page **rx_scratch_pgs,
@@ -1155,6 +1718,7 @@ ksocknal_process_receive(struct ksock_conn *conn,
 	LASSERT(conn->ksnc_rx_state == SOCKNAL_RX_KSM_HEADER ||
 		conn->ksnc_rx_state == SOCKNAL_RX_LNET_PAYLOAD ||
 		conn->ksnc_rx_state == SOCKNAL_RX_LNET_HEADER ||
+		conn->ksnc_rx_state == SOCKNAL_RX_STRIPE_HEADER ||
 		conn->ksnc_rx_state == SOCKNAL_RX_SLOP);
  again:
 	if (conn->ksnc_rx_nob_wanted != 0) {
@@ -1253,6 +1817,29 @@ ksocknal_process_receive(struct ksock_conn *conn,
 
 			goto again;     /* read lnet header now */
 
+		case KSOCK_MSG_STRIPE:
+			if (conn->ksnc_stripe) {
+				conn->ksnc_rx_state = SOCKNAL_RX_STRIPE_HEADER;
+				conn->ksnc_rx_nob_wanted =
+					sizeof(conn->ksnc_msg.ksm_u.stripe);
+				conn->ksnc_rx_nob_left =
+					sizeof(conn->ksnc_msg.ksm_u.stripe);
+
+				conn->ksnc_rx_iov = conn->ksnc_rx_iov_space.iov;
+				conn->ksnc_rx_iov[0].iov_base =
+					(void *)&conn->ksnc_msg.ksm_u.stripe;
+				conn->ksnc_rx_iov[0].iov_len =
+					sizeof(conn->ksnc_msg.ksm_u.stripe);
+
+				conn->ksnc_rx_niov = 1;
+				conn->ksnc_rx_kiov = NULL;
+				conn->ksnc_rx_nkiov = 0;
+
+				goto again; /* read lnet and stripe header */
+			}
+			/* not negotiated in HELLO */
+			fallthrough;
+
 		default:
 			CERROR("%s: Unknown message type: %x\n",
 			       libcfs_idstr(&conn->ksnc_peer->ksnp_id),
@@ -1262,6 +1849,21 @@ ksocknal_process_receive(struct ksock_conn *conn,
 			return -EPROTO;
 		}
 
+	case SOCKNAL_RX_STRIPE_HEADER:
+		rc = ksocknal_rx_stripe_start(conn);
+		if (rc < 0) {
+			ksocknal_new_packet(conn, 0);
+			ksocknal_close_conn_and_siblings(conn, rc);
+			return rc;
+		}
+
+		/* I'm racing with ksocknal_rx_stripe_ready() */
+		if (conn->ksnc_rx_state == SOCKNAL_RX_PARSE)
+			return 0;
+
+		/* parse the header or receive my part of the payload */
+		goto again;
+
 	case SOCKNAL_RX_LNET_HEADER:
 		/* unpack message header */
 		conn->ksnc_proto->pro_unpack(&conn->ksnc_msg, &hdr);
@@ -1285,6 +1887,12 @@ ksocknal_process_receive(struct ksock_conn *conn,
 				conn, 0);
 		if (rc < 0) {
 			/* I just received garbage: give up on this conn */
+			if (conn->ksnc_rx_stripe) {
+				/* other stripes skip their payload */
+				ksocknal_rx_stripe_ready(conn, NULL, 0, NULL,
+							 0, 0, rc);
+				ksocknal_rx_stripe_done(conn, rc);
+			}
 			ksocknal_new_packet(conn, 0);
 			ksocknal_close_conn_and_siblings(conn, rc);
 			ksocknal_conn_decref(conn);
@@ -1328,10 +1936,15 @@ ksocknal_process_receive(struct ksock_conn *conn,
 				lnet_nid_to_nid4(&id->nid));
 		}
 
-		if (rc && conn->ksnc_lnet_msg)
-			conn->ksnc_lnet_msg->msg_health_status =
-				LNET_MSG_STATUS_REMOTE_ERROR;
-		lnet_finalize(conn->ksnc_lnet_msg, rc);
+		if (conn->ksnc_rx_stripe) {
+			/* the last stripe finalizes the message */
+			ksocknal_rx_stripe_done(conn, rc);
+		} else {
+			if (rc && conn->ksnc_lnet_msg)
+				conn->ksnc_lnet_msg->msg_health_status =
+					LNET_MSG_STATUS_REMOTE_ERROR;
+			lnet_finalize(conn->ksnc_lnet_msg, rc);
+		}
 
 		if (rc != 0) {
 			ksocknal_new_packet(conn, 0);
@@ -1362,54 +1975,45 @@ ksocknal_recv(struct lnet_ni *ni, void *private, struct lnet_msg *msg,
 	      unsigned int rlen)
 {
 	struct ksock_conn *conn = private;
-	struct ksock_sched *sched = conn->ksnc_scheduler;
 
         LASSERT (mlen <= rlen);
-        LASSERT (niov <= LNET_MAX_IOV);
-
-	conn->ksnc_lnet_msg = msg;
-	conn->ksnc_rx_nob_wanted = mlen;
-	conn->ksnc_rx_nob_left   = rlen;
+	LASSERT(niov <= LNET_MAX_IOV_LARGE);
 
-	if (mlen == 0) {
-		conn->ksnc_rx_nkiov = 0;
-		conn->ksnc_rx_kiov = NULL;
-		conn->ksnc_rx_iov = conn->ksnc_rx_iov_space.iov;
-		conn->ksnc_rx_niov = 0;
+	if (conn->ksnc_rx_stripe) {
+		/* first stripe of a striped message: the others may be
+		 * waiting to know where their part of the payload goes
+		 */
+		ksocknal_rx_stripe_ready(conn, msg, niov, kiov, offset, mlen,
+					 0);
+		ksocknal_rx_stripe_setup(conn);
 	} else {
-		conn->ksnc_rx_niov = 0;
-		conn->ksnc_rx_iov  = NULL;
-		conn->ksnc_rx_kiov = conn->ksnc_rx_iov_space.kiov;
-		conn->ksnc_rx_nkiov =
-			lnet_extract_kiov(LNET_MAX_IOV, conn->ksnc_rx_kiov,
-					  niov, kiov, offset, mlen);
+		ksocknal_rx_setup(conn, msg, niov, kiov, offset, mlen, rlen);
 	}
 
-        LASSERT (mlen ==
-                 lnet_iov_nob (conn->ksnc_rx_niov, conn->ksnc_rx_iov) +
-                 lnet_kiov_nob (conn->ksnc_rx_nkiov, conn->ksnc_rx_kiov));
-
-        LASSERT (conn->ksnc_rx_scheduled);
-
-	spin_lock_bh(&sched->kss_lock);
+	ksocknal_rx_resume(conn);
+	return 0;
+}
 
-	switch (conn->ksnc_rx_state) {
-	case SOCKNAL_RX_PARSE_WAIT:
-		list_add_tail(&conn->ksnc_rx_list, &sched->kss_rx_conns);
-		wake_up(&sched->kss_waitq);
-		LASSERT(conn->ksnc_rx_ready);
-		break;
+static void
+ksocknal_zc_txlist_done(struct list_head *txlist)
+{
+	struct ksock_conn *conn;
+	struct ksock_tx *tx;
 
-        case SOCKNAL_RX_PARSE:
-                /* scheduler hasn't noticed I'm parsing yet */
-                break;
-        }
+	while ((tx = list_first_entry_or_null(txlist, struct ksock_tx,
+					      tx_zc_list)) != NULL) {
+		list_del(&tx->tx_zc_list);
 
-        conn->ksnc_rx_state = SOCKNAL_RX_LNET_PAYLOAD;
+		conn = tx->tx_conn;
+		if (tx->tx_zc_copied)
+			atomic64_add(tx->tx_zc_nob, &conn->ksnc_tx_zc_copied);
+		else
+			atomic64_add(tx->tx_zc_nob, &conn->ksnc_tx_zc_bytes);
+		atomic64_inc(&conn->ksnc_tx_zc_done);
 
-	spin_unlock_bh(&sched->kss_lock);
-	ksocknal_conn_decref(conn);
-	return 0;
+		/* pages are no longer referenced by the stack */
+		ksocknal_tx_decref(tx);
+	}
 }
 
 static inline int
@@ -1421,12 +2025,54 @@ ksocknal_sched_cansleep(struct ksock_sched *sched)
 
 	rc = (!ksocknal_data.ksnd_shuttingdown &&
 	      list_empty(&sched->kss_rx_conns) &&
-	      list_empty(&sched->kss_tx_conns));
+	      list_empty(&sched->kss_tx_conns) &&
+	      list_empty(&sched->kss_zc_done_txs));
 
 	spin_unlock_bh(&sched->kss_lock);
 	return rc;
 }
 
+/*
+ * Busy polling: spin for a while before going to sleep, so that a conn
+ * made ready by the socket callbacks soon after is picked up without a
+ * scheduler wakeup. The spinning time adapts on each CPT: it doubles, up
+ * to busy_poll, when work shows up and halves, down to 1/16th of it, when
+ * it expires in vain. Returns true if there is work to do.
+ */
+#define SOCKNAL_BUSY_POLL_BACKOFF	4
+
+static bool
+ksocknal_sched_busy_poll(struct ksock_sched *sched)
+{
+	s64 max_ns = (s64)*ksocknal_tunables.ksnd_busy_poll * NSEC_PER_USEC;
+	ktime_t end;
+	s64 ns;
+
+	if (max_ns <= 0)
+		return false;
+
+	ns = READ_ONCE(sched->kss_poll_ns);
+	if (ns <= 0 || ns > max_ns)
+		ns = max_ns;
+	ns = max(ns, max_ns >> SOCKNAL_BUSY_POLL_BACKOFF);
+
+	end = ktime_add_ns(ktime_get(), ns);
+	do {
+		if (!list_empty_careful(&sched->kss_rx_conns) ||
+		    !list_empty_careful(&sched->kss_tx_conns) ||
+		    !list_empty_careful(&sched->kss_zc_done_txs)) {
+			WRITE_ONCE(sched->kss_poll_ns, min(ns * 2, max_ns));
+			return true;
+		}
+		cpu_relax();
+	} while (ktime_before(ktime_get(), end) && !need_resched() &&
+		 !ksocknal_data.ksnd_shuttingdown);
+
+	/* idle, back off */
+	WRITE_ONCE(sched->kss_poll_ns, ns / 2);
+	return false;
+}
+
 int ksocknal_scheduler(void *arg)
 {
 	struct ksock_sched *sched;
@@ -1579,11 +2225,24 @@ int ksocknal_scheduler(void *arg)
 
 			did_something = true;
 		}
+		if (!list_empty(&sched->kss_zc_done_txs)) {
+			LIST_HEAD(zclist);
+
+			list_splice_init(&sched->kss_zc_done_txs, &zclist);
+			spin_unlock_bh(&sched->kss_lock);
+
+			ksocknal_zc_txlist_done(&zclist);
+
+			spin_lock_bh(&sched->kss_lock);
+			did_something = true;
+		}
+
 		if (!did_something ||	/* nothing to do */
 		    need_resched()) {	/* hogging CPU? */
 			spin_unlock_bh(&sched->kss_lock);
 
-			if (!did_something) {   /* wait for something to do */
+			if (!did_something &&  /* wait for something to do */
+			    !ksocknal_sched_busy_poll(sched)) {
 				rc = wait_event_interruptible_exclusive(
 					sched->kss_waitq,
 					!ksocknal_sched_cansleep(sched));
@@ -2520,6 +3179,17 @@ ksocknal_check_peer_timeouts(int idx)
 			goto again;
 		}
 
+		/* give up on striped messages missing stripes */
+		if (ksocknal_rx_stripes_stale(peer_ni)) {
+			ksocknal_peer_addref(peer_ni);
+			read_unlock(&ksocknal_data.ksnd_global_lock);
+
+			ksocknal_rx_stripes_expire(peer_ni, false);
+
+			ksocknal_peer_decref(peer_ni);
+			goto again;
+		}
+
 		if (list_empty(&peer_ni->ksnp_zc_req_list))
 			continue;
 
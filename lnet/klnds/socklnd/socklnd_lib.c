@@ -68,6 +68,66 @@ ksocknal_lib_zc_capable(struct ksock_conn *conn)
 	return ((caps & NETIF_F_SG) != 0 && (caps & NETIF_F_CSUM_MASK) != 0);
 }
 
+#ifdef HAVE_MSGHDR_MSG_UBUF
+/* Called by the network stack each time an skb referencing the payload
+ * of a MSG_ZEROCOPY tx is freed, and by ksocknal_lib_zc_put() for the
+ * sender's own reference.  May run in softirq context, so the tx is
+ * handed to the scheduler for completion.
+ */
+static void
+ksocknal_lib_zc_complete(struct sk_buff *skb, struct ubuf_info *uarg,
+			 bool zerocopy_success)
+{
+	struct ksock_tx *tx = container_of(uarg, struct ksock_tx, tx_zc_ubuf);
+	struct ksock_sched *sched;
+
+	/* e.g. loopback or a device that can't do SG: the stack copied
+	 * the pages before releasing them */
+	if (!zerocopy_success)
+		tx->tx_zc_copied = 1;
+
+	if (!refcount_dec_and_test(&uarg->refcnt))
+		return;
+
+	sched = tx->tx_conn->ksnc_scheduler;
+
+	spin_lock_bh(&sched->kss_lock);
+	list_add_tail(&tx->tx_zc_list, &sched->kss_zc_done_txs);
+	wake_up(&sched->kss_waitq);
+	spin_unlock_bh(&sched->kss_lock);
+}
+
+#ifdef HAVE_UBUF_INFO_OPS
+static const struct ubuf_info_ops ksocknal_zc_ubuf_ops = {
+	.complete = ksocknal_lib_zc_complete,
+};
+#endif
+
+void
+ksocknal_lib_zc_init(struct ksock_tx *tx)
+{
+	struct ubuf_info *uarg = &tx->tx_zc_ubuf;
+
+#ifdef HAVE_UBUF_INFO_OPS
+	uarg->ops = &ksocknal_zc_ubuf_ops;
+#else
+	uarg->callback = ksocknal_lib_zc_complete;
+#endif
+	uarg->flags = SKBFL_ZEROCOPY_FRAG;
+	/* sender's reference, see ksocknal_lib_zc_put() */
+	refcount_set(&uarg->refcnt, 1);
+
+	tx->tx_zc_copied = 0;
+	tx->tx_zc_nob = 0;
+}
+
+void
+ksocknal_lib_zc_put(struct ksock_tx *tx)
+{
+	ksocknal_lib_zc_complete(NULL, &tx->tx_zc_ubuf, true);
+}
+#endif /* HAVE_MSGHDR_MSG_UBUF */
+
 int
 ksocknal_lib_send_hdr(struct ksock_conn *conn, struct ksock_tx *tx,
 		      struct kvec *scratchiov)
@@ -140,6 +200,31 @@ ksocknal_lib_send_kiov(struct ksock_conn *conn, struct ksock_tx *tx,
 
 		rc = sk->sk_prot->sendpage(sk, page,
 					   offset, fragsize, msgflg);
+		if (rc > 0)
+			atomic64_add(rc, &conn->ksnc_tx_zc_bytes);
+#ifdef HAVE_MSGHDR_MSG_UBUF
+	} else if (tx->tx_zc_msg) {
+		/* Zero copy by MSG_ZEROCOPY: the stack takes its own page
+		 * references and releases tx_zc_ubuf once it drops them,
+		 * so all the frags can go in a single call */
+		struct msghdr msg = {
+			.msg_flags = MSG_DONTWAIT | MSG_ZEROCOPY,
+			.msg_ubuf = &tx->tx_zc_ubuf,
+		};
+		int i;
+
+		for (nob = i = 0; i < tx->tx_nkiov; i++)
+			nob += kiov[i].bv_len;
+
+		if (!list_empty(&conn->ksnc_tx_queue) ||
+		    nob < tx->tx_resid)
+			msg.msg_flags |= MSG_MORE;
+
+		iov_iter_bvec(&msg.msg_iter, WRITE, kiov, tx->tx_nkiov, nob);
+		rc = sock_sendmsg(sock, &msg);
+		if (rc > 0)
+			tx->tx_zc_nob += rc;
+#endif
 	} else {
 #if SOCKNAL_SINGLE_FRAG_TX || !SOCKNAL_RISK_KMAP_DEADLOCK
 		struct kvec	scratch;
@@ -149,7 +234,9 @@ ksocknal_lib_send_kiov(struct ksock_conn *conn, struct ksock_tx *tx,
 #ifdef CONFIG_HIGHMEM
 #warning "XXX risk of kmap deadlock on multiple frags..."
 #endif
-		unsigned int  niov = tx->tx_nkiov;
+		/* a large message is sent in LNET_MAX_IOV frags steps */
+		unsigned int  niov = min_t(unsigned int, tx->tx_nkiov,
+					   LNET_MAX_IOV);
 #endif
 		struct msghdr msg = { .msg_flags = MSG_DONTWAIT };
 		int	      i;
@@ -165,6 +252,8 @@ ksocknal_lib_send_kiov(struct ksock_conn *conn, struct ksock_tx *tx,
 			msg.msg_flags |= MSG_MORE;
 
 		rc = kernel_sendmsg(sock, &msg, scratchiov, niov, nob);
+		if (rc > 0)
+			atomic64_add(rc, &conn->ksnc_tx_copy_bytes);
 
 		for (i = 0; i < niov; i++)
 			kunmap(kiov[i].bv_page);
@@ -289,6 +378,53 @@ ksocknal_lib_kiov_vmap(struct bio_vec *kiov, int niov,
 	return addr;
 }
 
+#ifdef HAVE_SOCK_RECVMSG_ITER
+static int
+ksocknal_lib_recv_bvec(struct ksock_conn *conn)
+{
+	struct bio_vec *kiov = conn->ksnc_rx_kiov;
+	unsigned int niov = conn->ksnc_rx_nkiov;
+	struct msghdr msg = {
+		.msg_flags	= 0
+	};
+	void *base;
+	int fragnob;
+	int nob;
+	int sum;
+	int rc;
+	int i;
+
+	for (nob = i = 0; i < niov; i++)
+		nob += kiov[i].bv_len;
+
+	LASSERT(nob <= conn->ksnc_rx_nob_wanted);
+
+	/* the stack copies straight into the pages, nothing to map */
+	iov_iter_bvec(&msg.msg_iter, READ, kiov, niov, nob);
+	rc = sock_recvmsg(conn->ksnc_sock, &msg, MSG_DONTWAIT);
+	if (rc <= 0)
+		return rc;
+
+	atomic64_add(rc, &conn->ksnc_rx_bytes);
+
+	if (conn->ksnc_msg.ksm_csum != 0) {
+		for (i = 0, sum = rc; sum > 0; i++, sum -= fragnob) {
+			LASSERT(i < niov);
+
+			base = kmap(kiov[i].bv_page) + kiov[i].bv_offset;
+			fragnob = min_t(int, kiov[i].bv_len, sum);
+
+			conn->ksnc_rx_csum = ksocknal_csum(conn->ksnc_rx_csum,
+							   base, fragnob);
+
+			kunmap(kiov[i].bv_page);
+		}
+	}
+
+	return rc;
+}
+#endif /* HAVE_SOCK_RECVMSG_ITER */
+
 int
 ksocknal_lib_recv_kiov(struct ksock_conn *conn, struct page **pages,
 		       struct kvec *scratchiov)
@@ -317,6 +453,12 @@ ksocknal_lib_recv_kiov(struct ksock_conn *conn, struct page **pages,
         int          fragnob;
 	int n;
 
+#ifdef HAVE_SOCK_RECVMSG_ITER
+	/* vmap is still used to feed ZC recv capable (TOE) drivers */
+	if (!*ksocknal_tunables.ksnd_zc_recv)
+		return ksocknal_lib_recv_bvec(conn);
+#endif
+
         /* NB we can't trust socket ops to either consume our iovs
          * or leave them alone. */
 	if ((addr = ksocknal_lib_kiov_vmap(kiov, niov, scratchiov, pages)) != NULL) {
@@ -336,6 +478,8 @@ ksocknal_lib_recv_kiov(struct ksock_conn *conn, struct page **pages,
 
 	rc = kernel_recvmsg(conn->ksnc_sock, &msg, scratchiov, n, nob,
 			    MSG_DONTWAIT);
+	if (rc > 0)
+		atomic64_add(rc, &conn->ksnc_rx_bytes);
 
 	if (conn->ksnc_msg.ksm_csum != 0) {
 		for (i = 0, sum = rc; sum > 0; i++, sum -= fragnob) {
@@ -148,6 +148,18 @@ static unsigned int zc_recv_min_nfrags = 16;
 module_param(zc_recv_min_nfrags, int, 0644);
 MODULE_PARM_DESC(zc_recv_min_nfrags, "minimum # of fragments to enable ZC recv");
 
+static int tx_zerocopy;
+module_param(tx_zerocopy, int, 0644);
+MODULE_PARM_DESC(tx_zerocopy, "send bulk with MSG_ZEROCOPY and local completion instead of peer ZC-ACK");
+
+static int stripe_min;
+module_param(stripe_min, int, 0644);
+MODULE_PARM_DESC(stripe_min, "minimum payload size to stripe across connections (0 disables)");
+
+static int busy_poll;
+module_param(busy_poll, int, 0644);
+MODULE_PARM_DESC(busy_poll, "max microseconds schedulers busy poll for work before sleeping (0 disables)");
+
 static unsigned int conns_per_peer = DEFAULT_CONNS_PER_PEER;
 module_param(conns_per_peer, uint, 0644);
 MODULE_PARM_DESC(conns_per_peer, "number of connections per peer");
@@ -301,6 +313,9 @@ int ksocknal_tunables_init(void)
 	ksocknal_tunables.ksnd_zc_min_payload     = &zc_min_payload;
 	ksocknal_tunables.ksnd_zc_recv            = &zc_recv;
 	ksocknal_tunables.ksnd_zc_recv_min_nfrags = &zc_recv_min_nfrags;
+	ksocknal_tunables.ksnd_tx_zerocopy        = &tx_zerocopy;
+	ksocknal_tunables.ksnd_stripe_min         = &stripe_min;
+	ksocknal_tunables.ksnd_busy_poll          = &busy_poll;
 	if (conns_per_peer > ((1 << SOCKNAL_CONN_COUNT_MAX_BITS)-1)) {
 		CWARN("socklnd conns_per_peer is capped at %u.\n",
 		      (1 << SOCKNAL_CONN_COUNT_MAX_BITS)-1);
@@ -324,6 +339,13 @@ int ksocknal_tunables_init(void)
 	ksocknal_tunables.ksnd_protocol           = &protocol;
 #endif
 
+#ifndef HAVE_MSGHDR_MSG_UBUF
+	if (*ksocknal_tunables.ksnd_tx_zerocopy) {
+		CWARN("tx_zerocopy is not supported by this kernel, falling back to sendpage\n");
+		*ksocknal_tunables.ksnd_tx_zerocopy = 0;
+	}
+#endif
+
 	if (*ksocknal_tunables.ksnd_zc_min_payload < (2 << 10))
 		*ksocknal_tunables.ksnd_zc_min_payload = (2 << 10);
 
@@ -64,8 +64,10 @@ ksocknal_next_tx_carrier(struct ksock_conn *conn)
                 conn->ksnc_tx_carrier = NULL;
         } else {
 		conn->ksnc_tx_carrier = list_next_entry(tx, tx_list);
-		LASSERT(conn->ksnc_tx_carrier->tx_msg.ksm_type ==
-			tx->tx_msg.ksm_type);
+		/* LNET and STRIPE carry cookies alike */
+		LASSERT((conn->ksnc_tx_carrier->tx_msg.ksm_type ==
+			 KSOCK_MSG_NOOP) ==
+			(tx->tx_msg.ksm_type == KSOCK_MSG_NOOP));
         }
 }
 
@@ -102,7 +104,8 @@ ksocknal_queue_tx_zcack_v2(struct ksock_conn *conn,
                 return 0;
         }
 
-        LASSERT(tx->tx_msg.ksm_type == KSOCK_MSG_LNET);
+	LASSERT(tx->tx_msg.ksm_type == KSOCK_MSG_LNET ||
+		tx->tx_msg.ksm_type == KSOCK_MSG_STRIPE);
         LASSERT(tx->tx_msg.ksm_zc_cookies[1] == 0);
 
         if (tx_ack != NULL)
@@ -134,7 +137,7 @@ ksocknal_queue_tx_msg_v2(struct ksock_conn *conn, struct ksock_tx *tx_msg)
                 return NULL;
         }
 
-        if (tx->tx_msg.ksm_type == KSOCK_MSG_LNET) { /* nothing to carry */
+	if (tx->tx_msg.ksm_type != KSOCK_MSG_NOOP) { /* nothing to carry */
 		list_add_tail(&tx_msg->tx_list, &conn->ksnc_tx_queue);
                 return NULL;
         }
@@ -876,6 +879,18 @@ ksocknal_pack_msg_v2(struct ksock_tx *tx)
 		tx->tx_hdr.iov_len = hdr_size;
 		tx->tx_resid = tx->tx_nob = hdr_size + tx->tx_lnetmsg->msg_len;
 		break;
+	case KSOCK_MSG_STRIPE:
+		LASSERT(tx->tx_lnetmsg != NULL);
+		LASSERT(tx->tx_stripe != NULL);
+		hdr_size = (sizeof(struct ksock_msg_hdr) +
+			    sizeof(tx->tx_msg.ksm_u.stripe));
+
+		lnet_hdr_to_nid4(&tx->tx_lnetmsg->msg_hdr,
+				 &tx->tx_msg.ksm_u.stripe.ksms_lnetmsg);
+		tx->tx_hdr.iov_len = hdr_size;
+		tx->tx_resid = tx->tx_nob = hdr_size +
+			tx->tx_msg.ksm_u.stripe.ksms_stripe.kss_nob;
+		break;
 	case KSOCK_MSG_NOOP:
 		LASSERT(tx->tx_lnetmsg == NULL);
 		hdr_size = sizeof(struct ksock_msg_hdr);
@@ -128,6 +128,47 @@ module_param(lnet_recovery_limit, uint, 0644);
 MODULE_PARM_DESC(lnet_recovery_limit,
 		 "How long to attempt recovery of unhealthy peer interfaces in seconds. Set to 0 to allow indefinite recovery");
 
+/*
+ * lnet_rtt_threshold is how much lower, in percent, the measured round
+ * trip time of a local NI, peer NI or route has to be for Multi-Rail
+ * selection to prefer it over an otherwise equal one.
+ */
+unsigned int lnet_rtt_threshold = 50;
+module_param(lnet_rtt_threshold, uint, 0644);
+MODULE_PARM_DESC(lnet_rtt_threshold,
+		 "Percentage by which a path's round trip time must be lower to be preferred during Multi-Rail selection. Set to 0 to ignore latency");
+
+/*
+ * lnet_obj_cache_size is the number of freed messages, and of freed small
+ * MDs, each CPT keeps around for reuse instead of returning them to the slab.
+ */
+unsigned int lnet_obj_cache_size = 1024;
+module_param(lnet_obj_cache_size, uint, 0644);
+MODULE_PARM_DESC(lnet_obj_cache_size,
+		 "Number of freed messages and MDs kept per CPT for reuse. Set to 0 to disable");
+
+/*
+ * lnet_coalesce_size is the largest payload, in bytes, of a PUT or ACK that
+ * may be coalesced with other messages queued for the same peer NI while its
+ * send credits are exhausted. Only peers that advertise
+ * LNET_PING_FEAT_COALESCE receive such bundles.
+ */
+unsigned int lnet_coalesce_size;
+module_param(lnet_coalesce_size, uint, 0644);
+MODULE_PARM_DESC(lnet_coalesce_size,
+		 "Largest payload of a message coalesced with others queued for the same peer NI. Set to 0 to disable");
+
+/*
+ * lnet_large_mtu lets a message carry up to LNET_MTU_LARGE bytes of payload
+ * instead of LNET_MTU, between peers which both enable it on all the NIs
+ * they may use, whose LNDs support it. It is advertised to the peers with
+ * LNET_PING_FEAT_LARGE_MTU, so it can't be changed once LNet is up.
+ */
+unsigned int lnet_large_mtu;
+module_param(lnet_large_mtu, uint, 0444);
+MODULE_PARM_DESC(lnet_large_mtu,
+		 "Allow messages larger than 1MiB to peers which accept them. Set to 0 to disable");
+
 static int lnet_interfaces_max = LNET_INTERFACES_MAX_DEFAULT;
 static int intf_max_set(const char *val, cfs_kernel_param_arg_t *kp);
 
@@ -572,6 +613,7 @@ lnet_init_locks(void)
 {
 	spin_lock_init(&the_lnet.ln_eq_wait_lock);
 	spin_lock_init(&the_lnet.ln_msg_resend_lock);
+	spin_lock_init(&the_lnet.ln_bundle_lock);
 	init_completion(&the_lnet.ln_mt_wait_complete);
 	mutex_init(&the_lnet.ln_lnd_mutex);
 }
@@ -648,6 +690,46 @@ lnet_slab_cleanup(void)
 	}
 }
 
+static struct lnet_obj_cache **
+lnet_obj_cache_create(void)
+{
+	struct lnet_obj_cache **caches;
+	struct lnet_obj_cache *oc;
+	int i;
+
+	caches = cfs_percpt_alloc(lnet_cpt_table(), sizeof(*oc));
+	if (caches == NULL)
+		return NULL;
+
+	cfs_percpt_for_each(oc, i, caches) {
+		spin_lock_init(&oc->oc_lock);
+		init_llist_head(&oc->oc_free);
+		atomic_set(&oc->oc_nfree, 0);
+	}
+
+	return caches;
+}
+
+static void
+lnet_obj_cache_destroy(struct lnet_obj_cache **caches,
+		       struct kmem_cache *cachep)
+{
+	struct lnet_obj_cache *oc;
+	struct llist_node *node;
+	struct llist_node *next;
+	int i;
+
+	if (caches == NULL)
+		return;
+
+	cfs_percpt_for_each(oc, i, caches) {
+		llist_for_each_safe(node, next, llist_del_all(&oc->oc_free))
+			kmem_cache_free(cachep, node);
+	}
+
+	cfs_percpt_free(caches);
+}
+
 static int
 lnet_create_remote_nets_table(void)
 {
@@ -846,8 +928,8 @@ static void lnet_assert_wire_constants(void)
 	BUILD_BUG_ON((int)sizeof(((struct lnet_ni_status *)0)->ns_nid) != 8);
 	BUILD_BUG_ON((int)offsetof(struct lnet_ni_status, ns_status) != 8);
 	BUILD_BUG_ON((int)sizeof(((struct lnet_ni_status *)0)->ns_status) != 4);
-	BUILD_BUG_ON((int)offsetof(struct lnet_ni_status, ns_unused) != 12);
-	BUILD_BUG_ON((int)sizeof(((struct lnet_ni_status *)0)->ns_unused) != 4);
+	BUILD_BUG_ON((int)offsetof(struct lnet_ni_status, ns_mtu) != 12);
+	BUILD_BUG_ON((int)sizeof(((struct lnet_ni_status *)0)->ns_mtu) != 4);
 
 	/* Checks for struct lnet_ping_info and related constants */
 	BUILD_BUG_ON(LNET_PROTO_PING_MAGIC != 0x70696E67);
@@ -857,7 +939,9 @@ static void lnet_assert_wire_constants(void)
 	BUILD_BUG_ON(LNET_PING_FEAT_RTE_DISABLED != 4);
 	BUILD_BUG_ON(LNET_PING_FEAT_MULTI_RAIL != 8);
 	BUILD_BUG_ON(LNET_PING_FEAT_DISCOVERY != 16);
-	BUILD_BUG_ON(LNET_PING_FEAT_BITS != 31);
+	BUILD_BUG_ON(LNET_PING_FEAT_COALESCE != 32);
+	BUILD_BUG_ON(LNET_PING_FEAT_LARGE_MTU != 64);
+	BUILD_BUG_ON(LNET_PING_FEAT_BITS != 127);
 
 	/* Checks for struct lnet_ping_info */
 	BUILD_BUG_ON((int)sizeof(struct lnet_ping_info) != 16);
@@ -1309,6 +1393,14 @@ lnet_prepare(lnet_pid_t requested_pid)
 		goto failed;
 	}
 
+	the_lnet.ln_msg_cache = lnet_obj_cache_create();
+	the_lnet.ln_md_cache = lnet_obj_cache_create();
+	if (the_lnet.ln_msg_cache == NULL || the_lnet.ln_md_cache == NULL) {
+		CERROR("Failed to allocate object caches for LNet\n");
+		rc = -ENOMEM;
+		goto failed;
+	}
+
 	rc = lnet_peer_tables_create();
 	if (rc != 0)
 		goto failed;
@@ -1383,11 +1475,16 @@ lnet_unprepare (void)
 	lnet_msg_containers_destroy();
 	lnet_peer_uninit();
 	lnet_rtrpools_free(0);
+	lnet_bundle_reserve_free();
 
 	if (the_lnet.ln_counters != NULL) {
 		cfs_percpt_free(the_lnet.ln_counters);
 		the_lnet.ln_counters = NULL;
 	}
+	lnet_obj_cache_destroy(the_lnet.ln_md_cache, lnet_small_mds_cachep);
+	the_lnet.ln_md_cache = NULL;
+	lnet_obj_cache_destroy(the_lnet.ln_msg_cache, lnet_msg_cachep);
+	the_lnet.ln_msg_cache = NULL;
 	lnet_destroy_remote_nets_table();
 	lnet_udsp_destroy(true);
 	lnet_slab_cleanup();
@@ -1785,7 +1882,10 @@ lnet_ping_target_create(int nnis)
 	pbuf->pb_info.pi_pid = the_lnet.ln_pid;
 	pbuf->pb_info.pi_magic = LNET_PROTO_PING_MAGIC;
 	pbuf->pb_info.pi_features =
-		LNET_PING_FEAT_NI_STATUS | LNET_PING_FEAT_MULTI_RAIL;
+		LNET_PING_FEAT_NI_STATUS | LNET_PING_FEAT_MULTI_RAIL |
+		LNET_PING_FEAT_COALESCE;
+	if (lnet_large_mtu)
+		pbuf->pb_info.pi_features |= LNET_PING_FEAT_LARGE_MTU;
 
 	return pbuf;
 }
@@ -1851,6 +1951,7 @@ lnet_swap_pinginfo(struct lnet_ping_buffer *pbuf)
 		stat = &pbuf->pb_info.pi_ni[i];
 		__swab64s(&stat->ns_nid);
 		__swab32s(&stat->ns_status);
+		__swab32s(&stat->ns_mtu);
 	}
 }
 
@@ -1999,6 +2100,7 @@ lnet_ping_target_install_locked(struct lnet_ping_buffer *pbuf)
 			ns->ns_status = lnet_ni_get_status_locked(ni);
 			ni->ni_status = ns;
 			lnet_ni_unlock(ni);
+			ns->ns_mtu = lnet_ni_mtu(ni);
 
 			i++;
 		}
@@ -2833,6 +2935,7 @@ int lnet_lib_init(void)
 	the_lnet.ln_refcount = 0;
 	INIT_LIST_HEAD(&the_lnet.ln_net_zombie);
 	INIT_LIST_HEAD(&the_lnet.ln_msg_resend);
+	INIT_LIST_HEAD(&the_lnet.ln_bundles);
 
 	/* The hash table size is the number of bits it takes to express the set
 	 * ln_num_routes, minus 1 (better to under estimate than over so we
@@ -3874,6 +3977,24 @@ unlock:
 	return rc;
 }
 
+static int
+lnet_get_local_ni_rtt(struct lnet_ioctl_rtt *rtt)
+{
+	struct lnet_ni *ni;
+	int cpt;
+	int rc = 0;
+
+	cpt = lnet_net_lock_current();
+	ni = lnet_nid2ni_locked(rtt->rtt_nid, cpt);
+	if (ni)
+		rtt->rtt_us = lnet_rtt_get(&ni->ni_rtt);
+	else
+		rc = -ENOENT;
+	lnet_net_unlock(cpt);
+
+	return rc;
+}
+
 static int
 lnet_get_local_ni_recovery_list(struct lnet_ioctl_recovery_list *list)
 {
@@ -3992,7 +4113,9 @@ LNetCtl(unsigned int cmd, void *arg)
 				    &config->cfg_config_u.cfg_route.
 					rtr_priority,
 				    &config->cfg_config_u.cfg_route.
-					rtr_sensitivity);
+					rtr_sensitivity,
+				    &config->cfg_config_u.cfg_route.
+					rtr_rtt_us);
 		mutex_unlock(&the_lnet.ln_api_mutex);
 		return rc;
 
@@ -4153,6 +4276,22 @@ LNetCtl(unsigned int cmd, void *arg)
 		return rc;
 	}
 
+	case IOC_LIBCFS_GET_RTT: {
+		struct lnet_ioctl_rtt *rtt = arg;
+
+		if (rtt->rtt_hdr.ioc_len < sizeof(*rtt))
+			return -EINVAL;
+
+		mutex_lock(&the_lnet.ln_api_mutex);
+		if (rtt->rtt_type == LNET_HEALTH_TYPE_LOCAL_NI)
+			rc = lnet_get_local_ni_rtt(rtt);
+		else
+			rc = lnet_get_peer_ni_rtt(rtt);
+		mutex_unlock(&the_lnet.ln_api_mutex);
+
+		return rc;
+	}
+
 	case IOC_LIBCFS_GET_RECOVERY_QUEUE: {
 		struct lnet_ioctl_recovery_list *list = arg;
 		if (list->rlst_hdr.ioc_len < sizeof(*list))
@@ -178,7 +178,11 @@ lnet_md_build(const struct lnet_md *umd, int unlink)
 	size = offsetof(struct lnet_libmd, md_kiov[niov]);
 
 	if (size <= LNET_SMALL_MD_SIZE) {
-		lmd = kmem_cache_zalloc(lnet_small_mds_cachep, GFP_NOFS);
+		lmd = lnet_obj_cache_get(the_lnet.ln_md_cache,
+					 LNET_SMALL_MD_SIZE);
+		if (lmd == NULL)
+			lmd = kmem_cache_zalloc(lnet_small_mds_cachep,
+						GFP_NOFS);
 		if (lmd) {
 			CDEBUG(D_MALLOC,
 			       "slab-alloced 'md' of size %u at %p.\n",
@@ -251,9 +255,10 @@ lnet_md_build(const struct lnet_md *umd, int unlink)
 			pa += plen;
 			i += 1;
 		}
-		WARN(!(lmd->md_options  & LNET_MD_GNILND) && i > LNET_MAX_IOV,
+		WARN(!(lmd->md_options  & LNET_MD_GNILND) &&
+		     i > lnet_max_iov(),
 			"Max IOV exceeded: %d should be < %d\n",
-			i, LNET_MAX_IOV);
+			i, lnet_max_iov());
 		if ((umd->options & LNET_MD_MAX_SIZE) && /* max size used */
 		    (umd->max_size < 0 ||
 		     umd->max_size > (int)umd->length)) { /* illegal max_size */
@@ -328,9 +333,9 @@ lnet_md_validate(const struct lnet_md *umd)
 	}
 
 	if ((umd->options & LNET_MD_KIOV) &&
-	    umd->length > LNET_MAX_IOV) {
+	    umd->length > lnet_max_iov()) {
 		CERROR("Invalid option: too many fragments %u, %d max\n",
-		       umd->length, LNET_MAX_IOV);
+		       umd->length, lnet_max_iov());
 		return -EINVAL;
 	}
 
@@ -435,9 +440,9 @@ LNetMDBind(const struct lnet_md *umd, enum lnet_unlink unlink,
 	if (IS_ERR(md))
 		return PTR_ERR(md);
 
-	if (md->md_length > LNET_MTU) {
+	if (md->md_length > lnet_max_payload()) {
 		CERROR("Invalid length: too big transfer size %u, %d max\n",
-		       md->md_length, LNET_MTU);
+		       md->md_length, lnet_max_payload());
 		rc = -EINVAL;
 		goto out_free;
 	}
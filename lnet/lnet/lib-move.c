@@ -682,6 +682,16 @@ lnet_ni_recv(struct lnet_ni *ni, void *private, struct lnet_msg *msg,
 			LASSERT (niov > 0);
 			LASSERT ((iov == NULL) != (kiov == NULL));
 		}
+
+		if (msg->msg_bundled) {
+			/* payload is already here, see lnet_bundle_split() */
+			if (mlen != 0)
+				lnet_copy_flat2kiov(niov, kiov, offset,
+						    rlen, private, 0, mlen);
+			put_page(virt_to_page(private));
+			lnet_finalize(msg, 0);
+			return;
+		}
 	}
 
 	rc = (ni->ni_net->net_lnd->lnd_recv)(ni, private, msg, delayed,
@@ -948,6 +958,16 @@ lnet_post_send_locked(struct lnet_msg *msg, int do_send)
 }
 
 
+/* bytes moved by @msg: a GET is answered with up to its whole MD */
+static unsigned int
+lnet_msg_payload(struct lnet_msg *msg)
+{
+	if (msg->msg_type == LNET_MSG_GET && msg->msg_md)
+		return msg->msg_md->md_length;
+
+	return msg->msg_len;
+}
+
 static struct lnet_rtrbufpool *
 lnet_msg2bufpool(struct lnet_msg *msg)
 {
@@ -1023,11 +1043,14 @@ lnet_post_routed_recv_locked(struct lnet_msg *msg, int do_recv)
 		rbp->rbp_credits--;
 		if (rbp->rbp_credits < rbp->rbp_mincredits)
 			rbp->rbp_mincredits = rbp->rbp_credits;
+		if (rbp->rbp_credits < rbp->rbp_resize_mincredits)
+			rbp->rbp_resize_mincredits = rbp->rbp_credits;
 
 		if (rbp->rbp_credits < 0) {
 			/* must have checked eager_recv before here */
 			LASSERT(msg->msg_rx_ready_delay);
 			msg->msg_rx_delayed = 1;
+			rbp->rbp_nblocked++;
 			list_add_tail(&msg->msg_list, &rbp->rbp_msgs);
 			return LNET_CREDIT_WAIT;
 		}
@@ -1054,6 +1077,282 @@ lnet_post_routed_recv_locked(struct lnet_msg *msg, int do_recv)
 	return LNET_CREDIT_OK;
 }
 
+/*
+ * Message coalescing.
+ *
+ * While a peer NI has no send credits left, every message for it waits on
+ * lpni_txq and then goes out in an LND frame of its own. When a credit
+ * comes back and the next waiting message is tiny, the tiny messages queued
+ * behind it for the same local NI are packed with it into one carrier PUT
+ * to LNET_RESERVED_PORTAL. The carrier uses the returned credit and the
+ * others give theirs back. Each record of the carrier payload is the wire
+ * header of a message followed by its payload; the receiver parses the
+ * records as if the messages had arrived on their own.
+ *
+ * No message is held back to fill a bundle, so coalescing only happens
+ * when the peer NI is already the bottleneck.
+ */
+
+/* stay below the immediate message size of the LNDs, a bundle should
+ * never need an RDMA handshake */
+#define LNET_BUNDLE_MAX_SIZE	(3 << 10)
+#define LNET_BUNDLE_REC_SIZE(nob) \
+	round_up(sizeof(struct lnet_hdr_nid4) + (nob), 8)
+
+/* sent bundles preallocated by lnet_bundle_reserve() */
+#define LNET_BUNDLE_RESERVE	8
+
+struct lnet_bundle {
+	/* chain on ln_bundles while reserved */
+	struct list_head	lb_list;
+	/* messages carried by a sent bundle */
+	struct list_head	lb_msgs;
+	/* carrier of a reserved bundle */
+	struct lnet_msg		*lb_carrier;
+	/* the bundle payload, within a single page */
+	struct bio_vec		lb_kiov;
+};
+
+static void
+lnet_bundle_free(struct lnet_bundle *lb)
+{
+	if (lb->lb_carrier != NULL)
+		lnet_msg_free(lb->lb_carrier);
+	if (lb->lb_kiov.bv_page != NULL)
+		put_page(lb->lb_kiov.bv_page);
+	LIBCFS_FREE(lb, sizeof(*lb));
+}
+
+/*
+ * Top up the reserve of sent bundles. The bundles are built when a peer
+ * credit is returned, in whatever context completes the previous message,
+ * so their carrier and page are allocated beforehand, here, by senders of
+ * PUTs which may block.
+ */
+void
+lnet_bundle_reserve(void)
+{
+	struct lnet_bundle *lb;
+
+	while (lnet_coalesce_size != 0 &&
+	       READ_ONCE(the_lnet.ln_nbundles) < LNET_BUNDLE_RESERVE) {
+		LIBCFS_ALLOC(lb, sizeof(*lb));
+		if (lb == NULL)
+			return;
+
+		INIT_LIST_HEAD(&lb->lb_msgs);
+		lb->lb_carrier = lnet_msg_alloc();
+		lb->lb_kiov.bv_page = alloc_page(GFP_NOFS | __GFP_ZERO);
+		if (lb->lb_carrier == NULL || lb->lb_kiov.bv_page == NULL) {
+			lnet_bundle_free(lb);
+			return;
+		}
+
+		spin_lock(&the_lnet.ln_bundle_lock);
+		if (the_lnet.ln_nbundles >= LNET_BUNDLE_RESERVE) {
+			spin_unlock(&the_lnet.ln_bundle_lock);
+			lnet_bundle_free(lb);
+			return;
+		}
+		list_add(&lb->lb_list, &the_lnet.ln_bundles);
+		the_lnet.ln_nbundles++;
+		spin_unlock(&the_lnet.ln_bundle_lock);
+	}
+}
+
+void
+lnet_bundle_reserve_free(void)
+{
+	struct lnet_bundle *lb;
+
+	while ((lb = list_first_entry_or_null(&the_lnet.ln_bundles,
+					      struct lnet_bundle,
+					      lb_list)) != NULL) {
+		list_del(&lb->lb_list);
+		the_lnet.ln_nbundles--;
+		lnet_bundle_free(lb);
+	}
+	LASSERT(the_lnet.ln_nbundles == 0);
+}
+
+static struct lnet_bundle *
+lnet_bundle_get(void)
+{
+	struct lnet_bundle *lb;
+
+	spin_lock(&the_lnet.ln_bundle_lock);
+	lb = list_first_entry_or_null(&the_lnet.ln_bundles,
+				      struct lnet_bundle, lb_list);
+	if (lb != NULL) {
+		list_del(&lb->lb_list);
+		the_lnet.ln_nbundles--;
+	}
+	spin_unlock(&the_lnet.ln_bundle_lock);
+
+	return lb;
+}
+
+static void
+lnet_bundle_put(struct lnet_bundle *lb)
+{
+	spin_lock(&the_lnet.ln_bundle_lock);
+	list_add(&lb->lb_list, &the_lnet.ln_bundles);
+	the_lnet.ln_nbundles++;
+	spin_unlock(&the_lnet.ln_bundle_lock);
+}
+
+static bool
+lnet_bundle_msg_ok(struct lnet_msg *msg)
+{
+	if (msg->msg_type != LNET_MSG_PUT && msg->msg_type != LNET_MSG_ACK)
+		return false;
+
+	if (msg->msg_len > lnet_coalesce_size || msg->msg_routing)
+		return false;
+
+	if (msg->msg_md != NULL &&
+	    (msg->msg_md->md_flags & LNET_MD_FLAG_ABORTED) != 0)
+		return false;
+
+	/* records carry a NID4 header and are parsed by the next hop */
+	return nid_same(&msg->msg_hdr.dest_nid, &msg->msg_txpeer->lpni_nid) &&
+	       nid_is_nid4(&msg->msg_hdr.dest_nid) &&
+	       nid_is_nid4(&msg->msg_hdr.src_nid);
+}
+
+/*
+ * \a msg has just been granted the peer credit it waited for on lpni_txq.
+ * If other tiny messages still wait behind it, pack them all into a carrier
+ * which takes over the peer credit of \a msg and return the carrier.
+ * Otherwise, or if no bundle is reserved, return \a msg.
+ *
+ * Called with lnet_net_lock(msg->msg_tx_cpt) held, which may be dropped
+ * while the payload is copied. Nothing is allocated here.
+ */
+static struct lnet_msg *
+lnet_bundle_tx_locked(struct lnet_msg *msg)
+{
+	struct lnet_peer_ni *lpni = msg->msg_txpeer;
+	struct lnet_ni *ni = msg->msg_txni;
+	int cpt = msg->msg_tx_cpt;
+	struct lnet_msg *carrier;
+	struct lnet_bundle *lb;
+	struct lnet_msg *sub;
+	struct lnet_msg *tmp;
+	unsigned int nob;
+	int nmsgs = 0;
+	char *base;
+
+	if (lnet_coalesce_size == 0 || list_empty(&lpni->lpni_txq) ||
+	    !(lpni->lpni_peer_net->lpn_peer->lp_state & LNET_PEER_COALESCE) ||
+	    !lnet_bundle_msg_ok(msg))
+		return msg;
+
+	lb = lnet_bundle_get();
+	if (lb == NULL)
+		return msg;
+
+	list_add_tail(&msg->msg_list, &lb->lb_msgs);
+	nob = LNET_BUNDLE_REC_SIZE(msg->msg_len);
+
+	spin_lock(&lpni->lpni_lock);
+	list_for_each_entry_safe(sub, tmp, &lpni->lpni_txq, msg_list) {
+		if (sub->msg_txni != ni || sub->msg_tx_cpt != cpt ||
+		    !lnet_bundle_msg_ok(sub))
+			continue;
+
+		if (nob + LNET_BUNDLE_REC_SIZE(sub->msg_len) >
+		    LNET_BUNDLE_MAX_SIZE)
+			break;
+
+		/* give back the credit it has been queued for */
+		LASSERT(sub->msg_peertxcredit);
+		sub->msg_peertxcredit = 0;
+		sub->msg_tx_delayed = 0;
+		sub->msg_carried = 1;
+		lpni->lpni_txqnob -= sub->msg_len +
+				     sizeof(struct lnet_hdr_nid4);
+		lpni->lpni_txcredits++;
+
+		list_move_tail(&sub->msg_list, &lb->lb_msgs);
+		nob += LNET_BUNDLE_REC_SIZE(sub->msg_len);
+		nmsgs++;
+	}
+
+	if (nmsgs == 0) {
+		spin_unlock(&lpni->lpni_lock);
+		list_del(&msg->msg_list);
+		lnet_bundle_put(lb);
+		return msg;
+	}
+
+	/* the carrier takes over the peer credit of msg */
+	msg->msg_peertxcredit = 0;
+	msg->msg_tx_delayed = 0;
+	msg->msg_carried = 1;
+	lpni->lpni_txqnob += nob - msg->msg_len;
+	spin_unlock(&lpni->lpni_lock);
+
+	/* all bundled messages are mine now */
+	lnet_net_unlock(cpt);
+
+	carrier = lb->lb_carrier;
+	lb->lb_carrier = NULL;
+	base = page_address(lb->lb_kiov.bv_page);
+	nob = 0;
+	list_for_each_entry(sub, &lb->lb_msgs, msg_list) {
+		lnet_hdr_to_nid4(&sub->msg_hdr,
+				 (struct lnet_hdr_nid4 *)(base + nob));
+		lnet_copy_kiov2flat(PAGE_SIZE, base,
+				    nob + sizeof(struct lnet_hdr_nid4),
+				    sub->msg_niov, sub->msg_kiov,
+				    sub->msg_offset, sub->msg_len);
+		nob += LNET_BUNDLE_REC_SIZE(sub->msg_len);
+	}
+
+	lb->lb_kiov.bv_offset = 0;
+	lb->lb_kiov.bv_len = nob;
+
+	carrier->msg_bundle = lb;
+	carrier->msg_type = LNET_MSG_PUT;
+	carrier->msg_target = msg->msg_target;
+	carrier->msg_len = nob;
+	carrier->msg_niov = 1;
+	carrier->msg_kiov = &lb->lb_kiov;
+	carrier->msg_sending = 1;
+	carrier->msg_tx_delayed = 1;
+	carrier->msg_peertxcredit = 1;
+	carrier->msg_no_resend = true;
+	/* accounted as a sent PUT, no event without an MD */
+	carrier->msg_ev.type = LNET_EVENT_SEND;
+
+	carrier->msg_hdr.type = LNET_MSG_PUT;
+	carrier->msg_hdr.dest_nid = msg->msg_hdr.dest_nid;
+	carrier->msg_hdr.dest_pid = msg->msg_hdr.dest_pid;
+	carrier->msg_hdr.src_nid = msg->msg_hdr.src_nid;
+	carrier->msg_hdr.src_pid = the_lnet.ln_pid;
+	carrier->msg_hdr.payload_length = nob;
+	carrier->msg_hdr.msg.put.ptl_index = cpu_to_le32(LNET_RESERVED_PORTAL);
+	carrier->msg_hdr.msg.put.match_bits =
+		cpu_to_le64(LNET_PROTO_BUNDLE_MATCHBITS);
+	carrier->msg_hdr.msg.put.ack_wmd.wh_interface_cookie =
+		LNET_WIRE_HANDLE_COOKIE_NONE;
+	carrier->msg_hdr.msg.put.ack_wmd.wh_object_cookie =
+		LNET_WIRE_HANDLE_COOKIE_NONE;
+
+	lnet_net_lock(cpt);
+	lnet_msg_commit(carrier, cpt);
+	carrier->msg_txni = ni;
+	lnet_ni_addref_locked(ni, cpt);
+	carrier->msg_txpeer = lpni;
+	lnet_peer_ni_addref_locked(lpni);
+
+	CDEBUG(D_NET, "%s: coalesced %d messages to %s, %u bytes\n",
+	       libcfs_nidstr(&ni->ni_nid), nmsgs + 1,
+	       libcfs_nidstr(&lpni->lpni_nid), nob);
+	return carrier;
+}
+
 void
 lnet_return_tx_credits_locked(struct lnet_msg *msg)
 {
@@ -1127,6 +1426,7 @@ lnet_return_tx_credits_locked(struct lnet_msg *msg)
 				lnet_net_unlock(msg->msg_tx_cpt);
 				lnet_net_lock(msg2_cpt);
 			}
+			msg2 = lnet_bundle_tx_locked(msg2);
                         (void) lnet_post_send_locked(msg2, 1);
 			if (msg2_cpt != msg->msg_tx_cpt) {
 				lnet_net_unlock(msg2_cpt);
@@ -1316,6 +1616,7 @@ lnet_select_peer_ni(struct lnet_ni *best_ni, lnet_nid_t dst_nid,
 	bool best_lpni_is_preferred = false;
 	bool lpni_is_preferred;
 	int lpni_healthv;
+	int rtt_cmp;
 	__u32 lpni_sel_prio;
 	__u32 best_sel_prio = LNET_MAX_SELECTION_PRIORITY;
 
@@ -1338,11 +1639,13 @@ lnet_select_peer_ni(struct lnet_ni *best_ni, lnet_nid_t dst_nid,
 		lpni_sel_prio = lpni->lpni_sel_priority;
 
 		if (best_lpni)
-			CDEBUG(D_NET, "n:[%s, %s] h:[%d, %d] p:[%d, %d] c:[%d, %d] s:[%d, %d]\n",
+			CDEBUG(D_NET, "n:[%s, %s] h:[%d, %d] p:[%d, %d] r:[%u, %u] c:[%d, %d] s:[%d, %d]\n",
 				libcfs_nidstr(&lpni->lpni_nid),
 				libcfs_nidstr(&best_lpni->lpni_nid),
 				lpni_healthv, best_lpni_healthv,
 				lpni_sel_prio, best_sel_prio,
+				lnet_rtt_get(&lpni->lpni_rtt),
+				lnet_rtt_get(&best_lpni->lpni_rtt),
 				lpni->lpni_txcredits, best_lpni_credits,
 				lpni->lpni_seq, best_lpni->lpni_seq);
 		else
@@ -1376,6 +1679,14 @@ lnet_select_peer_ni(struct lnet_ni *best_ni, lnet_nid_t dst_nid,
 			continue;
 		}
 
+		/* a peer NI that completes sends markedly faster wins */
+		rtt_cmp = lnet_rtt_compare(&lpni->lpni_rtt,
+					   &best_lpni->lpni_rtt);
+		if (rtt_cmp < 0)
+			continue;
+		else if (rtt_cmp > 0)
+			goto select_lpni;
+
 		if (lpni->lpni_txcredits < best_lpni_credits)
 			/* We already have a peer that has more credits
 			 * available than this one. No need to consider
@@ -1470,7 +1781,7 @@ lnet_compare_gw_lpnis(struct lnet_peer_ni *lpni1, struct lnet_peer_ni *lpni2)
 	return 0;
 }
 
-/* Compare route priorities and hop counts */
+/* Compare route priorities, hop counts and latency */
 static int
 lnet_compare_routes(struct lnet_route *r1, struct lnet_route *r2)
 {
@@ -1489,7 +1800,7 @@ lnet_compare_routes(struct lnet_route *r1, struct lnet_route *r2)
 	if (r1_hops > r2_hops)
 		return -1;
 
-	return 0;
+	return lnet_rtt_compare(&r1->lr_rtt, &r2->lr_rtt);
 }
 
 static struct lnet_route *
@@ -1669,6 +1980,7 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 		int ni_credits;
 		int ni_healthv;
 		int ni_fatal;
+		int rtt_cmp;
 		__u32 ni_sel_prio;
 		unsigned int ni_dev_prio;
 
@@ -1733,6 +2045,13 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 		else if (distance < shortest_distance)
 			goto select_ni;
 
+		/* a healthy but congested rail shows in its latency */
+		rtt_cmp = lnet_rtt_compare(&ni->ni_rtt, &best_ni->ni_rtt);
+		if (rtt_cmp < 0)
+			continue;
+		else if (rtt_cmp > 0)
+			goto select_ni;
+
 		if (ni_credits < best_credits)
 			continue;
 		else if (ni_credits > best_credits)
@@ -1832,6 +2151,23 @@ lnet_handle_send(struct lnet_send_data *sd)
 	int rc;
 	__u32 routing = send_case & REMOTE_DST;
 	 struct lnet_rsp_tracker *rspt;
+	unsigned int nob = lnet_msg_payload(msg);
+
+	/* a message larger than LNET_MTU is never routed, and both ends must
+	 * accept it. LNetPeerMaxPayload() told the caller so, but the peer
+	 * may have changed since.
+	 */
+	if (nob > LNET_MTU &&
+	    (routing || nob > lnet_ni_mtu(best_ni) ||
+	     nob > lnet_peer_ni_mtu(best_lpni))) {
+		CERROR("Can't send %s of %u bytes from %s to %s%s: %u/%u max\n",
+		       lnet_msgtyp2str(msg->msg_type), nob,
+		       libcfs_nidstr(&best_ni->ni_nid),
+		       libcfs_nidstr(&best_lpni->lpni_nid),
+		       routing ? " (router)" : "", lnet_ni_mtu(best_ni),
+		       lnet_peer_ni_mtu(best_lpni));
+		return -EMSGSIZE;
+	}
 
 	/* Increment sequence number of the selected peer, peer net,
 	 * local ni and local net so that we pick the next ones
@@ -2418,6 +2754,7 @@ lnet_find_best_ni_on_local_net(struct lnet_peer *peer, int md_cpt,
 	__u32 best_net_sel_prio = LNET_MAX_SELECTION_PRIORITY;
 	__u32 net_sel_prio;
 	bool exit = false;
+	int rtt_cmp;
 
 	/*
 	 * The peer can have multiple interfaces, some of them can be on
@@ -2475,6 +2812,13 @@ lnet_find_best_ni_on_local_net(struct lnet_peer *peer, int md_cpt,
 		else if (best_net_sel_prio > net_sel_prio)
 			goto select_lpn;
 
+		/* a net the peer answers markedly faster on wins */
+		rtt_cmp = lnet_rtt_compare(&lpn->lpn_rtt, &best_lpn->lpn_rtt);
+		if (rtt_cmp < 0)
+			continue;
+		else if (rtt_cmp > 0)
+			goto select_lpn;
+
 		if (best_lpn->lpn_seq < lpn->lpn_seq)
 			continue;
 		else if (best_lpn->lpn_seq > lpn->lpn_seq)
@@ -3811,6 +4155,7 @@ static int
 lnet_monitor_thread(void *arg)
 {
 	time64_t rsp_timeout = 0;
+	time64_t rtrpool_resize = 0;
 	time64_t now;
 
 	wait_for_completion(&the_lnet.ln_started);
@@ -3823,6 +4168,7 @@ lnet_monitor_thread(void *arg)
 	 *     pings them
 	 *  4. Checks if there are any NIs on the remote recovery queue
 	 *     and pings them.
+	 *  5. Resizes the router buffer pools if router_buffers_auto is set
 	 */
 	while (the_lnet.ln_mt_state == LNET_MT_STATE_RUNNING) {
 		now = ktime_get_real_seconds();
@@ -3837,6 +4183,11 @@ lnet_monitor_thread(void *arg)
 			rsp_timeout = now + (lnet_transaction_timeout / 2);
 		}
 
+		if (the_lnet.ln_routing && now >= rtrpool_resize) {
+			lnet_rtrpools_resize();
+			rtrpool_resize = now + 1;
+		}
+
 		lnet_recover_local_nis();
 		lnet_recover_peer_nis();
 
@@ -4150,6 +4501,20 @@ lnet_drop_message(struct lnet_ni *ni, int cpt, void *private, unsigned int nob,
 	lnet_ni_recv(ni, private, NULL, 0, 0, 0, nob);
 }
 
+/* as lnet_drop_message(), for a message split out of a bundle */
+static void
+lnet_drop_bundled_message(struct lnet_ni *ni, int cpt, void *private,
+			  unsigned int nob, __u32 msg_type)
+{
+	lnet_net_lock(cpt);
+	lnet_incr_stats(&ni->ni_stats, msg_type, LNET_STATS_TYPE_DROP);
+	the_lnet.ln_counters[cpt]->lct_common.lcc_drop_count++;
+	the_lnet.ln_counters[cpt]->lct_common.lcc_drop_length += nob;
+	lnet_net_unlock(cpt);
+
+	put_page(virt_to_page(private));
+}
+
 static void
 lnet_recv_put(struct lnet_ni *ni, struct lnet_msg *msg)
 {
@@ -4169,6 +4534,44 @@ lnet_recv_put(struct lnet_ni *ni, struct lnet_msg *msg)
 		     msg->msg_offset, msg->msg_wanted, hdr->payload_length);
 }
 
+/* receive the payload of a carrier PUT, it is split on completion */
+static int
+lnet_parse_bundle(struct lnet_ni *ni, struct lnet_msg *msg)
+{
+	unsigned int nob = msg->msg_hdr.payload_length;
+	struct lnet_bundle *lb;
+
+	if (msg->msg_bundled || nob == 0 || nob > LNET_BUNDLE_MAX_SIZE ||
+	    msg->msg_hdr.msg.put.offset != 0) {
+		CNETERR("Dropping bad bundle of %u bytes from %s\n",
+			nob, libcfs_nidstr(&msg->msg_from));
+		return -ENOENT;
+	}
+
+	LIBCFS_ALLOC(lb, sizeof(*lb));
+	if (lb == NULL)
+		return -ENOENT;
+
+	lb->lb_kiov.bv_page = alloc_page(GFP_NOFS);
+	if (lb->lb_kiov.bv_page == NULL) {
+		LIBCFS_FREE(lb, sizeof(*lb));
+		return -ENOENT;
+	}
+	lb->lb_kiov.bv_offset = 0;
+	lb->lb_kiov.bv_len = nob;
+	INIT_LIST_HEAD(&lb->lb_msgs);
+
+	msg->msg_bundle = lb;
+	msg->msg_niov = 1;
+	msg->msg_kiov = &lb->lb_kiov;
+	/* accounted as a received PUT, no event without an MD */
+	msg->msg_ev.type = LNET_EVENT_PUT;
+
+	lnet_ni_recv(ni, msg->msg_private, msg, msg->msg_rx_delayed,
+		     0, nob, nob);
+	return 0;
+}
+
 static int
 lnet_parse_put(struct lnet_ni *ni, struct lnet_msg *msg)
 {
@@ -4192,7 +4595,13 @@ lnet_parse_put(struct lnet_ni *ni, struct lnet_msg *msg)
 	info.mi_mbits	= hdr->msg.put.match_bits;
 	info.mi_cpt	= lnet_nid2cpt(&msg->msg_initiator, ni);
 
-	msg->msg_rx_ready_delay = ni->ni_net->net_lnd->lnd_eager_recv == NULL;
+	if (info.mi_portal == LNET_RESERVED_PORTAL &&
+	    info.mi_mbits == LNET_PROTO_BUNDLE_MATCHBITS)
+		return lnet_parse_bundle(ni, msg);
+
+	/* the payload of a bundled message is already in memory */
+	msg->msg_rx_ready_delay = ni->ni_net->net_lnd->lnd_eager_recv == NULL ||
+				  msg->msg_bundled;
 	ready_delay = msg->msg_rx_ready_delay;
 
  again:
@@ -4491,9 +4900,10 @@ lnet_msgtyp2str (int type)
 }
 EXPORT_SYMBOL(lnet_msgtyp2str);
 
-int
-lnet_parse(struct lnet_ni *ni, struct lnet_hdr *hdr,
-	   struct lnet_nid *from_nid, void *private, int rdma_req)
+static int
+lnet_parse_common(struct lnet_ni *ni, struct lnet_hdr *hdr,
+		  struct lnet_nid *from_nid, void *private, int rdma_req,
+		  bool bundled)
 {
 	struct lnet_peer_ni *lpni;
 	struct lnet_msg *msg;
@@ -4525,6 +4935,13 @@ lnet_parse(struct lnet_ni *ni, struct lnet_hdr *hdr,
 		lnet_msgtyp2str(type),
 		(for_me) ? "for me" : "routed");
 
+	if (bundled && !for_me) {
+		CERROR("%s, src %s: bundled %s for %s\n",
+		       libcfs_nidstr(from_nid), libcfs_nidstr(&src_nid),
+		       lnet_msgtyp2str(type), libcfs_nidstr(&dest_nid));
+		return -EPROTO;
+	}
+
 	switch (type) {
 	case LNET_MSG_ACK:
 	case LNET_MSG_GET:
@@ -4540,14 +4957,14 @@ lnet_parse(struct lnet_ni *ni, struct lnet_hdr *hdr,
 	case LNET_MSG_PUT:
 	case LNET_MSG_REPLY:
 		if (payload_length >
-		    (__u32)(for_me ? LNET_MAX_PAYLOAD : LNET_MTU)) {
+		    (__u32)(for_me ? lnet_ni_mtu(ni) : LNET_MTU)) {
 			CERROR("%s, src %s: bad %s payload %d "
 			       "(%d max expected)\n",
 			       libcfs_nidstr(from_nid),
 			       libcfs_nidstr(&src_nid),
 			       lnet_msgtyp2str(type),
 			       payload_length,
-			       for_me ? LNET_MAX_PAYLOAD : LNET_MTU);
+			       for_me ? lnet_ni_mtu(ni) : LNET_MTU);
 			return -EPROTO;
 		}
 		break;
@@ -4629,7 +5046,7 @@ lnet_parse(struct lnet_ni *ni, struct lnet_hdr *hdr,
 	}
 
 	/* FIXME need to support large-addr nid */
-	if (!list_empty(&the_lnet.ln_drop_rules) &&
+	if (!bundled && !list_empty(&the_lnet.ln_drop_rules) &&
 	    lnet_drop_rule_match(hdr, lnet_nid_to_nid4(&ni->ni_nid), NULL)) {
 		CDEBUG(D_NET,
 		       "%s, src %s, dst %s: Dropping %s to simulate silent message loss\n",
@@ -4653,6 +5070,7 @@ lnet_parse(struct lnet_ni *ni, struct lnet_hdr *hdr,
 	msg->msg_private = private;
 	msg->msg_receiving = 1;
 	msg->msg_rdma_get = rdma_req;
+	msg->msg_bundled = bundled;
 	msg->msg_len = msg->msg_wanted = payload_length;
 	msg->msg_offset = 0;
 	msg->msg_hdr = *hdr;
@@ -4756,8 +5174,8 @@ lnet_parse(struct lnet_ni *ni, struct lnet_hdr *hdr,
 
 	lnet_msg_commit(msg, cpt);
 
-	/* message delay simulation */
-	if (unlikely(!list_empty(&the_lnet.ln_delay_rules) &&
+	/* message delay simulation, the carrier of a bundle went through it */
+	if (unlikely(!bundled && !list_empty(&the_lnet.ln_delay_rules) &&
 		     lnet_delay_rule_match_locked(hdr, msg))) {
 		lnet_net_unlock(cpt);
 		return 0;
@@ -4789,11 +5207,99 @@ lnet_parse(struct lnet_ni *ni, struct lnet_hdr *hdr,
 	lnet_finalize(msg, rc);
 
  drop:
-	lnet_drop_message(ni, cpt, private, payload_length, type);
+	if (bundled)
+		lnet_drop_bundled_message(ni, cpt, private, payload_length,
+					  type);
+	else
+		lnet_drop_message(ni, cpt, private, payload_length, type);
 	return 0;
 }
+
+int
+lnet_parse(struct lnet_ni *ni, struct lnet_hdr *hdr,
+	   struct lnet_nid *from_nid, void *private, int rdma_req)
+{
+	return lnet_parse_common(ni, hdr, from_nid, private, rdma_req, false);
+}
 EXPORT_SYMBOL(lnet_parse);
 
+/*
+ * Parse each record of a received carrier PUT as a message of its own.
+ * Every message holds a reference on the page of the bundle until it has
+ * been received or dropped.
+ */
+static void
+lnet_bundle_split(struct lnet_msg *msg, struct lnet_bundle *lb)
+{
+	struct page *page = lb->lb_kiov.bv_page;
+	char *base = page_address(page);
+	unsigned int nob = lb->lb_kiov.bv_len;
+	unsigned int off = 0;
+	struct lnet_hdr hdr;
+	int nmsgs = 0;
+	int rc;
+
+	while (off < nob) {
+		if (nob - off < sizeof(struct lnet_hdr_nid4))
+			goto bad;
+
+		lnet_hdr_from_nid4(&hdr, (struct lnet_hdr_nid4 *)(base + off));
+		off += sizeof(struct lnet_hdr_nid4);
+
+		if (hdr.payload_length > nob - off ||
+		    (hdr.type != LNET_MSG_PUT && hdr.type != LNET_MSG_ACK))
+			goto bad;
+
+		get_page(page);
+		rc = lnet_parse_common(msg->msg_rxni, &hdr, &msg->msg_from,
+				       base + off, 0, true);
+		if (rc < 0)
+			put_page(page);
+
+		off = round_up(off + hdr.payload_length, 8);
+		nmsgs++;
+	}
+
+	CDEBUG(D_NET, "%s: split %d messages from %s, %u bytes\n",
+	       libcfs_nidstr(&msg->msg_rxni->ni_nid), nmsgs,
+	       libcfs_nidstr(&msg->msg_from), nob);
+	return;
+
+bad:
+	CERROR("%s: bad bundle record at %u of %u bytes from %s\n",
+	       libcfs_nidstr(&msg->msg_rxni->ni_nid), off, nob,
+	       libcfs_nidstr(&msg->msg_from));
+}
+
+/*
+ * Called by lnet_finalize() for a carrier. A received bundle is split,
+ * the messages of a sent bundle complete with the status of the carrier.
+ * Only the carrier is health checked and counted, the messages it carried
+ * are not resent on their own.
+ */
+void
+lnet_bundle_finalize(struct lnet_msg *msg, int status)
+{
+	struct lnet_bundle *lb = msg->msg_bundle;
+	struct lnet_msg *sub;
+
+	msg->msg_bundle = NULL;
+
+	if (msg->msg_rx_committed) {
+		if (status == 0)
+			lnet_bundle_split(msg, lb);
+	} else {
+		while (!list_empty(&lb->lb_msgs)) {
+			sub = list_first_entry(&lb->lb_msgs, struct lnet_msg,
+					       msg_list);
+			list_del_init(&sub->msg_list);
+			lnet_finalize(sub, status);
+		}
+	}
+
+	lnet_bundle_free(lb);
+}
+
 void
 lnet_drop_delayed_msg_list(struct list_head *head, char *reason)
 {
@@ -4824,9 +5330,16 @@ lnet_drop_delayed_msg_list(struct list_head *head, char *reason)
 		 * called lnet_drop_message(), so I just hang onto msg as well
 		 * until that's done */
 
-		lnet_drop_message(msg->msg_rxni, msg->msg_rx_cpt,
-				  msg->msg_private, msg->msg_len,
-				  msg->msg_type);
+		if (msg->msg_bundled)
+			lnet_drop_bundled_message(msg->msg_rxni,
+						  msg->msg_rx_cpt,
+						  msg->msg_private,
+						  msg->msg_len,
+						  msg->msg_type);
+		else
+			lnet_drop_message(msg->msg_rxni, msg->msg_rx_cpt,
+					  msg->msg_private, msg->msg_len,
+					  msg->msg_type);
 
 		msg->msg_no_resend = true;
 		/*
@@ -4986,6 +5499,9 @@ LNetPut(lnet_nid_t self4, struct lnet_handle_md mdh, enum lnet_ack_req ack,
 		return -EIO;
 	}
 
+	/* bundles are built where nothing may be allocated */
+	lnet_bundle_reserve();
+
 	msg = lnet_msg_alloc();
 	if (msg == NULL) {
 		CERROR("Dropping PUT to %s: ENOMEM on struct lnet_msg\n",
@@ -153,6 +153,7 @@ lnet_msg_commit(struct lnet_msg *msg, int cpt)
 
 	if (msg->msg_sending) {
 		LASSERT(!msg->msg_receiving);
+		msg->msg_tx_start = ktime_get();
 		msg->msg_tx_cpt = cpt;
 		msg->msg_tx_committed = 1;
 		if (msg->msg_rx_committed) { /* routed message REPLY */
@@ -176,6 +177,66 @@ lnet_msg_commit(struct lnet_msg *msg, int cpt)
 		common->lcc_msgs_max = common->lcc_msgs_alloc;
 }
 
+static void
+lnet_rtt_update(struct lnet_rtt *rtt, __u32 sample)
+{
+	__u32 srtt = lnet_rtt_get(rtt);
+
+	/* EWMA with a weight of 1/8 for the new sample, as TCP does */
+	if (srtt != 0)
+		sample = ((__u64)srtt * 7 + sample) >> 3;
+
+	WRITE_ONCE(rtt->rtt_srtt, max_t(__u32, sample, 1));
+	WRITE_ONCE(rtt->rtt_stamp, ktime_get_seconds());
+}
+
+/*
+ * Feed the time this send took to complete into the estimates of the
+ * local NI, peer NI, peer net and, for a routed message, the route it took.  Only
+ * messages with at most LNET_RTT_SAMPLE_MAX bytes of payload are sampled
+ * (GETs, ACKs, small PUTs and REPLYs), so the estimates compare paths and
+ * not the sizes of what was sent over them.  These are updated under
+ * whichever CPT lock the message holds; a lost update is harmless.
+ */
+static void
+lnet_msg_rtt_sample_locked(struct lnet_msg *msg)
+{
+	struct lnet_peer_ni *lpni = msg->msg_txpeer;
+	struct lnet_remotenet *rnet;
+	struct lnet_route *route;
+	__u32 dst_net;
+	s64 sample;
+
+	if (!lpni || msg->msg_health_status != LNET_MSG_STATUS_OK ||
+	    msg->msg_len > LNET_RTT_SAMPLE_MAX)
+		return;
+
+	sample = ktime_us_delta(ktime_get(), msg->msg_tx_start);
+	sample = clamp_t(s64, sample, 1, U32_MAX);
+
+	lnet_rtt_update(&lpni->lpni_rtt, sample);
+	if (lpni->lpni_peer_net)
+		lnet_rtt_update(&lpni->lpni_peer_net->lpn_rtt, sample);
+	if (msg->msg_txni)
+		lnet_rtt_update(&msg->msg_txni->ni_rtt, sample);
+
+	dst_net = LNET_NID_NET(&msg->msg_target.nid);
+	if (dst_net == LNET_NID_NET(&lpni->lpni_nid) ||
+	    !lpni->lpni_peer_net || !lnet_isrouter(lpni))
+		return;
+
+	rnet = lnet_find_rnet_locked(dst_net);
+	if (!rnet)
+		return;
+
+	list_for_each_entry(route, &rnet->lrn_routes, lr_list) {
+		if (route->lr_gateway == lpni->lpni_peer_net->lpn_peer) {
+			lnet_rtt_update(&route->lr_rtt, sample);
+			break;
+		}
+	}
+}
+
 static void
 lnet_msg_decommit_tx(struct lnet_msg *msg, int status)
 {
@@ -207,7 +268,7 @@ lnet_msg_decommit_tx(struct lnet_msg *msg, int status)
 
 	case LNET_EVENT_SEND:
 		LASSERT(!msg->msg_rx_committed);
-		if (msg->msg_type == LNET_MSG_PUT)
+		if (msg->msg_type == LNET_MSG_PUT && !msg->msg_carried)
 			common->lcc_send_length += msg->msg_len;
 		break;
 
@@ -220,9 +281,15 @@ lnet_msg_decommit_tx(struct lnet_msg *msg, int status)
 		break;
 	}
 
+	/* a bundled message was counted with its carrier */
+	if (msg->msg_carried)
+		goto out;
+
 	common->lcc_send_count++;
 
 incr_stats:
+	lnet_msg_rtt_sample_locked(msg);
+
 	if (msg->msg_txpeer)
 		lnet_incr_stats(&msg->msg_txpeer->lpni_stats,
 				msg->msg_type,
@@ -245,7 +312,8 @@ lnet_msg_decommit_rx(struct lnet_msg *msg, int status)
 	LASSERT(!msg->msg_tx_committed); /* decommitted or never committed */
 	LASSERT(msg->msg_rx_committed);
 
-	if (status != 0)
+	/* a message split out of a bundle was counted with its carrier */
+	if (status != 0 || msg->msg_bundled)
 		goto out;
 
 	common = &(the_lnet.ln_counters[msg->msg_rx_cpt]->lct_common);
@@ -1038,6 +1106,10 @@ lnet_is_health_check(struct lnet_msg *msg)
 	bool hc = true;
 	int status = msg->msg_ev.status;
 
+	/* the carrier of a bundle is health checked for all its messages */
+	if (msg->msg_carried)
+		return false;
+
 	if ((!msg->msg_tx_committed && !msg->msg_rx_committed) ||
 	    !msg->msg_onactivelist) {
 		CDEBUG(D_NET, "msg %p not committed for send or receive\n",
@@ -1144,6 +1216,10 @@ lnet_finalize(struct lnet_msg *msg, int status)
 
 	msg->msg_ev.status = status;
 
+	/* the messages of a bundle share the fate of their carrier */
+	if (msg->msg_bundle != NULL)
+		lnet_bundle_finalize(msg, status);
+
 	if (lnet_is_health_check(msg)) {
 		/*
 		 * Check the health status of the message. If it has one
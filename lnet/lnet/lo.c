@@ -79,6 +79,8 @@ lolnd_startup(struct lnet_ni *ni)
 	LASSERT (ni->ni_net->net_lnd == &the_lolnd);
 	LASSERT (!lolnd_instanced);
 	lolnd_instanced = 1;
+	/* payload is copied, any size goes */
+	ni->ni_mtu = LNET_MTU_LARGE;
 
 	return (0);
 }
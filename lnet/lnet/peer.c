@@ -1507,6 +1507,65 @@ out_unlock:
 }
 EXPORT_SYMBOL(LNetPrimaryNID);
 
+/**
+ * Largest payload of a message exchanged with peer \a nid, whichever of its
+ * NIs and of the local NIs Multi-Rail selects. This is LNET_MTU unless the
+ * discovered peer advertised LNET_PING_FEAT_LARGE_MTU and every NI on the
+ * local nets it shares with this node accepts more, on both sides. A peer
+ * only reached through routers is limited to LNET_MTU.
+ *
+ * \param nid	peer NID
+ *
+ * \retval	a power of two between LNET_MTU and LNET_MTU_LARGE
+ */
+unsigned int
+LNetPeerMaxPayload(lnet_nid_t nid)
+{
+	struct lnet_peer_net *lpn;
+	struct lnet_peer_ni *lpni;
+	struct lnet_peer_ni *tmp;
+	struct lnet_peer *lp;
+	struct lnet_net *net;
+	struct lnet_ni *ni;
+	unsigned int mtu = LNET_MTU_LARGE;
+	bool direct = false;
+	int cpt;
+
+	if (!lnet_large_mtu)
+		return LNET_MTU;
+
+	cpt = lnet_net_lock_current();
+	lpni = lnet_find_peer_ni_locked(nid);
+	if (!lpni) {
+		lnet_net_unlock(cpt);
+		return LNET_MTU;
+	}
+
+	lp = lpni->lpni_peer_net->lpn_peer;
+	if (!(lp->lp_state & LNET_PEER_LARGE_MTU))
+		mtu = LNET_MTU;
+
+	list_for_each_entry(lpn, &lp->lp_peer_nets, lpn_peer_nets) {
+		net = lnet_get_net_locked(lpn->lpn_net_id);
+		if (!net)
+			continue;
+
+		direct = true;
+		list_for_each_entry(ni, &net->net_ni_list, ni_netlist)
+			mtu = min(mtu, lnet_ni_mtu(ni));
+		list_for_each_entry(tmp, &lpn->lpn_peer_nis, lpni_peer_nis)
+			mtu = min(mtu, lnet_peer_ni_mtu(tmp));
+	}
+	lnet_peer_ni_decref_locked(lpni);
+	lnet_net_unlock(cpt);
+
+	if (!direct)
+		return LNET_MTU;
+
+	return rounddown_pow_of_two(mtu);
+}
+EXPORT_SYMBOL(LNetPeerMaxPayload);
+
 struct lnet_peer_net *
 lnet_peer_get_net_locked(struct lnet_peer *peer, __u32 net_id)
 {
@@ -2963,6 +3022,17 @@ static void lnet_discovery_event_handler(struct lnet_event *event)
 	lnet_net_unlock(LNET_LOCK_EX);
 }
 
+/* largest payload the peer NI described by @ns in @pbuf accepts */
+static unsigned int
+lnet_ping_ni_mtu(struct lnet_ping_buffer *pbuf, struct lnet_ni_status *ns)
+{
+	if (!(pbuf->pb_info.pi_features & LNET_PING_FEAT_LARGE_MTU) ||
+	    ns->ns_mtu <= LNET_MTU)
+		return 0;
+
+	return min_t(unsigned int, ns->ns_mtu, LNET_MTU_LARGE);
+}
+
 /*
  * Build a peer from incoming data.
  *
@@ -3011,6 +3081,14 @@ static int lnet_peer_merge_data(struct lnet_peer *lp,
 		lp->lp_state |= LNET_PEER_ROUTER_ENABLED;
 	else
 		lp->lp_state &= ~LNET_PEER_ROUTER_ENABLED;
+	if (pbuf->pb_info.pi_features & LNET_PING_FEAT_COALESCE)
+		lp->lp_state |= LNET_PEER_COALESCE;
+	else
+		lp->lp_state &= ~LNET_PEER_COALESCE;
+	if (pbuf->pb_info.pi_features & LNET_PING_FEAT_LARGE_MTU)
+		lp->lp_state |= LNET_PEER_LARGE_MTU;
+	else
+		lp->lp_state &= ~LNET_PEER_LARGE_MTU;
 	spin_unlock(&lp->lp_lock);
 
 	nnis = max_t(int, lp->lp_nnis, pbuf->pb_info.pi_nnis);
@@ -3061,6 +3139,8 @@ static int lnet_peer_merge_data(struct lnet_peer *lp,
 				lpni = lnet_find_peer_ni_locked(curnis[i]);
 				if (lpni) {
 					lpni->lpni_ns_status = pbuf->pb_info.pi_ni[j].ns_status;
+					lpni->lpni_mtu = lnet_ping_ni_mtu(pbuf,
+						&pbuf->pb_info.pi_ni[j]);
 					lnet_peer_ni_decref_locked(lpni);
 				}
 				break;
@@ -3091,6 +3171,7 @@ static int lnet_peer_merge_data(struct lnet_peer *lp,
 		lpni = lnet_find_peer_ni_locked(addnis[i].ns_nid);
 		if (lpni) {
 			lpni->lpni_ns_status = addnis[i].ns_status;
+			lpni->lpni_mtu = lnet_ping_ni_mtu(pbuf, &addnis[i]);
 			lnet_peer_ni_decref_locked(lpni);
 		}
 	}
@@ -4240,6 +4321,26 @@ lnet_peer_ni_add_to_recoveryq_locked(struct lnet_peer_ni *lpni,
 	list_add_tail(&lpni->lpni_recovery, recovery_queue);
 }
 
+int
+lnet_get_peer_ni_rtt(struct lnet_ioctl_rtt *rtt)
+{
+	struct lnet_peer_ni *lpni;
+	int cpt;
+	int rc = 0;
+
+	cpt = lnet_net_lock_current();
+	lpni = lnet_find_peer_ni_locked(rtt->rtt_nid);
+	if (lpni) {
+		rtt->rtt_us = lnet_rtt_get(&lpni->lpni_rtt);
+		lnet_peer_ni_decref_locked(lpni);
+	} else {
+		rc = -ENOENT;
+	}
+	lnet_net_unlock(cpt);
+
+	return rc;
+}
+
 /* Call with the ln_api_mutex held */
 void
 lnet_peer_ni_set_healthv(lnet_nid_t nid, int value, bool all)
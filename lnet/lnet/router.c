@@ -23,6 +23,7 @@
 #define DEBUG_SUBSYSTEM S_LNET
 
 #include <linux/random.h>
+#include <linux/swap.h>
 #include <lnet/lib-lnet.h>
 
 #define LNET_NRB_TINY_MIN	512	/* min value for each CPT */
@@ -34,6 +35,10 @@
 #define LNET_NRB_LARGE		(LNET_NRB_LARGE_MIN * 4)
 #define LNET_NRB_LARGE_PAGES	((LNET_MTU + PAGE_SIZE - 1) >> \
 				  PAGE_SHIFT)
+/* upper bound of router_buffers_auto */
+#define LNET_RTRPOOL_AUTO_MAX	16
+/* # idle resize passes before a grown pool is trimmed back */
+#define LNET_RTRPOOL_IDLE_PASSES	10
 
 static char *forwarding = "";
 module_param(forwarding, charp, 0444);
@@ -48,6 +53,10 @@ MODULE_PARM_DESC(small_router_buffers, "# of small (1 page) messages to buffer i
 static int large_router_buffers;
 module_param(large_router_buffers, int, 0444);
 MODULE_PARM_DESC(large_router_buffers, "# of large messages to buffer in the router");
+static int router_buffers_auto;
+module_param(router_buffers_auto, int, 0644);
+MODULE_PARM_DESC(router_buffers_auto, "Max factor router buffer pools may grow by under load (0 to disable automatic resizing)");
+
 static int peer_buffer_credits;
 module_param(peer_buffer_credits, int, 0444);
 MODULE_PARM_DESC(peer_buffer_credits, "# router buffer credits per peer");
@@ -972,7 +981,7 @@ int lnet_get_rtr_pool_cfg(int cpt, struct lnet_ioctl_pool_cfg *pool_cfg)
 
 int
 lnet_get_route(int idx, __u32 *net, __u32 *hops, lnet_nid_t *gateway,
-	       __u32 *flags, __u32 *priority, __u32 *sensitivity)
+	       __u32 *flags, __u32 *priority, __u32 *sensitivity, __u32 *rtt)
 {
 	struct lnet_remotenet *rnet;
 	struct list_head *rn_list;
@@ -1000,6 +1009,7 @@ lnet_get_route(int idx, __u32 *net, __u32 *hops, lnet_nid_t *gateway,
 					*priority = route->lr_priority;
 					*sensitivity = route->lr_gateway->
 						lp_health_sensitivity;
+					*rtt = lnet_rtt_get(&route->lr_rtt);
 					if (lnet_is_route_alive(route))
 						*flags |= LNET_RT_ALIVE;
 					else
@@ -1340,6 +1350,8 @@ lnet_rtrpool_free_bufs(struct lnet_rtrbufpool *rbp, int cpt)
 	rbp->rbp_req_nbuffers = 0;
 	rbp->rbp_nbuffers = rbp->rbp_credits = 0;
 	rbp->rbp_mincredits = 0;
+	rbp->rbp_resize_mincredits = 0;
+	rbp->rbp_idle_passes = 0;
 	lnet_net_unlock(cpt);
 
 	/* Free buffers on the free list. */
@@ -1436,6 +1448,12 @@ lnet_rtrpool_init(struct lnet_rtrbufpool *rbp, int npages)
 	rbp->rbp_npages = npages;
 	rbp->rbp_credits = 0;
 	rbp->rbp_mincredits = 0;
+	rbp->rbp_base_nbuffers = 0;
+	rbp->rbp_resize_mincredits = 0;
+	rbp->rbp_idle_passes = 0;
+	rbp->rbp_nblocked = 0;
+	rbp->rbp_ngrow = 0;
+	rbp->rbp_nshrink = 0;
 }
 
 void
@@ -1568,6 +1586,7 @@ lnet_rtrpools_alloc(int im_a_router)
 
 	cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
 		lnet_rtrpool_init(&rtrp[LNET_TINY_BUF_IDX], 0);
+		rtrp[LNET_TINY_BUF_IDX].rbp_base_nbuffers = nrb_tiny;
 		rc = lnet_rtrpool_adjust_bufs(&rtrp[LNET_TINY_BUF_IDX],
 					      nrb_tiny, i);
 		if (rc)
@@ -1575,6 +1594,7 @@ lnet_rtrpools_alloc(int im_a_router)
 
 		lnet_rtrpool_init(&rtrp[LNET_SMALL_BUF_IDX],
 				  LNET_NRB_SMALL_PAGES);
+		rtrp[LNET_SMALL_BUF_IDX].rbp_base_nbuffers = nrb_small;
 		rc = lnet_rtrpool_adjust_bufs(&rtrp[LNET_SMALL_BUF_IDX],
 					      nrb_small, i);
 		if (rc)
@@ -1582,6 +1602,7 @@ lnet_rtrpools_alloc(int im_a_router)
 
 		lnet_rtrpool_init(&rtrp[LNET_LARGE_BUF_IDX],
 				  LNET_NRB_LARGE_PAGES);
+		rtrp[LNET_LARGE_BUF_IDX].rbp_base_nbuffers = nrb_large;
 		rc = lnet_rtrpool_adjust_bufs(&rtrp[LNET_LARGE_BUF_IDX],
 					      nrb_large, i);
 		if (rc)
@@ -1613,6 +1634,7 @@ lnet_rtrpools_adjust_helper(int tiny, int small, int large)
 		tiny_router_buffers = tiny;
 		nrb = lnet_nrb_tiny_calculate();
 		cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
+			rtrp[LNET_TINY_BUF_IDX].rbp_base_nbuffers = nrb;
 			rc = lnet_rtrpool_adjust_bufs(&rtrp[LNET_TINY_BUF_IDX],
 						      nrb, i);
 			if (rc != 0)
@@ -1623,6 +1645,7 @@ lnet_rtrpools_adjust_helper(int tiny, int small, int large)
 		small_router_buffers = small;
 		nrb = lnet_nrb_small_calculate();
 		cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
+			rtrp[LNET_SMALL_BUF_IDX].rbp_base_nbuffers = nrb;
 			rc = lnet_rtrpool_adjust_bufs(&rtrp[LNET_SMALL_BUF_IDX],
 						      nrb, i);
 			if (rc != 0)
@@ -1633,6 +1656,7 @@ lnet_rtrpools_adjust_helper(int tiny, int small, int large)
 		large_router_buffers = large;
 		nrb = lnet_nrb_large_calculate();
 		cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
+			rtrp[LNET_LARGE_BUF_IDX].rbp_base_nbuffers = nrb;
 			rc = lnet_rtrpool_adjust_bufs(&rtrp[LNET_LARGE_BUF_IDX],
 						      nrb, i);
 			if (rc != 0)
@@ -1708,6 +1732,102 @@ lnet_rtrpools_disable(void)
 	lnet_rtrpools_free(1);
 }
 
+static bool
+lnet_rtrpool_mem_pressure(void)
+{
+	return nr_free_pages() < cfs_totalram_pages() / 16;
+}
+
+/* Grow a pool that had messages waiting for buffers since the last pass,
+ * and trim a pool that was grown back towards its configured size once it
+ * has stayed mostly idle for a while, or straight away when memory is
+ * short.  Shrinking just lowers rbp_req_nbuffers, the excess buffers are
+ * freed as they come back in lnet_return_rx_credits_locked(). */
+static void
+lnet_rtrpool_resize(struct lnet_rtrbufpool *rbp, int cpt, int factor,
+		    bool pressure)
+{
+	int nbufs;
+	int minc;
+	int target;
+	int rc;
+
+	lnet_net_lock(cpt);
+	nbufs = rbp->rbp_req_nbuffers;
+	minc = rbp->rbp_resize_mincredits;
+	rbp->rbp_resize_mincredits = rbp->rbp_credits;
+	if (nbufs == 0) {
+		lnet_net_unlock(cpt);
+		return;
+	}
+
+	target = nbufs;
+	if (minc < 0 && !pressure) {
+		rbp->rbp_idle_passes = 0;
+		target = min(nbufs + max(-minc, nbufs / 4),
+			     rbp->rbp_base_nbuffers * factor);
+	} else if (minc > nbufs / 2 || pressure) {
+		if (pressure ||
+		    ++rbp->rbp_idle_passes >= LNET_RTRPOOL_IDLE_PASSES) {
+			rbp->rbp_idle_passes = 0;
+			target = max(nbufs - nbufs / 4,
+				     rbp->rbp_base_nbuffers);
+		}
+	} else {
+		rbp->rbp_idle_passes = 0;
+	}
+	lnet_net_unlock(cpt);
+
+	if (target == nbufs)
+		return;
+
+	CDEBUG(D_NET, "CPT %d: resize %d page router buffer pool %d -> %d%s\n",
+	       cpt, rbp->rbp_npages, nbufs, target,
+	       pressure ? " (memory pressure)" : "");
+
+	rc = lnet_rtrpool_adjust_bufs(rbp, target, cpt);
+	if (rc != 0)
+		return;
+
+	lnet_net_lock(cpt);
+	if (target > nbufs)
+		rbp->rbp_ngrow++;
+	else
+		rbp->rbp_nshrink++;
+	lnet_net_unlock(cpt);
+}
+
+/* Called once a second by the monitor thread */
+void
+lnet_rtrpools_resize(void)
+{
+	struct lnet_rtrbufpool *rtrp;
+	bool pressure;
+	int factor;
+	int i;
+	int j;
+
+	factor = min(router_buffers_auto, LNET_RTRPOOL_AUTO_MAX);
+	if (factor <= 0 || !the_lnet.ln_routing)
+		return;
+
+	/* never block the monitor thread behind configuration or shutdown,
+	 * both of which may free the pools under ln_api_mutex */
+	if (!mutex_trylock(&the_lnet.ln_api_mutex))
+		return;
+
+	if (the_lnet.ln_rtrpools == NULL || !the_lnet.ln_routing)
+		goto out;
+
+	pressure = lnet_rtrpool_mem_pressure();
+	cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
+		for (j = 0; j < LNET_NRBPOOLS; j++)
+			lnet_rtrpool_resize(&rtrp[j], i, factor, pressure);
+	}
+out:
+	mutex_unlock(&the_lnet.ln_api_mutex);
+}
+
 static inline void
 lnet_notify_peer_down(struct lnet_ni *ni, struct lnet_nid *nid)
 {
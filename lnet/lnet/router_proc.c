@@ -550,8 +550,8 @@ static int proc_lnet_buffers(struct ctl_table *table, int write,
 
 	LASSERT(!write);
 
-	/* (4 %d) * 4 * LNET_CPT_NUMBER */
-	tmpsiz = 64 * (LNET_NRBPOOLS + 1) * LNET_CPT_NUMBER;
+	/* (4 %d + 3 %llu) * 4 * LNET_CPT_NUMBER */
+	tmpsiz = 128 * (LNET_NRBPOOLS + 1) * LNET_CPT_NUMBER;
 	LIBCFS_ALLOC(tmpstr, tmpsiz);
 	if (tmpstr == NULL)
 		return -ENOMEM;
@@ -559,8 +559,9 @@ static int proc_lnet_buffers(struct ctl_table *table, int write,
 	s = tmpstr; /* points to current position in tmpstr[] */
 
 	s += scnprintf(s, tmpstr + tmpsiz - s,
-		       "%5s %5s %7s %7s\n",
-		       "pages", "count", "credits", "min");
+		       "%5s %5s %7s %7s %7s %5s %6s\n",
+		       "pages", "count", "credits", "min",
+		       "blocked", "grow", "shrink");
 	LASSERT(tmpstr + tmpsiz - s > 0);
 
 	if (the_lnet.ln_rtrpools == NULL)
@@ -572,11 +573,14 @@ static int proc_lnet_buffers(struct ctl_table *table, int write,
 		lnet_net_lock(LNET_LOCK_EX);
 		cfs_percpt_for_each(rbp, i, the_lnet.ln_rtrpools) {
 			s += scnprintf(s, tmpstr + tmpsiz - s,
-				       "%5d %5d %7d %7d\n",
+				       "%5d %5d %7d %7d %7llu %5llu %6llu\n",
 				       rbp[idx].rbp_npages,
 				       rbp[idx].rbp_nbuffers,
 				       rbp[idx].rbp_credits,
-				       rbp[idx].rbp_mincredits);
+				       rbp[idx].rbp_mincredits,
+				       rbp[idx].rbp_nblocked,
+				       rbp[idx].rbp_ngrow,
+				       rbp[idx].rbp_nshrink);
 			LASSERT(tmpstr + tmpsiz - s > 0);
 		}
 		lnet_net_unlock(LNET_LOCK_EX);
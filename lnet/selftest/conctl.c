@@ -662,7 +662,7 @@ lst_batch_info_ioctl(struct lstio_batch_info_args *args)
 }
 
 static int
-lst_stat_query_ioctl(struct lstio_stat_args *args)
+lst_stat_query_ioctl(struct lstio_stat_args *args, bool latency)
 {
 	int rc;
 	char *name = NULL;
@@ -680,7 +680,7 @@ lst_stat_query_ioctl(struct lstio_stat_args *args)
 
 		rc = lstcon_nodes_stat(args->lstio_sta_count,
 				       args->lstio_sta_idsp,
-				       args->lstio_sta_timeout,
+				       args->lstio_sta_timeout, latency,
 				       args->lstio_sta_resultp);
 	} else if (args->lstio_sta_namep != NULL) {
 		if (args->lstio_sta_nmlen <= 0 ||
@@ -695,6 +695,7 @@ lst_stat_query_ioctl(struct lstio_stat_args *args)
 				    args->lstio_sta_nmlen);
 		if (rc == 0)
 			rc = lstcon_group_stat(name, args->lstio_sta_timeout,
+					       latency,
 					       args->lstio_sta_resultp);
 		else
 			rc = -EFAULT;
@@ -910,7 +911,10 @@ lstcon_ioctl_entry(struct notifier_block *nb,
 		rc = lst_test_add_ioctl((struct lstio_test_args *)buf);
 		break;
 	case LSTIO_STAT_QUERY:
-		rc = lst_stat_query_ioctl((struct lstio_stat_args *)buf);
+		rc = lst_stat_query_ioctl((struct lstio_stat_args *)buf, false);
+		break;
+	case LSTIO_LAT_QUERY:
+		rc = lst_stat_query_ioctl((struct lstio_stat_args *)buf, true);
 		break;
 	default:
 		rc = -EINVAL;
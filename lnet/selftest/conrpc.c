@@ -223,6 +223,9 @@ lstcon_rpc_trans_name(int transop)
         if (transop == LST_TRANS_STATQRY)
                 return "STATQRY";
 
+	if (transop == LST_TRANS_LATQRY)
+		return "LATQRY";
+
         return "Unknown";
 }
 
@@ -694,6 +697,25 @@ lstcon_statrpc_prep(struct lstcon_node *nd, unsigned int feats,
         return 0;
 }
 
+int
+lstcon_latrpc_prep(struct lstcon_node *nd, unsigned int feats, int first,
+		   struct lstcon_rpc **crpc)
+{
+	struct srpc_lat_reqst *lrq;
+	int rc;
+
+	rc = lstcon_rpc_prep(nd, SRPC_SERVICE_QUERY_LAT, feats, 0, 0, crpc);
+	if (rc != 0)
+		return rc;
+
+	lrq = &(*crpc)->crp_rpc->crpc_reqstmsg.msg_body.lat_reqst;
+
+	lrq->lat_sid   = console_session.ses_id;
+	lrq->lat_first = first;
+
+	return 0;
+}
+
 static struct lnet_process_id_packed *
 lstcon_next_id(int idx, int nkiov, struct bio_vec *kiov)
 {
@@ -775,6 +797,22 @@ lstcon_pingrpc_prep(struct lst_test_ping_param *param,
         return 0;
 }
 
+static int
+lstcon_rrrpc_prep(struct lst_test_rr_param *param,
+		  struct srpc_test_reqst *req)
+{
+	struct test_rr_req *rrq = &req->tsr_u.rr;
+
+	if (param->rr_req_size < 0 || param->rr_req_size > LST_RR_SIZE_MAX ||
+	    param->rr_rep_size < 0 || param->rr_rep_size > LST_RR_SIZE_MAX)
+		return -EINVAL;
+
+	rrq->rr_req_size = param->rr_req_size;
+	rrq->rr_rep_size = param->rr_rep_size;
+	rrq->rr_flags    = param->rr_flags;
+	return 0;
+}
+
 static int
 lstcon_bulkrpc_v0_prep(struct lst_test_bulk_param *param,
 		       struct srpc_test_reqst *req)
@@ -891,6 +929,12 @@ lstcon_testrpc_prep(struct lstcon_node *nd, int transop, unsigned int feats,
 					 &test->tes_param[0], trq);
 		break;
 
+	case LST_TEST_RR:
+		trq->tsr_service = SRPC_SERVICE_RR;
+		rc = lstcon_rrrpc_prep((struct lst_test_rr_param *)
+				       &test->tes_param[0], trq);
+		break;
+
 	case LST_TEST_BULK:
 		trq->tsr_service = SRPC_SERVICE_BRW;
 		if ((feats & LST_FEAT_BULK_LEN) == 0) {
@@ -967,6 +1011,7 @@ lstcon_rpc_stat_reply(struct lstcon_rpc_trans *trans, struct srpc_msg *msg,
 	struct srpc_batch_reply *bat_rep;
 	struct srpc_test_reply *test_rep;
 	struct srpc_stat_reply *stat_rep;
+	struct srpc_lat_reply *lat_rep;
 	int rc = 0;
 
 	switch (trans->tas_opc) {
@@ -1068,6 +1113,18 @@ lstcon_rpc_stat_reply(struct lstcon_rpc_trans *trans, struct srpc_msg *msg,
                 rc = stat_rep->str_status;
                 break;
 
+	case LST_TRANS_LATQRY:
+		lat_rep = &msg->msg_body.lat_reply;
+
+		if (lat_rep->lat_status == 0) {
+			lstcon_statqry_stat_success(stat, 1);
+			return;
+		}
+
+		lstcon_statqry_stat_failure(stat, 1);
+		rc = lat_rep->lat_status;
+		break;
+
         default:
                 LBUG();
         }
@@ -1139,6 +1196,9 @@ lstcon_rpc_trans_ndlist(struct list_head *ndlist,
 		case LST_TRANS_STATQRY:
 			rc = lstcon_statrpc_prep(nd, feats, &rpc);
                         break;
+		case LST_TRANS_LATQRY:
+			rc = lstcon_latrpc_prep(nd, feats, *(int *)arg, &rpc);
+			break;
                 default:
                         rc = -EINVAL;
                         break;
@@ -1304,6 +1304,19 @@ lstcon_test_add(char *batch_name, int type, int loop,
 	if (dst_grp->grp_userland)
 		*retp = 1;
 
+	if (type == LST_TEST_RR) {
+		if ((console_session.ses_features & LST_FEAT_LATENCY) == 0) {
+			CDEBUG(D_NET, "rr test isn't supported by all nodes\n");
+			rc = -EOPNOTSUPP;
+			goto out;
+		}
+
+		if (paramlen < sizeof(struct lst_test_rr_param)) {
+			rc = -EINVAL;
+			goto out;
+		}
+	}
+
 	LIBCFS_ALLOC(test, offsetof(struct lstcon_test, tes_param[paramlen]));
 	if (!test) {
 		CERROR("Can't allocate test descriptor\n");
@@ -1485,13 +1498,76 @@ lstcon_statrpc_readent(int transop, struct srpc_msg *msg,
 }
 
 static int
-lstcon_ndlist_stat(struct list_head *ndlist,
-		   int timeout, struct list_head __user *result_up)
+lstcon_latrpc_readent(int transop, struct srpc_msg *msg,
+		      struct lstcon_rpc_ent __user *ent_up)
+{
+	struct srpc_lat_reply *rep = &msg->msg_body.lat_reply;
+	__u32 __user *buckets = (__u32 __user *)&ent_up->rpe_payload[0];
+
+	if (rep->lat_status != 0)
+		return 0;
+
+	if (rep->lat_first >= LST_LAT_NBUCKETS ||
+	    rep->lat_first % LST_LAT_CHUNK != 0)
+		return -EPROTO;
+
+	if (copy_to_user(&buckets[rep->lat_first], rep->lat_buckets,
+			 sizeof(rep->lat_buckets)))
+		return -EFAULT;
+
+	return 0;
+}
+
+/* the histogram doesn't fit in one srpc_msg, fetch it chunk by chunk */
+static int
+lstcon_ndlist_latency(struct list_head *ndlist,
+		      int timeout, struct list_head __user *result_up)
+{
+	LIST_HEAD(head);
+	struct lstcon_rpc_trans *trans;
+	int first;
+	int rc = 0;
+
+	if ((console_session.ses_features & LST_FEAT_LATENCY) == 0) {
+		CDEBUG(D_NET, "Latency isn't supported by all nodes\n");
+		return -EOPNOTSUPP;
+	}
+
+	for (first = 0; first < LST_LAT_NBUCKETS; first += LST_LAT_CHUNK) {
+		rc = lstcon_rpc_trans_ndlist(ndlist, &head, LST_TRANS_LATQRY,
+					     &first, NULL, &trans);
+		if (rc != 0) {
+			CERROR("Can't create transaction: %d\n", rc);
+			return rc;
+		}
+
+		lstcon_rpc_trans_postwait(trans,
+					  LST_VALIDATE_TIMEOUT(timeout));
+
+		rc = lstcon_rpc_trans_interpreter(trans, result_up,
+						  lstcon_latrpc_readent);
+		lstcon_rpc_trans_destroy(trans);
+
+		/* don't let later chunks hide errors of this one */
+		if (rc != 0 ||
+		    lstcon_rpc_stat_failure(lstcon_trans_stat(), 0) != 0)
+			break;
+	}
+
+	return rc;
+}
+
+static int
+lstcon_ndlist_stat(struct list_head *ndlist, int timeout,
+		   bool latency, struct list_head __user *result_up)
 {
 	LIST_HEAD(head);
 	struct lstcon_rpc_trans *trans;
 	int rc;
 
+	if (latency)
+		return lstcon_ndlist_latency(ndlist, timeout, result_up);
+
         rc = lstcon_rpc_trans_ndlist(ndlist, &head,
                                      LST_TRANS_STATQRY, NULL, NULL, &trans);
         if (rc != 0) {
@@ -1509,7 +1585,7 @@ lstcon_ndlist_stat(struct list_head *ndlist,
 }
 
 int
-lstcon_group_stat(char *grp_name, int timeout,
+lstcon_group_stat(char *grp_name, int timeout, bool latency,
 		  struct list_head __user *result_up)
 {
 	struct lstcon_group *grp;
@@ -1521,7 +1597,8 @@ lstcon_group_stat(char *grp_name, int timeout,
                 return rc;
         }
 
-        rc = lstcon_ndlist_stat(&grp->grp_ndl_list, timeout, result_up);
+	rc = lstcon_ndlist_stat(&grp->grp_ndl_list, timeout, latency,
+				result_up);
 
 	lstcon_group_decref(grp);
 
@@ -1530,7 +1607,8 @@ lstcon_group_stat(char *grp_name, int timeout,
 
 int
 lstcon_nodes_stat(int count, struct lnet_process_id __user *ids_up,
-		  int timeout, struct list_head __user *result_up)
+		  int timeout, bool latency,
+		  struct list_head __user *result_up)
 {
 	struct lstcon_ndlink *ndl;
 	struct lstcon_group *tmp;
@@ -1565,7 +1643,8 @@ lstcon_nodes_stat(int count, struct lnet_process_id __user *ids_up,
                 return rc;
         }
 
-        rc = lstcon_ndlist_stat(&tmp->grp_ndl_list, timeout, result_up);
+	rc = lstcon_ndlist_stat(&tmp->grp_ndl_list, timeout, latency,
+				result_up);
 
 	lstcon_group_decref(tmp);
 
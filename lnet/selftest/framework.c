@@ -407,6 +407,35 @@ sfw_get_stats(struct srpc_stat_reqst *request, struct srpc_stat_reply *reply)
 	return 0;
 }
 
+static int
+sfw_get_latency(struct srpc_lat_reqst *request, struct srpc_lat_reply *reply)
+{
+	struct sfw_session *sn = sfw_data.fw_session;
+	int i;
+
+	reply->lat_sid = (sn == NULL) ? LST_INVALID_SID : sn->sn_id;
+	reply->lat_first = request->lat_first;
+
+	if (request->lat_sid.ses_nid == LNET_NID_ANY ||
+	    request->lat_first >= LST_LAT_NBUCKETS ||
+	    request->lat_first % LST_LAT_CHUNK != 0) {
+		reply->lat_status = EINVAL;
+		return 0;
+	}
+
+	if (sn == NULL || !sfw_sid_equal(request->lat_sid, sn->sn_id)) {
+		reply->lat_status = ESRCH;
+		return 0;
+	}
+
+	for (i = 0; i < LST_LAT_CHUNK; i++)
+		reply->lat_buckets[i] =
+			atomic_read(&sn->sn_lat_hist[request->lat_first + i]);
+
+	reply->lat_status = 0;
+	return 0;
+}
+
 int
 sfw_make_session(struct srpc_mksn_reqst *request, struct srpc_mksn_reply *reply)
 {
@@ -726,6 +755,15 @@ sfw_unpack_addtest_req(struct srpc_msg *msg)
                 return;
         }
 
+	if (req->tsr_service == SRPC_SERVICE_RR) {
+		struct test_rr_req *rr = &req->tsr_u.rr;
+
+		__swab32s(&rr->rr_req_size);
+		__swab32s(&rr->rr_rep_size);
+		__swab32s(&rr->rr_flags);
+		return;
+	}
+
 	LBUG();
 }
 
@@ -871,10 +909,18 @@ sfw_test_rpc_done(struct srpc_client_rpc *rpc)
 {
 	struct sfw_test_unit *tsu = rpc->crpc_priv;
 	struct sfw_test_instance *tsi = tsu->tsu_instance;
+	struct sfw_session *sn = tsi->tsi_batch->bat_session;
         int                  done = 0;
 
         tsi->tsi_ops->tso_done_rpc(tsu, rpc);
 
+	/* round trip of the RPC, including bulk transfer if any */
+	if (rpc->crpc_status == 0) {
+		s64 usec = ktime_us_delta(ktime_get(), rpc->crpc_start);
+
+		atomic_inc(&sn->sn_lat_hist[lst_lat_bucket(max_t(s64, usec, 0))]);
+	}
+
 	spin_lock(&tsi->tsi_lock);
 
 	LASSERT(sfw_test_active(tsi));
@@ -1303,6 +1349,11 @@ sfw_handle_server_rpc(struct srpc_server_rpc *rpc)
                                    &reply->msg_body.stat_reply);
                 break;
 
+	case SRPC_SERVICE_QUERY_LAT:
+		rc = sfw_get_latency(&request->msg_body.lat_reqst,
+				     &reply->msg_body.lat_reply);
+		break;
+
         case SRPC_SERVICE_DEBUG:
                 rc = sfw_debug_session(&request->msg_body.dbg_reqst,
                                        &reply->msg_body.dbg_reply);
@@ -1448,6 +1499,27 @@ sfw_unpack_message(struct srpc_msg *msg)
                 return;
         }
 
+	if (msg->msg_type == SRPC_MSG_LAT_REQST) {
+		struct srpc_lat_reqst *req = &msg->msg_body.lat_reqst;
+
+		__swab64s(&req->lat_rpyid);
+		__swab32s(&req->lat_first);
+		sfw_unpack_sid(req->lat_sid);
+		return;
+	}
+
+	if (msg->msg_type == SRPC_MSG_LAT_REPLY) {
+		struct srpc_lat_reply *rep = &msg->msg_body.lat_reply;
+		int i;
+
+		__swab32s(&rep->lat_status);
+		__swab32s(&rep->lat_first);
+		sfw_unpack_sid(rep->lat_sid);
+		for (i = 0; i < LST_LAT_CHUNK; i++)
+			__swab32s(&rep->lat_buckets[i]);
+		return;
+	}
+
         if (msg->msg_type == SRPC_MSG_MKSN_REQST) {
 		struct srpc_mksn_reqst *req = &msg->msg_body.mksn_reqst;
 
@@ -1592,6 +1664,7 @@ sfw_post_rpc(struct srpc_client_rpc *rpc)
 static struct srpc_service sfw_services[] = {
 	{ .sv_id = SRPC_SERVICE_DEBUG,		.sv_name = "debug", },
 	{ .sv_id = SRPC_SERVICE_QUERY_STAT,	.sv_name = "query stats", },
+	{ .sv_id = SRPC_SERVICE_QUERY_LAT,	.sv_name = "query latency", },
 	{ .sv_id = SRPC_SERVICE_MAKE_SESSION,	.sv_name = "make session", },
 	{ .sv_id = SRPC_SERVICE_REMOVE_SESSION,	.sv_name = "remove session", },
 	{ .sv_id = SRPC_SERVICE_BATCH,		.sv_name = "batch service", },
@@ -1648,6 +1721,11 @@ sfw_startup (void)
         rc = sfw_register_test(&ping_test_service, &ping_test_client);
         LASSERT (rc == 0);
 
+	rr_init_test_client();
+	rr_init_test_service();
+	rc = sfw_register_test(&rr_test_service, &rr_test_client);
+	LASSERT(rc == 0);
+
 	error = 0;
 	list_for_each_entry(tsc, &sfw_data.fw_tests, tsc_list) {
 		sv = tsc->tsc_srv_service;
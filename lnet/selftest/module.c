@@ -96,6 +96,7 @@ lnet_selftest_structure_assertion(void)
 			      78);
 	BUILD_BUG_ON(sizeof(struct srpc_stat_reply) != 136);
 	BUILD_BUG_ON(sizeof(struct srpc_stat_reqst) != 28);
+	BUILD_BUG_ON(sizeof(struct srpc_lat_reply) != 136);
 }
 
 static int __init
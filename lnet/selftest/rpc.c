@@ -457,7 +457,10 @@ srpc_post_passive_rqtbuf(int service, int local, void *buf, int len,
 
 	return srpc_post_passive_rdma(srpc_serv_portal(service),
 				      local, service, buf, len,
-				      LNET_MD_OP_PUT, any, mdh, ev);
+				      LNET_MD_OP_PUT |
+				      (srpc_serv_is_padded(service) ?
+				       LNET_MD_TRUNCATE : 0),
+				      any, mdh, ev);
 }
 
 static int
@@ -789,15 +792,23 @@ static int
 srpc_send_request(struct srpc_client_rpc *rpc)
 {
 	struct srpc_event *ev = &rpc->crpc_reqstev;
+	void *buf = &rpc->crpc_reqstmsg;
+	int len = sizeof(struct srpc_msg);
 	int rc;
 
 	ev->ev_fired = 0;
 	ev->ev_data  = rpc;
 	ev->ev_type  = SRPC_REQUEST_SENT;
 
+	if (rpc->crpc_reqstpad != NULL) {
+		LASSERT(rpc->crpc_reqstlen >= len);
+		memcpy(rpc->crpc_reqstpad, buf, len);
+		buf = rpc->crpc_reqstpad;
+		len = rpc->crpc_reqstlen;
+	}
+
 	rc = srpc_post_active_rdma(srpc_serv_portal(rpc->crpc_service),
-				   rpc->crpc_service, &rpc->crpc_reqstmsg,
-				   sizeof(struct srpc_msg), LNET_MD_OP_PUT,
+				   rpc->crpc_service, buf, len, LNET_MD_OP_PUT,
 				   rpc->crpc_dest, LNET_NID_ANY,
 				   &rpc->crpc_reqstmdh, ev);
 	if (rc != 0) {
@@ -823,7 +834,9 @@ srpc_prepare_reply(struct srpc_client_rpc *rpc)
 	rc = srpc_post_passive_rdma(SRPC_RDMA_PORTAL, 0, *id,
 				    &rpc->crpc_replymsg,
 				    sizeof(struct srpc_msg),
-				    LNET_MD_OP_PUT, rpc->crpc_dest,
+				    LNET_MD_OP_PUT |
+				    (srpc_serv_is_padded(rpc->crpc_service) ?
+				     LNET_MD_TRUNCATE : 0), rpc->crpc_dest,
 				    &rpc->crpc_replymdh, ev);
 	if (rc != 0) {
 		LASSERT(rc == -ENOMEM);
@@ -1355,6 +1368,8 @@ srpc_post_rpc(struct srpc_client_rpc *rpc)
 	       libcfs_id2str(rpc->crpc_dest), rpc->crpc_service,
 	       rpc->crpc_timeout);
 
+	rpc->crpc_start = ktime_get();
+
 	srpc_add_client_rpc_timer(rpc);
 	swi_schedule_workitem(&rpc->crpc_wi);
 }
@@ -1368,6 +1383,8 @@ srpc_send_reply(struct srpc_server_rpc *rpc)
 	struct srpc_buffer *buffer = rpc->srpc_reqstbuf;
 	struct srpc_service_cd *scd = rpc->srpc_scd;
 	struct srpc_service *sv = scd->scd_svc;
+	void *buf;
+	int len;
 	__u64 rpyid;
 	int rc;
 
@@ -1395,8 +1412,17 @@ srpc_send_reply(struct srpc_server_rpc *rpc)
 	msg->msg_version = SRPC_MSG_VERSION;
 	msg->msg_type    = srpc_service2reply(sv->sv_id);
 
-	rc = srpc_post_active_rdma(SRPC_RDMA_PORTAL, rpyid, msg,
-				   sizeof(*msg), LNET_MD_OP_PUT,
+	buf = msg;
+	len = sizeof(*msg);
+	if (rpc->srpc_replypad != NULL) {
+		LASSERT(rpc->srpc_replylen >= len);
+		memcpy(rpc->srpc_replypad, msg, len);
+		buf = rpc->srpc_replypad;
+		len = rpc->srpc_replylen;
+	}
+
+	rc = srpc_post_active_rdma(SRPC_RDMA_PORTAL, rpyid, buf, len,
+				   LNET_MD_OP_PUT,
 				   rpc->srpc_peer, rpc->srpc_self,
 				   &rpc->srpc_replymdh, ev);
 	if (rc != 0)
@@ -58,6 +58,10 @@ enum srpc_msg_type {
         SRPC_MSG_PING_REPLY     = 15,
         SRPC_MSG_JOIN_REQST     = 16,
         SRPC_MSG_JOIN_REPLY     = 17,
+	SRPC_MSG_LAT_REQST	= 18,
+	SRPC_MSG_LAT_REPLY	= 19,
+	SRPC_MSG_RR_REQST	= 20,
+	SRPC_MSG_RR_REPLY	= 21,
 };
 
 /* CAVEAT EMPTOR:
@@ -185,6 +189,12 @@ struct test_ping_req {
 	__u32			png_flags;      /* reserved flags */
 } __packed;
 
+struct test_rr_req {
+	__u32			rr_req_size;	/* bytes of request on wire */
+	__u32			rr_rep_size;	/* bytes of reply on wire */
+	__u32			rr_flags;	/* reserved flags */
+} __packed;
+
 struct srpc_test_reqst {
 	__u64			tsr_rpyid;      /* reply buffer matchbits */
 	__u64			tsr_bulkid;     /* bulk buffer matchbits */
@@ -200,6 +210,7 @@ struct srpc_test_reqst {
 
 	union {
 		struct test_ping_req	ping;
+		struct test_rr_req	rr;
 		struct test_bulk_req	bulk_v0;
 		struct test_bulk_req_v1	bulk_v1;
 	} tsr_u;
@@ -225,6 +236,34 @@ struct srpc_ping_reply {
         __u32                   pnr_seq;
 } __packed;
 
+/* latency histogram query, one chunk of LST_LAT_CHUNK buckets per RPC */
+struct srpc_lat_reqst {
+	__u64			lat_rpyid;	/* reply buffer matchbits */
+	struct lst_sid		lat_sid;	/* session id */
+	__u32			lat_first;	/* first bucket wanted */
+} __packed;
+
+struct srpc_lat_reply {
+	__u32			lat_status;
+	struct lst_sid		lat_sid;
+	__u32			lat_first;	/* first bucket returned */
+	__u32			lat_buckets[LST_LAT_CHUNK];
+} __packed;
+
+/* request-reply test, messages are padded to the sizes of the test */
+struct srpc_rr_reqst {
+	__u64			rr_rpyid;
+	__u32			rr_magic;
+	__u32			rr_seq;
+	__u32			rr_rep_size;	/* bytes of reply wanted */
+} __packed;
+
+struct srpc_rr_reply {
+	__u32			rr_status;
+	__u32			rr_magic;
+	__u32			rr_seq;
+} __packed;
+
 struct srpc_brw_reqst {
         __u64                   brw_rpyid;      /* reply buffer matchbits */
         __u64                   brw_bulkid;     /* bulk buffer matchbits */
@@ -269,9 +308,13 @@ struct srpc_msg {
 		struct srpc_test_reply		tes_reply;
 		struct srpc_join_reqst		join_reqst;
 		struct srpc_join_reply		join_reply;
+		struct srpc_lat_reqst		lat_reqst;
+		struct srpc_lat_reply		lat_reply;
 
 		struct srpc_ping_reqst		ping_reqst;
 		struct srpc_ping_reply		ping_reply;
+		struct srpc_rr_reqst		rr_reqst;
+		struct srpc_rr_reply		rr_reply;
 		struct srpc_brw_reqst		brw_reqst;
 		struct srpc_brw_reply		brw_reply;
 	} msg_body;
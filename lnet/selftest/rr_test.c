@@ -0,0 +1,280 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * lnet/selftest/rr_test.c
+ *
+ * Request-reply test: small RPCs with configurable request and reply
+ * sizes and no bulk, to measure message rate and round trip latency.
+ * Both messages are padded beyond struct srpc_msg on the wire, the
+ * receiver only keeps the leading struct srpc_msg.
+ */
+
+#include "selftest.h"
+
+#define LST_RR_TEST_MAGIC	0xbabec0de
+
+static int rr_srv_workitems = SFW_TEST_WI_MAX;
+module_param(rr_srv_workitems, int, 0644);
+MODULE_PARM_DESC(rr_srv_workitems, "# request-reply server workitems");
+
+struct lst_rr_data {
+	spinlock_t	rrd_lock;	/* serialize */
+	int		rrd_counter;	/* sequence counter */
+};
+
+static struct lst_rr_data lst_rr_data;
+
+/* bytes really sent on the wire for a requested message size */
+static inline unsigned int
+rr_wire_size(unsigned int size)
+{
+	return max_t(unsigned int, size, sizeof(struct srpc_msg));
+}
+
+static void
+rr_client_fini(struct sfw_test_instance *tsi)
+{
+	struct sfw_session *sn = tsi->tsi_batch->bat_session;
+	unsigned int len = rr_wire_size(tsi->tsi_u.rr.rr_req_size);
+	struct sfw_test_unit *tsu;
+	int errors;
+
+	LASSERT(sn != NULL);
+	LASSERT(tsi->tsi_is_client);
+
+	list_for_each_entry(tsu, &tsi->tsi_units, tsu_list) {
+		if (tsu->tsu_private == NULL)
+			continue;
+
+		LIBCFS_FREE(tsu->tsu_private, len);
+		tsu->tsu_private = NULL;
+	}
+
+	errors = atomic_read(&sn->sn_ping_errors);
+	if (errors)
+		CWARN("%d request-reply RPCs have failed.\n", errors);
+	else
+		CDEBUG(D_NET, "Request-reply test finished OK.\n");
+}
+
+static int
+rr_client_init(struct sfw_test_instance *tsi)
+{
+	struct sfw_session *sn = tsi->tsi_batch->bat_session;
+	struct test_rr_req *rr = &tsi->tsi_u.rr;
+	struct sfw_test_unit *tsu;
+	unsigned int len;
+
+	LASSERT(tsi->tsi_is_client);
+	LASSERT(sn != NULL && (sn->sn_features & ~LST_FEATS_MASK) == 0);
+
+	if (rr->rr_req_size > LST_RR_SIZE_MAX ||
+	    rr->rr_rep_size > LST_RR_SIZE_MAX)
+		return -EINVAL;
+
+	spin_lock_init(&lst_rr_data.rrd_lock);
+	lst_rr_data.rrd_counter = 0;
+
+	/* a test unit has one RPC in flight, so one request pad each */
+	len = rr_wire_size(rr->rr_req_size);
+	if (len == sizeof(struct srpc_msg))
+		return 0;
+
+	list_for_each_entry(tsu, &tsi->tsi_units, tsu_list) {
+		LIBCFS_CPT_ALLOC(tsu->tsu_private, lnet_cpt_table(),
+				 lnet_cpt_of_nid(tsu->tsu_dest.nid, NULL), len);
+		if (tsu->tsu_private == NULL) {
+			rr_client_fini(tsi);
+			return -ENOMEM;
+		}
+	}
+
+	return 0;
+}
+
+static int
+rr_client_prep_rpc(struct sfw_test_unit *tsu, struct lnet_process_id dest,
+		   struct srpc_client_rpc **rpc)
+{
+	struct sfw_test_instance *tsi = tsu->tsu_instance;
+	struct sfw_session *sn = tsi->tsi_batch->bat_session;
+	struct test_rr_req *rr = &tsi->tsi_u.rr;
+	struct srpc_rr_reqst *req;
+	int rc;
+
+	LASSERT(sn != NULL);
+	LASSERT((sn->sn_features & ~LST_FEATS_MASK) == 0);
+
+	rc = sfw_create_test_rpc(tsu, dest, sn->sn_features, 0, 0, rpc);
+	if (rc != 0)
+		return rc;
+
+	if (tsu->tsu_private != NULL) {
+		(*rpc)->crpc_reqstpad = tsu->tsu_private;
+		(*rpc)->crpc_reqstlen = rr_wire_size(rr->rr_req_size);
+	}
+
+	req = &(*rpc)->crpc_reqstmsg.msg_body.rr_reqst;
+
+	req->rr_magic = LST_RR_TEST_MAGIC;
+	req->rr_rep_size = rr->rr_rep_size;
+
+	spin_lock(&lst_rr_data.rrd_lock);
+	req->rr_seq = lst_rr_data.rrd_counter++;
+	spin_unlock(&lst_rr_data.rrd_lock);
+
+	return rc;
+}
+
+static void
+rr_client_done_rpc(struct sfw_test_unit *tsu, struct srpc_client_rpc *rpc)
+{
+	struct sfw_test_instance *tsi = tsu->tsu_instance;
+	struct sfw_session *sn = tsi->tsi_batch->bat_session;
+	struct srpc_rr_reqst *reqst = &rpc->crpc_reqstmsg.msg_body.rr_reqst;
+	struct srpc_rr_reply *reply = &rpc->crpc_replymsg.msg_body.rr_reply;
+
+	LASSERT(sn != NULL);
+
+	if (rpc->crpc_status != 0) {
+		if (!tsi->tsi_stopping) /* rpc could have been aborted */
+			atomic_inc(&sn->sn_ping_errors);
+		CERROR("Unable to send request %d to %s: %d\n",
+		       reqst->rr_seq, libcfs_id2str(rpc->crpc_dest),
+		       rpc->crpc_status);
+		return;
+	}
+
+	if (rpc->crpc_replymsg.msg_magic != SRPC_MSG_MAGIC) {
+		__swab32s(&reply->rr_status);
+		__swab32s(&reply->rr_magic);
+		__swab32s(&reply->rr_seq);
+	}
+
+	if (reply->rr_magic != LST_RR_TEST_MAGIC ||
+	    reply->rr_seq != reqst->rr_seq) {
+		rpc->crpc_status = -EBADMSG;
+		atomic_inc(&sn->sn_ping_errors);
+		CERROR("Bad reply from %s: magic %x seq %u, %x/%u expected\n",
+		       libcfs_id2str(rpc->crpc_dest), reply->rr_magic,
+		       reply->rr_seq, LST_RR_TEST_MAGIC, reqst->rr_seq);
+		return;
+	}
+
+	if (reply->rr_status != 0) {
+		rpc->crpc_status = -reply->rr_status;
+		atomic_inc(&sn->sn_ping_errors);
+		CERROR("Request %u to %s failed: %d\n", reqst->rr_seq,
+		       libcfs_id2str(rpc->crpc_dest), reply->rr_status);
+	}
+}
+
+static void
+rr_server_rpc_done(struct srpc_server_rpc *rpc)
+{
+	if (rpc->srpc_replypad == NULL)
+		return;
+
+	LIBCFS_FREE(rpc->srpc_replypad, rpc->srpc_replylen);
+	rpc->srpc_replypad = NULL;
+}
+
+static int
+rr_server_handle(struct srpc_server_rpc *rpc)
+{
+	struct srpc_service *sv = rpc->srpc_scd->scd_svc;
+	struct srpc_msg *reqstmsg = &rpc->srpc_reqstbuf->buf_msg;
+	struct srpc_msg *replymsg = &rpc->srpc_replymsg;
+	struct srpc_rr_reqst *req = &reqstmsg->msg_body.rr_reqst;
+	struct srpc_rr_reply *rep = &replymsg->msg_body.rr_reply;
+	unsigned int len;
+
+	LASSERT(sv->sv_id == SRPC_SERVICE_RR);
+
+	if (reqstmsg->msg_magic != SRPC_MSG_MAGIC) {
+		LASSERT(reqstmsg->msg_magic == __swab32(SRPC_MSG_MAGIC));
+
+		__swab32s(&req->rr_magic);
+		__swab32s(&req->rr_seq);
+		__swab32s(&req->rr_rep_size);
+	}
+	LASSERT(reqstmsg->msg_type == srpc_service2request(sv->sv_id));
+
+	if (req->rr_magic != LST_RR_TEST_MAGIC) {
+		CERROR("Unexpect magic %08x from %s\n",
+		       req->rr_magic, libcfs_id2str(rpc->srpc_peer));
+		return -EINVAL;
+	}
+
+	rep->rr_seq   = req->rr_seq;
+	rep->rr_magic = LST_RR_TEST_MAGIC;
+
+	if ((reqstmsg->msg_ses_feats & ~LST_FEATS_MASK) != 0) {
+		replymsg->msg_ses_feats = LST_FEATS_MASK;
+		rep->rr_status = EPROTO;
+		return 0;
+	}
+
+	replymsg->msg_ses_feats = reqstmsg->msg_ses_feats;
+
+	if (req->rr_rep_size > LST_RR_SIZE_MAX) {
+		rep->rr_status = EINVAL;
+		return 0;
+	}
+
+	len = rr_wire_size(req->rr_rep_size);
+	if (len > sizeof(struct srpc_msg)) {
+		LIBCFS_ALLOC(rpc->srpc_replypad, len);
+		if (rpc->srpc_replypad == NULL) {
+			rep->rr_status = ENOMEM;
+			return 0;
+		}
+		rpc->srpc_replylen = len;
+		rpc->srpc_done = rr_server_rpc_done;
+	}
+
+	CDEBUG(D_NET, "Get request %d from %s, reply %u bytes\n",
+	       req->rr_seq, libcfs_id2str(rpc->srpc_peer), len);
+	return 0;
+}
+
+struct sfw_test_client_ops rr_test_client;
+
+void rr_init_test_client(void)
+{
+	rr_test_client.tso_init     = rr_client_init;
+	rr_test_client.tso_fini     = rr_client_fini;
+	rr_test_client.tso_prep_rpc = rr_client_prep_rpc;
+	rr_test_client.tso_done_rpc = rr_client_done_rpc;
+}
+
+struct srpc_service rr_test_service;
+
+void rr_init_test_service(void)
+{
+	rr_test_service.sv_id       = SRPC_SERVICE_RR;
+	rr_test_service.sv_name     = "rr_test";
+	rr_test_service.sv_handler  = rr_server_handle;
+	rr_test_service.sv_wi_total = rr_srv_workitems;
+}
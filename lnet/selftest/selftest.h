@@ -76,11 +76,13 @@ struct sfw_test_instance;
 #define SRPC_SERVICE_TEST               4
 #define SRPC_SERVICE_QUERY_STAT         5
 #define SRPC_SERVICE_JOIN               6
+#define SRPC_SERVICE_QUERY_LAT		7
 #define SRPC_FRAMEWORK_SERVICE_MAX_ID   10
 /* other services start from SRPC_FRAMEWORK_SERVICE_MAX_ID+1 */
 #define SRPC_SERVICE_BRW                11
 #define SRPC_SERVICE_PING               12
-#define SRPC_SERVICE_MAX_ID             12
+#define SRPC_SERVICE_RR			13
+#define SRPC_SERVICE_MAX_ID		13
 
 #define SRPC_REQUEST_PORTAL             50
 /* a lazy portal for framework RPC requests */
@@ -120,6 +122,12 @@ srpc_service2request (int service)
 
         case SRPC_SERVICE_JOIN:
                 return SRPC_MSG_JOIN_REQST;
+
+	case SRPC_SERVICE_QUERY_LAT:
+		return SRPC_MSG_LAT_REQST;
+
+	case SRPC_SERVICE_RR:
+		return SRPC_MSG_RR_REQST;
         }
 }
 
@@ -129,6 +137,15 @@ srpc_service2reply (int service)
         return srpc_service2request(service) + 1;
 }
 
+/* messages of this service may be padded beyond struct srpc_msg on wire,
+ * receivers only keep the leading struct srpc_msg.
+ */
+static inline bool
+srpc_serv_is_padded(int service)
+{
+	return service == SRPC_SERVICE_RR;
+}
+
 enum srpc_event_type {
         SRPC_BULK_REQ_RCVD   = 1, /* passive bulk request(PUT sink/GET source) received */
         SRPC_BULK_PUT_SENT   = 2, /* active bulk PUT sent (source) */
@@ -186,6 +203,9 @@ struct srpc_server_rpc {
 	lnet_nid_t		srpc_self;
 	struct lnet_process_id	srpc_peer;
 	struct srpc_msg		srpc_replymsg;
+	/* srpc_replymsg is copied to the head of it and sent if set */
+	void			*srpc_replypad;
+	unsigned int		srpc_replylen;
 	struct lnet_handle_md	srpc_replymdh;
 	struct srpc_buffer     *srpc_reqstbuf;
 	struct srpc_bulk       *srpc_bulk;
@@ -224,6 +244,10 @@ struct srpc_client_rpc {
 	/* bulk, request(reqst), and reply exchanged on wire */
 	struct srpc_msg		crpc_reqstmsg;
 	struct srpc_msg		crpc_replymsg;
+	/* crpc_reqstmsg is copied to the head of it and sent if set */
+	void			*crpc_reqstpad;
+	unsigned int		crpc_reqstlen;
+	ktime_t			crpc_start;	/* time of posting */
 	struct lnet_handle_md	crpc_reqstmdh;
 	struct lnet_handle_md	crpc_replymdh;
 	struct srpc_bulk	crpc_bulk;
@@ -333,6 +357,8 @@ struct sfw_session {
 	atomic_t		sn_brw_errors;
 	atomic_t		sn_ping_errors;
 	ktime_t			sn_started;
+	/* latency of test RPCs, see lst_lat_bucket() */
+	atomic_t		sn_lat_hist[LST_LAT_NBUCKETS];
 };
 
 #define sfw_sid_equal(sid0, sid1)     ((sid0).ses_nid == (sid1).ses_nid && \
@@ -379,6 +405,7 @@ struct sfw_test_instance {
 
 	union {
 		struct test_ping_req	ping;	  /* ping parameter */
+		struct test_rr_req	rr;	  /* request-reply parameter */
 		struct test_bulk_req	bulk_v0;  /* bulk parameter */
 		struct test_bulk_req_v1	bulk_v1;  /* bulk v1 parameter */
 	} tsi_u;
@@ -610,4 +637,9 @@ extern struct srpc_service brw_test_service;
 void brw_init_test_client(void);
 void brw_init_test_service(void);
 
+extern struct sfw_test_client_ops rr_test_client;
+extern struct srpc_service rr_test_service;
+void rr_init_test_client(void);
+void rr_init_test_service(void);
+
 #endif /* __SELFTEST_SELFTEST_H__ */
@@ -1041,6 +1041,12 @@ int lustre_lnet_show_route(char *nw, char *gw, int hops, int prio, int detail,
 						cfg_route.rtr_sensitivity) == NULL)
 				goto out;
 
+			if (!backup &&
+			    cYAML_create_number(item, "rtt_us",
+						data.cfg_config_u.
+						cfg_route.rtr_rtt_us) == NULL)
+				goto out;
+
 			rt_alive = data.cfg_config_u.cfg_route.rtr_flags &
 					LNET_RT_ALIVE;
 			rt_multi_hop = data.cfg_config_u.cfg_route.rtr_flags &
@@ -1939,6 +1945,23 @@ add_msg_stats_to_yaml_blk(struct cYAML *yaml,
 	return true;
 }
 
+/* the round trip time estimate has an ioctl of its own so the health
+ * stats keep their layout, a kernel without it reports no "rtt_us" */
+static bool
+add_rtt_to_yaml_blk(struct cYAML *yaml, lnet_nid_t nid,
+		    enum lnet_health_type type)
+{
+	struct lnet_ioctl_rtt rtt;
+
+	LIBCFS_IOC_INIT_V2(rtt, rtt_hdr);
+	rtt.rtt_nid = nid;
+	rtt.rtt_type = type;
+	if (l_ioctl(LNET_DEV_ID, IOC_LIBCFS_GET_RTT, &rtt) != 0)
+		return true;
+
+	return cYAML_create_number(yaml, "rtt_us", rtt.rtt_us) != NULL;
+}
+
 static struct lnet_ioctl_comm_count *
 get_counts(struct lnet_ioctl_element_msg_stats *msg_stats, int idx)
 {
@@ -2335,6 +2358,9 @@ continue_without_udsp_info:
 						hstats.hlni_next_ping)
 							== NULL)
 				goto out;
+			if (!add_rtt_to_yaml_blk(yhstats, ni_data->lic_nid,
+						 LNET_HEALTH_TYPE_LOCAL_NI))
+				goto out;
 
 continue_without_msg_stats:
 			tunables = cYAML_create_object(item, "tunables");
@@ -3230,6 +3256,10 @@ continue_without_udsp_info:
 							== NULL)
 				goto out;
 
+			if (!add_rtt_to_yaml_blk(yhstats, *nidp,
+						 LNET_HEALTH_TYPE_PEER_NI))
+				goto out;
+
 		}
 	}
 
@@ -344,6 +344,8 @@ lst_test_type2name(int type)
                 return "ping";
         if (type == LST_TEST_BULK)
                 return "brw";
+	if (type == LST_TEST_RR)
+		return "rr";
 
         return "unknown";
 }
@@ -355,6 +357,8 @@ lst_test_name2type(char *name)
                 return LST_TEST_PING;
         if (strcasecmp(name, "brw") == 0)
                 return LST_TEST_BULK;
+	if (strcasecmp(name, "rr") == 0)
+		return LST_TEST_RR;
 
         return -1;
 }
@@ -1486,7 +1490,7 @@ jt_lst_list_group(int argc, char **argv)
 
 int
 lst_stat_ioctl(char *name, int count, struct lnet_process_id *idsp,
-	       int timeout, struct list_head *resultp)
+	       int timeout, int lat, struct list_head *resultp)
 {
 	struct lstio_stat_args args = { 0 };
 
@@ -1498,7 +1502,8 @@ lst_stat_ioctl(char *name, int count, struct lnet_process_id *idsp,
 	args.lstio_sta_idsp    = idsp;
 	args.lstio_sta_resultp = resultp;
 
-	return lst_ioctl(LSTIO_STAT_QUERY, &args, sizeof(args));
+	return lst_ioctl(lat ? LSTIO_LAT_QUERY : LSTIO_STAT_QUERY,
+			 &args, sizeof(args));
 }
 
 typedef struct {
@@ -1524,7 +1529,8 @@ lst_stat_req_param_free(lst_stat_req_param_t *srp)
 }
 
 static int
-lst_stat_req_param_alloc(char *name, lst_stat_req_param_t **srpp, int save_old)
+lst_stat_req_param_alloc(char *name, lst_stat_req_param_t **srpp,
+			 int save_old, int lat)
 {
         lst_stat_req_param_t *srp = NULL;
         int                   count = save_old ? 2 : 1;
@@ -1559,6 +1565,7 @@ lst_stat_req_param_alloc(char *name, lst_stat_req_param_t **srpp, int save_old)
 
 	for (i = 0; i < count; i++) {
 		rc = lst_alloc_rpcent(&srp->srp_result[i], srp->srp_count,
+				      lat ? sizeof(__u32) * LST_LAT_NBUCKETS :
 				      sizeof(struct sfw_counters)  +
 				      sizeof(struct srpc_counters) +
 				      sizeof(struct lnet_counters_common));
@@ -1846,6 +1853,117 @@ lst_print_stat(char *name, struct list_head *resultp,
 	lst_print_lnet_stat(name, bwrt, rdwr, type, mbs);
 }
 
+/* latency (usec) under which @pct percent of @total RPCs completed */
+static __u64
+lst_lat_percentile(__u64 *hist, __u64 total, double pct)
+{
+	__u64 want = (__u64)(total * pct / 100);
+	__u64 sum = 0;
+	int i;
+
+	if (want == 0)
+		want = 1;
+
+	for (i = 0; i < LST_LAT_NBUCKETS; i++) {
+		sum += hist[i];
+		if (sum >= want)
+			return lst_lat_bucket_floor(i);
+	}
+
+	return lst_lat_bucket_floor(LST_LAT_NBUCKETS - 1);
+}
+
+static void
+lst_print_latency(char *name, struct list_head *resultp, int idx)
+{
+	struct list_head tmp[2];
+	struct lstcon_rpc_ent *new;
+	struct lstcon_rpc_ent *old;
+	__u64 hist[LST_LAT_NBUCKETS] = { 0 };
+	__u32 *lat_new;
+	__u32 *lat_old;
+	__u64 total = 0;
+	float rate = 0;
+	float delta;
+	int errcount = 0;
+	int max = -1;
+	int i;
+
+	INIT_LIST_HEAD(&tmp[0]);
+	INIT_LIST_HEAD(&tmp[1]);
+
+	while (!list_empty(&resultp[idx])) {
+		if (list_empty(&resultp[1 - idx])) {
+			fprintf(stderr, "Group is changed, re-run stat\n");
+			break;
+		}
+
+		new = list_entry(resultp[idx].next, struct lstcon_rpc_ent,
+				 rpe_link);
+		old = list_entry(resultp[1 - idx].next, struct lstcon_rpc_ent,
+				 rpe_link);
+
+		/* first time get stats result, can't calculate diff */
+		if (new->rpe_peer.nid == LNET_NID_ANY)
+			break;
+
+		if (new->rpe_peer.nid != old->rpe_peer.nid ||
+		    new->rpe_peer.pid != old->rpe_peer.pid)
+			break;
+
+		list_move_tail(&new->rpe_link, &tmp[idx]);
+		list_move_tail(&old->rpe_link, &tmp[1 - idx]);
+
+		if (new->rpe_rpc_errno != 0 || new->rpe_fwk_errno != 0 ||
+		    old->rpe_rpc_errno != 0 || old->rpe_fwk_errno != 0) {
+			errcount++;
+			continue;
+		}
+
+		lat_new = (__u32 *)&new->rpe_payload[0];
+		lat_old = (__u32 *)&old->rpe_payload[0];
+
+		/* both snapshots are taken at nearly the same time on all
+		 * nodes, so the stamps of each node give the interval
+		 */
+		delta = (new->rpe_stamp.tv_sec - old->rpe_stamp.tv_sec) +
+			(float)(new->rpe_stamp.tv_nsec -
+				old->rpe_stamp.tv_nsec) / 1000000000;
+
+		for (i = 0; i < LST_LAT_NBUCKETS; i++) {
+			__u32 cnt = lat_new[i] - lat_old[i];
+
+			if (cnt == 0)
+				continue;
+
+			hist[i] += cnt;
+			total += cnt;
+			if (delta > 0)
+				rate += cnt / delta;
+			if (i > max)
+				max = i;
+		}
+	}
+
+	list_splice(&tmp[idx], &resultp[idx]);
+	list_splice(&tmp[1 - idx], &resultp[1 - idx]);
+
+	if (errcount > 0)
+		fprintf(stdout, "Failed to stat on %d nodes\n", errcount);
+
+	if (max < 0)
+		return;
+
+	fprintf(stdout, "[LNet Latency of %s]\n", name);
+	fprintf(stdout,
+		"RPCs: %-10llu Rate: %-8.0f RPC/s p50: %-8llu p99: %-8llu p99.9: %-8llu max: %llu usec\n",
+		(unsigned long long)total, rate,
+		(unsigned long long)lst_lat_percentile(hist, total, 50),
+		(unsigned long long)lst_lat_percentile(hist, total, 99),
+		(unsigned long long)lst_lat_percentile(hist, total, 99.9),
+		(unsigned long long)lst_lat_bucket_floor(max));
+}
+
 int
 jt_lst_stat(int argc, char **argv)
 {
@@ -1864,6 +1982,7 @@ jt_lst_stat(int argc, char **argv)
 	int		      rc;
 	int		      c;
 	int		      mbs     = 0; /* report as MB/s */
+	int		      lat     = 0; /* latency percentiles */
 
 	static const struct option stat_opts[] = {
 		{ .name = "timeout", .has_arg = required_argument, .val = 't' },
@@ -1879,6 +1998,7 @@ jt_lst_stat(int argc, char **argv)
 		{ .name = "min",     .has_arg = no_argument,       .val = 'n' },
 		{ .name = "max",     .has_arg = no_argument,       .val = 'x' },
 		{ .name = "mbs",     .has_arg = no_argument,       .val = 'm' },
+		{ .name = "lat",     .has_arg = no_argument,       .val = 'L' },
 		{ .name = NULL } };
 
         if (session_key == 0) {
@@ -1888,7 +2008,7 @@ jt_lst_stat(int argc, char **argv)
         }
 
         while (1) {
-		c = getopt_long(argc, argv, "t:d:lcbarwgnxm", stat_opts,
+		c = getopt_long(argc, argv, "t:d:lcbarwgnxmL", stat_opts,
 				&optidx);
 
                 if (c == -1)
@@ -1946,6 +2066,9 @@ jt_lst_stat(int argc, char **argv)
 		case 'm':
 			mbs = 1;
 			break;
+		case 'L':
+			lat = 1;
+			break;
 
 		default:
 			lst_print_usage(argv[0]);
@@ -1975,7 +2098,7 @@ jt_lst_stat(int argc, char **argv)
 	INIT_LIST_HEAD(&head);
 
         while (optind < argc) {
-                rc = lst_stat_req_param_alloc(argv[optind++], &srp, 1);
+		rc = lst_stat_req_param_alloc(argv[optind++], &srp, 1, lat);
                 if (rc != 0)
                         goto out;
 
@@ -1992,17 +2115,23 @@ jt_lst_stat(int argc, char **argv)
 		last = now;
 
 		list_for_each_entry(srp, &head, srp_link) {
-                        rc = lst_stat_ioctl(srp->srp_name,
-                                            srp->srp_count, srp->srp_ids,
-                                            timeout, &srp->srp_result[idx]);
+			rc = lst_stat_ioctl(srp->srp_name,
+					    srp->srp_count, srp->srp_ids,
+					    timeout, lat,
+					    &srp->srp_result[idx]);
                         if (rc == -1) {
                                 lst_print_error("stat", "Failed to stat %s: %s\n",
                                                 srp->srp_name, strerror(errno));
                                 goto out;
                         }
 
-			lst_print_stat(srp->srp_name, srp->srp_result,
-				       idx, lnet, bwrt, rdwr, type, mbs);
+			if (lat)
+				lst_print_latency(srp->srp_name,
+						  srp->srp_result, idx);
+			else
+				lst_print_stat(srp->srp_name, srp->srp_result,
+					       idx, lnet, bwrt, rdwr, type,
+					       mbs);
 
 			lst_reset_rpcent(&srp->srp_result[1 - idx]);
 		}
@@ -2073,7 +2202,7 @@ jt_lst_show_error(int argc, char **argv)
 	INIT_LIST_HEAD(&head);
 
         while (optind < argc) {
-                rc = lst_stat_req_param_alloc(argv[optind++], &srp, 0);
+		rc = lst_stat_req_param_alloc(argv[optind++], &srp, 0, 0);
                 if (rc != 0)
                         goto out;
 
@@ -2081,8 +2210,8 @@ jt_lst_show_error(int argc, char **argv)
         }
 
 	list_for_each_entry(srp, &head, srp_link) {
-                rc = lst_stat_ioctl(srp->srp_name, srp->srp_count,
-                                    srp->srp_ids, 10, &srp->srp_result[0]);
+		rc = lst_stat_ioctl(srp->srp_name, srp->srp_count,
+				    srp->srp_ids, 10, 0, &srp->srp_result[0]);
 
                 if (rc == -1) {
                         lst_print_error(srp->srp_name, "Failed to show errors of %s: %s\n",
@@ -2990,10 +3119,59 @@ lst_get_bulk_param(int argc, char **argv, struct lst_test_bulk_param *bulk)
         return rc;
 }
 
+static int
+lst_get_rr_size(char *tok, int *size)
+{
+	char *end = NULL;
+
+	*size = strtol(tok, &end, 0);
+	if (end != NULL && (*end == 'k' || *end == 'K'))
+		*size *= 1024;
+
+	if (*size < 0 || *size > LST_RR_SIZE_MAX) {
+		fprintf(stderr, "Invalid size %s, max is %d bytes\n",
+			tok, LST_RR_SIZE_MAX);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+lst_get_rr_param(int argc, char **argv, struct lst_test_rr_param *rr)
+{
+	int i;
+
+	/* zero means the minimum, a bare selftest message */
+	rr->rr_req_size = 0;
+	rr->rr_rep_size = 0;
+	rr->rr_flags    = 0;
+
+	for (i = 0; i < argc; i++) {
+		if (strcasestr(argv[i], "req=") == argv[i]) {
+			if (lst_get_rr_size(strchr(argv[i], '=') + 1,
+					    &rr->rr_req_size) != 0)
+				return -1;
+
+		} else if (strcasestr(argv[i], "rep=") == argv[i]) {
+			if (lst_get_rr_size(strchr(argv[i], '=') + 1,
+					    &rr->rr_rep_size) != 0)
+				return -1;
+
+		} else {
+			fprintf(stderr, "Unknow parameter: %s\n", argv[i]);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 int
 lst_get_test_param(char *test, int argc, char **argv, void **param, int *plen)
 {
 	struct lst_test_bulk_param *bulk = NULL;
+	struct lst_test_rr_param *rr = NULL;
         int                    type;
 
         type = lst_test_name2type(test);
@@ -3025,6 +3203,23 @@ lst_get_test_param(char *test, int argc, char **argv, void **param, int *plen)
 
                 break;
 
+	case LST_TEST_RR:
+		rr = malloc(sizeof(*rr));
+		if (rr == NULL) {
+			fprintf(stderr, "Out of memory\n");
+			return -1;
+		}
+
+		if (lst_get_rr_param(argc, argv, rr) != 0) {
+			free(rr);
+			return -1;
+		}
+
+		*param = rr;
+		*plen  = sizeof(*rr);
+
+		break;
+
         default:
                 break;
         }
@@ -3235,7 +3430,7 @@ static command_t lst_cmdlist[] = {
           "Usage: lst list_group [--active] [--busy] [--down] [--unknown] GROUP ..."    },
 	{"stat",                jt_lst_stat,            NULL,
 	 "Usage: lst stat [--bw] [--rate] [--read] [--write] [--max] [--min] [--avg] "
-	 " [--mbs] [--timeout #] [--delay #] [--count #] GROUP [GROUP]"                 },
+	 " [--mbs] [--lat] [--timeout #] [--delay #] [--count #] GROUP [GROUP]"         },
         {"show_error",          jt_lst_show_error,      NULL,
          "Usage: lst show_error NAME | IDS ..."                                         },
         {"add_batch",           jt_lst_add_batch,       NULL,
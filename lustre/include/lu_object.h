@@ -1592,6 +1592,8 @@ struct lu_tgt_qos {
 						       * every obj*/
 	__u64			 ltq_avail;	/* bytes/inode avail */
 	__u64			 ltq_weight;	/* net weighting */
+	__u32			 ltq_load_penalty; /* 0-256 share of weight
+						    * taken for I/O load */
 	time64_t		 ltq_used;	/* last used time, seconds */
 	bool			 ltq_usable:1;	/* usable for striping */
 };
@@ -1603,6 +1605,8 @@ struct lu_tgt_qos {
 #define LOV_QOS_DEF_PRIO_FREE		90
 #define LMV_QOS_DEF_PRIO_FREE		90
 
+#define LOV_QOS_DEF_PRIO_LOAD		0
+
 struct lu_tgt_desc {
 	union {
 		struct dt_device	*ltd_tgt;
@@ -1641,6 +1645,7 @@ struct lu_qos {
 	__u32			 lq_active_svr_count;
 	unsigned int		 lq_prio_free;   /* priority for free space */
 	unsigned int		 lq_threshold_rr;/* priority for rr */
+	unsigned int		 lq_prio_load;	 /* priority for I/O load */
 #ifdef HAVE_SERVER_SUPPORT
 	struct lu_qos_rr	 lq_rr;          /* round robin qos data */
 #endif
@@ -107,7 +107,10 @@ struct target_distribute_txn_data {
 	struct list_head		tdtd_replay_finish_list;
 	spinlock_t			tdtd_replay_list_lock;
 	/* last replay update transno */
-	__u32				tdtd_replay_ready:1;
+	__u32				tdtd_replay_ready:1,
+	/* only the master sub transaction of a sync distributed transaction
+	 * is committed synchronously, see top_check_async_commit() */
+					tdtd_async_commit:1;
 
 	/* Manage the llog recovery threads */
 	atomic_t		tdtd_recovery_threads_count;
@@ -135,6 +138,9 @@ struct tg_grants_data {
 	/* shall we grant space to clients not
 	 * supporting OBD_CONNECT_GRANT_PARAM? */
 	int			 tgd_grant_compat_disable;
+	/* when short of space, grant clients what they write at their rate
+	 * in that many seconds, 0 disables rate-based grant */
+	int			 tgd_grant_rate_window;
 	/* protect all statfs-related counters */
 	spinlock_t		 tgd_osfs_lock;
 	time64_t		 tgd_osfs_age;
@@ -194,6 +200,8 @@ struct lu_target {
 	/* Number of clients supporting multiple modify RPCs
 	 * recorded in the bitmap */
 	atomic_t		 lut_num_clients;
+	/* Number of connected clients without "bucket" dir hash support */
+	atomic_t		 lut_bucket_unaware_clients;
 	/* Client generation to identify client slot reuse */
 	atomic_t		 lut_client_generation;
 	/** reply_data file */
@@ -206,6 +214,8 @@ struct lu_target {
 	/** cross MDT locks which should trigger Sync-on-Lock-Cancel */
 	spinlock_t		 lut_slc_locks_guard;
 	struct list_head	 lut_slc_locks;
+	/** syncs skipped upon lock cancel, see tgt_blocking_ast() */
+	atomic_t		 lut_slc_skip_count;
 
 	/* target grants fields */
 	struct tg_grants_data	 lut_tgd;
@@ -537,6 +547,10 @@ static inline int exp_grant_param_supp(struct obd_export *exp)
  * the client's page size is. */
 #define COMPAT_BSIZE_SHIFT 12
 
+/* Default seconds of writes at the client's rate granted ahead when the
+ * target is short of space, about the client writeback interval */
+#define TGT_GRANT_RATE_WINDOW	4
+
 void tgt_grant_sanity_check(struct obd_device *obd, const char *func);
 void tgt_grant_connect(const struct lu_env *env, struct obd_export *exp,
 		       struct obd_connect_data *data, bool new_conn);
@@ -565,6 +579,10 @@ ssize_t grant_compat_disable_show(struct kobject *kobj, struct attribute *attr,
 ssize_t grant_compat_disable_store(struct kobject *kobj,
 				   struct attribute *attr,
 				   const char *buffer, size_t count);
+ssize_t grant_rate_window_show(struct kobject *kobj, struct attribute *attr,
+			       char *buf);
+ssize_t grant_rate_window_store(struct kobject *kobj, struct attribute *attr,
+				const char *buffer, size_t count);
 #if LUSTRE_VERSION_CODE < OBD_OCD_VERSION(2, 16, 53, 0)
 ssize_t sync_lock_cancel_show(struct kobject *kobj,
 			      struct attribute *attr, char *buf);
@@ -66,6 +66,8 @@ struct tg_export_data {
 	loff_t			ted_lr_off;
 	/** Client index in last_rcvd file */
 	int			ted_lr_idx;
+	/** Highest transno of this export, protected by lut_translock */
+	__u64			ted_last_transno;
 
 	/**
 	 * ted_nodemap_lock is used to ensure that the nodemap is not destroyed
@@ -101,6 +103,15 @@ struct tg_export_data {
 	long			ted_grant;    /* in bytes */
 	long			ted_pending;  /* bytes just being written */
 	__u8			ted_pagebits; /* log2 of client page size */
+	/* write rate of the client, see tgt_grant_rate_update() */
+	u64			ted_write_rate;  /* bytes per second */
+	u64			ted_write_bytes; /* since ted_rate_time */
+	ktime_t			ted_rate_time;
+	/* grant efficiency: space allocated vs. consumed by writes */
+	u64			ted_grant_given;
+	u64			ted_grant_used;
+	/* replies asking the client to release unused grant */
+	unsigned int		ted_grant_reclaims;
 
 	/**
 	 * File Modification Data (FMD) tracking
@@ -118,6 +129,8 @@ struct mdt_export_data {
 	/** List of all files opened by client on this MDT */
 	struct list_head	med_open_head;
 	spinlock_t		med_open_lock; /* med_open_head, mfd_list */
+	/** client doesn't support "bucket" dir hash */
+	bool			med_bucket_unaware;
 };
 
 struct ec_export_data { /* echo client */
@@ -429,6 +442,22 @@ static inline bool imp_connect_shortio(struct obd_import *imp)
 	return ocd->ocd_connect_flags & OBD_CONNECT_SHORTIO;
 }
 
+static inline bool imp_connect_batch_destroy(struct obd_import *imp)
+{
+	struct obd_connect_data *ocd = &imp->imp_connect_data;
+
+	return (ocd->ocd_connect_flags & OBD_CONNECT_FLAGS2) &&
+	       (ocd->ocd_connect_flags2 & OBD_CONNECT2_BATCH_DESTROY);
+}
+
+static inline bool imp_connect_large_bulk(struct obd_import *imp)
+{
+	struct obd_connect_data *ocd = &imp->imp_connect_data;
+
+	return (ocd->ocd_connect_flags & OBD_CONNECT_FLAGS2) &&
+	       (ocd->ocd_connect_flags2 & OBD_CONNECT2_LARGE_BULK);
+}
+
 static inline __u64 exp_connect_ibits(struct obd_export *exp)
 {
 	struct obd_connect_data *ocd;
@@ -489,6 +518,11 @@ static inline int exp_connect_dom_lvb(struct obd_export *exp)
 	return !!(exp_connect_flags2(exp) & OBD_CONNECT2_DOM_LVB);
 }
 
+static inline int exp_connect_large_bulk(struct obd_export *exp)
+{
+	return !!(exp_connect_flags2(exp) & OBD_CONNECT2_LARGE_BULK);
+}
+
 enum {
 	/* archive_ids in array format */
 	KKUC_CT_DATA_ARRAY_MAGIC	= 0x092013cea,
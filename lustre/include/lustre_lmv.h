@@ -50,6 +50,7 @@ struct lmv_stripe_md {
 	__u32	lsm_md_layout_version;
 	__u32	lsm_md_migrate_offset;
 	__u32	lsm_md_migrate_hash;
+	__u64	lsm_md_bucket_weights;
 	__u32	lsm_md_default_count;
 	__u32	lsm_md_default_index;
 	char	lsm_md_pool_name[LOV_MAXPOOLNAME + 1];
@@ -101,6 +102,8 @@ lsm_md_eq(const struct lmv_stripe_md *lsm1, const struct lmv_stripe_md *lsm2)
 				lsm2->lsm_md_migrate_offset ||
 	    lsm1->lsm_md_migrate_hash !=
 				lsm2->lsm_md_migrate_hash ||
+	    lsm1->lsm_md_bucket_weights !=
+				lsm2->lsm_md_bucket_weights ||
 	    strncmp(lsm1->lsm_md_pool_name, lsm2->lsm_md_pool_name,
 		    sizeof(lsm1->lsm_md_pool_name)) != 0)
 		return false;
@@ -122,6 +125,15 @@ lsm_md_eq(const struct lmv_stripe_md *lsm1, const struct lmv_stripe_md *lsm2)
 	return true;
 }
 
+static inline const char *lmv_hash_name(__u32 hash_type)
+{
+	hash_type &= LMV_HASH_TYPE_MASK;
+	if (hash_type >= LMV_HASH_TYPE_MAX)
+		return "unknown";
+
+	return mdt_hash_name[hash_type];
+}
+
 static inline void lsm_md_dump(int mask, const struct lmv_stripe_md *lsm)
 {
 	bool valid_hash = lmv_dir_bad_hash(lsm);
@@ -131,15 +143,16 @@ static inline void lsm_md_dump(int mask, const struct lmv_stripe_md *lsm)
 	 * terminated string so only print LOV_MAXPOOLNAME bytes.
 	 */
 	CDEBUG(mask,
-	       "magic %#x stripe count %d master mdt %d hash type %s:%#x max-inherit %hhu max-inherit-rr %hhu version %d migrate offset %d migrate hash %#x pool %.*s\n",
+	       "magic %#x stripe count %d master mdt %d hash type %s:%#x max-inherit %hhu max-inherit-rr %hhu version %d migrate offset %d migrate hash %#x bucket weights %#llx pool %.*s\n",
 	       lsm->lsm_md_magic, lsm->lsm_md_stripe_count,
 	       lsm->lsm_md_master_mdt_index,
 	       valid_hash ? "invalid hash" :
-			    mdt_hash_name[lsm->lsm_md_hash_type & (LMV_HASH_TYPE_MAX - 1)],
+			    lmv_hash_name(lsm->lsm_md_hash_type),
 	       lsm->lsm_md_hash_type, lsm->lsm_md_max_inherit,
 	       lsm->lsm_md_max_inherit_rr, lsm->lsm_md_layout_version,
 	       lsm->lsm_md_migrate_offset, lsm->lsm_md_migrate_hash,
-	       LOV_MAXPOOLNAME, lsm->lsm_md_pool_name);
+	       lsm->lsm_md_bucket_weights, LOV_MAXPOOLNAME,
+	       lsm->lsm_md_pool_name);
 
 	if (!lmv_dir_striped(lsm))
 		return;
@@ -164,6 +177,7 @@ static inline void lmv1_le_to_cpu(struct lmv_mds_md_v1 *lmv_dst,
 				le32_to_cpu(lmv_src->lmv_master_mdt_index);
 	lmv_dst->lmv_hash_type = le32_to_cpu(lmv_src->lmv_hash_type);
 	lmv_dst->lmv_layout_version = le32_to_cpu(lmv_src->lmv_layout_version);
+	lmv_dst->lmv_bucket_weights = le64_to_cpu(lmv_src->lmv_bucket_weights);
 	if (lmv_src->lmv_stripe_count > LMV_MAX_STRIPE_COUNT)
 		return;
 	for (i = 0; i < lmv_src->lmv_stripe_count; i++)
@@ -247,13 +261,8 @@ static inline __u32 crush_hash(__u32 a, __u32 b)
  * https://www.ssrc.ucsc.edu/Papers/weil-sc06.pdf for details of CRUSH
  * algorithm.
  */
-static inline unsigned int
-lmv_hash_crush(unsigned int count, const char *name, int namelen)
+static inline unsigned int lmv_hash_pg_id(const char *name, int namelen)
 {
-	unsigned long long straw;
-	unsigned long long highest_straw = 0;
-	unsigned int pg_id;
-	unsigned int idx = 0;
 	int i;
 
 	/* put temp and backup file on the same MDT where target is located.
@@ -271,7 +280,19 @@ lmv_hash_crush(unsigned int count, const char *name, int namelen)
 		namelen -= i;
 	}
 
-	pg_id = lmv_hash_fnv1a(LMV_CRUSH_PG_COUNT, name, namelen);
+	return lmv_hash_fnv1a(LMV_CRUSH_PG_COUNT, name, namelen);
+}
+
+static inline unsigned int
+lmv_hash_crush(unsigned int count, const char *name, int namelen)
+{
+	unsigned long long straw;
+	unsigned long long highest_straw = 0;
+	unsigned int pg_id;
+	unsigned int idx = 0;
+	int i;
+
+	pg_id = lmv_hash_pg_id(name, namelen);
 
 	/* distribute PG among all stripes pseudo-randomly, so they are almost
 	 * evenly distributed, and when stripe count changes, only (delta /
@@ -291,7 +312,97 @@ lmv_hash_crush(unsigned int count, const char *name, int namelen)
 	return idx;
 }
 
-/* directory layout may change in three ways:
+static inline unsigned int lmv_bucket_weight(__u64 weights, unsigned int idx)
+{
+	return (weights >> (idx * LMV_BUCKET_WEIGHT_BITS)) &
+	       LMV_BUCKET_WEIGHT_MAX;
+}
+
+/* weights of stripes [0, count) in lmv_bucket_weights */
+static inline __u64 lmv_bucket_weights_mask(unsigned int count)
+{
+	if (count >= LMV_BUCKET_STRIPES_MAX)
+		return ~0ULL;
+
+	return (1ULL << (count * LMV_BUCKET_WEIGHT_BITS)) - 1;
+}
+
+/* weights of stripes from \a offset, moved to the lowest bits */
+static inline __u64 lmv_bucket_weights_from(__u64 weights, unsigned int offset)
+{
+	if (offset >= LMV_BUCKET_STRIPES_MAX)
+		return 0;
+
+	return weights >> (offset * LMV_BUCKET_WEIGHT_BITS);
+}
+
+/*
+ * "bucket" hash maps the name to one of LMV_CRUSH_PG_COUNT placement groups
+ * like CRUSH, while the PGs are assigned to stripes in contiguous ranges
+ * proportional to the stripe weights in \a weights, so that MDTs with more
+ * free space and less load receive more sub files. The weights are part of
+ * the LMV, so clients find the stripe without asking the MDT. If all weights
+ * are 0, PGs are spread evenly, the same as all weights are equal.
+ */
+static inline unsigned int
+lmv_hash_bucket(unsigned int count, __u64 weights, const char *name,
+		int namelen)
+{
+	unsigned int total = 0;
+	unsigned int bucket;
+	unsigned int w;
+	unsigned int i;
+
+	if (count > LMV_BUCKET_STRIPES_MAX)
+		return lmv_hash_crush(count, name, namelen);
+
+	for (i = 0; i < count; i++)
+		total += lmv_bucket_weight(weights, i);
+
+	bucket = lmv_hash_pg_id(name, namelen);
+	if (total == 0)
+		return bucket * count / LMV_CRUSH_PG_COUNT;
+
+	bucket = bucket * total / LMV_CRUSH_PG_COUNT;
+	for (i = 0; i < count; i++) {
+		w = lmv_bucket_weight(weights, i);
+		if (bucket < w)
+			break;
+		bucket -= w;
+	}
+	LASSERT(i < count);
+
+	return i;
+}
+
+static inline bool lmv_hash_is_bucket(__u32 hash_type)
+{
+	return (hash_type & LMV_HASH_TYPE_MASK) == LMV_HASH_TYPE_BUCKET;
+}
+
+/* "bucket" hash is replaced by CRUSH, which places names in a similar way,
+ * if the stripe weights can't be stored in lmv_bucket_weights, or it's not
+ * supported by the other side.
+ */
+static inline __u32 lmv_hash_bucket_to_crush(__u32 hash_type)
+{
+	if (!lmv_hash_is_bucket(hash_type))
+		return hash_type;
+
+	return (hash_type & ~LMV_HASH_TYPE_MASK) | LMV_HASH_TYPE_CRUSH;
+}
+
+/* check hash type in restripe command against directory layout */
+static inline bool lmv_hash_type_match(__u32 lum_hash, __u32 lmv_hash)
+{
+	lum_hash &= LMV_HASH_TYPE_MASK;
+	lmv_hash &= LMV_HASH_TYPE_MASK;
+
+	return lum_hash == lmv_hash ||
+	       lmv_hash_bucket_to_crush(lum_hash) == lmv_hash;
+}
+
+/* directory layout may change in four ways:
  * 1. directory migration, in its LMV source stripes are appended after
  *    target stripes, \a migrate_hash is source hash type, \a migrate_offset is
  *    target stripe count,
@@ -299,11 +410,18 @@ lmv_hash_crush(unsigned int count, const char *name, int namelen)
  *    \a migrate_offset is stripe count before split.
  * 3. directory merge, \a migrate_hash is hash type after merge,
  *    \a migrate_offset is stripe count after merge.
+ * 4. "bucket" hash rebalance, \a migrate_offset and \a migrate_hash are the
+ *    low and high 32 bits of stripe weights before rebalance.
+ * \a bucket_weights are the stripe weights of "bucket" hash, which are kept
+ * for the stripes that don't change in split and merge. In migration source
+ * stripe weights follow target's if both are "bucket" hash, otherwise they
+ * are in the lowest bits.
  */
 static inline int
 __lmv_name_to_stripe_index(__u32 hash_type, __u32 stripe_count,
 			   __u32 migrate_hash, __u32 migrate_offset,
-			   const char *name, int namelen, bool new_layout)
+			   __u64 bucket_weights, const char *name, int namelen,
+			   bool new_layout)
 {
 	__u32 saved_hash = hash_type;
 	__u32 saved_count = stripe_count;
@@ -326,9 +444,16 @@ __lmv_name_to_stripe_index(__u32 hash_type, __u32 stripe_count,
 		if (new_layout) {
 			stripe_count = migrate_offset;
 		} else {
+			if (lmv_hash_is_bucket(hash_type))
+				bucket_weights = lmv_bucket_weights_from(
+						bucket_weights, migrate_offset);
 			hash_type = migrate_hash;
 			stripe_count -= migrate_offset;
 		}
+	} else if (lmv_hash_is_rebalancing(hash_type)) {
+		if (!new_layout)
+			bucket_weights = (__u64)migrate_hash << 32 |
+					 migrate_offset;
 	}
 
 	if (stripe_count > 1) {
@@ -345,6 +470,11 @@ __lmv_name_to_stripe_index(__u32 hash_type, __u32 stripe_count,
 			stripe_index = lmv_hash_crush(stripe_count, name,
 						      namelen);
 			break;
+		case LMV_HASH_TYPE_BUCKET:
+			stripe_index = lmv_hash_bucket(stripe_count,
+						       bucket_weights, name,
+						       namelen);
+			break;
 		default:
 			return -EBADFD;
 		}
@@ -372,6 +502,7 @@ static inline int lmv_name_to_stripe_index(struct lmv_mds_md_v1 *lmv,
 						  lmv->lmv_stripe_count,
 						  lmv->lmv_migrate_hash,
 						  lmv->lmv_migrate_offset,
+						  lmv->lmv_bucket_weights,
 						  name, namelen, true);
 
 	if (lmv->lmv_magic == cpu_to_le32(LMV_MAGIC_V1))
@@ -380,6 +511,7 @@ static inline int lmv_name_to_stripe_index(struct lmv_mds_md_v1 *lmv,
 					le32_to_cpu(lmv->lmv_stripe_count),
 					le32_to_cpu(lmv->lmv_migrate_hash),
 					le32_to_cpu(lmv->lmv_migrate_offset),
+					le64_to_cpu(lmv->lmv_bucket_weights),
 					name, namelen, true);
 
 	return -EINVAL;
@@ -394,6 +526,7 @@ static inline int lmv_name_to_stripe_index_old(struct lmv_mds_md_v1 *lmv,
 						  lmv->lmv_stripe_count,
 						  lmv->lmv_migrate_hash,
 						  lmv->lmv_migrate_offset,
+						  lmv->lmv_bucket_weights,
 						  name, namelen, false);
 
 	if (lmv->lmv_magic == cpu_to_le32(LMV_MAGIC_V1) ||
@@ -403,6 +536,7 @@ static inline int lmv_name_to_stripe_index_old(struct lmv_mds_md_v1 *lmv,
 					le32_to_cpu(lmv->lmv_stripe_count),
 					le32_to_cpu(lmv->lmv_migrate_hash),
 					le32_to_cpu(lmv->lmv_migrate_offset),
+					le64_to_cpu(lmv->lmv_bucket_weights),
 					name, namelen, false);
 
 	return -EINVAL;
@@ -420,10 +554,10 @@ static inline bool lmv_user_magic_supported(__u32 lum_magic)
 	       "%s LMV: magic=%#x count=%u index=%u hash=%s:%#x version=%u migrate offset=%u migrate hash=%s:%u.\n",\
 	       msg, (lmv)->lmv_magic, (lmv)->lmv_stripe_count,		\
 	       (lmv)->lmv_master_mdt_index,				\
-	       mdt_hash_name[(lmv)->lmv_hash_type & (LMV_HASH_TYPE_MAX - 1)],\
+	       lmv_hash_name((lmv)->lmv_hash_type),			\
 	       (lmv)->lmv_hash_type, (lmv)->lmv_layout_version,		\
 	       (lmv)->lmv_migrate_offset,				\
-	       mdt_hash_name[(lmv)->lmv_migrate_hash & (LMV_HASH_TYPE_MAX - 1)],\
+	       lmv_hash_name((lmv)->lmv_migrate_hash),			\
 	       (lmv)->lmv_migrate_hash)
 
 /* master LMV is sane */
@@ -493,13 +627,20 @@ static inline bool lmv_is_migrating(const struct lmv_mds_md_v1 *lmv)
 	return lmv_hash_is_migrating(cpu_to_le32(lmv->lmv_hash_type));
 }
 
+static inline bool lmv_is_rebalancing(const struct lmv_mds_md_v1 *lmv)
+{
+	if (!lmv_is_sane2(lmv))
+		return false;
+
+	return lmv_hash_is_rebalancing(cpu_to_le32(lmv->lmv_hash_type));
+}
+
 static inline bool lmv_is_restriping(const struct lmv_mds_md_v1 *lmv)
 {
 	if (!lmv_is_sane2(lmv))
 		return false;
 
-	return lmv_hash_is_splitting(cpu_to_le32(lmv->lmv_hash_type)) ||
-	       lmv_hash_is_merging(cpu_to_le32(lmv->lmv_hash_type));
+	return lmv_hash_is_restriping(cpu_to_le32(lmv->lmv_hash_type));
 }
 
 static inline bool lmv_is_layout_changing(const struct lmv_mds_md_v1 *lmv)
@@ -507,9 +648,7 @@ static inline bool lmv_is_layout_changing(const struct lmv_mds_md_v1 *lmv)
 	if (!lmv_is_sane2(lmv))
 		return false;
 
-	return lmv_hash_is_splitting(cpu_to_le32(lmv->lmv_hash_type)) ||
-	       lmv_hash_is_merging(cpu_to_le32(lmv->lmv_hash_type)) ||
-	       lmv_hash_is_migrating(cpu_to_le32(lmv->lmv_hash_type));
+	return lmv_hash_is_layout_changing(cpu_to_le32(lmv->lmv_hash_type));
 }
 
 static inline bool lmv_is_fixed(const struct lmv_mds_md_v1 *lmv)
@@ -1388,6 +1388,8 @@ struct ptlrpc_bulk_desc {
 	int                    bd_nob;          /* # bytes covered */
 	int                    bd_nob_transferred; /* # bytes GOT/PUT */
 	unsigned int		bd_nob_last;	/* # bytes in last MD */
+	unsigned int		bd_md_size;	/* max # bytes in a MD */
+	unsigned int		bd_md_max_iov;	/* max # frags in a MD */
 
 	__u64                  bd_last_mbits;
 
@@ -2100,6 +2102,8 @@ struct ptlrpc_bulk_desc *ptlrpc_prep_bulk_imp(struct ptlrpc_request *req,
 void __ptlrpc_prep_bulk_page(struct ptlrpc_bulk_desc *desc,
 			     struct page *page, int pageoffset, int len,
 			     int pin);
+void ptlrpc_bulk_set_md_size(struct ptlrpc_bulk_desc *desc,
+			     unsigned int md_size);
 
 void ptlrpc_free_bulk(struct ptlrpc_bulk_desc *bulk);
 
@@ -402,6 +402,7 @@ extern struct req_msg_field RMF_RCS;
 extern struct req_msg_field RMF_FIEMAP_KEY;
 extern struct req_msg_field RMF_FIEMAP_VAL;
 extern struct req_msg_field RMF_OST_ID;
+extern struct req_msg_field RMF_OST_ID_ARRAY;
 extern struct req_msg_field RMF_SHORT_IO;
 
 /* MGS config read message format */
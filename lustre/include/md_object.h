@@ -219,6 +219,20 @@ struct md_layout_change {
 	};
 };
 
+/**
+ * One name of a batched namespace-only migration, see mdo_migrate_batch().
+ */
+struct md_migrate_item {
+	/* object the name refers to, NULL to skip this item */
+	struct md_object	*mmi_obj;
+	/* name under the parent, NUL terminated */
+	struct lu_name		 mmi_name;
+	/* 0 if migrated, -EALREADY if it needn't be, -EAGAIN if it has
+	 * hard links and must be migrated alone, or -errno
+	 */
+	int			 mmi_rc;
+};
+
 union ldlm_policy_data;
 /**
  * Operations implemented for each md object (both directory and leaf).
@@ -352,6 +366,11 @@ struct md_dir_operations {
 			   struct md_object *sobj, const struct lu_name *lname,
 			   struct md_object *tobj, struct md_op_spec *spec,
 			   struct md_attr *ma);
+
+	int (*mdo_migrate_batch)(const struct lu_env *env,
+				 struct md_object *pobj,
+				 struct md_migrate_item *items, int count,
+				 struct md_attr *ma);
 };
 
 struct md_device_operations {
@@ -650,6 +669,16 @@ static inline int mdo_migrate(const struct lu_env *env,
 					     ma);
 }
 
+static inline int mdo_migrate_batch(const struct lu_env *env,
+				    struct md_object *pobj,
+				    struct md_migrate_item *items, int count,
+				    struct md_attr *ma)
+{
+	LASSERT(pobj->mo_dir_ops->mdo_migrate_batch);
+	return pobj->mo_dir_ops->mdo_migrate_batch(env, pobj, items, count,
+						   ma);
+}
+
 static inline int mdo_is_subdir(const struct lu_env *env,
 				struct md_object *mo,
 				const struct lu_fid *fid)
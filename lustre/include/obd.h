@@ -805,6 +805,16 @@ void obd_nid_del(struct obd_device *obd, struct obd_export *exp);
 
 #define KEY_CACHE_LRU_SHRINK	"cache_lru_shrink"
 #define KEY_OSP_CONNECTED	"osp_connected"
+#define KEY_POOL_TIER		"pool_tier"
+
+/* value of KEY_POOL_TIER: tiering policy of the OST pools around pti_pool */
+struct pool_tier_info {
+	char	pti_pool[LOV_MAXPOOLNAME + 1];	  /* in: pool of the file */
+	char	pti_demote[LOV_MAXPOOLNAME + 1];  /* out: pool for cold files */
+	char	pti_promote[LOV_MAXPOOLNAME + 1]; /* out: pool for hot files */
+	__u64	pti_demote_heat;  /* out: heat under which a file is cold */
+	__u64	pti_promote_heat; /* out: cold threshold of pti_promote */
+};
 
 /* Flags for op_xvalid */
 enum op_xvalid {
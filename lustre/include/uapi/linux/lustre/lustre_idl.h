@@ -850,6 +850,12 @@ struct ptlrpc_body_v2 {
 #define OBD_CONNECT2_BATCH_RPC        0x400000ULL /* Multi-RPC batch request */
 #define OBD_CONNECT2_PCCRO	      0x800000ULL /* Read-only PCC */
 #define OBD_CONNECT2_ATOMIC_OPEN_LOCK 0x4000000ULL/* request lock on 1st open */
+/* 0x8000000ULL through 0x10000000000ULL are assigned on other branches, see
+ * obd_connect_names[], do not reuse them here.
+ */
+#define OBD_CONNECT2_BUCKET_HASH  0x20000000000ULL /* bucket hash striped dir */
+#define OBD_CONNECT2_BATCH_DESTROY 0x40000000000ULL /* OST_DESTROY obj array */
+#define OBD_CONNECT2_LARGE_BULK   0x80000000000ULL /* bulk MDs > LNET_MTU */
 /* XXX README XXX:
  * Please DO NOT add flag values here before first ensuring that this same
  * flag value is not in use on some other branch.  Please clear any such
@@ -912,7 +918,8 @@ struct ptlrpc_body_v2 {
 				OBD_CONNECT2_GETATTR_PFID |\
 				OBD_CONNECT2_LSEEK | OBD_CONNECT2_DOM_LVB |\
 				OBD_CONNECT2_REP_MBITS | \
-				OBD_CONNECT2_ATOMIC_OPEN_LOCK)
+				OBD_CONNECT2_ATOMIC_OPEN_LOCK | \
+				OBD_CONNECT2_BUCKET_HASH)
 
 #define OST_CONNECT_SUPPORTED  (OBD_CONNECT_SRVLOCK | OBD_CONNECT_GRANT | \
 				OBD_CONNECT_REQPORTAL | OBD_CONNECT_VERSION | \
@@ -935,7 +942,9 @@ struct ptlrpc_body_v2 {
 
 #define OST_CONNECT_SUPPORTED2 (OBD_CONNECT2_LOCKAHEAD | OBD_CONNECT2_INC_XID |\
 				OBD_CONNECT2_ENCRYPT | OBD_CONNECT2_LSEEK |\
-				OBD_CONNECT2_REP_MBITS)
+				OBD_CONNECT2_REP_MBITS | \
+				OBD_CONNECT2_BATCH_DESTROY | \
+				OBD_CONNECT2_LARGE_BULK)
 
 #define ECHO_CONNECT_SUPPORTED (OBD_CONNECT_FID | OBD_CONNECT_FLAGS2)
 #define ECHO_CONNECT_SUPPORTED2 OBD_CONNECT2_REP_MBITS
@@ -1101,6 +1110,8 @@ enum obdo_flags {
 	OBD_FL_FLUSH	    = 0x00200000, /* flush pages on the OST */
 	OBD_FL_SHORT_IO	    = 0x00400000, /* short io request */
 	OBD_FL_ROOT_SQUASH  = 0x00800000, /* root squash */
+	/* 0x01000000 is OBD_FL_ROOT_PRJQUOTA on other branches */
+	OBD_FL_GRANT_RECLAIM = 0x02000000, /* target asks to shrink grant */
 	/* OBD_FL_LOCAL_MASK = 0xF0000000, was local-only flags until 2.10 */
 
 	/*
@@ -1437,6 +1448,14 @@ struct obd_ioobj {
 #define ioobj_max_brw_set(ioo, num)					\
 do { (ioo)->ioo_max_brw = ((num) - 1) << IOOBJ_MAX_BRW_BITS; } while (0)
 
+/* With OBD_CONNECT2_LARGE_BULK, the low bits of ioo_max_brw hold log2 of the
+ * size of the bulk MDs, larger than LNET_MTU. 0 means LNET_MTU sized MDs.
+ * Must be set after ioobj_max_brw_set(). */
+#define IOOBJ_MD_BITS_MASK	0xffU
+#define ioobj_md_bits_get(ioo)	((ioo)->ioo_max_brw & IOOBJ_MD_BITS_MASK)
+#define ioobj_md_bits_set(ioo, bits)					\
+do { (ioo)->ioo_max_brw |= (bits) & IOOBJ_MD_BITS_MASK; } while (0)
+
 /* multiple of 8 bytes => can array */
 struct niobuf_remote {
 	__u64	rnb_offset;
@@ -2213,7 +2232,9 @@ struct lmv_mds_md_v1 {
 	__u32 lmv_migrate_hash;		/* hash type of source stripes of
 					 * migrating directory */
 	__u32 lmv_padding2;
-	__u64 lmv_padding3;
+	__u64 lmv_bucket_weights;	/* 4-bit weight of each stripe for
+					 * "bucket" hash, stripe 0 in the
+					 * lowest bits, see lmv_hash_bucket */
 	char lmv_pool_name[LOV_MAXPOOLNAME + 1];	/* pool name */
 	struct lu_fid lmv_stripe_fids[0];	/* FIDs for each stripe */
 };
@@ -2224,6 +2245,9 @@ struct lmv_mds_md_v1 {
 #define lmv_merge_offset	lmv_migrate_offset
 /* directory hash type after merge */
 #define lmv_merge_hash		lmv_migrate_hash
+/* stripe weights before "bucket" hash rebalance, low and high 32 bits */
+#define lmv_rebalance_weights_lo	lmv_migrate_offset
+#define lmv_rebalance_weights_hi	lmv_migrate_hash
 
 /* foreign LMV EA */
 struct lmv_foreign_md {
@@ -2272,6 +2296,11 @@ static inline __u64 lustre_hash_fnv_1a_64(const void *buf, __kernel_size_t size)
 /* CRUSH placement group count */
 #define LMV_CRUSH_PG_COUNT	4096
 
+/* "bucket" hash stores a 4-bit weight per stripe in lmv_bucket_weights */
+#define LMV_BUCKET_WEIGHT_BITS	4
+#define LMV_BUCKET_WEIGHT_MAX	((1 << LMV_BUCKET_WEIGHT_BITS) - 1)
+#define LMV_BUCKET_STRIPES_MAX	(64 / LMV_BUCKET_WEIGHT_BITS)
+
 union lmv_mds_md {
 	__u32			 lmv_magic;
 	struct lmv_mds_md_v1	 lmv_md_v1;
@@ -283,10 +283,10 @@ struct obd_statfs {
 					/* used in QoS code to find preferred
 					 * OSTs */
 	__u32           os_granted;	/* space granted for MDS */
-	__u32           os_spare3;	/* Unused padding fields.  Remember */
-	__u32           os_spare4;	/* to fix lustre_swab_obd_statfs() */
-	__u32           os_spare5;
-	__u32           os_spare6;
+	__u32		os_io_inflight;	/* bulk I/Os being serviced now */
+	__u32		os_io_latency;	/* average I/O service time, usec */
+	__u32           os_spare5;	/* Unused padding fields.  Remember */
+	__u32           os_spare6;	/* to fix lustre_swab_obd_statfs() */
 	__u32           os_spare7;
 	__u32           os_spare8;
 	__u32           os_spare9;
@@ -1000,6 +1000,7 @@ enum lmv_hash_type {
 	LMV_HASH_TYPE_ALL_CHARS = 1,
 	LMV_HASH_TYPE_FNV_1A_64 = 2,
 	LMV_HASH_TYPE_CRUSH	= 3,
+	LMV_HASH_TYPE_BUCKET	= 4,	/* weighted buckets, see lmv_hash_bucket */
 	LMV_HASH_TYPE_MAX,
 };
 
@@ -1008,6 +1009,7 @@ static __attribute__((unused)) const char *mdt_hash_name[] = {
 	"all_char",
 	"fnv_1a_64",
 	"crush",
+	"bucket",
 };
 
 #define LMV_HASH_TYPE_DEFAULT LMV_HASH_TYPE_CRUSH
@@ -1022,7 +1024,8 @@ static inline bool lmv_is_known_hash_type(__u32 type)
 {
 	return (type & LMV_HASH_TYPE_MASK) == LMV_HASH_TYPE_FNV_1A_64 ||
 	       (type & LMV_HASH_TYPE_MASK) == LMV_HASH_TYPE_ALL_CHARS ||
-	       (type & LMV_HASH_TYPE_MASK) == LMV_HASH_TYPE_CRUSH;
+	       (type & LMV_HASH_TYPE_MASK) == LMV_HASH_TYPE_CRUSH ||
+	       (type & LMV_HASH_TYPE_MASK) == LMV_HASH_TYPE_BUCKET;
 }
 
 /* fixed layout, such directories won't split automatically */
@@ -1064,15 +1067,25 @@ static inline bool lmv_hash_is_migrating(__u32 hash)
 	return (hash & LMV_HASH_FLAG_LAYOUT_CHANGE) == LMV_HASH_FLAG_MIGRATION;
 }
 
+/* SPLIT, MERGE and MIGRATION are all set for "bucket" hash rebalance, which
+ * only changes stripe weights
+ */
+static inline bool lmv_hash_is_rebalancing(__u32 hash)
+{
+	return (hash & LMV_HASH_FLAG_LAYOUT_CHANGE) ==
+	       LMV_HASH_FLAG_LAYOUT_CHANGE;
+}
+
 static inline bool lmv_hash_is_restriping(__u32 hash)
 {
-	return lmv_hash_is_splitting(hash) || lmv_hash_is_merging(hash);
+	return lmv_hash_is_splitting(hash) || lmv_hash_is_merging(hash) ||
+	       lmv_hash_is_rebalancing(hash);
 }
 
 static inline bool lmv_hash_is_layout_changing(__u32 hash)
 {
 	return lmv_hash_is_splitting(hash) || lmv_hash_is_merging(hash) ||
-	       lmv_hash_is_migrating(hash);
+	       lmv_hash_is_migrating(hash) || lmv_hash_is_rebalancing(hash);
 }
 
 struct lustre_foreign_type {
@@ -489,6 +489,13 @@ static int ll_dir_setdirstripe(struct dentry *dparent, struct lmv_user_md *lump,
 	    !OBD_FAIL_CHECK(OBD_FAIL_LLITE_NO_CHECK_DEAD))
 		RETURN(-ENOENT);
 
+	/* MDS without 'bucket' hash support can't calculate stripe weights,
+	 * switch to 'crush', which places names in a similar way.
+	 */
+	if (!(exp_connect_flags2(sbi->ll_md_exp) & OBD_CONNECT2_BUCKET_HASH))
+		lump->lum_hash_type =
+			lmv_hash_bucket_to_crush(lump->lum_hash_type);
+
 	/* MDS < 2.14 doesn't support 'crush' hash type, and cannot handle
 	 * unknown hash if client doesn't set a valid one. switch to fnv_1a_64.
 	 */
@@ -165,6 +165,7 @@ lsm_name_to_stripe_info(const struct lmv_stripe_md *lsm, const char *name,
 						  lsm->lsm_md_stripe_count,
 						  lsm->lsm_md_migrate_hash,
 						  lsm->lsm_md_migrate_offset,
+						  lsm->lsm_md_bucket_weights,
 						  name, namelen, new_layout);
 	if (stripe_index < 0)
 		return ERR_PTR(stripe_index);
@@ -3344,6 +3344,7 @@ static int lmv_unpack_md_v1(struct obd_export *exp, struct lmv_stripe_md *lsm,
 	lsm->lsm_md_layout_version = le32_to_cpu(lmm1->lmv_layout_version);
 	lsm->lsm_md_migrate_offset = le32_to_cpu(lmm1->lmv_migrate_offset);
 	lsm->lsm_md_migrate_hash = le32_to_cpu(lmm1->lmv_migrate_hash);
+	lsm->lsm_md_bucket_weights = le64_to_cpu(lmm1->lmv_bucket_weights);
 	cplen = strlcpy(lsm->lsm_md_pool_name, lmm1->lmv_pool_name,
 			sizeof(lsm->lsm_md_pool_name));
 
@@ -1266,6 +1266,7 @@ static int lod_fid_alloc(const struct lu_env *env, struct lu_device *d,
 						 lo->ldo_dir_stripe_count,
 						 lo->ldo_dir_migrate_hash,
 						 lo->ldo_dir_migrate_offset,
+						 lo->ldo_dir_bucket_weights,
 						 name->ln_name,
 						 name->ln_namelen, true);
 		if (idx < 0)
@@ -2073,17 +2074,18 @@ static struct lu_device_type lod_device_type = {
 /**
  * Implementation of obd_ops::o_get_info() for LOD
  *
- * Currently, there is only one supported key: KEY_OSP_CONNECTED , to provide
- * the caller binary status whether LOD has seen connection to any OST target.
- * It will also check if the MDT update log context being initialized (if
- * needed).
+ * KEY_OSP_CONNECTED provides the caller binary status whether LOD has seen
+ * connection to any OST target. It will also check if the MDT update log
+ * context being initialized (if needed).
+ * KEY_POOL_TIER returns the tiering policy of an OST pool, see
+ * lod_pool_tier_get().
  *
  * \param[in] env		LU environment provided by the caller
  * \param[in] exp		export of the caller
  * \param[in] keylen		len of the key
  * \param[in] key		the key
- * \param[in] vallen		not used
- * \param[in] val		not used
+ * \param[in] vallen		size of \a val for KEY_POOL_TIER
+ * \param[in,out] val		struct pool_tier_info for KEY_POOL_TIER
  *
  * \retval			0 if a connection was seen
  * \retval			-EAGAIN if LOD isn't running yet or no
@@ -2144,6 +2146,15 @@ static int lod_obd_get_info(const struct lu_env *env, struct obd_export *exp,
 		lod_putref(d, &d->lod_mdt_descs);
 
 		RETURN(rc);
+	} else if (KEY_IS(KEY_POOL_TIER)) {
+		struct obd_device *obd = exp->exp_obd;
+
+		if (!obd->obd_set_up || obd->obd_stopping)
+			RETURN(-EAGAIN);
+		if (!vallen || *vallen != sizeof(struct pool_tier_info))
+			RETURN(-EINVAL);
+
+		rc = lod_pool_tier_get(lu2lod_dev(obd->obd_lu_dev), val);
 	}
 
 	RETURN(rc);
@@ -69,8 +69,13 @@ struct pool_desc {
 	unsigned int		 pool_spill_threshold_pct;
 	atomic_t		 pool_spill_hit;
 	char			 pool_spill_target[LOV_MAXPOOLNAME + 1];
+	/* cold files are moved from this pool to pool_tier_target */
+	char			 pool_tier_target[LOV_MAXPOOLNAME + 1];
+	__u64			 pool_tier_heat;
 };
 
+#define LOD_POOL_TIER_HEAT_DEFAULT	16
+
 struct lod_device;
 int lod_pool_hash_init(struct rhashtable *tbl);
 void lod_pool_hash_destroy(struct rhashtable *tbl);
@@ -273,6 +278,8 @@ struct lod_object {
 			__u32		ldo_dir_migrate_offset;
 			__u32		ldo_dir_migrate_hash;
 			__u32		ldo_dir_layout_version;
+			/* stripe weights of "bucket" hash */
+			__u64		ldo_dir_bucket_weights;
 			/* Is a slave stripe of striped directory? */
 			__u32		ldo_dir_slave_stripe:1,
 					ldo_dir_striped:1,
@@ -467,6 +474,16 @@ static inline struct lod_device *dt2lod_dev(struct dt_device *d)
 	return container_of(d, struct lod_device, lod_dt_dev);
 }
 
+/* "bucket" hash directories can't be accessed by clients without
+ * OBD_CONNECT2_BUCKET_HASH, don't create them while such clients are connected
+ */
+static inline bool lod_bucket_hash_allowed(struct lod_device *d)
+{
+	struct lu_target *lut = lod2lu_dev(d)->ld_site->ls_tgt;
+
+	return !lut || !atomic_read(&lut->lut_bucket_unaware_clients);
+}
+
 static inline struct lod_object *lu2lod_obj(struct lu_object *o)
 {
 	LASSERT(ergo(o != NULL, lu_device_is_lod(o->lo_dev)));
@@ -728,6 +745,8 @@ int lod_mdt_alloc_qos(const struct lu_env *env, struct lod_object *lo,
 int lod_mdt_alloc_rr(const struct lu_env *env, struct lod_object *lo,
 		     struct dt_object **stripes, u32 stripe_idx,
 		     u32 stripe_count);
+__u64 lod_mdt_bucket_weights(const struct lu_env *env, struct lod_object *lo,
+			     __u64 weights, __u32 start, __u32 end);
 int lod_prepare_create(const struct lu_env *env, struct lod_object *lo,
 		       struct lu_attr *attr, const struct lu_buf *buf,
 		       struct thandle *th);
@@ -839,5 +858,6 @@ void lod_check_and_spill_pool(const struct lu_env *env, struct lod_device *lod,
 			      char **poolname);
 void lod_spill_target_refresh(const struct lu_env *env, struct lod_device *lod,
 			      struct pool_desc *pool);
+int lod_pool_tier_get(struct lod_device *lod, struct pool_tier_info *pti);
 extern struct lprocfs_vars lprocfs_lod_spill_vars[];
 #endif
@@ -195,7 +195,9 @@ int lod_add_device(const struct lu_env *env, struct lod_device *lod,
 					   OBD_CONNECT_VERSION |
 					   OBD_CONNECT_PINGLESS |
 					   OBD_CONNECT_LFSCK |
-					   OBD_CONNECT_BULK_MBITS;
+					   OBD_CONNECT_BULK_MBITS |
+					   OBD_CONNECT_FLAGS2;
+		data->ocd_connect_flags2 = OBD_CONNECT2_BATCH_DESTROY;
 
 		data->ocd_group = tgt_index;
 		ltd = &lod->lod_ost_descs;
@@ -398,6 +398,7 @@ static int lod_striped_lookup(const struct lu_env *env, struct dt_object *dt,
 						   lo->ldo_dir_stripe_count,
 						   lo->ldo_dir_migrate_hash,
 						   lo->ldo_dir_migrate_offset,
+						   lo->ldo_dir_bucket_weights,
 						   name, strlen(name), true);
 		if (index < 0)
 			return index;
@@ -1766,6 +1767,7 @@ static int lod_prep_lmv_md(const struct lu_env *env, struct dt_object *dt,
 	lmm1->lmv_stripe_count = cpu_to_le32(stripe_count);
 	lmm1->lmv_hash_type = cpu_to_le32(lo->ldo_dir_hash_type);
 	lmm1->lmv_layout_version = cpu_to_le32(lo->ldo_dir_layout_version);
+	lmm1->lmv_bucket_weights = cpu_to_le64(lo->ldo_dir_bucket_weights);
 	if (lod_is_layout_changing(lo)) {
 		lmm1->lmv_migrate_hash = cpu_to_le32(lo->ldo_dir_migrate_hash);
 		lmm1->lmv_migrate_offset =
@@ -1874,6 +1876,7 @@ out:
 	lo->ldo_dir_migrate_offset = le32_to_cpu(lmv1->lmv_migrate_offset);
 	lo->ldo_dir_migrate_hash = le32_to_cpu(lmv1->lmv_migrate_hash);
 	lo->ldo_dir_hash_type = le32_to_cpu(lmv1->lmv_hash_type);
+	lo->ldo_dir_bucket_weights = le64_to_cpu(lmv1->lmv_bucket_weights);
 	if (rc != 0)
 		lod_striping_free_nolock(env, lo);
 
@@ -2281,6 +2284,18 @@ static int lod_prep_md_striped_create(const struct lu_env *env,
 	smp_mb();
 	lo->ldo_dir_stripe_loaded = 1;
 
+	lo->ldo_dir_bucket_weights = 0;
+	if (lmv_hash_is_bucket(lo->ldo_dir_hash_type)) {
+		if (lo->ldo_dir_stripe_count > LMV_BUCKET_STRIPES_MAX ||
+		    !lod_bucket_hash_allowed(lod))
+			lo->ldo_dir_hash_type =
+				lmv_hash_bucket_to_crush(lo->ldo_dir_hash_type);
+		else
+			lo->ldo_dir_bucket_weights =
+				lod_mdt_bucket_weights(env, lo, 0, 0,
+						lo->ldo_dir_stripe_count);
+	}
+
 	rc = lod_dir_declare_create_stripes(env, dt, attr, dof, th);
 	if (rc < 0)
 		lod_striping_free(env, lo);
@@ -2400,7 +2415,6 @@ static int lod_dir_layout_set(const struct lu_env *env,
 {
 	struct dt_object *next = dt_object_child(dt);
 	struct lod_object *lo = lod_dt_obj(dt);
-	struct lod_device *lod = lu2lod_dev(lod2lu_obj(lo)->lo_dev);
 	struct lmv_mds_md_v1 *lmv = buf->lb_buf;
 	struct lmv_mds_md_v1 *slave_lmv;
 	struct lu_buf slave_buf;
@@ -2412,13 +2426,6 @@ static int lod_dir_layout_set(const struct lu_env *env,
 	if (!lmv_is_sane2(lmv))
 		RETURN(-EINVAL);
 
-	/* adjust hash for dir merge, which may not be set in user command */
-	if (lmv_is_merging(lmv) &&
-	    !(lmv->lmv_migrate_hash & LMV_HASH_TYPE_MASK))
-		lmv->lmv_merge_hash |=
-			lod->lod_mdt_descs.ltd_lmv_desc.ld_pattern &
-			LMV_HASH_TYPE_MASK;
-
 	LMV_DEBUG(D_INFO, lmv, "set");
 
 	rc = lod_sub_xattr_set(env, next, buf, XATTR_NAME_LMV, fl, th);
@@ -2433,6 +2440,7 @@ static int lod_dir_layout_set(const struct lu_env *env,
 	lo->ldo_dir_migrate_offset = le32_to_cpu(lmv->lmv_migrate_offset);
 	lo->ldo_dir_migrate_hash = le32_to_cpu(lmv->lmv_migrate_hash);
 	lo->ldo_dir_layout_version = le32_to_cpu(lmv->lmv_layout_version);
+	lo->ldo_dir_bucket_weights = le64_to_cpu(lmv->lmv_bucket_weights);
 
 	OBD_ALLOC_PTR(slave_lmv);
 	if (!slave_lmv)
@@ -2460,6 +2468,79 @@ static int lod_dir_layout_set(const struct lu_env *env,
 	RETURN(rc);
 }
 
+/**
+ * Prepare hash type and stripe weights for directory merge and rebalance.
+ *
+ * Merge hash may not be set in user command, and it uses the default. If it's
+ * "bucket" hash, it needs stripe weights of the target stripes, unless the
+ * directory is "bucket" hash already, in which case the target stripes keep
+ * their weights. Rebalance calculates stripe weights of all stripes by the
+ * current MDT load, while the old weights are kept in the LMV to find sub
+ * files which are not migrated yet. The result is stored in \a lmv, which is
+ * set by lod_dir_layout_set() later.
+ *
+ * \param[in] env	execution environment
+ * \param[in] lo	directory object with stripes loaded
+ * \param[in] lmv	LMV to set
+ *
+ * \retval		0 on success
+ * \retval		-EALREADY if rebalance doesn't change stripe weights
+ * \retval		negative if failed
+ */
+static int lod_dir_declare_layout_weights(const struct lu_env *env,
+					  struct lod_object *lo,
+					  struct lmv_mds_md_v1 *lmv)
+{
+	struct lod_device *lod = lu2lod_dev(lod2lu_obj(lo)->lo_dev);
+	__u32 hash_type = le32_to_cpu(lmv->lmv_hash_type);
+	__u32 merge_hash;
+	__u32 count;
+	__u64 weights;
+
+	if (le32_to_cpu(lmv->lmv_magic) != LMV_MAGIC_V1 ||
+	    !lo->ldo_dir_stripe_count)
+		return 0;
+
+	if (lmv_hash_is_merging(hash_type)) {
+		merge_hash = le32_to_cpu(lmv->lmv_merge_hash);
+		if (!(merge_hash & LMV_HASH_TYPE_MASK))
+			merge_hash |= LMV_HASH_TYPE_MASK &
+				lod->lod_mdt_descs.ltd_lmv_desc.ld_pattern;
+
+		count = le32_to_cpu(lmv->lmv_merge_offset);
+		if (lmv_hash_is_bucket(merge_hash) &&
+		    !lmv_hash_is_bucket(hash_type)) {
+			if (count > LMV_BUCKET_STRIPES_MAX ||
+			    !lod_bucket_hash_allowed(lod))
+				merge_hash =
+					lmv_hash_bucket_to_crush(merge_hash);
+			else
+				lmv->lmv_bucket_weights = cpu_to_le64(
+					lod_mdt_bucket_weights(env, lo, 0, 0,
+							       count));
+		}
+		lmv->lmv_merge_hash = cpu_to_le32(merge_hash);
+
+		return 0;
+	}
+
+	if (!lmv_hash_is_rebalancing(hash_type))
+		return 0;
+
+	if (!lmv_hash_is_bucket(hash_type) ||
+	    lo->ldo_dir_stripe_count > LMV_BUCKET_STRIPES_MAX)
+		return -EINVAL;
+
+	weights = lod_mdt_bucket_weights(env, lo, 0, 0,
+					 lo->ldo_dir_stripe_count);
+	if (weights == lo->ldo_dir_bucket_weights)
+		return -EALREADY;
+
+	lmv->lmv_bucket_weights = cpu_to_le64(weights);
+
+	return 0;
+}
+
 /**
  * Implementation of dt_object_operations::do_declare_xattr_set.
  *
@@ -2495,6 +2576,15 @@ static int lod_dir_declare_xattr_set(const struct lu_env *env,
 		rc = lod_verify_striping(env, d, lo, buf, false);
 		if (rc != 0)
 			RETURN(rc);
+	} else if (strcmp(name, XATTR_NAME_LMV) == 0 &&
+		   buf->lb_len >= sizeof(struct lmv_mds_md_v1)) {
+		rc = lod_striping_load(env, lo);
+		if (rc != 0)
+			RETURN(rc);
+
+		rc = lod_dir_declare_layout_weights(env, lo, buf->lb_buf);
+		if (rc != 0)
+			RETURN(rc);
 	}
 
 	rc = lod_sub_declare_xattr_set(env, next, buf, name, fl, th);
@@ -8238,6 +8328,7 @@ static int lod_dir_declare_layout_attach(const struct lu_env *env,
 	struct lu_name *sname;
 	struct linkea_data ldata = { NULL };
 	struct lu_buf linkea_buf;
+	__u64 src_weights;
 	__u32 idx;
 	int i;
 	int rc;
@@ -8348,6 +8439,20 @@ static int lod_dir_declare_layout_attach(const struct lu_env *env,
 	lo->ldo_stripe = stripes;
 	lo->ldo_dir_migrate_offset = lo->ldo_dir_stripe_count;
 	lo->ldo_dir_migrate_hash = le32_to_cpu(lmv->lmv_hash_type);
+	/* source stripe weights follow target's if target is "bucket" hash,
+	 * and if they don't fit, target falls back to CRUSH.
+	 */
+	src_weights = le64_to_cpu(lmv->lmv_bucket_weights);
+	if (lmv_hash_is_bucket(lo->ldo_dir_hash_type) && src_weights &&
+	    lo->ldo_dir_stripe_count + stripe_count > LMV_BUCKET_STRIPES_MAX)
+		lo->ldo_dir_hash_type =
+			lmv_hash_bucket_to_crush(lo->ldo_dir_hash_type);
+	if (!lmv_hash_is_bucket(lo->ldo_dir_hash_type))
+		lo->ldo_dir_bucket_weights = src_weights;
+	else if (src_weights)
+		lo->ldo_dir_bucket_weights |=
+			src_weights << (lo->ldo_dir_stripe_count *
+					LMV_BUCKET_WEIGHT_BITS);
 	lo->ldo_dir_stripe_count += stripe_count;
 	lo->ldo_dir_stripes_allocated += stripe_count;
 
@@ -8554,6 +8659,7 @@ static int lod_dir_declare_layout_split(const struct lu_env *env,
 	struct dt_object **stripes;
 	u32 stripe_count;
 	u32 saved_count;
+	u32 start;
 	int i;
 	int rc;
 
@@ -8598,6 +8704,26 @@ static int lod_dir_declare_layout_split(const struct lu_env *env,
 	if (!lmv_is_known_hash_type(lo->ldo_dir_hash_type))
 		lo->ldo_dir_hash_type =
 			lod->lod_mdt_descs.ltd_lmv_desc.ld_pattern;
+	/* stripe weights of old layout are kept if it's "bucket" hash, and new
+	 * stripes are weighted by MDT load if new layout is "bucket" hash.
+	 */
+	if (lmv_hash_is_bucket(lo->ldo_dir_split_hash)) {
+		start = saved_count;
+	} else {
+		start = 0;
+		lo->ldo_dir_bucket_weights = 0;
+		if (!lod_bucket_hash_allowed(lod))
+			lo->ldo_dir_hash_type =
+				lmv_hash_bucket_to_crush(lo->ldo_dir_hash_type);
+	}
+	if (lo->ldo_dir_stripe_count > LMV_BUCKET_STRIPES_MAX)
+		lo->ldo_dir_hash_type =
+			lmv_hash_bucket_to_crush(lo->ldo_dir_hash_type);
+	if (lmv_hash_is_bucket(lo->ldo_dir_hash_type))
+		lo->ldo_dir_bucket_weights =
+			lod_mdt_bucket_weights(env, lo,
+					       lo->ldo_dir_bucket_weights,
+					       start, lo->ldo_dir_stripe_count);
 	lo->ldo_dir_hash_type |= LMV_HASH_FLAG_SPLIT | LMV_HASH_FLAG_MIGRATION;
 	lo->ldo_dir_split_offset = saved_count;
 	lo->ldo_dir_layout_version++;
@@ -8700,6 +8826,8 @@ static int lod_dir_layout_shrink(const struct lu_env *env,
 	struct dt_object *dto;
 	struct lu_buf *lmv_buf = &info->lti_buf;
 	struct lmv_mds_md_v1 *lmv = &info->lti_lmv.lmv_md_v1;
+	__u64 weights;
+	__u32 hash_type;
 	u32 mdtidx;
 	int type = LU_SEQ_RANGE_ANY;
 	int i;
@@ -8711,15 +8839,25 @@ static int lod_dir_layout_shrink(const struct lu_env *env,
 
 	lmv_buf->lb_buf = lmv;
 	lmv_buf->lb_len = sizeof(*lmv);
+	/* hash type after merge is in merge hash */
+	if (lmv_hash_is_merging(lo->ldo_dir_hash_type))
+		hash_type = lo->ldo_dir_migrate_hash;
+	else
+		hash_type = lo->ldo_dir_hash_type;
+	hash_type &= LMV_HASH_TYPE_MASK | LMV_HASH_FLAG_FIXED;
+
 	lmv->lmv_magic = cpu_to_le32(LMV_MAGIC_STRIPE);
 	lmv->lmv_stripe_count = cpu_to_le32(final_stripe_count);
-	lmv->lmv_hash_type = cpu_to_le32(lo->ldo_dir_hash_type) &
-			     cpu_to_le32(LMV_HASH_TYPE_MASK |
-					 LMV_HASH_FLAG_FIXED);
+	lmv->lmv_hash_type = cpu_to_le32(hash_type);
 	lmv->lmv_layout_version =
 			cpu_to_le32(lo->ldo_dir_layout_version + 1);
 	lmv->lmv_migrate_offset = 0;
 	lmv->lmv_migrate_hash = 0;
+	/* remaining stripes keep their weights */
+	weights = lo->ldo_dir_bucket_weights &
+		  lmv_bucket_weights_mask(final_stripe_count);
+	lmv->lmv_bucket_weights =
+		cpu_to_le64(lmv_hash_is_bucket(hash_type) ? weights : 0);
 
 	for (i = 0; i < lo->ldo_dir_stripe_count; i++) {
 		dto = lo->ldo_stripe[i];
@@ -436,6 +436,8 @@ int lod_pool_new(struct obd_device *obd, char *poolname)
 	new_pool->pool_spill_threshold_pct = 0;
 	new_pool->pool_spill_target[0] = '\0';
 	atomic_set(&new_pool->pool_spill_hit, 0);
+	new_pool->pool_tier_target[0] = '\0';
+	new_pool->pool_tier_heat = LOD_POOL_TIER_HEAT_DEFAULT;
 	new_pool->pool_lobd = obd;
 	atomic_set(&new_pool->pool_refcount, 1);
 	rc = lu_tgt_pool_init(&new_pool->pool_obds, 0);
@@ -814,3 +816,52 @@ repeat:
 
 	lod_pool_putref(pool);
 }
+
+/**
+ * Get the tiering policy of the pools next to pool \a pti->pti_pool.
+ *
+ * A pool with a tier target sends its cold files to that target pool, so
+ * the cold files of pti_pool go to its own tier target, while hot files of
+ * pti_pool go back to the pool which has pti_pool as its tier target.
+ *
+ * \param[in] lod	LOD device
+ * \param[in,out] pti	pool of the file in, demote/promote policy out
+ *
+ * \retval		0 if pti_pool has a demote or promote target
+ * \retval		-ENOENT if pti_pool is not part of a tiering policy
+ */
+int lod_pool_tier_get(struct lod_device *lod, struct pool_tier_info *pti)
+{
+	struct obd_device *obd = lod2obd(lod);
+	struct pool_desc *pool;
+
+	pti->pti_demote[0] = '\0';
+	pti->pti_promote[0] = '\0';
+	pti->pti_pool[LOV_MAXPOOLNAME] = '\0';
+
+	pool = lod_pool_find(lod, pti->pti_pool);
+	if (pool) {
+		if (pool->pool_tier_target[0] != '\0') {
+			strlcpy(pti->pti_demote, pool->pool_tier_target,
+				sizeof(pti->pti_demote));
+			pti->pti_demote_heat = pool->pool_tier_heat;
+		}
+		lod_pool_putref(pool);
+	}
+
+	spin_lock(&obd->obd_dev_lock);
+	list_for_each_entry(pool, &lod->lod_pool_list, pool_list) {
+		if (strcmp(pool->pool_tier_target, pti->pti_pool) == 0) {
+			strlcpy(pti->pti_promote, pool->pool_name,
+				sizeof(pti->pti_promote));
+			pti->pti_promote_heat = pool->pool_tier_heat;
+			break;
+		}
+	}
+	spin_unlock(&obd->obd_dev_lock);
+
+	if (pti->pti_demote[0] == '\0' && pti->pti_promote[0] == '\0')
+		return -ENOENT;
+
+	return 0;
+}
@@ -43,6 +43,7 @@
 #include <uapi/linux/lustre/lustre_idl.h>
 #include <lustre_swab.h>
 #include <obd_class.h>
+#include <lustre_lmv.h>
 
 #include "lod_internal.h"
 
@@ -202,6 +203,7 @@ void lod_qos_statfs_update(const struct lu_env *env, struct lod_device *lod,
 	struct lu_tgt_desc *tgt;
 	time64_t max_age;
 	u64 avail;
+	u32 latency, inflight;
 	ENTRY;
 
 	max_age = ktime_get_seconds() - 2 * ltd->ltd_lov_desc.ld_qos_maxage;
@@ -221,10 +223,15 @@ void lod_qos_statfs_update(const struct lu_env *env, struct lod_device *lod,
 	lod_getref(ltd);
 	ltd_foreach_tgt(ltd, tgt) {
 		avail = tgt->ltd_statfs.os_bavail;
+		latency = tgt->ltd_statfs.os_io_latency;
+		inflight = tgt->ltd_statfs.os_io_inflight;
 		if (lod_statfs_and_check(env, lod, ltd, tgt, 0))
 			continue;
 
-		if (tgt->ltd_statfs.os_bavail != avail)
+		if (tgt->ltd_statfs.os_bavail != avail ||
+		    (ltd->ltd_qos.lq_prio_load &&
+		     (tgt->ltd_statfs.os_io_latency != latency ||
+		      tgt->ltd_statfs.os_io_inflight != inflight)))
 			/* recalculate weigths */
 			set_bit(LQ_DIRTY, &ltd->ltd_qos.lq_flags);
 	}
@@ -1849,6 +1856,114 @@ unlock:
 	RETURN(rc);
 }
 
+/**
+ * Calculate stripe weights of a striped directory with "bucket" hash.
+ *
+ * Each stripe is weighted by the QoS weight of the MDT it is located on, which
+ * counts in free space, free inodes and the penalties of recent allocations,
+ * the same as lod_mdt_alloc_qos() uses to choose MDTs for new directories.
+ * The weights are scaled to [1, LMV_BUCKET_WEIGHT_MAX], so the most loaded MDT
+ * still gets sub files. If MDTs are balanced, all stripes get the same weight.
+ *
+ * Sub files of the stripes below \a start are placed by \a weights in the old
+ * layout of directory split, so these stripes keep their weights, or if they
+ * are spread evenly, they get the same weight, which places names the same
+ * way.
+ *
+ * \param[in] env	execution environment for this thread
+ * \param[in] lo	LOD object with stripes allocated
+ * \param[in] weights	current stripe weights
+ * \param[in] start	the first stripe to calculate weight for
+ * \param[in] end	stripe count of the new layout
+ *
+ * \retval		stripe weights in the format of lmv_bucket_weights
+ */
+__u64 lod_mdt_bucket_weights(const struct lu_env *env, struct lod_object *lo,
+			     __u64 weights, __u32 start, __u32 end)
+{
+	struct lod_device *lod = lu2lod_dev(lo->ldo_obj.do_lu.lo_dev);
+	struct lu_tgt_descs *ltd = &lod->lod_mdt_descs;
+	u64 tgt_weight[LMV_BUCKET_STRIPES_MAX] = { 0 };
+	u64 max_weight = 0;
+	u64 unit;
+	u32 old_total = 0;
+	u32 total = 0;
+	u32 fill = 0;
+	u32 w;
+	struct lu_tgt_desc *mdt;
+	u32 mdt_idx;
+	int type = LU_SEQ_RANGE_MDT;
+	int i;
+	int rc;
+
+	ENTRY;
+
+	LASSERT(start <= end && end <= LMV_BUCKET_STRIPES_MAX &&
+		end <= lo->ldo_dir_stripe_count);
+
+	if (ltd_qos_is_usable(ltd)) {
+		down_write(&ltd->ltd_qos.lq_rw_sem);
+		rc = ltd_qos_penalties_calc(ltd);
+		for (i = 0; !rc && i < end; i++) {
+			if (!lo->ldo_stripe[i])
+				continue;
+
+			rc = lod_fld_lookup(env, lod,
+				lu_object_fid(&lo->ldo_stripe[i]->do_lu),
+				&mdt_idx, &type);
+			if (rc)
+				break;
+
+			if (!test_bit(mdt_idx, ltd->ltd_tgt_bitmap))
+				continue;
+
+			mdt = LTD_TGT(ltd, mdt_idx);
+			lu_tgt_qos_weight_calc(mdt);
+			tgt_weight[i] = mdt->ltd_qos.ltq_weight;
+			max_weight = max(max_weight, tgt_weight[i]);
+		}
+		up_write(&ltd->ltd_qos.lq_rw_sem);
+		if (rc)
+			max_weight = 0;
+	}
+
+	/* QoS weight is the product of free space and inodes, scale it down by
+	 * division to avoid overflow. If it's 0, MDTs are balanced.
+	 */
+	unit = max_t(u64, div_u64(max_weight, LMV_BUCKET_WEIGHT_MAX), 1);
+	for (i = 0; i < end && max_weight; i++)
+		tgt_weight[i] = clamp_t(u64, div64_u64(tgt_weight[i], unit), 1,
+					LMV_BUCKET_WEIGHT_MAX);
+
+	for (i = 0; i < start; i++)
+		old_total += lmv_bucket_weight(weights, i);
+
+	for (i = 0; i < start; i++) {
+		if (old_total)
+			tgt_weight[i] = lmv_bucket_weight(weights, i);
+		total += tgt_weight[i];
+	}
+
+	/* old stripes spread evenly get the same weight, and new stripes get
+	 * the average weight of old stripes if MDTs are balanced.
+	 */
+	if (total)
+		fill = max_t(u32, total / start, 1);
+
+	weights = 0;
+	for (i = 0; i < end; i++) {
+		w = tgt_weight[i];
+		if ((i < start && !old_total) || !w)
+			w = fill;
+		weights |= (__u64)w << (i * LMV_BUCKET_WEIGHT_BITS);
+	}
+
+	CDEBUG(D_LAYOUT, "%s: "DFID" bucket weights %#llx\n",
+	       lod2obd(lod)->obd_name, PFID(lod_object_fid(lo)), weights);
+
+	RETURN(weights);
+}
+
 /**
  * Check stripe count the caller can use.
  *
@@ -32,6 +32,7 @@
 
 #include <lprocfs_status.h>
 #include <obd_class.h>
+#include <lustre_lmv.h>
 #include <linux/seq_file.h>
 #include "lod_internal.h"
 #include <uapi/linux/lustre/lustre_param.h>
@@ -664,6 +665,67 @@ static ssize_t qos_prio_free_store(struct kobject *kobj, struct attribute *attr,
 LUSTRE_RW_ATTR(mdt_qos_prio_free);
 LUSTRE_RW_ATTR(qos_prio_free);
 
+/**
+ * Show QoS I/O load priority parameter.
+ *
+ * The QoS I/O load parameter controls how much the weight of an OST busier
+ * than the pool average is reduced, based on the I/O queue depth and service
+ * time the OST reports in statfs.  0% (the default) ignores the OST load,
+ * 100% stops allocating on an OST whose load is far above the average.
+ */
+static ssize_t qos_prio_load_show(struct kobject *kobj,
+				  struct attribute *attr, char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct lod_device *lod = dt2lod_dev(dt);
+
+	return scnprintf(buf, PAGE_SIZE, "%d%%\n",
+			 (lod->lod_ost_descs.ltd_qos.lq_prio_load * 100 +
+			  255) >> 8);
+}
+
+/**
+ * Set QoS I/O load priority parameter.
+ *
+ * A busy OST also makes the OSTs count as imbalanced, so QoS allocation is
+ * used even if the OSTs have the same free space.  See qos_prio_load_show().
+ */
+static ssize_t qos_prio_load_store(struct kobject *kobj, struct attribute *attr,
+				   const char *buffer, size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct lod_device *lod = dt2lod_dev(dt);
+	struct lu_tgt_descs *ltd = &lod->lod_ost_descs;
+	char buf[6], *tmp;
+	unsigned int val;
+	int rc;
+
+	/* "100%\n\0" should be largest string */
+	if (count >= sizeof(buf))
+		return -ERANGE;
+
+	strncpy(buf, buffer, sizeof(buf));
+	buf[sizeof(buf) - 1] = '\0';
+	tmp = strchr(buf, '%');
+	if (tmp)
+		*tmp = '\0';
+
+	rc = kstrtouint(buf, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val > 100)
+		return -EINVAL;
+
+	ltd->ltd_qos.lq_prio_load = (val << 8) / 100;
+	set_bit(LQ_DIRTY, &ltd->ltd_qos.lq_flags);
+
+	return count;
+}
+LUSTRE_RW_ATTR(qos_prio_load);
+
 /**
  * Show threshold for "same space on all OSTs" rule.
  */
@@ -1079,11 +1141,16 @@ static ssize_t mdt_hash_store(struct kobject *kobj, struct attribute *attr,
 	len = strcspn(hash, "\n ");
 	hash[len] = '\0';
 	for (i = LMV_HASH_TYPE_ALL_CHARS; i < LMV_HASH_TYPE_MAX; i++) {
-		if (!strcmp(hash, mdt_hash_name[i])) {
-			lod->lod_mdt_descs.ltd_lmv_desc.ld_pattern = i;
-			kfree(hash);
-			return count;
-		}
+		if (strcmp(hash, mdt_hash_name[i]))
+			continue;
+
+		kfree(hash);
+		/* clients connected can't access "bucket" hash directory */
+		if (lmv_hash_is_bucket(i) && !lod_bucket_hash_allowed(lod))
+			return -EOPNOTSUPP;
+
+		lod->lod_mdt_descs.ltd_lmv_desc.ld_pattern = i;
+		return count;
 	}
 	kfree(hash);
 
@@ -1215,6 +1282,91 @@ static int lod_spill_hit_seq_show(struct seq_file *m, void *v)
 }
 LPROC_SEQ_FOPS_RO(lod_spill_hit);
 
+static int lod_tier_target_seq_show(struct seq_file *m, void *v)
+{
+	struct pool_desc *pool = m->private;
+
+	LASSERT(pool != NULL);
+	seq_printf(m, "%s\n", pool->pool_tier_target);
+
+	return 0;
+}
+
+/*
+ * Set the pool where the MDT tiering policy moves the cold files of this
+ * pool, and from where it moves hot files back.  An empty string disables
+ * tiering for this pool.
+ */
+static ssize_t
+lod_tier_target_seq_write(struct file *file, const char __user *buffer,
+			  size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct pool_desc *pool = m->private;
+	char target[LOV_MAXPOOLNAME + 1];
+	struct lod_device *lod;
+	char *str;
+
+	LASSERT(pool != NULL);
+	lod = lu2lod_dev(pool->pool_lobd->obd_lu_dev);
+
+	if (count > LOV_MAXPOOLNAME)
+		return -E2BIG;
+	if (copy_from_user(target, buffer, count))
+		return -EFAULT;
+	target[count] = '\0';
+	str = strim(target);
+
+	if (*str == '\0') {
+		pool->pool_tier_target[0] = '\0';
+		return count;
+	}
+	if (strcmp(pool->pool_name, str) == 0)
+		return -ELOOP;
+	if (!lod_pool_exists(lod, str))
+		return -ENODEV;
+
+	strlcpy(pool->pool_tier_target, str, sizeof(pool->pool_tier_target));
+
+	return count;
+}
+LPROC_SEQ_FOPS(lod_tier_target);
+
+static int lod_tier_heat_seq_show(struct seq_file *m, void *v)
+{
+	struct pool_desc *pool = m->private;
+
+	LASSERT(pool != NULL);
+	seq_printf(m, "%llu\n", pool->pool_tier_heat);
+
+	return 0;
+}
+
+/*
+ * Set the open heat under which a file of this pool is cold. A file in the
+ * tier target pool is moved back once its heat reaches twice this value.
+ */
+static ssize_t
+lod_tier_heat_seq_write(struct file *file, const char __user *buffer,
+			size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct pool_desc *pool = m->private;
+	u64 val;
+	int rc;
+
+	LASSERT(pool != NULL);
+
+	rc = kstrtoull_from_user(buffer, count, 0, &val);
+	if (rc)
+		return rc;
+
+	pool->pool_tier_heat = val;
+
+	return count;
+}
+LPROC_SEQ_FOPS(lod_tier_heat);
+
 struct lprocfs_vars lprocfs_lod_spill_vars[] = {
 	{ .name	=	"spill_threshold_pct",
 	  .fops	=	&lod_spill_threshold_pct_fops },
@@ -1224,6 +1376,10 @@ struct lprocfs_vars lprocfs_lod_spill_vars[] = {
 	  .fops	=	&lod_spill_is_active_fops },
 	{ .name	=	"spill_hit",
 	  .fops	=	&lod_spill_hit_fops },
+	{ .name	=	"tier_target",
+	  .fops	=	&lod_tier_target_fops },
+	{ .name	=	"tier_heat",
+	  .fops	=	&lod_tier_heat_fops },
 	{ NULL }
 };
 
@@ -1252,6 +1408,7 @@ static struct attribute *lod_attrs[] = {
 	&lustre_attr_numobd.attr,
 	&lustre_attr_qos_maxage.attr,
 	&lustre_attr_qos_prio_free.attr,
+	&lustre_attr_qos_prio_load.attr,
 	&lustre_attr_qos_threshold_rr.attr,
 	&lustre_attr_mdt_stripecount.attr,
 	&lustre_attr_mdt_stripetype.attr,
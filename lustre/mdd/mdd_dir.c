@@ -3384,7 +3384,7 @@ static int mdd_migrate_sanity_check(const struct lu_env *env,
 		mdd_read_unlock(env, sobj);
 	}
 
-	if (mdd_object_exists(tobj))
+	if (tobj && mdd_object_exists(tobj))
 		RETURN(-EEXIST);
 
 	rc = mdd_may_delete(env, spobj, spattr, sobj, attr, NULL, 1, 0);
@@ -4204,7 +4204,9 @@ static int mdd_migrate_cmd_check(struct mdd_device *mdd,
 	/* TODO: check specific MDTs */
 	if (lum_stripe_count != lmv->lmv_migrate_offset ||
 	    lum->lum_stripe_offset != lmv->lmv_master_mdt_index ||
-	    (lum_hash_type && lum_hash_type != lmv_hash_type)) {
+	    (lum_hash_type &&
+	     !lmv_hash_type_match(le32_to_cpu(lum_hash_type),
+				  le32_to_cpu(lmv_hash_type)))) {
 		CERROR("%s: '"DNAME"' migration was interrupted, run 'lfs migrate -m %d -c %d -H %s "DNAME"' to finish migration.\n",
 			mdd2obd_dev(mdd)->obd_name, PNAME(lname),
 			le32_to_cpu(lmv->lmv_master_mdt_index),
@@ -4404,6 +4406,63 @@ out:
 	return rc;
 }
 
+/*
+ * Locate the source and target parent stripes of \a lname under the striped
+ * directory whose LMV is \a lmv. The caller puts \a spobj and \a tpobj if
+ * they are set, even on failure.
+ *
+ * \retval	0 on success
+ * \retval	-EALREADY if \a lname is already on its target stripe
+ * \retval	-errno on failure
+ */
+static int mdd_migrate_stripes_locate(const struct lu_env *env,
+				      struct mdd_device *mdd,
+				      struct lmv_mds_md_v1 *lmv,
+				      const struct lu_name *lname,
+				      struct mdd_object **spobj,
+				      struct mdd_object **tpobj)
+{
+	struct lu_fid *fid = &mdd_env_info(env)->mdi_fid2;
+	struct mdd_object *obj;
+	int index;
+
+	/* locate target parent stripe */
+	index = lmv_name_to_stripe_index(lmv, lname->ln_name,
+					 lname->ln_namelen);
+	if (index < 0)
+		return index;
+
+	fid_le_to_cpu(fid, &lmv->lmv_stripe_fids[index]);
+	obj = mdd_object_find(env, mdd, fid);
+	if (IS_ERR(obj))
+		return PTR_ERR(obj);
+	*tpobj = obj;
+
+	/* locate source parent stripe */
+	if (!lmv_is_layout_changing(lmv)) {
+		mdd_object_get(obj);
+		*spobj = obj;
+		return 0;
+	}
+
+	index = lmv_name_to_stripe_index_old(lmv, lname->ln_name,
+					     lname->ln_namelen);
+	if (index < 0)
+		return index;
+
+	fid_le_to_cpu(fid, &lmv->lmv_stripe_fids[index]);
+	obj = mdd_object_find(env, mdd, fid);
+	if (IS_ERR(obj))
+		return PTR_ERR(obj);
+	*spobj = obj;
+
+	/* parent stripe unchanged */
+	if (*spobj == *tpobj)
+		return lmv_is_restriping(lmv) ? -EALREADY : -EINVAL;
+
+	return 0;
+}
+
 /**
  * Migrate directory or file between MDTs.
  *
@@ -4423,7 +4482,6 @@ static int mdd_migrate(const struct lu_env *env, struct md_object *md_pobj,
 		       struct md_object *md_tobj, struct md_op_spec *spec,
 		       struct md_attr *ma)
 {
-	struct mdd_thread_info *info = mdd_env_info(env);
 	struct mdd_device *mdd = mdo2mdd(md_pobj);
 	struct mdd_object *pobj = md2mdd_obj(md_pobj);
 	struct mdd_object *sobj = md2mdd_obj(md_sobj);
@@ -4431,7 +4489,6 @@ static int mdd_migrate(const struct lu_env *env, struct md_object *md_pobj,
 	struct mdd_object *spobj = NULL;
 	struct mdd_object *tpobj = NULL;
 	struct lu_buf pbuf = { NULL };
-	struct lu_fid *fid = &info->mdi_fid2;
 	struct lmv_mds_md_v1 *lmv;
 	int rc;
 
@@ -4444,50 +4501,18 @@ static int mdd_migrate(const struct lu_env *env, struct md_object *md_pobj,
 
 	lmv = pbuf.lb_buf;
 	if (lmv) {
-		int index;
-
 		if (!lmv_is_sane(lmv))
 			GOTO(out, rc = -EBADF);
 
-		/* locate target parent stripe */
 		/* fail check here to make sure top dir migration succeed. */
 		if (lmv_is_migrating(lmv) &&
 		    OBD_FAIL_CHECK_RESET(OBD_FAIL_MIGRATE_ENTRIES, 0))
 			GOTO(out, rc = -EIO);
 
-		index = lmv_name_to_stripe_index(lmv, lname->ln_name,
-						 lname->ln_namelen);
-		if (index < 0)
-			GOTO(out, rc = index);
-
-		fid_le_to_cpu(fid, &lmv->lmv_stripe_fids[index]);
-		tpobj = mdd_object_find(env, mdd, fid);
-		if (IS_ERR(tpobj))
-			GOTO(out, rc = PTR_ERR(tpobj));
-
-		/* locate source parent stripe */
-		if (lmv_is_layout_changing(lmv)) {
-			index = lmv_name_to_stripe_index_old(lmv,
-							     lname->ln_name,
-							     lname->ln_namelen);
-			if (index < 0)
-				GOTO(out, rc = index);
-
-			fid_le_to_cpu(fid, &lmv->lmv_stripe_fids[index]);
-			spobj = mdd_object_find(env, mdd, fid);
-			if (IS_ERR(spobj))
-				GOTO(out, rc = PTR_ERR(spobj));
-
-			/* parent stripe unchanged */
-			if (spobj == tpobj) {
-				if (!lmv_is_restriping(lmv))
-					GOTO(out, rc = -EINVAL);
-				GOTO(out, rc = -EALREADY);
-			}
-		} else {
-			spobj = tpobj;
-			mdd_object_get(spobj);
-		}
+		rc = mdd_migrate_stripes_locate(env, mdd, lmv, lname, &spobj,
+						&tpobj);
+		if (rc)
+			GOTO(out, rc);
 	} else {
 		tpobj = pobj;
 		spobj = pobj;
@@ -4509,6 +4534,222 @@ out:
 	return rc;
 }
 
+/* per name state of mdd_migrate_batch() */
+struct mdd_migrate_batch_item {
+	struct mdd_object	*mbi_spobj;
+	struct mdd_object	*mbi_tpobj;
+	struct lu_attr		 mbi_attr;
+	struct lu_attr		 mbi_spattr;
+	struct lu_attr		 mbi_tpattr;
+	struct linkea_data	 mbi_ldata;
+	/* private copy of the linkEA, mdi_link_buf is reused by next name */
+	struct lu_buf		 mbi_linkbuf;
+};
+
+static int mdd_migrate_batch_prep(const struct lu_env *env,
+				  struct mdd_device *mdd,
+				  struct lmv_mds_md_v1 *lmv,
+				  struct mdd_object *sobj,
+				  const struct lu_name *lname,
+				  struct mdd_migrate_batch_item *mbi)
+{
+	struct linkea_data *ldata = &mdd_env_info(env)->mdi_link_data;
+	int rc;
+
+	rc = mdd_migrate_stripes_locate(env, mdd, lmv, lname, &mbi->mbi_spobj,
+					&mbi->mbi_tpobj);
+	if (rc)
+		return rc;
+
+	rc = mdd_la_get(env, sobj, &mbi->mbi_attr);
+	if (rc)
+		return rc;
+
+	/* parents of other links need to be locked by caller */
+	if (!S_ISDIR(mbi->mbi_attr.la_mode) && mbi->mbi_attr.la_nlink > 1)
+		return -EAGAIN;
+
+	rc = mdd_la_get(env, mbi->mbi_spobj, &mbi->mbi_spattr);
+	if (rc)
+		return rc;
+
+	rc = mdd_la_get(env, mbi->mbi_tpobj, &mbi->mbi_tpattr);
+	if (rc)
+		return rc;
+
+	rc = mdd_migrate_sanity_check(env, mdd, mbi->mbi_spobj,
+				      mbi->mbi_tpobj, sobj, NULL,
+				      &mbi->mbi_spattr, &mbi->mbi_tpattr,
+				      &mbi->mbi_attr);
+	if (rc)
+		return rc;
+
+	rc = mdd_migrate_linkea_prepare(env, mdd, mbi->mbi_spobj,
+					mbi->mbi_tpobj, sobj, lname, lname,
+					&mbi->mbi_attr, ldata);
+	if (rc < 0)
+		return rc;
+
+	mbi->mbi_ldata = *ldata;
+	if (ldata->ld_leh) {
+		lu_buf_alloc(&mbi->mbi_linkbuf, ldata->ld_leh->leh_len);
+		if (!mbi->mbi_linkbuf.lb_buf)
+			return -ENOMEM;
+
+		memcpy(mbi->mbi_linkbuf.lb_buf, ldata->ld_leh,
+		       ldata->ld_leh->leh_len);
+		mbi->mbi_ldata.ld_buf = &mbi->mbi_linkbuf;
+		mbi->mbi_ldata.ld_leh = mbi->mbi_linkbuf.lb_buf;
+		mbi->mbi_ldata.ld_lee = NULL;
+	}
+
+	return 0;
+}
+
+/**
+ * Migrate names between stripes of a restriping directory in one transaction.
+ *
+ * Each name of \a items is moved from the stripe it is on to the stripe it
+ * hashes to in the new layout of \a md_pobj, and the linkEA of its object is
+ * updated, like mdd_migrate() with sp_migrate_nsonly set. If some stripes
+ * are remote, all their updates are sent in one distributed transaction.
+ * The caller holds the locks of the parent and of all objects.
+ *
+ * Items without mmi_obj are skipped. Names that can't be migrated this way
+ * are left out, and their mmi_rc tells why, see struct md_migrate_item.
+ *
+ * \param[in] env	execution environment
+ * \param[in] md_pobj	parent master object
+ * \param[in] items	names to migrate
+ * \param[in] count	number of \a items
+ * \param[in] ma	used to update stripes mtime and ctime
+ *
+ * \retval		0 on success, some names may be left out
+ * \retval		-errno on failure, no name is migrated
+ */
+static int mdd_migrate_batch(const struct lu_env *env,
+			     struct md_object *md_pobj,
+			     struct md_migrate_item *items, int count,
+			     struct md_attr *ma)
+{
+	struct mdd_device *mdd = mdo2mdd(md_pobj);
+	struct mdd_object *pobj = md2mdd_obj(md_pobj);
+	struct mdd_migrate_batch_item *mbis;
+	struct mdd_migrate_batch_item *mbi;
+	struct mdd_object *sobj;
+	struct lu_name *lname;
+	struct lu_buf pbuf = { NULL };
+	struct lmv_mds_md_v1 *lmv;
+	struct thandle *handle;
+	int todo = 0;
+	int rc;
+	int i;
+
+	ENTRY;
+
+	rc = mdd_stripe_get(env, pobj, &pbuf, XATTR_NAME_LMV);
+	if (rc)
+		RETURN(rc == -ENODATA ? -EINVAL : rc);
+
+	lmv = pbuf.lb_buf;
+	if (!lmv_is_sane(lmv) || !lmv_is_restriping(lmv))
+		GOTO(out_buf, rc = -EINVAL);
+
+	OBD_ALLOC_PTR_ARRAY_LARGE(mbis, count);
+	if (!mbis)
+		GOTO(out_buf, rc = -ENOMEM);
+
+	for (i = 0; i < count; i++) {
+		if (!items[i].mmi_obj)
+			continue;
+
+		items[i].mmi_rc = mdd_migrate_batch_prep(env, mdd, lmv,
+						md2mdd_obj(items[i].mmi_obj),
+						&items[i].mmi_name, &mbis[i]);
+		if (!items[i].mmi_rc)
+			todo++;
+	}
+
+	if (!todo)
+		GOTO(out_free, rc = 0);
+
+	handle = mdd_trans_create(env, mdd);
+	if (IS_ERR(handle))
+		GOTO(out_free, rc = PTR_ERR(handle));
+
+	for (i = 0; i < count; i++) {
+		if (items[i].mmi_rc)
+			continue;
+
+		mbi = &mbis[i];
+		sobj = md2mdd_obj(items[i].mmi_obj);
+		lname = &items[i].mmi_name;
+		rc = mdd_declare_migrate_update(env, mbi->mbi_spobj,
+						mbi->mbi_tpobj, sobj, lname,
+						lname, &mbi->mbi_attr,
+						&mbi->mbi_spattr,
+						&mbi->mbi_tpattr,
+						&mbi->mbi_ldata, ma, handle);
+		if (rc)
+			GOTO(stop, rc);
+
+		rc = mdd_declare_changelog_store(env, mdd, CL_MIGRATE, lname,
+						 lname, handle);
+		if (rc)
+			GOTO(stop, rc);
+	}
+
+	rc = mdd_trans_start(env, mdd, handle);
+	if (rc)
+		GOTO(stop, rc);
+
+	for (i = 0; i < count; i++) {
+		if (items[i].mmi_rc)
+			continue;
+
+		mbi = &mbis[i];
+		sobj = md2mdd_obj(items[i].mmi_obj);
+		lname = &items[i].mmi_name;
+		rc = mdd_migrate_update(env, mbi->mbi_spobj, mbi->mbi_tpobj,
+					sobj, lname, lname, &mbi->mbi_attr,
+					&mbi->mbi_spattr, &mbi->mbi_tpattr,
+					&mbi->mbi_ldata, ma, handle);
+		if (rc)
+			GOTO(stop, rc);
+
+		rc = mdd_changelog_ns_store(env, mdd, CL_MIGRATE, 0, sobj,
+					    mdd_object_fid(mbi->mbi_spobj),
+					    mdd_object_fid(sobj),
+					    mdd_object_fid(mbi->mbi_tpobj),
+					    lname, lname, handle);
+		if (rc)
+			GOTO(stop, rc);
+	}
+	EXIT;
+
+stop:
+	rc = mdd_trans_stop(env, mdd, rc, handle);
+	if (rc) {
+		for (i = 0; i < count; i++)
+			if (!items[i].mmi_rc)
+				items[i].mmi_rc = rc;
+	}
+out_free:
+	for (i = 0; i < count; i++) {
+		mbi = &mbis[i];
+		if (!IS_ERR_OR_NULL(mbi->mbi_spobj))
+			mdd_object_put(env, mbi->mbi_spobj);
+		if (!IS_ERR_OR_NULL(mbi->mbi_tpobj))
+			mdd_object_put(env, mbi->mbi_tpobj);
+		lu_buf_free(&mbi->mbi_linkbuf);
+	}
+	OBD_FREE_PTR_ARRAY_LARGE(mbis, count);
+out_buf:
+	lu_buf_free(&pbuf);
+
+	return rc;
+}
+
 static int mdd_declare_1sd_collapse(const struct lu_env *env,
 				    struct mdd_object *pobj,
 				    struct mdd_object *obj,
@@ -5075,4 +5316,5 @@ const struct md_dir_operations mdd_dir_ops = {
 	.mdo_unlink        = mdd_unlink,
 	.mdo_create_data   = mdd_create_data,
 	.mdo_migrate	   = mdd_migrate,
+	.mdo_migrate_batch = mdd_migrate_batch,
 };
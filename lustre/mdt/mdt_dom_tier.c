@@ -0,0 +1,457 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * lustre/mdt/mdt_dom_tier.c
+ *
+ * Data-on-MDT and OST pool tiering policy.
+ *
+ * The MDT tracks an open heat for each cached regular file and, on close,
+ * compares it together with the Lazy Size-on-MDT value against the policy
+ * thresholds:
+ *  - a small and hot file striped over OSTs only is a candidate to be moved
+ *    into a DoM layout (promote);
+ *  - a cold file with a DoM component which has grown past that component
+ *    is a candidate to be moved to an OST-only layout (demote).
+ *
+ * OST pools are tiered by the policy set on each pool of the LOD: a pool
+ * with a "tier_target" sends its files colder than "tier_heat" to the
+ * target pool, and files of the target pool whose heat reaches twice that
+ * value come back.  The factor of two keeps a file close to the threshold
+ * from moving back and forth.
+ *
+ * The MDT has no data path to OST objects, so the data movement itself is
+ * done in userspace by lfs_tier_migrate, which reads the candidates from
+ * the "dom_tier_queue" parameter and migrates them with layout swap
+ * (lfs migrate). A successful layout change drops the file from the queue.
+ */
+
+#define DEBUG_SUBSYSTEM S_MDS
+
+#include "mdt_internal.h"
+
+/* all lookups are done under mdtr_lock, so items are freed right away */
+static const struct rhashtable_params dom_tier_hash_params = {
+	.key_len	= sizeof(struct lu_fid),
+	.key_offset	= offsetof(struct mdt_dom_tier_item, mdti_fid),
+	.head_offset	= offsetof(struct mdt_dom_tier_item, mdti_hash),
+	.automatic_shrinking = true,
+};
+
+int mdt_dom_tier_init(struct mdt_device *mdt)
+{
+	struct mdt_dom_tier *tier = &mdt->mdt_dom_tier;
+
+	spin_lock_init(&tier->mdtr_lock);
+	INIT_LIST_HEAD(&tier->mdtr_queue);
+	tier->mdtr_count = 0;
+	tier->mdtr_max = DOM_TIER_QUEUE_MAX;
+	tier->mdtr_enabled = 0;
+	tier->mdtr_pool_enabled = 0;
+	tier->mdtr_promote_size = DOM_TIER_PROMOTE_SIZE;
+	tier->mdtr_heat_threshold = DOM_TIER_HEAT_THRESHOLD;
+	tier->mdtr_heat_weight = DOM_TIER_HEAT_DECAY_WEIGHT;
+	tier->mdtr_heat_period = DOM_TIER_HEAT_PERIOD_SECOND;
+	tier->mdtr_promoted = 0;
+	tier->mdtr_demoted = 0;
+	tier->mdtr_dropped = 0;
+	memset(tier->mdtr_pool_cache, 0, sizeof(tier->mdtr_pool_cache));
+
+	return rhashtable_init(&tier->mdtr_hash, &dom_tier_hash_params);
+}
+
+/* empty the DoM tiering queue */
+void mdt_dom_tier_clear(struct mdt_device *mdt)
+{
+	struct mdt_dom_tier *tier = &mdt->mdt_dom_tier;
+	struct mdt_dom_tier_item *item, *next;
+	LIST_HEAD(list);
+
+	spin_lock(&tier->mdtr_lock);
+	list_for_each_entry(item, &tier->mdtr_queue, mdti_linkage)
+		rhashtable_remove_fast(&tier->mdtr_hash, &item->mdti_hash,
+				       dom_tier_hash_params);
+	list_splice_init(&tier->mdtr_queue, &list);
+	tier->mdtr_count = 0;
+	spin_unlock(&tier->mdtr_lock);
+
+	list_for_each_entry_safe(item, next, &list, mdti_linkage) {
+		list_del(&item->mdti_linkage);
+		OBD_FREE_PTR(item);
+	}
+}
+
+void mdt_dom_tier_fini(struct mdt_device *mdt)
+{
+	mdt_dom_tier_clear(mdt);
+	rhashtable_destroy(&mdt->mdt_dom_tier.mdtr_hash);
+}
+
+/* account one open of regular file \a o in its heat */
+void mdt_dom_tier_heat_add(struct mdt_device *mdt, struct mdt_object *o)
+{
+	struct mdt_dom_tier *tier = &mdt->mdt_dom_tier;
+	time64_t now = ktime_get_real_seconds();
+
+	if (!tier->mdtr_enabled && !tier->mdtr_pool_enabled)
+		return;
+
+	spin_lock(&o->mot_heat_lock);
+	if (!o->mot_heat_start)
+		o->mot_heat_start = now;
+	obd_heat_add(&o->mot_heat, now, 1,
+		     tier->mdtr_heat_weight, tier->mdtr_heat_period);
+	spin_unlock(&o->mot_heat_lock);
+}
+
+static __u64 mdt_dom_tier_heat_get(struct mdt_device *mdt,
+				   struct mdt_object *o)
+{
+	struct mdt_dom_tier *tier = &mdt->mdt_dom_tier;
+	__u64 heat;
+
+	spin_lock(&o->mot_heat_lock);
+	heat = obd_heat_get(&o->mot_heat, ktime_get_real_seconds(),
+			    tier->mdtr_heat_weight, tier->mdtr_heat_period);
+	spin_unlock(&o->mot_heat_lock);
+
+	return heat;
+}
+
+static inline struct mdt_dom_tier_item *
+mdt_dom_tier_find_locked(struct mdt_dom_tier *tier, const struct lu_fid *fid)
+{
+	return rhashtable_lookup_fast(&tier->mdtr_hash, fid,
+				      dom_tier_hash_params);
+}
+
+const char *mdt_dom_tier_action_name(enum mdt_dom_tier_action action)
+{
+	switch (action) {
+	case DOM_TIER_PROMOTE:
+		return "promote";
+	case DOM_TIER_DEMOTE:
+		return "demote";
+	case POOL_TIER_PROMOTE:
+		return "pool_promote";
+	case POOL_TIER_DEMOTE:
+		return "pool_demote";
+	}
+
+	return "unknown";
+}
+
+static void mdt_dom_tier_add(struct mdt_device *mdt, struct mdt_object *o,
+			     enum mdt_dom_tier_action action, __u64 size,
+			     __u64 heat, const char *pool)
+{
+	struct mdt_dom_tier *tier = &mdt->mdt_dom_tier;
+	struct mdt_dom_tier_item *item;
+	struct mdt_dom_tier_item *old;
+
+	OBD_ALLOC_PTR(item);
+	if (!item)
+		return;
+
+	item->mdti_fid = *mdt_object_fid(o);
+	item->mdti_size = size;
+	item->mdti_heat = heat;
+	item->mdti_time = ktime_get_real_seconds();
+	item->mdti_action = action;
+	if (pool)
+		strlcpy(item->mdti_pool, pool, sizeof(item->mdti_pool));
+
+	spin_lock(&tier->mdtr_lock);
+	old = mdt_dom_tier_find_locked(tier, &item->mdti_fid);
+	if (old) {
+		/* refresh the existing entry, the file may change direction */
+		old->mdti_size = size;
+		old->mdti_heat = heat;
+		old->mdti_action = action;
+		memcpy(old->mdti_pool, item->mdti_pool, sizeof(old->mdti_pool));
+		spin_unlock(&tier->mdtr_lock);
+		OBD_FREE_PTR(item);
+		return;
+	}
+
+	if (tier->mdtr_count >= tier->mdtr_max ||
+	    rhashtable_insert_fast(&tier->mdtr_hash, &item->mdti_hash,
+				   dom_tier_hash_params)) {
+		tier->mdtr_dropped++;
+		spin_unlock(&tier->mdtr_lock);
+		OBD_FREE_PTR(item);
+		return;
+	}
+
+	list_add_tail(&item->mdti_linkage, &tier->mdtr_queue);
+	tier->mdtr_count++;
+	if (action == DOM_TIER_PROMOTE || action == POOL_TIER_PROMOTE)
+		tier->mdtr_promoted++;
+	else
+		tier->mdtr_demoted++;
+	spin_unlock(&tier->mdtr_lock);
+
+	CDEBUG(D_INODE, "%s: queue "DFID" to %s %s, size %llu, heat %llu\n",
+	       mdt_obd_name(mdt), PFID(&item->mdti_fid),
+	       mdt_dom_tier_action_name(action), item->mdti_pool, size, heat);
+}
+
+/* OST pool of the first instantiated OST component of layout \a lmm */
+static bool mdt_lmm_pool_get(struct lov_mds_md *lmm, char *pool)
+{
+	struct lov_comp_md_v1 *comp_v1;
+	struct lov_mds_md *v1 = lmm;
+	int i;
+
+	if (le32_to_cpu(lmm->lmm_magic) == LOV_MAGIC_COMP_V1) {
+		comp_v1 = (struct lov_comp_md_v1 *)lmm;
+		v1 = NULL;
+		for (i = 0; i < le16_to_cpu(comp_v1->lcm_entry_count); i++) {
+			struct lov_comp_md_entry_v1 *lcme;
+			struct lov_mds_md *comp;
+
+			lcme = &comp_v1->lcm_entries[i];
+			if (!(le32_to_cpu(lcme->lcme_flags) & LCME_FL_INIT))
+				continue;
+
+			comp = (struct lov_mds_md *)((char *)comp_v1 +
+					le32_to_cpu(lcme->lcme_offset));
+			if (lov_pattern(le32_to_cpu(comp->lmm_pattern)) !=
+			    LOV_PATTERN_MDT) {
+				v1 = comp;
+				break;
+			}
+		}
+	}
+
+	if (!v1 || le32_to_cpu(v1->lmm_magic) != LOV_MAGIC_V3)
+		return false;
+
+	strlcpy(pool, ((struct lov_mds_md_v3 *)v1)->lmm_pool_name,
+		LOV_MAXPOOLNAME + 1);
+
+	return pool[0] != '\0';
+}
+
+/* forget the cached pool policies, e.g. once the LOD pool setup changed */
+void mdt_pool_tier_cache_reset(struct mdt_device *mdt)
+{
+	struct mdt_dom_tier *tier = &mdt->mdt_dom_tier;
+
+	spin_lock(&tier->mdtr_lock);
+	memset(tier->mdtr_pool_cache, 0, sizeof(tier->mdtr_pool_cache));
+	spin_unlock(&tier->mdtr_lock);
+}
+
+/*
+ * Get the tiering policy of pool \a pti->pti_pool.
+ *
+ * The policy of the last POOL_TIER_CACHE_SIZE pools is kept for
+ * POOL_TIER_CACHE_AGE seconds, so a close normally doesn't go down to the
+ * LOD, which walks its pool list under obd_dev_lock. A change of the pool
+ * policy is seen by the MDT within that time.
+ */
+static int mdt_pool_tier_get(struct mdt_thread_info *info,
+			     struct pool_tier_info *pti)
+{
+	struct mdt_device *mdt = info->mti_mdt;
+	struct mdt_dom_tier *tier = &mdt->mdt_dom_tier;
+	struct mdt_pool_tier_cache *cache;
+	struct mdt_pool_tier_cache *oldest = NULL;
+	time64_t now = ktime_get_seconds();
+	__u32 vallen = sizeof(*pti);
+	int rc;
+	int i;
+
+	spin_lock(&tier->mdtr_lock);
+	for (i = 0; i < POOL_TIER_CACHE_SIZE; i++) {
+		cache = &tier->mdtr_pool_cache[i];
+		if (cache->mptc_time == 0 ||
+		    cache->mptc_time + POOL_TIER_CACHE_AGE < now ||
+		    strcmp(cache->mptc_info.pti_pool, pti->pti_pool) != 0)
+			continue;
+
+		rc = cache->mptc_rc;
+		if (!rc)
+			*pti = cache->mptc_info;
+		spin_unlock(&tier->mdtr_lock);
+
+		return rc;
+	}
+	spin_unlock(&tier->mdtr_lock);
+
+	rc = obd_get_info(info->mti_env, mdt->mdt_child_exp,
+			  sizeof(KEY_POOL_TIER), KEY_POOL_TIER, &vallen, pti);
+	if (rc && rc != -ENOENT)
+		return rc;
+
+	spin_lock(&tier->mdtr_lock);
+	for (i = 0; i < POOL_TIER_CACHE_SIZE; i++) {
+		cache = &tier->mdtr_pool_cache[i];
+		if (strcmp(cache->mptc_info.pti_pool, pti->pti_pool) == 0) {
+			oldest = cache;
+			break;
+		}
+		if (!oldest || cache->mptc_time < oldest->mptc_time)
+			oldest = cache;
+	}
+	oldest->mptc_info = *pti;
+	oldest->mptc_rc = rc;
+	oldest->mptc_time = now;
+	spin_unlock(&tier->mdtr_lock);
+
+	return rc;
+}
+
+/*
+ * Check if file \a o should move to another OST pool by the pool tiering
+ * policy of the LOD.
+ */
+static void mdt_pool_tier_check(struct mdt_thread_info *info,
+				struct mdt_object *o, __u64 size, __u64 heat)
+{
+	struct mdt_device *mdt = info->mti_mdt;
+	struct mdt_dom_tier *tier = &mdt->mdt_dom_tier;
+	struct pool_tier_info pti;
+	time64_t age;
+
+	if (!mdt_lmm_pool_get(info->mti_big_lmm, pti.pti_pool))
+		return;
+
+	if (mdt_pool_tier_get(info, &pti))
+		return;
+
+	spin_lock(&o->mot_heat_lock);
+	age = ktime_get_real_seconds() - o->mot_heat_start;
+	spin_unlock(&o->mot_heat_lock);
+
+	if (pti.pti_promote[0] != '\0' &&
+	    heat >= 2 * pti.pti_promote_heat) {
+		mdt_dom_tier_add(mdt, o, POOL_TIER_PROMOTE, size, heat,
+				 pti.pti_promote);
+	} else if (pti.pti_demote[0] != '\0' &&
+		   heat < pti.pti_demote_heat &&
+		   age >= tier->mdtr_heat_period) {
+		/* the heat of a file opened for a shorter time than one
+		 * period says nothing about it, e.g. a file just written
+		 */
+		mdt_dom_tier_add(mdt, o, POOL_TIER_DEMOTE, size, heat,
+				 pti.pti_demote);
+	}
+}
+
+/**
+ * Drop file \a fid from the DoM tiering queue.
+ *
+ * Called when the agent has migrated the file, or when its layout has been
+ * changed by other means, so the decision is stale.
+ *
+ * \retval	true if the file was queued
+ */
+bool mdt_dom_tier_remove(struct mdt_device *mdt, const struct lu_fid *fid)
+{
+	struct mdt_dom_tier *tier = &mdt->mdt_dom_tier;
+	struct mdt_dom_tier_item *item;
+
+	spin_lock(&tier->mdtr_lock);
+	item = mdt_dom_tier_find_locked(tier, fid);
+	if (item) {
+		rhashtable_remove_fast(&tier->mdtr_hash, &item->mdti_hash,
+				       dom_tier_hash_params);
+		list_del(&item->mdti_linkage);
+		tier->mdtr_count--;
+	}
+	spin_unlock(&tier->mdtr_lock);
+
+	if (item)
+		OBD_FREE_PTR(item);
+
+	return item != NULL;
+}
+
+/**
+ * Check if file \a o should move into or out of DoM, or to another OST pool.
+ *
+ * Called on the last close of a regular file after the LSOM update,
+ * so the size known to the MDT is up-to-date.
+ */
+void mdt_dom_tier_check(struct mdt_thread_info *info, struct mdt_object *o)
+{
+	struct mdt_device *mdt = info->mti_mdt;
+	struct mdt_dom_tier *tier = &mdt->mdt_dom_tier;
+	bool queued = false;
+	bool lsom_inited;
+	__u32 dom_size;
+	int dom_only;
+	__u64 size;
+	__u64 heat;
+	int rc;
+
+	ENTRY;
+
+	if ((!tier->mdtr_enabled && !tier->mdtr_pool_enabled) ||
+	    mdt_object_remote(o))
+		RETURN_EXIT;
+
+	/* both DoM directions need the size of OST data, which is only known
+	 * through LSOM, DoM-only files never spill over their component
+	 */
+	mutex_lock(&o->mot_som_mutex);
+	lsom_inited = o->mot_lsom_inited;
+	size = o->mot_lsom_size;
+	mutex_unlock(&o->mot_som_mutex);
+	if (!lsom_inited && !tier->mdtr_pool_enabled)
+		RETURN_EXIT;
+
+	if (info->mti_big_lmm_used)
+		RETURN_EXIT;
+
+	rc = mdt_big_xattr_get(info, o, XATTR_NAME_LOV);
+	if (rc < 0)
+		RETURN_EXIT;
+
+	dom_size = mdt_lmm_dom_entry_check(info->mti_big_lmm, &dom_only);
+	if (dom_only)
+		RETURN_EXIT;
+
+	heat = mdt_dom_tier_heat_get(mdt, o);
+	if (tier->mdtr_enabled && lsom_inited) {
+		if (dom_size == 0 && size <= tier->mdtr_promote_size &&
+		    heat >= tier->mdtr_heat_threshold) {
+			mdt_dom_tier_add(mdt, o, DOM_TIER_PROMOTE, size, heat,
+					 NULL);
+			queued = true;
+		} else if (dom_size != 0 && size > dom_size &&
+			   heat < tier->mdtr_heat_threshold) {
+			mdt_dom_tier_add(mdt, o, DOM_TIER_DEMOTE, size, heat,
+					 NULL);
+			queued = true;
+		}
+	}
+
+	/* a move into or out of DoM takes precedence over the pool policy */
+	if (!queued && tier->mdtr_pool_enabled)
+		mdt_pool_tier_check(info, o, size, heat);
+
+	EXIT;
+}
@@ -5841,6 +5841,7 @@ static void mdt_fini(const struct lu_env *env, struct mdt_device *m)
 	mdt_stack_pre_fini(env, m, md2lu_dev(m->mdt_child));
 
 	mdt_restriper_stop(m);
+	mdt_dom_tier_fini(m);
 	ping_evictor_stop();
 
 	/* Remove the HSM /proc entry so the coordinator cannot be
@@ -5993,6 +5994,9 @@ static int mdt_init0(const struct lu_env *env, struct mdt_device *m,
 	m->mdt_enable_remote_rename = 1;
 	m->mdt_dir_restripe_nsonly = 1;
 	m->mdt_enable_remote_subdir_mount = 1;
+	rc = mdt_dom_tier_init(m);
+	if (rc)
+		GOTO(err_lmi, rc);
 
 	atomic_set(&m->mdt_mds_mds_conns, 0);
 	atomic_set(&m->mdt_async_commit_count, 0);
@@ -6007,7 +6011,7 @@ static int mdt_init0(const struct lu_env *env, struct mdt_device *m,
 	if (rc) {
 		CERROR("%s: Can't init device stack, rc %d\n",
 		       mdt_obd_name(m), rc);
-		GOTO(err_lmi, rc);
+		GOTO(err_dom_tier, rc);
 	}
 
 	s = mdt_lu_site(m);
@@ -6194,6 +6198,8 @@ err_fini_fld:
 	mdt_fld_fini(env, m);
 err_fini_stack:
 	mdt_stack_fini(env, m, md2lu_dev(m->mdt_child));
+err_dom_tier:
+	mdt_dom_tier_fini(m);
 err_lmi:
 	if (lmi)
 		server_put_mount(dev, true);
@@ -6315,11 +6321,13 @@ static struct lu_object *mdt_object_alloc(const struct lu_env *env,
 		init_rwsem(&mo->mot_dom_sem);
 		init_rwsem(&mo->mot_open_sem);
 		atomic_set(&mo->mot_open_count, 0);
-		mo->mot_restripe_offset = 0;
 		INIT_LIST_HEAD(&mo->mot_restripe_linkage);
 		mo->mot_lsom_size = 0;
 		mo->mot_lsom_blocks = 0;
 		mo->mot_lsom_inited = false;
+		spin_lock_init(&mo->mot_heat_lock);
+		obd_heat_clear(&mo->mot_heat, 1);
+		mo->mot_heat_start = 0;
 		RETURN(o);
 	}
 	RETURN(NULL);
@@ -6644,6 +6652,18 @@ static int mdt_connect_internal(const struct lu_env *env,
 		mdt_enable_slc(mdt);
 	}
 
+	/* "bucket" hash directories can't be accessed by this client, LOD
+	 * won't create them while it's connected.
+	 */
+	if (!(data->ocd_connect_flags & (OBD_CONNECT_MDS_MDS |
+					 OBD_CONNECT_LIGHTWEIGHT)) &&
+	    !((data->ocd_connect_flags & OBD_CONNECT_FLAGS2) &&
+	      (data->ocd_connect_flags2 & OBD_CONNECT2_BUCKET_HASH)) &&
+	    !exp->exp_mdt_data.med_bucket_unaware) {
+		exp->exp_mdt_data.med_bucket_unaware = true;
+		atomic_inc(&mdt->mdt_lut.lut_bucket_unaware_clients);
+	}
+
 	if (!mdt->mdt_lut.lut_dt_conf.ddp_has_lseek_data_hole)
 		data->ocd_connect_flags2 &= ~OBD_CONNECT2_LSEEK;
 
@@ -6956,6 +6976,9 @@ static int mdt_destroy_export(struct obd_export *exp)
                 RETURN(0);
 
 	ldlm_destroy_export(exp);
+	if (exp->exp_mdt_data.med_bucket_unaware &&
+	    exp->exp_obd->u.obt.obt_magic == OBT_MAGIC)
+		atomic_dec(&class_exp2tgt(exp)->lut_bucket_unaware_clients);
 	tgt_client_free(exp);
 
 	LASSERT(list_empty(&exp->exp_outstanding_replies));
@@ -211,10 +211,83 @@ struct mdt_statfs_cache {
 /* directory auto-split allocate delta new stripes each time */
 #define DIR_SPLIT_DELTA_DEFAULT	4
 
+/* sub files migrated by restripe worker in one transaction */
+#define DIR_RESTRIPE_MIGRATE_BATCH_DEFAULT	16
+/* upper limit of sub files migrated in one transaction */
+#define DIR_RESTRIPE_MIGRATE_BATCH_MAX		64
+
+/* default number of sub file migration threads in dir restripe */
+#define DIR_RESTRIPE_THREADS_DEFAULT	4
+/* upper limit of sub file migration threads in dir restripe */
+#define DIR_RESTRIPE_THREADS_MAX	32
+
+struct mdt_dir_restriper;
+struct mdt_migrate_batch_lock;
+
+/* stripe whose sub files are being migrated in dir restripe */
+struct mdt_restripe_stripe {
+	struct mdt_object	*mrs_obj;
+	/* hash ranges not migrated yet, protected by mdr_lock */
+	int			 mrs_ranges;
+	/* first error of its hash ranges, protected by mdr_lock */
+	int			 mrs_rc;
+};
+
+/*
+ * Hash range of a stripe, whose sub files are migrated by one worker thread
+ * at a time. A range is split in two when it's picked while other threads
+ * are idle, so that all threads can work on one stripe.
+ */
+struct mdt_restripe_range {
+	/* link to mdr_migrating */
+	struct list_head	    mrr_linkage;
+	struct mdt_restripe_stripe *mrr_stripe;
+	/* hash to migrate sub files from */
+	__u64			    mrr_offset;
+	/* end of hash range, exclusive */
+	__u64			    mrr_end;
+};
+
+/* sub file migration thread of dir restripe */
+struct mdt_restripe_worker {
+	struct lu_env		  mrw_env;
+	struct lu_context	  mrw_session;
+	struct task_struct	 *mrw_task;
+	struct mdt_dir_restriper *mrw_restriper;
+	/* lum used in migrate */
+	union lmv_mds_md	  mrw_lmv;
+	/* page used in readdir */
+	struct page		 *mrw_page;
+	/* spare range to split the picked one */
+	struct mdt_restripe_range *mrw_range;
+	/* names and locks of one migration transaction */
+	struct md_migrate_item	 *mrw_items;
+	struct mdt_migrate_batch_lock *mrw_locks;
+	char			(*mrw_names)[NAME_MAX + 1];
+	/* sub files migrated by this thread */
+	atomic64_t		  mrw_migrated;
+};
+
 struct mdt_dir_restriper {
 	struct lu_env		mdr_env;
 	struct lu_context	mdr_session;
 	struct task_struct     *mdr_task;
+	/* sub file migration threads */
+	struct mdt_restripe_worker *mdr_workers;
+	int			mdr_worker_count;
+	wait_queue_head_t	mdr_migrate_waitq;
+	/* max sub files migrated in one transaction */
+	u32			mdr_migrate_batch;
+	/* statistics */
+	atomic64_t		mdr_stat_migrated;
+	atomic64_t		mdr_stat_failed;
+	atomic64_t		mdr_stat_passes;
+	atomic64_t		mdr_stat_trans;
+	atomic64_t		mdr_stat_split;
+	/* transactions run while another worker's one was running */
+	atomic64_t		mdr_stat_trans_overlapped;
+	/* workers holding the locks of a migration transaction */
+	atomic_t		mdr_migrate_inflight;
 	/* lock for below fields */
 	spinlock_t		mdr_lock;
 	/* auto split when plain dir/shard sub files exceed threshold */
@@ -223,16 +296,93 @@ struct mdt_dir_restriper {
 	u32			mdr_dir_split_delta;
 	/* directories to split */
 	struct list_head	mdr_auto_splitting;
-	/* directories under which sub files are migrating */
+	/* stripe hash ranges whose sub files are to migrate */
 	struct list_head	mdr_migrating;
+	/* number of ranges being migrated by worker threads */
+	int			mdr_migrate_active;
+	/* migrated count when current round of migration started */
+	s64			mdr_migrate_base;
+	/* time when current round of sub file migration started */
+	time64_t		mdr_migrate_start;
 	/* directories waiting to update layout after migration */
 	struct list_head	mdr_updating;
 	/* time to update directory layout after migration */
 	time64_t		mdr_update_time;
-	/* lum used in split/migrate/layout_change */
+	/* lum used in split/layout_change */
 	union lmv_mds_md	mdr_lmv;
-	/* page used in readdir */
-	struct page	       *mdr_page;
+};
+
+/* default heat decay weight and period used by the DoM tiering policy */
+#define DOM_TIER_HEAT_DECAY_WEIGHT	((80 * 256 + 50) / 100)
+#define DOM_TIER_HEAT_PERIOD_SECOND	60
+/* files whose open heat reaches this value are "hot" */
+#define DOM_TIER_HEAT_THRESHOLD		16
+/* OST files up to this size are candidates to move into DoM */
+#define DOM_TIER_PROMOTE_SIZE		(1024 * 1024)
+/* maximum number of pending migration candidates */
+#define DOM_TIER_QUEUE_MAX		1024
+/* number of OST pools whose tiering policy is cached by the MDT */
+#define POOL_TIER_CACHE_SIZE		8
+/* seconds a cached pool tiering policy is used before asking the LOD again */
+#define POOL_TIER_CACHE_AGE		30
+
+enum mdt_dom_tier_action {
+	DOM_TIER_PROMOTE = 0,	/* OST-striped file to DoM */
+	DOM_TIER_DEMOTE	 = 1,	/* DoM file to OST-only */
+	POOL_TIER_PROMOTE = 2,	/* hot file to a faster OST pool */
+	POOL_TIER_DEMOTE = 3,	/* cold file to a slower OST pool */
+};
+
+struct mdt_dom_tier_item {
+	/* FIFO order of the queue */
+	struct list_head	 mdti_linkage;
+	/* lookup by FID in mdtr_hash */
+	struct rhash_head	 mdti_hash;
+	struct lu_fid		 mdti_fid;
+	__u64			 mdti_size;
+	__u64			 mdti_heat;
+	time64_t		 mdti_time;
+	enum mdt_dom_tier_action mdti_action;
+	/* target pool for POOL_TIER_* actions */
+	char			 mdti_pool[LOV_MAXPOOLNAME + 1];
+};
+
+/* tiering policy of one OST pool as returned by the LOD */
+struct mdt_pool_tier_cache {
+	struct pool_tier_info	mptc_info;
+	/* result of KEY_POOL_TIER, -ENOENT for a pool without policy */
+	int			mptc_rc;
+	time64_t		mptc_time;
+};
+
+/*
+ * DoM and OST pool tiering policy. Candidates are selected on close from the
+ * LSOM size, the OST pool and the open heat of the file, and are queued for
+ * lfs_tier_migrate which moves data with layout swap (lfs migrate).
+ * The pool policy itself is set per OST pool on the LOD, see
+ * lod_pool_tier_get().
+ */
+struct mdt_dom_tier {
+	/* lock for below fields */
+	spinlock_t		mdtr_lock;
+	struct list_head	mdtr_queue;
+	struct rhashtable	mdtr_hash;
+	unsigned int		mdtr_count;
+	unsigned int		mdtr_max;
+	unsigned int		mdtr_enabled:1,
+				mdtr_pool_enabled:1;
+	__u64			mdtr_promote_size;
+	__u64			mdtr_heat_threshold;
+	unsigned int		mdtr_heat_weight;
+	unsigned int		mdtr_heat_period;
+	/* statistics */
+	__u64			mdtr_promoted;
+	__u64			mdtr_demoted;
+	__u64			mdtr_dropped;
+	/* pool policy of the last pools seen on close, saves a walk of the
+	 * LOD pool list on each close
+	 */
+	struct mdt_pool_tier_cache mdtr_pool_cache[POOL_TIER_CACHE_SIZE];
 };
 
 struct mdt_device {
@@ -330,6 +480,8 @@ struct mdt_device {
 	struct mdt_object	  *mdt_md_root;
 
 	struct mdt_dir_restriper   mdt_restriper;
+
+	struct mdt_dom_tier	   mdt_dom_tier;
 };
 
 #define MDT_SERVICE_WATCHDOG_FACTOR	(2)
@@ -362,10 +514,13 @@ struct mdt_object {
 	struct rw_semaphore	mot_open_sem;
 	atomic_t		mot_lease_count;
 	atomic_t		mot_open_count;
-	/* directory offset, used in sub file migration in dir restripe */
-	loff_t			mot_restripe_offset;
 	/* link to mdt_restriper auto_splitting/migrating/updating */
 	struct list_head	mot_restripe_linkage;
+	/* open heat used by tiering policy, protected by mot_heat_lock */
+	spinlock_t		mot_heat_lock;
+	struct obd_heat_instance mot_heat;
+	/* time the open heat started to be tracked */
+	time64_t		mot_heat_start;
 };
 
 struct mdt_lock_handle {
@@ -387,6 +542,27 @@ struct mdt_lock_handle {
 	enum ldlm_mode		mlh_rreg_mode;
 };
 
+/* PDO lock of a name on one parent stripe in mdt_reint_migrate_batch() */
+struct mdt_migrate_name_lock {
+	struct mdt_object	*mnl_obj;
+	struct mdt_lock_handle	 mnl_lh;
+	bool			 mnl_locked;
+};
+
+/* lock of one name in mdt_reint_migrate_batch() */
+struct mdt_migrate_batch_lock {
+	/* source parent stripe and object of the name */
+	struct mdt_object	*mbl_spobj;
+	struct mdt_object	*mbl_sobj;
+	/* the name on its source and target parent stripes */
+	struct mdt_migrate_name_lock mbl_names[2];
+	struct mdt_lock_handle	 mbl_lh;
+	struct ldlm_enqueue_info mbl_einfo;
+	/* locks on object stripes */
+	struct list_head	 mbl_slave_locks;
+	bool			 mbl_locked;
+};
+
 enum {
 	MDT_LH_PARENT,	/* parent lockh */
 	MDT_LH_CHILD,	/* child lockh */
@@ -1427,6 +1603,10 @@ static inline bool mdt_is_rootadmin(struct mdt_thread_info *info)
 
 int mdt_reint_migrate(struct mdt_thread_info *info,
 		      struct mdt_lock_handle *unused);
+int mdt_reint_migrate_batch(struct mdt_thread_info *info,
+			    const struct lu_fid *pfid,
+			    struct md_migrate_item *items,
+			    struct mdt_migrate_batch_lock *locks, int count);
 int mdt_dir_layout_update(struct mdt_thread_info *info);
 
 /* directory restripe */
@@ -1448,4 +1628,14 @@ int mdt_is_remote_object(struct mdt_thread_info *info,
 			 struct mdt_object *parent,
 			 struct mdt_object *child);
 
+/* DoM tiering */
+int mdt_dom_tier_init(struct mdt_device *mdt);
+void mdt_dom_tier_fini(struct mdt_device *mdt);
+void mdt_dom_tier_clear(struct mdt_device *mdt);
+void mdt_dom_tier_heat_add(struct mdt_device *mdt, struct mdt_object *o);
+void mdt_dom_tier_check(struct mdt_thread_info *info, struct mdt_object *o);
+bool mdt_dom_tier_remove(struct mdt_device *mdt, const struct lu_fid *fid);
+void mdt_pool_tier_cache_reset(struct mdt_device *mdt);
+const char *mdt_dom_tier_action_name(enum mdt_dom_tier_action action);
+
 #endif /* _MDT_INTERNAL_H */
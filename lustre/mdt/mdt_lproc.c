@@ -1135,6 +1135,50 @@ static ssize_t enable_remote_rename_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(enable_remote_rename);
 
+/**
+ * Show whether only the master part of a sync distributed transaction is
+ * committed synchronously, the others being recovered from update logs.
+ *
+ * This is off by default: it only covers transactions which are sync
+ * themselves, not the commit on lock cancel of dependent DNE operations.
+ */
+static ssize_t dne_async_commit_show(struct kobject *kobj,
+				     struct attribute *attr, char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	struct target_distribute_txn_data *tdtd = mdt->mdt_lut.lut_tdtd;
+
+	if (!tdtd)
+		return -ENODEV;
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n", tdtd->tdtd_async_commit);
+}
+
+static ssize_t dne_async_commit_store(struct kobject *kobj,
+				      struct attribute *attr,
+				      const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	struct target_distribute_txn_data *tdtd = mdt->mdt_lut.lut_tdtd;
+	bool val;
+	int rc;
+
+	if (!tdtd)
+		return -ENODEV;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	tdtd->tdtd_async_commit = val;
+	return count;
+}
+LUSTRE_RW_ATTR(dne_async_commit);
+
 static ssize_t dir_split_count_show(struct kobject *kobj,
 				     struct attribute *attr,
 				     char *buf)
@@ -1202,6 +1246,107 @@ static ssize_t dir_split_delta_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(dir_split_delta);
 
+static ssize_t dir_restripe_migrate_batch_show(struct kobject *kobj,
+					       struct attribute *attr,
+					       char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 mdt->mdt_restriper.mdr_migrate_batch);
+}
+
+static ssize_t dir_restripe_migrate_batch_store(struct kobject *kobj,
+						struct attribute *attr,
+						const char *buffer,
+						size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	u32 val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val == 0 || val > DIR_RESTRIPE_MIGRATE_BATCH_MAX)
+		return -ERANGE;
+
+	mdt->mdt_restriper.mdr_migrate_batch = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(dir_restripe_migrate_batch);
+
+/**
+ * Show directory restripe progress and throughput.
+ *
+ * Rate is the number of sub files migrated per second since the
+ * current round of sub file migration started. Sub files migrated by
+ * each worker thread are listed in thread order.
+ */
+static int mdt_dir_restripe_stats_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device *obd = m->private;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	struct mdt_dir_restriper *restriper = &mdt->mdt_restriper;
+	struct mdt_restripe_range *range;
+	time64_t elapsed = 0;
+	s64 migrated;
+	int queued = 0;
+	int active;
+	int i;
+
+	migrated = atomic64_read(&restriper->mdr_stat_migrated);
+
+	spin_lock(&restriper->mdr_lock);
+	list_for_each_entry(range, &restriper->mdr_migrating, mrr_linkage)
+		queued++;
+	active = restriper->mdr_migrate_active;
+	if (queued || active) {
+		elapsed = ktime_get_real_seconds() -
+			  restriper->mdr_migrate_start;
+		migrated -= restriper->mdr_migrate_base;
+	}
+	spin_unlock(&restriper->mdr_lock);
+
+	seq_printf(m, "threads: %d\n"
+		   "ranges_migrating: %d\n"
+		   "ranges_queued: %d\n"
+		   "dirs_split: %lld\n"
+		   "entries_migrated: %lld\n"
+		   "entries_failed: %lld\n"
+		   "migrate_passes: %lld\n"
+		   "migrate_transactions: %lld\n"
+		   "migrate_transactions_overlapped: %lld\n",
+		   restriper->mdr_worker_count, active, queued,
+		   (s64)atomic64_read(&restriper->mdr_stat_split),
+		   (s64)atomic64_read(&restriper->mdr_stat_migrated),
+		   (s64)atomic64_read(&restriper->mdr_stat_failed),
+		   (s64)atomic64_read(&restriper->mdr_stat_passes),
+		   (s64)atomic64_read(&restriper->mdr_stat_trans),
+		   (s64)atomic64_read(
+			&restriper->mdr_stat_trans_overlapped));
+	seq_puts(m, "thread_entries_migrated:");
+	for (i = 0; i < restriper->mdr_worker_count; i++)
+		seq_printf(m, " %lld", (s64)atomic64_read(
+				&restriper->mdr_workers[i].mrw_migrated));
+	seq_putc(m, '\n');
+	if (queued || active)
+		seq_printf(m, "round_elapsed: %lld\n"
+			   "round_entries_migrated: %lld\n"
+			   "round_rate: %lld\n",
+			   elapsed, migrated,
+			   elapsed ? div64_s64(migrated, elapsed) : migrated);
+
+	return 0;
+}
+LPROC_SEQ_FOPS_RO(mdt_dir_restripe_stats);
+
 static ssize_t dir_restripe_nsonly_show(struct kobject *kobj,
 					struct attribute *attr, char *buf)
 {
@@ -1263,6 +1408,280 @@ static ssize_t enable_remote_subdir_mount_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(enable_remote_subdir_mount);
 
+static ssize_t dom_tier_enable_show(struct kobject *kobj,
+				    struct attribute *attr, char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 mdt->mdt_dom_tier.mdtr_enabled);
+}
+
+static ssize_t dom_tier_enable_store(struct kobject *kobj,
+				     struct attribute *attr,
+				     const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	mdt->mdt_dom_tier.mdtr_enabled = val;
+	if (!val && !mdt->mdt_dom_tier.mdtr_pool_enabled)
+		mdt_dom_tier_clear(mdt);
+	return count;
+}
+LUSTRE_RW_ATTR(dom_tier_enable);
+
+static ssize_t pool_tier_enable_show(struct kobject *kobj,
+				     struct attribute *attr, char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 mdt->mdt_dom_tier.mdtr_pool_enabled);
+}
+
+/*
+ * Enable the OST pool tiering policy, which is configured per pool by the
+ * "tier_target" and "tier_heat" parameters of the LOD pools.
+ */
+static ssize_t pool_tier_enable_store(struct kobject *kobj,
+				      struct attribute *attr,
+				      const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	/* a new setting also takes a changed pool policy immediately */
+	mdt_pool_tier_cache_reset(mdt);
+	mdt->mdt_dom_tier.mdtr_pool_enabled = val;
+	if (!val && !mdt->mdt_dom_tier.mdtr_enabled)
+		mdt_dom_tier_clear(mdt);
+	return count;
+}
+LUSTRE_RW_ATTR(pool_tier_enable);
+
+static ssize_t dom_tier_promote_size_show(struct kobject *kobj,
+					  struct attribute *attr, char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%llu\n",
+			 mdt->mdt_dom_tier.mdtr_promote_size);
+}
+
+static ssize_t dom_tier_promote_size_store(struct kobject *kobj,
+					   struct attribute *attr,
+					   const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	s64 val;
+	int rc;
+
+	rc = sysfs_memparse(buffer, count, &val, "B");
+	if (rc < 0)
+		return rc;
+
+	if (val < 0)
+		return -ERANGE;
+
+	mdt->mdt_dom_tier.mdtr_promote_size = val;
+	return count;
+}
+LUSTRE_RW_ATTR(dom_tier_promote_size);
+
+static ssize_t dom_tier_heat_threshold_show(struct kobject *kobj,
+					    struct attribute *attr, char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%llu\n",
+			 mdt->mdt_dom_tier.mdtr_heat_threshold);
+}
+
+static ssize_t dom_tier_heat_threshold_store(struct kobject *kobj,
+					     struct attribute *attr,
+					     const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	u64 val;
+	int rc;
+
+	rc = kstrtoull(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	mdt->mdt_dom_tier.mdtr_heat_threshold = val;
+	return count;
+}
+LUSTRE_RW_ATTR(dom_tier_heat_threshold);
+
+static ssize_t dom_tier_heat_decay_percentage_show(struct kobject *kobj,
+						   struct attribute *attr,
+						   char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 (mdt->mdt_dom_tier.mdtr_heat_weight * 100 + 128) /
+			 256);
+}
+
+static ssize_t dom_tier_heat_decay_percentage_store(struct kobject *kobj,
+						    struct attribute *attr,
+						    const char *buffer,
+						    size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 10, &val);
+	if (rc)
+		return rc;
+
+	if (val > 100)
+		return -ERANGE;
+
+	mdt->mdt_dom_tier.mdtr_heat_weight = (val * 256 + 50) / 100;
+	return count;
+}
+LUSTRE_RW_ATTR(dom_tier_heat_decay_percentage);
+
+static ssize_t dom_tier_heat_period_second_show(struct kobject *kobj,
+						struct attribute *attr,
+						char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 mdt->mdt_dom_tier.mdtr_heat_period);
+}
+
+static ssize_t dom_tier_heat_period_second_store(struct kobject *kobj,
+						 struct attribute *attr,
+						 const char *buffer,
+						 size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 10, &val);
+	if (rc)
+		return rc;
+
+	if (val == 0)
+		return -ERANGE;
+
+	mdt->mdt_dom_tier.mdtr_heat_period = val;
+	return count;
+}
+LUSTRE_RW_ATTR(dom_tier_heat_period_second);
+
+/**
+ * Show the DoM and pool tiering statistics and the queue of candidate files.
+ */
+static int mdt_dom_tier_queue_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device *obd = m->private;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	struct mdt_dom_tier *tier = &mdt->mdt_dom_tier;
+	struct mdt_dom_tier_item *item;
+
+	spin_lock(&tier->mdtr_lock);
+	seq_printf(m, "queued: %u\npromoted: %llu\ndemoted: %llu\n"
+		   "dropped: %llu\n", tier->mdtr_count, tier->mdtr_promoted,
+		   tier->mdtr_demoted, tier->mdtr_dropped);
+	list_for_each_entry(item, &tier->mdtr_queue, mdti_linkage) {
+		seq_printf(m, "- { fid: "DFID", action: %s, ",
+			   PFID(&item->mdti_fid),
+			   mdt_dom_tier_action_name(item->mdti_action));
+		if (item->mdti_pool[0] != '\0')
+			seq_printf(m, "pool: %s, ", item->mdti_pool);
+		seq_printf(m, "size: %llu, heat: %llu, time: %lld }\n",
+			   item->mdti_size, item->mdti_heat, item->mdti_time);
+	}
+	spin_unlock(&tier->mdtr_lock);
+
+	return 0;
+}
+
+/**
+ * Remove a file from the DoM tiering queue.
+ *
+ * lfs_tier_migrate writes the FID of a file it failed to migrate, a
+ * migrated file is dropped by its layout swap. "clear" empties the queue.
+ */
+static ssize_t
+mdt_dom_tier_queue_seq_write(struct file *file, const char __user *buffer,
+			     size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct obd_device *obd = m->private;
+	struct mdt_device *mdt = mdt_dev(obd->obd_lu_dev);
+	char kernbuf[FID_LEN + 1];
+	struct lu_fid fid;
+	char *str;
+
+	if (count >= sizeof(kernbuf))
+		return -EINVAL;
+
+	if (copy_from_user(kernbuf, buffer, count))
+		return -EFAULT;
+	kernbuf[count] = '\0';
+	str = strim(kernbuf);
+
+	if (strcmp(str, "clear") == 0) {
+		mdt_dom_tier_clear(mdt);
+		return count;
+	}
+
+	if (*str == '[')
+		str++;
+	if (sscanf(str, SFID, RFID(&fid)) != 3 || !fid_is_sane(&fid))
+		return -EINVAL;
+
+	if (!mdt_dom_tier_remove(mdt, &fid))
+		return -ENOENT;
+
+	return count;
+}
+LPROC_SEQ_FOPS(mdt_dom_tier_queue);
+
 /**
  * Show if the OFD enforces T10PI checksum.
  *
@@ -1378,6 +1797,7 @@ LUSTRE_RO_ATTR(tot_dirty);
 LUSTRE_RO_ATTR(tot_granted);
 LUSTRE_RO_ATTR(tot_pending);
 LUSTRE_RW_ATTR(grant_compat_disable);
+LUSTRE_RW_ATTR(grant_rate_window);
 LUSTRE_RO_ATTR(instance);
 
 LUSTRE_RO_ATTR(num_exports);
@@ -1388,6 +1808,7 @@ static struct attribute *mdt_attrs[] = {
 	&lustre_attr_tot_granted.attr,
 	&lustre_attr_tot_pending.attr,
 	&lustre_attr_grant_compat_disable.attr,
+	&lustre_attr_grant_rate_window.attr,
 	&lustre_attr_instance.attr,
 	&lustre_attr_recovery_time_hard.attr,
 	&lustre_attr_recovery_time_soft.attr,
@@ -1407,6 +1828,7 @@ static struct attribute *mdt_attrs[] = {
 	&lustre_attr_enable_dir_restripe.attr,
 	&lustre_attr_enable_dir_auto_split.attr,
 	&lustre_attr_enable_remote_rename.attr,
+	&lustre_attr_dne_async_commit.attr,
 	&lustre_attr_commit_on_sharing.attr,
 	&lustre_attr_local_recovery.attr,
 	&lustre_attr_async_commit_count.attr,
@@ -1420,8 +1842,15 @@ static struct attribute *mdt_attrs[] = {
 	&lustre_attr_dir_split_count.attr,
 	&lustre_attr_dir_split_delta.attr,
 	&lustre_attr_dir_restripe_nsonly.attr,
+	&lustre_attr_dir_restripe_migrate_batch.attr,
 	&lustre_attr_checksum_t10pi_enforce.attr,
 	&lustre_attr_enable_remote_subdir_mount.attr,
+	&lustre_attr_dom_tier_enable.attr,
+	&lustre_attr_dom_tier_promote_size.attr,
+	&lustre_attr_dom_tier_heat_threshold.attr,
+	&lustre_attr_dom_tier_heat_decay_percentage.attr,
+	&lustre_attr_dom_tier_heat_period_second.attr,
+	&lustre_attr_pool_tier_enable.attr,
 	NULL,
 };
 
@@ -1444,6 +1873,10 @@ static struct lprocfs_vars lprocfs_mdt_obd_vars[] = {
 	  .fops =	&mdt_nosquash_nids_fops			},
 	{ .name =	"checksum_type",
 	  .fops =	&mdt_checksum_type_fops		},
+	{ .name =	"dir_restripe_stats",
+	  .fops =	&mdt_dir_restripe_stats_fops		},
+	{ .name =	"dom_tier_queue",
+	  .fops =	&mdt_dom_tier_queue_fops		},
 	{ NULL }
 };
 
@@ -441,6 +441,8 @@ static int mdt_mfd_open(struct mdt_thread_info *info, struct mdt_object *p,
 	atomic_inc(&o->mot_open_count);
 	if (open_flags & MDS_OPEN_LEASE)
 		atomic_inc(&o->mot_lease_count);
+	else if (isreg)
+		mdt_dom_tier_heat_add(info->mti_mdt, o);
 
 	/* replay handle */
 	if (req_is_replay(req)) {
@@ -2378,6 +2380,8 @@ int mdt_mfd_close(struct mdt_thread_info *info, struct mdt_file_data *mfd)
 	case MDS_CLOSE_LAYOUT_SPLIT:
 	case MDS_CLOSE_LAYOUT_SWAP: {
 		rc = mdt_close_handle_layouts(info, o, ma);
+		if (rc == 0)
+			mdt_dom_tier_remove(info->mti_mdt, ofid);
 		if (rc < 0) {
 			CDEBUG(D_INODE,
 			       "%s: cannot %s layout of "DFID": rc = %d\n",
@@ -2419,6 +2423,10 @@ int mdt_mfd_close(struct mdt_thread_info *info, struct mdt_file_data *mfd)
 		}
 	}
 
+	if (S_ISREG(lu_object_attr(&o->mot_obj)) && intent == 0 &&
+	    atomic_read(&o->mot_open_count) == 1)
+		mdt_dom_tier_check(info, o);
+
 	if (open_flags & MDS_FMODE_WRITE)
 		mdt_write_put(o);
 	else if (open_flags & MDS_FMODE_EXEC)
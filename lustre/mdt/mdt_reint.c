@@ -41,6 +41,7 @@
 
 #define DEBUG_SUBSYSTEM S_MDS
 
+#include <linux/sort.h>
 #include <lprocfs_status.h>
 #include "mdt_internal.h"
 #include <lustre_lmv.h>
@@ -543,6 +544,11 @@ static int mdt_create(struct mdt_thread_info *info)
 		    LMV_HASH_TYPE_CRUSH)
 			RETURN(-EPROTO);
 
+		if ((!(exp_connect_flags2(exp) & OBD_CONNECT2_BUCKET_HASH)) &&
+		    (le32_to_cpu(lum->lum_hash_type) & LMV_HASH_TYPE_MASK) ==
+		    LMV_HASH_TYPE_BUCKET)
+			RETURN(-EPROTO);
+
 		if (!cap_raised(uc->uc_cap, CAP_SYS_ADMIN) &&
 		    uc->uc_gid != mdt->mdt_enable_remote_dir_gid &&
 		    mdt->mdt_enable_remote_dir_gid != -1)
@@ -2444,6 +2450,296 @@ unlock_rename:
 	return rc;
 }
 
+/*
+ * PDO lock of a remote stripe is converted to EX lock on the whole stripe,
+ * see mdt_object_lock_internal(), so all names on it share one lock.
+ */
+static inline __u32 mdt_migrate_name_lock_hash(struct mdt_migrate_name_lock *l)
+{
+	return mdt_object_remote(l->mnl_obj) ? 0 : l->mnl_lh.mlh_pdo_hash;
+}
+
+static int mdt_migrate_name_lock_cmp(const void *a, const void *b)
+{
+	struct mdt_migrate_name_lock *l1 = *(struct mdt_migrate_name_lock **)a;
+	struct mdt_migrate_name_lock *l2 = *(struct mdt_migrate_name_lock **)b;
+	__u32 h1;
+	__u32 h2;
+	int rc;
+
+	rc = lu_fid_cmp(mdt_object_fid(l1->mnl_obj),
+			mdt_object_fid(l2->mnl_obj));
+	if (rc)
+		return rc;
+
+	h1 = mdt_migrate_name_lock_hash(l1);
+	h2 = mdt_migrate_name_lock_hash(l2);
+
+	return h1 < h2 ? -1 : h1 > h2;
+}
+
+/*
+ * Find the source and target parent stripes of \a lname in the layout
+ * \a lmv, and init PDO locks of the name on them.
+ */
+static int mdt_migrate_name_lock_prep(struct mdt_thread_info *info,
+				      struct lmv_mds_md_v1 *lmv,
+				      const struct lu_name *lname,
+				      struct mdt_migrate_batch_lock *mbl)
+{
+	struct mdt_migrate_name_lock *mnl;
+	struct mdt_object *stripe;
+	struct lu_fid fid;
+	int index;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(mbl->mbl_names); i++) {
+		if (i == 0)
+			index = lmv_name_to_stripe_index_old(lmv,
+					lname->ln_name, lname->ln_namelen);
+		else
+			index = lmv_name_to_stripe_index(lmv, lname->ln_name,
+							 lname->ln_namelen);
+		if (index < 0)
+			return index;
+
+		fid_le_to_cpu(&fid, &lmv->lmv_stripe_fids[index]);
+		stripe = mdt_object_find(info->mti_env, info->mti_mdt, &fid);
+		if (IS_ERR(stripe))
+			return PTR_ERR(stripe);
+
+		mnl = &mbl->mbl_names[i];
+		mnl->mnl_obj = stripe;
+		mdt_lock_pdo_init(&mnl->mnl_lh, LCK_PW, lname);
+	}
+
+	return 0;
+}
+
+/**
+ * Migrate names of a restriping directory in one transaction.
+ *
+ * This is used by dir restripe to migrate sub files namespace only. The
+ * parent master object is PR locked to keep its layout, which allows other
+ * workers to migrate names of the same directory at the same time, and
+ * each name is PDO locked on its source and target stripes only. These
+ * name locks are taken in FID and name hash order to avoid deadlock with
+ * other workers. Then each name is looked up and its object locked like
+ * mdt_reint_migrate() does, and all names are migrated by
+ * mdo_migrate_batch().
+ *
+ * \param[in] info	thread info, with mti_attr.ma_attr time to set
+ * \param[in] pfid	parent master object FID
+ * \param[in] items	names to migrate, mmi_rc tells the result of each
+ * \param[in] locks	lock of each name, used internally
+ * \param[in] count	number of \a items
+ *
+ * \retval		0 on success
+ * \retval		-errno if parent can't be locked or transaction failed
+ */
+int mdt_reint_migrate_batch(struct mdt_thread_info *info,
+			    const struct lu_fid *pfid,
+			    struct md_migrate_item *items,
+			    struct mdt_migrate_batch_lock *locks, int count)
+{
+	const struct lu_env *env = info->mti_env;
+	struct mdt_device *mdt = info->mti_mdt;
+	struct mdt_dir_restriper *restriper = &mdt->mdt_restriper;
+	struct md_attr *ma = &info->mti_attr;
+	struct mdt_migrate_name_lock **order = NULL;
+	struct mdt_migrate_name_lock *mnl;
+	struct mdt_migrate_batch_lock *mbl;
+	struct mdt_lock_handle *lhp;
+	struct mdt_object *pobj;
+	struct mdt_object *sobj;
+	int nr = 0;
+	int todo = 0;
+	int rc;
+	int i;
+	int j;
+
+	ENTRY;
+
+	if (!mdt->mdt_enable_remote_dir || !mdt->mdt_enable_dir_migration)
+		RETURN(-EPERM);
+
+	for (i = 0; i < count; i++) {
+		mbl = &locks[i];
+		mbl->mbl_spobj = NULL;
+		mbl->mbl_sobj = NULL;
+		mbl->mbl_locked = false;
+		for (j = 0; j < ARRAY_SIZE(mbl->mbl_names); j++) {
+			mbl->mbl_names[j].mnl_obj = NULL;
+			mbl->mbl_names[j].mnl_locked = false;
+		}
+		INIT_LIST_HEAD(&mbl->mbl_slave_locks);
+		items[i].mmi_obj = NULL;
+		items[i].mmi_rc = 0;
+	}
+
+	pobj = mdt_object_find(env, mdt, pfid);
+	if (IS_ERR(pobj))
+		RETURN(PTR_ERR(pobj));
+
+	if (!mdt_object_exists(pobj))
+		GOTO(put_parent, rc = -ENOENT);
+
+	lhp = &info->mti_lh[MDT_LH_PARENT];
+	mdt_lock_reg_init(lhp, LCK_PR);
+	rc = mdt_object_lock(info, pobj, lhp, MDS_INODELOCK_UPDATE);
+	if (rc)
+		GOTO(put_parent, rc);
+
+	rc = mdt_stripe_get(info, pobj, ma, XATTR_NAME_LMV);
+	if (rc)
+		GOTO(unlock_parent, rc);
+
+	if (!(ma->ma_valid & MA_LMV))
+		GOTO(unlock_parent, rc = -ENODATA);
+
+	if (!lmv_is_sane(&ma->ma_lmv->lmv_md_v1))
+		GOTO(unlock_parent, rc = -EBADF);
+
+	OBD_ALLOC_PTR_ARRAY(order, count * ARRAY_SIZE(mbl->mbl_names));
+	if (!order)
+		GOTO(unlock_parent, rc = -ENOMEM);
+
+	for (i = 0; i < count; i++) {
+		mbl = &locks[i];
+		items[i].mmi_rc = mdt_migrate_name_lock_prep(info,
+					&ma->ma_lmv->lmv_md_v1,
+					&items[i].mmi_name, mbl);
+		if (items[i].mmi_rc)
+			continue;
+
+		for (j = 0; j < ARRAY_SIZE(mbl->mbl_names); j++)
+			order[nr++] = &mbl->mbl_names[j];
+	}
+
+	sort(order, nr, sizeof(*order), mdt_migrate_name_lock_cmp, NULL);
+	for (i = 0; i < nr; i++) {
+		mnl = order[i];
+		/* the same name hash on the same stripe is locked already */
+		if (i > 0 && !mdt_migrate_name_lock_cmp(&order[i - 1], &mnl))
+			continue;
+
+		rc = mdt_reint_object_lock(info, mnl->mnl_obj, &mnl->mnl_lh,
+					   MDS_INODELOCK_UPDATE, true);
+		if (rc)
+			GOTO(unlock_names, rc);
+
+		mnl->mnl_locked = true;
+	}
+
+	/* lookup all names first, parent LMV in @ma is reused below */
+	for (i = 0; i < count; i++) {
+		mbl = &locks[i];
+		if (items[i].mmi_rc)
+			continue;
+
+		items[i].mmi_rc = mdt_migrate_lookup(info, pobj, ma,
+						     &items[i].mmi_name,
+						     &mbl->mbl_spobj,
+						     &mbl->mbl_sobj);
+	}
+
+	for (i = 0; i < count; i++) {
+		mbl = &locks[i];
+		sobj = mbl->mbl_sobj;
+		if (items[i].mmi_rc)
+			continue;
+
+		if (S_ISDIR(lu_object_attr(&sobj->mot_obj))) {
+			rc = mdt_stripe_get(info, sobj, ma, XATTR_NAME_LMV);
+			/* race with restripe/auto-split? */
+			if (!rc && (ma->ma_valid & MA_LMV) &&
+			    lmv_is_restriping(&ma->ma_lmv->lmv_md_v1))
+				rc = -EBUSY;
+			if (rc) {
+				items[i].mmi_rc = rc;
+				continue;
+			}
+		}
+
+		if (!mdt->mdt_opts.mo_migrate_hsm_allowed) {
+			ma->ma_need = MA_HSM;
+			ma->ma_valid = 0;
+			rc = mdt_attr_get_complex(info, sobj, ma);
+			if (!rc && (ma->ma_valid & MA_HSM) &&
+			    ma->ma_hsm.mh_flags != 0)
+				rc = -EOPNOTSUPP;
+			if (rc) {
+				items[i].mmi_rc = rc;
+				continue;
+			}
+		}
+
+		mdt_lock_reg_init(&mbl->mbl_lh, LCK_EX);
+		rc = mdt_migrate_object_lock(info, mbl->mbl_spobj, sobj,
+					     &mbl->mbl_lh, &mbl->mbl_einfo,
+					     &mbl->mbl_slave_locks);
+		if (rc) {
+			items[i].mmi_rc = rc;
+			continue;
+		}
+
+		mbl->mbl_locked = true;
+		items[i].mmi_obj = mdt_object_child(sobj);
+		todo++;
+	}
+
+	rc = 0;
+	if (todo) {
+		if (atomic_inc_return(&restriper->mdr_migrate_inflight) > 1)
+			atomic64_inc(&restriper->mdr_stat_trans_overlapped);
+		OBD_FAIL_TIMEOUT_MS(OBD_FAIL_MIGRATE_BATCH_DELAY, cfs_fail_val);
+
+		rc = mdo_migrate_batch(env, mdt_object_child(pobj), items,
+				       count, ma);
+		atomic_dec(&restriper->mdr_migrate_inflight);
+		for (i = 0; i < count; i++)
+			if (items[i].mmi_obj && !items[i].mmi_rc)
+				lprocfs_counter_incr(
+					mdt->mdt_lu_dev.ld_obd->obd_md_stats,
+					LPROC_MDT_MIGRATE + LPROC_MD_LAST_OPC);
+	}
+
+	for (i = 0; i < count; i++) {
+		mbl = &locks[i];
+		if (mbl->mbl_locked)
+			mdt_migrate_object_unlock(info, mbl->mbl_sobj,
+						  &mbl->mbl_lh,
+						  &mbl->mbl_einfo,
+						  &mbl->mbl_slave_locks,
+						  items[i].mmi_rc);
+		if (mbl->mbl_sobj)
+			mdt_object_put(env, mbl->mbl_sobj);
+		if (mbl->mbl_spobj)
+			mdt_object_put(env, mbl->mbl_spobj);
+	}
+	EXIT;
+
+unlock_names:
+	for (i = 0; i < count; i++) {
+		mbl = &locks[i];
+		for (j = 0; j < ARRAY_SIZE(mbl->mbl_names); j++) {
+			mnl = &mbl->mbl_names[j];
+			if (mnl->mnl_locked)
+				mdt_object_unlock(info, mnl->mnl_obj,
+						  &mnl->mnl_lh, rc);
+			if (mnl->mnl_obj)
+				mdt_object_put(env, mnl->mnl_obj);
+		}
+	}
+	OBD_FREE_PTR_ARRAY(order, count * ARRAY_SIZE(mbl->mbl_names));
+unlock_parent:
+	mdt_object_unlock(info, pobj, lhp, rc);
+put_parent:
+	mdt_object_put(env, pobj);
+
+	return rc;
+}
+
 static int mdt_object_lock_save(struct mdt_thread_info *info,
 				struct mdt_object *dir,
 				struct mdt_lock_handle *lh,
@@ -33,6 +33,10 @@
 #include <linux/kthread.h>
 #include "mdt_internal.h"
 
+static int dir_restripe_threads = DIR_RESTRIPE_THREADS_DEFAULT;
+module_param(dir_restripe_threads, int, 0444);
+MODULE_PARM_DESC(dir_restripe_threads, "number of threads to migrate sub files in directory restripe");
+
 /* add directory into splitting list and wake up restripe thread */
 void mdt_auto_split_add(struct mdt_thread_info *info, struct mdt_object *o)
 {
@@ -60,22 +64,50 @@ void mdt_restripe_migrate_add(struct mdt_thread_info *info,
 {
 	struct mdt_device *mdt = info->mti_mdt;
 	struct mdt_dir_restriper *restriper = &mdt->mdt_restriper;
+	struct mdt_restripe_stripe *mrs;
+	struct mdt_restripe_range *range;
+
+	/* checked again under lock below */
+	if (o->mot_restriping)
+		return;
+
+	OBD_ALLOC_PTR(mrs);
+	OBD_ALLOC_PTR(range);
+	if (!mrs || !range)
+		goto out;
 
 	spin_lock(&restriper->mdr_lock);
 	if (!o->mot_restriping) {
 		o->mot_restriping = 1;
-		o->mot_restripe_offset = 0;
 		mdt_object_get(NULL, o);
 		LASSERT(list_empty(&o->mot_restripe_linkage));
-		list_add_tail(&o->mot_restripe_linkage,
-			      &restriper->mdr_migrating);
+		if (list_empty(&restriper->mdr_migrating) &&
+		    !restriper->mdr_migrate_active) {
+			restriper->mdr_migrate_start = ktime_get_real_seconds();
+			restriper->mdr_migrate_base =
+				atomic64_read(&restriper->mdr_stat_migrated);
+		}
+		/* the whole hash range, it's split by worker threads */
+		mrs->mrs_obj = o;
+		mrs->mrs_ranges = 1;
+		range->mrr_stripe = mrs;
+		range->mrr_offset = 0;
+		range->mrr_end = MDS_DIR_END_OFF;
+		list_add_tail(&range->mrr_linkage, &restriper->mdr_migrating);
+		mrs = NULL;
+		range = NULL;
 
 		CDEBUG(D_INFO, "add "DFID" into migrate list.\n",
 		       PFID(mdt_object_fid(o)));
 	}
 	spin_unlock(&restriper->mdr_lock);
 
-	wake_up_process(restriper->mdr_task);
+	wake_up(&restriper->mdr_migrate_waitq);
+out:
+	if (mrs)
+		OBD_FREE_PTR(mrs);
+	if (range)
+		OBD_FREE_PTR(range);
 }
 
 void mdt_restripe_update_add(struct mdt_thread_info *info,
@@ -153,6 +185,7 @@ int mdt_restripe_internal(struct mdt_thread_info *info,
 	struct lmv_user_md *lum = spec->u.sp_ea.eadata;
 	struct lmv_mds_md_v1 *lmv;
 	u32 lmv_stripe_count = 0;
+	bool rebalance = false;
 	int rc;
 
 	ENTRY;
@@ -170,9 +203,16 @@ int mdt_restripe_internal(struct mdt_thread_info *info,
 		if (lmv_is_layout_changing(lmv))
 			RETURN(-EBUSY);
 
-		/* check whether stripe count and hash unchanged */
+		/* "bucket" hash with stripe count unchanged: rebalance stripes
+		 * by the current MDT load, or check whether stripe count and
+		 * hash unchanged.
+		 */
 		if (lum->lum_stripe_count == lmv->lmv_stripe_count &&
-		    lum->lum_hash_type == lmv->lmv_hash_type)
+		    lmv_hash_is_bucket(le32_to_cpu(lum->lum_hash_type)) &&
+		    lmv_hash_is_bucket(le32_to_cpu(lmv->lmv_hash_type)))
+			rebalance = true;
+		else if (lum->lum_stripe_count == lmv->lmv_stripe_count &&
+			 lum->lum_hash_type == lmv->lmv_hash_type)
 			RETURN(-EALREADY);
 
 		lmv_stripe_count = le32_to_cpu(lmv->lmv_stripe_count);
@@ -230,7 +270,7 @@ int mdt_restripe_internal(struct mdt_thread_info *info,
 		else
 			*tfid = *mdt_object_fid(child);
 	} else {
-		/* merge only needs to override LMV */
+		/* merge and rebalance only need to override LMV */
 		struct lu_buf *buf = &info->mti_buf;
 		__u32 version;
 
@@ -242,12 +282,27 @@ int mdt_restripe_internal(struct mdt_thread_info *info,
 		if (lum->lum_stripe_count == 0)
 			lum->lum_stripe_count = cpu_to_le32(1);
 
-		lmv->lmv_hash_type |= cpu_to_le32(LMV_HASH_FLAG_MERGE |
-						  LMV_HASH_FLAG_MIGRATION);
+		if (rebalance) {
+			__u64 weights = le64_to_cpu(lmv->lmv_bucket_weights);
+
+			/* LOD sets new weights, keep the old ones to find sub
+			 * files not migrated yet.
+			 */
+			lmv->lmv_hash_type |=
+				cpu_to_le32(LMV_HASH_FLAG_LAYOUT_CHANGE);
+			lmv->lmv_rebalance_weights_lo =
+				cpu_to_le32(lower_32_bits(weights));
+			lmv->lmv_rebalance_weights_hi =
+				cpu_to_le32(upper_32_bits(weights));
+		} else {
+			lmv->lmv_hash_type |=
+				cpu_to_le32(LMV_HASH_FLAG_MERGE |
+					    LMV_HASH_FLAG_MIGRATION);
+			lmv->lmv_merge_offset = lum->lum_stripe_count;
+			lmv->lmv_merge_hash = lum->lum_hash_type;
+		}
 		lmv->lmv_hash_type |= lum->lum_hash_type &
 				      cpu_to_le32(LMV_HASH_FLAG_FIXED);
-		lmv->lmv_merge_offset = lum->lum_stripe_count;
-		lmv->lmv_merge_hash = lum->lum_hash_type;
 		lmv->lmv_layout_version = cpu_to_le32(++version);
 
 		buf->lb_buf = lmv;
@@ -415,6 +470,8 @@ static int mdt_auto_split(struct mdt_thread_info *info)
 	mdt_auto_split_prep(info, spec, ma, lum_stripe_count);
 
 	rc = mdt_restripe_internal(info, parent, child, lname, fid, spec, ma);
+	if (!rc)
+		atomic64_inc(&restriper->mdr_stat_split);
 	EXIT;
 
 unlock_child:
@@ -483,20 +540,11 @@ static int mdt_restripe_migrate_finish(struct mdt_thread_info *info,
 		CERROR("%s: update "DFID" LMV failed: rc = %d\n",
 		       mdt_obd_name(mdt), PFID(mdt_object_fid(stripe)), rc);
 
-	LASSERT(!list_empty(&stripe->mot_restripe_linkage));
-	LASSERT(stripe->mot_restriping);
-
-	spin_lock(&mdt->mdt_lock);
-	stripe->mot_restriping = 0;
-	list_del_init(&stripe->mot_restripe_linkage);
-	spin_unlock(&mdt->mdt_lock);
-
-	mdt_object_put(info->mti_env, stripe);
-
-	RETURN(rc);
+	RETURN(rc ? rc : 1);
 }
 
 static void mdt_restripe_migrate_prep(struct mdt_thread_info *info,
+				      struct mdt_restripe_worker *worker,
 				      const struct lu_fid *fid1,
 				      const struct lu_fid *fid2,
 				      const struct lu_name *lname,
@@ -515,10 +563,10 @@ static void mdt_restripe_migrate_prep(struct mdt_thread_info *info,
 	rr->rr_fid2 = fid2;
 	rr->rr_name = *lname;
 
-	lum = &info->mti_mdt->mdt_restriper.mdr_lmv.lmv_user_md;
+	lum = &worker->mrw_lmv.lmv_user_md;
 	lum->lum_magic = cpu_to_le32(LMV_USER_MAGIC);
 	lum->lum_stripe_offset = cpu_to_le32(LMV_OFFSET_DEFAULT);
-	if (lmv_is_splitting(lmv)) {
+	if (lmv_is_splitting(lmv) || lmv_is_rebalancing(lmv)) {
 		lum->lum_stripe_count = lmv->lmv_stripe_count;
 		lum->lum_hash_type =
 			lmv->lmv_hash_type & le32_to_cpu(LMV_HASH_TYPE_MASK);
@@ -540,36 +588,145 @@ static void mdt_restripe_migrate_prep(struct mdt_thread_info *info,
 			info->mti_mdt->mdt_dir_restripe_nsonly;
 }
 
-/* migrate sub-file from @mdr_restripe_offset */
-static int mdt_restripe_migrate(struct mdt_thread_info *info)
+static int mdt_restripe_migrate_one(struct mdt_thread_info *info,
+				    struct mdt_restripe_worker *worker,
+				    struct mdt_object *master,
+				    const struct lu_fid *fid1,
+				    const struct lu_name *lname,
+				    __u16 type,
+				    const struct lmv_mds_md_v1 *lmv)
+{
+	struct mdt_dir_restriper *restriper = worker->mrw_restriper;
+	struct lu_fid fid2;
+	int rc;
+
+	rc = mdt_fid_alloc(info->mti_env, info->mti_mdt, &fid2, master, lname);
+	if (rc < 0)
+		return rc;
+
+	mdt_restripe_migrate_prep(info, worker, fid1, &fid2, lname, type, lmv);
+
+	rc = mdt_reint_migrate(info, NULL);
+	/* mti_big_buf is allocated in XATTR migration */
+	if (unlikely(info->mti_big_buf.lb_buf))
+		lu_buf_free(&info->mti_big_buf);
+	/* -ENOENT: file is removed after readpage */
+	if (rc == -EALREADY || rc == -ENOENT)
+		return 0;
+
+	if (!rc) {
+		atomic64_inc(&restriper->mdr_stat_migrated);
+		atomic64_inc(&worker->mrw_migrated);
+	}
+
+	return rc;
+}
+
+/*
+ * Migrate the first \a count names of mrw_items namespace only in one
+ * transaction, files with hard links are migrated one by one afterwards.
+ */
+static int mdt_restripe_migrate_names(struct mdt_thread_info *info,
+				      struct mdt_restripe_worker *worker,
+				      struct mdt_object *master,
+				      const struct lu_fid *fid1,
+				      const struct lmv_mds_md_v1 *lmv,
+				      int count)
+{
+	struct mdt_dir_restriper *restriper = worker->mrw_restriper;
+	struct lu_attr *attr = &info->mti_attr.ma_attr;
+	struct md_migrate_item *item;
+	int rc;
+	int i;
+
+	if (!count)
+		return 0;
+
+	attr->la_ctime = attr->la_mtime = ktime_get_real_seconds();
+	attr->la_valid = LA_CTIME | LA_MTIME;
+
+	rc = mdt_reint_migrate_batch(info, fid1, worker->mrw_items,
+				     worker->mrw_locks, count);
+	if (rc)
+		return rc;
+
+	atomic64_inc(&restriper->mdr_stat_trans);
+
+	for (i = 0; i < count; i++) {
+		item = &worker->mrw_items[i];
+		switch (item->mmi_rc) {
+		case 0:
+			atomic64_inc(&restriper->mdr_stat_migrated);
+			atomic64_inc(&worker->mrw_migrated);
+			break;
+		case -EALREADY:
+		case -ENOENT:
+			/* -ENOENT: file is removed after readpage */
+			break;
+		case -EAGAIN:
+			/* parents of other links need to be locked */
+			rc = mdt_restripe_migrate_one(info, worker, master,
+						      fid1, &item->mmi_name,
+						      S_IFREG, lmv);
+			break;
+		default:
+			rc = item->mmi_rc;
+			break;
+		}
+		if (rc)
+			return rc;
+	}
+
+	return 0;
+}
+
+/**
+ * Migrate sub files of \a range from its mrr_offset.
+ *
+ * Sub files are read from one directory page, and up to mdr_migrate_batch
+ * of them are migrated before the range is given back to the migrating
+ * list, so that worker threads serve all restriping stripes in turn.
+ * Sub directories, and files if dir_restripe_nsonly is set, are migrated
+ * namespace only in one transaction, other files are migrated one by one.
+ *
+ * \retval	0 if there are more sub files to migrate
+ * \retval	1 if all sub files of this range are migrated
+ * \retval	negative errno on failure
+ */
+static int mdt_restripe_migrate(struct mdt_thread_info *info,
+				struct mdt_restripe_worker *worker,
+				struct mdt_restripe_range *range)
 {
 	const struct lu_env *env = info->mti_env;
 	struct mdt_device *mdt = info->mti_mdt;
 	struct mdt_dir_restriper *restriper = &mdt->mdt_restriper;
-	struct mdt_object *stripe = NULL;
+	struct mdt_object *stripe = range->mrr_stripe->mrs_obj;
 	struct mdt_object *master = NULL;
 	struct md_attr *ma = &info->mti_attr;
-	struct lmv_mds_md_v1 *lmv;
+	struct lmv_mds_md_v1 lmv;
 	struct lu_name *lname = &info->mti_name;
 	struct lu_rdpg *rdpg = &info->mti_u.rdpg.mti_rdpg;
-	struct lu_fid fid1;
-	struct lu_fid fid2;
+	struct md_migrate_item *item;
+	struct lu_fid fid1 = { 0 };
 	struct lu_dirpage *dp;
 	struct lu_dirent *ent;
-	const char *name = NULL;
+	struct lu_dirent *next;
+	char *name;
 	int namelen = 0;
+	__u64 hash;
 	__u16 type;
+	u32 count = 0;
+	int batched = 0;
+	bool done = false;
 	int idx = 0;
 	int len;
 	int rc;
 
 	ENTRY;
 
-	if (list_empty(&restriper->mdr_migrating))
-		RETURN(0);
-
-	stripe = list_entry(restriper->mdr_migrating.next, typeof(*stripe),
-			    mot_restripe_linkage);
+	/* other range of this stripe failed, stripe will be added again */
+	if (READ_ONCE(range->mrr_stripe->mrs_rc))
+		RETURN(1);
 
 	/* get master object FID and stripe name */
 	rc = mdt_attr_get_pfid_name(info, stripe, &fid1, lname);
@@ -597,45 +754,59 @@ static int mdt_restripe_migrate(struct mdt_thread_info *info)
 	if (!(ma->ma_valid & MA_LMV))
 		GOTO(out, rc = -ENODATA);
 
-	lmv = &ma->ma_lmv->lmv_md_v1;
-	if (le32_to_cpu(lmv->lmv_magic) != LMV_MAGIC_STRIPE)
+	/* ma_lmv is reused by migrate, keep stripe LMV in local copy */
+	lmv = ma->ma_lmv->lmv_md_v1;
+	if (le32_to_cpu(lmv.lmv_magic) != LMV_MAGIC_STRIPE)
 		GOTO(out, rc = -EBADF);
 
-	if (!lmv_is_restriping(lmv))
+	if (!lmv_is_restriping(&lmv))
 		GOTO(out, rc = -EINVAL);
 
-	if ((lmv_is_splitting(lmv) &&
-	     idx >= le32_to_cpu(lmv->lmv_split_offset)) ||
-	    (lmv_is_merging(lmv) &&
-	     (le32_to_cpu(lmv->lmv_hash_type) & LMV_HASH_TYPE_MASK) ==
+	if ((lmv_is_splitting(&lmv) &&
+	     idx >= le32_to_cpu(lmv.lmv_split_offset)) ||
+	    (lmv_is_merging(&lmv) &&
+	     (le32_to_cpu(lmv.lmv_hash_type) & LMV_HASH_TYPE_MASK) ==
 		LMV_HASH_TYPE_CRUSH &&
-	     idx < le32_to_cpu(lmv->lmv_merge_offset))) {
+	     idx < le32_to_cpu(lmv.lmv_merge_offset)))
 		/* new stripes doesn't need to migrate sub files in dir
 		 * split, neither for target stripes in dir merge if hash type
 		 * is CRUSH.
 		 */
-		rc = mdt_restripe_migrate_finish(info, stripe, lmv);
-		RETURN(rc);
-	}
+		RETURN(1);
 
-	/* get sub file name @mot_restripe_offset.
-	 * TODO: read one dirent instead of whole page.
-	 */
-	rdpg->rp_hash = stripe->mot_restripe_offset;
+	/* get sub files from @mrr_offset */
+	rdpg->rp_hash = range->mrr_offset;
 	rdpg->rp_count = PAGE_SIZE;
 	rdpg->rp_npages = 1;
 	rdpg->rp_attrs = LUDA_64BITHASH | LUDA_FID | LUDA_TYPE;
-	rdpg->rp_pages = &restriper->mdr_page;
+	rdpg->rp_pages = &worker->mrw_page;
 	rc = mo_readpage(env, mdt_object_child(stripe), rdpg);
 	if (rc < 0)
 		GOTO(out, rc);
+	rc = 0;
+
+	master = mdt_object_find(env, mdt, &fid1);
+	if (IS_ERR(master))
+		GOTO(out, rc = PTR_ERR(master));
 
-	dp = page_address(restriper->mdr_page);
-	for (ent = lu_dirent_start(dp); ent; ent = lu_dirent_next(ent)) {
-		LASSERT(le64_to_cpu(ent->lde_hash) >= rdpg->rp_hash);
+	dp = page_address(worker->mrw_page);
+	for (ent = lu_dirent_start(dp); ent; ent = next) {
+		hash = le64_to_cpu(ent->lde_hash);
+		LASSERT(hash >= rdpg->rp_hash);
+
+		/* the rest belongs to next range */
+		if (hash >= range->mrr_end) {
+			done = true;
+			break;
+		}
 
 		if (unlikely(!(le32_to_cpu(ent->lde_attrs) & LUDA_TYPE)))
-			GOTO(out, rc = -EINVAL);
+			GOTO(out_put, rc = -EINVAL);
+
+		/* skip dummy record */
+		next = lu_dirent_next(ent);
+		while (next && le16_to_cpu(next->lde_namelen) == 0)
+			next = lu_dirent_next(next);
 
 		namelen = le16_to_cpu(ent->lde_namelen);
 		if (!namelen)
@@ -644,81 +815,133 @@ static int mdt_restripe_migrate(struct mdt_thread_info *info)
 		if (name_is_dot_or_dotdot(ent->lde_name, namelen))
 			continue;
 
-		name = ent->lde_name;
-		type = lu_dirent_type_get(ent);
-		break;
-	}
-
-	if (!name) {
-		if (le64_to_cpu(dp->ldp_hash_end) == MDS_DIR_END_OFF) {
-			rc = mdt_restripe_migrate_finish(info, stripe, lmv);
-			RETURN(rc);
-		}
-
-		GOTO(out, rc = -EBADF);
-	}
+		if (count >= restriper->mdr_migrate_batch)
+			break;
 
-	/* copy name out because it should end with '\0' */
-	memcpy(info->mti_filename, name, namelen);
-	info->mti_filename[namelen] = '\0';
-	lname->ln_name = info->mti_filename;
-	lname->ln_namelen = namelen;
+		type = lu_dirent_type_get(ent);
 
-	CDEBUG(D_INFO, "migrate "DFID"/"DNAME" type %ho\n",
-	       PFID(&fid1), PNAME(lname), type);
+		/* copy name out because it should end with '\0' */
+		name = worker->mrw_names[batched];
+		memcpy(name, ent->lde_name, namelen);
+		name[namelen] = '\0';
+		lname->ln_name = name;
+		lname->ln_namelen = namelen;
 
-	master = mdt_object_find(env, mdt, &fid1);
-	if (IS_ERR(master))
-		GOTO(out, rc = PTR_ERR(master));
+		CDEBUG(D_INFO, "migrate "DFID"/"DNAME" type %ho\n",
+		       PFID(&fid1), PNAME(lname), type);
 
-	rc = mdt_fid_alloc(env, mdt, &fid2, master, lname);
-	mdt_object_put(env, master);
-	if (rc < 0)
-		GOTO(out, rc);
+		if (S_ISDIR(type) || mdt->mdt_dir_restripe_nsonly) {
+			item = &worker->mrw_items[batched++];
+			item->mmi_name.ln_name = name;
+			item->mmi_name.ln_namelen = namelen;
+		} else {
+			/* inode migration isn't batched */
+			rc = mdt_restripe_migrate_names(info, worker, master,
+							&fid1, &lmv, batched);
+			batched = 0;
+			if (!rc)
+				rc = mdt_restripe_migrate_one(info, worker,
+							      master, &fid1,
+							      lname, type,
+							      &lmv);
+			if (rc)
+				GOTO(out_put, rc);
+		}
+		count++;
 
-	mdt_restripe_migrate_prep(info, &fid1, &fid2, lname, type, lmv);
+		/* if migration fails, the whole range is dropped */
+		if (next)
+			range->mrr_offset = le64_to_cpu(next->lde_hash);
+		else
+			range->mrr_offset = le64_to_cpu(dp->ldp_hash_end);
+	}
 
-	rc = mdt_reint_migrate(info, NULL);
-	/* mti_big_buf is allocated in XATTR migration */
-	if (unlikely(info->mti_big_buf.lb_buf))
-		lu_buf_free(&info->mti_big_buf);
-	if (rc == -EALREADY)
-		rc = 0;
+	rc = mdt_restripe_migrate_names(info, worker, master, &fid1, &lmv,
+					batched);
 	if (rc)
-		GOTO(out, rc);
+		GOTO(out_put, rc);
 
-	LASSERT(ent);
-	do {
-		ent = lu_dirent_next(ent);
-		if (!ent)
-			break;
+	if (done)
+		GOTO(out_put, rc = 1);
 
-		namelen = le16_to_cpu(ent->lde_namelen);
-	} while (namelen == 0); /* Skip dummy record */
+	if (!ent) {
+		hash = le64_to_cpu(dp->ldp_hash_end);
+		/* whole page is done */
+		if (hash == MDS_DIR_END_OFF || hash >= range->mrr_end)
+			GOTO(out_put, rc = 1);
 
-	if (ent)
-		stripe->mot_restripe_offset = le64_to_cpu(ent->lde_hash);
-	else
-		stripe->mot_restripe_offset = le64_to_cpu(dp->ldp_hash_end);
+		/* no sub file in this page, and hash doesn't move forward */
+		if (!count && hash <= rdpg->rp_hash)
+			GOTO(out_put, rc = -EBADF);
+
+		range->mrr_offset = hash;
+	}
 
 	EXIT;
+out_put:
+	mdt_object_put(env, master);
 out:
-	if (rc) {
+	if (rc < 0) {
+		atomic64_inc(&restriper->mdr_stat_failed);
 		/* -EBUSY: file is opened by others */
 		if (rc != -EBUSY)
 			CERROR("%s: migrate "DFID"/"DNAME" failed: rc = %d\n",
 			       mdt_obd_name(mdt), PFID(&fid1), PNAME(lname),
 			       rc);
+	}
 
-		spin_lock(&mdt->mdt_lock);
-		stripe->mot_restriping = 0;
-		list_del_init(&stripe->mot_restripe_linkage);
-		spin_unlock(&mdt->mdt_lock);
+	return rc;
+}
 
-		mdt_object_put(env, stripe);
+/* all hash ranges of a stripe are migrated, or one of them failed */
+static void mdt_restripe_stripe_done(struct mdt_thread_info *info,
+				     struct mdt_restripe_stripe *mrs)
+{
+	struct mdt_dir_restriper *restriper = &info->mti_mdt->mdt_restriper;
+	struct mdt_object *stripe = mrs->mrs_obj;
+	struct md_attr *ma = &info->mti_attr;
+	struct lmv_mds_md_v1 lmv;
+	int rc;
+
+	if (!mrs->mrs_rc) {
+		rc = mdt_stripe_get(info, stripe, ma, XATTR_NAME_LMV);
+		if (!rc && (ma->ma_valid & MA_LMV)) {
+			/* ma_lmv is reused in lock, keep a local copy */
+			lmv = ma->ma_lmv->lmv_md_v1;
+			if (le32_to_cpu(lmv.lmv_magic) == LMV_MAGIC_STRIPE &&
+			    lmv_is_restriping(&lmv))
+				mdt_restripe_migrate_finish(info, stripe, &lmv);
+		}
 	}
 
-	return rc;
+	spin_lock(&restriper->mdr_lock);
+	stripe->mot_restriping = 0;
+	spin_unlock(&restriper->mdr_lock);
+
+	mdt_object_put(info->mti_env, stripe);
+	OBD_FREE_PTR(mrs);
+}
+
+/*
+ * Split \a range in two halves, and put the upper half in \a new. Empty
+ * halves are done in one readdir, so that idle threads keep halving the
+ * range where sub files are, whatever the hash distribution is.
+ */
+static bool mdt_restripe_range_split(struct mdt_restripe_range *range,
+				     struct mdt_restripe_range *new)
+{
+	__u64 half = (range->mrr_end - range->mrr_offset) >> 1;
+
+	if (!half)
+		return false;
+
+	new->mrr_stripe = range->mrr_stripe;
+	new->mrr_offset = range->mrr_offset + half;
+	new->mrr_end = range->mrr_end;
+	range->mrr_end = new->mrr_offset;
+	range->mrr_stripe->mrs_ranges++;
+
+	return true;
 }
 
 static inline bool mdt_restripe_update_pending(struct mdt_thread_info *info)
@@ -748,7 +971,7 @@ static void mdt_restripe_layout_update_prep(struct mdt_thread_info *info,
 	lum = &info->mti_mdt->mdt_restriper.mdr_lmv.lmv_user_md;
 	lum->lum_magic = cpu_to_le32(LMV_USER_MAGIC);
 	lum->lum_stripe_offset = cpu_to_le32(LMV_OFFSET_DEFAULT);
-	if (lmv_is_splitting(lmv)) {
+	if (lmv_is_splitting(lmv) || lmv_is_rebalancing(lmv)) {
 		lum->lum_stripe_count = lmv->lmv_stripe_count;
 		lum->lum_hash_type =
 			lmv->lmv_hash_type & le32_to_cpu(LMV_HASH_TYPE_MASK);
@@ -868,10 +1091,11 @@ static int mdt_restriper_main(void *arg)
 			__set_current_state(TASK_RUNNING);
 			mdt_restripe_layout_update(info);
 			cond_resched();
-		} else if (!list_empty(&restriper->mdr_migrating)) {
-			__set_current_state(TASK_RUNNING);
-			mdt_restripe_migrate(info);
-			cond_resched();
+		} else if (!list_empty(&restriper->mdr_updating)) {
+			/* sub files are migrated by worker threads, check
+			 * periodically whether layout can be updated.
+			 */
+			schedule_timeout(cfs_time_seconds(1));
 		} else {
 			schedule();
 		}
@@ -881,40 +1105,119 @@ static int mdt_restriper_main(void *arg)
 	RETURN(0);
 }
 
-int mdt_restriper_start(struct mdt_device *mdt)
+static int mdt_restripe_worker_main(void *arg)
 {
-	struct mdt_dir_restriper *restriper = &mdt->mdt_restriper;
-	struct task_struct *task;
+	struct mdt_restripe_worker *worker = arg;
+	struct mdt_dir_restriper *restriper = worker->mrw_restriper;
+	struct lu_env *env = &worker->mrw_env;
 	struct mdt_thread_info *info;
-	struct lu_ucred *uc;
+	struct mdt_restripe_range *range;
+	struct mdt_restripe_stripe *mrs;
+	bool split;
+	bool last;
 	int rc;
 
 	ENTRY;
 
-	spin_lock_init(&restriper->mdr_lock);
-	INIT_LIST_HEAD(&restriper->mdr_auto_splitting);
-	INIT_LIST_HEAD(&restriper->mdr_migrating);
-	INIT_LIST_HEAD(&restriper->mdr_updating);
-	restriper->mdr_dir_split_count = DIR_SPLIT_COUNT_DEFAULT;
-	restriper->mdr_dir_split_delta = DIR_SPLIT_DELTA_DEFAULT;
+	info = lu_context_key_get(&env->le_ctx, &mdt_thread_key);
 
-	restriper->mdr_page = alloc_page(GFP_KERNEL);
-	if (!restriper->mdr_page)
-		RETURN(-ENOMEM);
+	while (!kthread_should_stop()) {
+		wait_event_idle(restriper->mdr_migrate_waitq,
+				kthread_should_stop() ||
+				!list_empty(&restriper->mdr_migrating));
 
-	rc = lu_env_init(&restriper->mdr_env, LCT_MD_THREAD);
-	if (rc)
-		GOTO(out_page, rc);
+		if (!worker->mrw_range)
+			OBD_ALLOC_PTR(worker->mrw_range);
+
+		range = NULL;
+		split = false;
+		spin_lock(&restriper->mdr_lock);
+		if (!list_empty(&restriper->mdr_migrating)) {
+			range = list_first_entry(&restriper->mdr_migrating,
+						 struct mdt_restripe_range,
+						 mrr_linkage);
+			list_del_init(&range->mrr_linkage);
+			restriper->mdr_migrate_active++;
+			/* share the last range with idle threads */
+			if (list_empty(&restriper->mdr_migrating) &&
+			    restriper->mdr_migrate_active <
+			    restriper->mdr_worker_count && worker->mrw_range)
+				split = mdt_restripe_range_split(range,
+							worker->mrw_range);
+			if (split) {
+				list_add_tail(&worker->mrw_range->mrr_linkage,
+					      &restriper->mdr_migrating);
+				worker->mrw_range = NULL;
+			}
+		}
+		spin_unlock(&restriper->mdr_lock);
+
+		if (!range)
+			continue;
+
+		if (split)
+			wake_up(&restriper->mdr_migrate_waitq);
 
-	rc = lu_context_init(&restriper->mdr_session, LCT_SERVER_SESSION);
+		mrs = range->mrr_stripe;
+		LASSERT(mrs->mrs_obj->mot_restriping);
+		rc = mdt_restripe_migrate(info, worker, range);
+		atomic64_inc(&restriper->mdr_stat_passes);
+
+		last = false;
+		spin_lock(&restriper->mdr_lock);
+		restriper->mdr_migrate_active--;
+		if (rc == 0) {
+			/* more sub files to migrate, put it at the tail so
+			 * that stripes are served in turn.
+			 */
+			list_add_tail(&range->mrr_linkage,
+				      &restriper->mdr_migrating);
+			range = NULL;
+		} else {
+			if (rc < 0 && !mrs->mrs_rc)
+				mrs->mrs_rc = rc;
+			last = --mrs->mrs_ranges == 0;
+		}
+		spin_unlock(&restriper->mdr_lock);
+
+		if (range) {
+			OBD_FREE_PTR(range);
+			if (last)
+				mdt_restripe_stripe_done(info, mrs);
+		} else {
+			wake_up(&restriper->mdr_migrate_waitq);
+		}
+
+		cond_resched();
+	}
+
+	RETURN(0);
+}
+
+/* set up environment of restripe threads, which run as root */
+static struct mdt_thread_info *
+mdt_restripe_env_init(struct mdt_device *mdt, struct lu_env *env,
+		      struct lu_context *session)
+{
+	struct mdt_thread_info *info;
+	struct lu_ucred *uc;
+	int rc;
+
+	rc = lu_env_init(env, LCT_MD_THREAD);
 	if (rc)
-		GOTO(out_env, rc);
+		return ERR_PTR(rc);
 
-	lu_context_enter(&restriper->mdr_session);
-	restriper->mdr_env.le_ses = &restriper->mdr_session;
+	rc = lu_context_init(session, LCT_SERVER_SESSION);
+	if (rc) {
+		lu_env_fini(env);
+		return ERR_PTR(rc);
+	}
 
-	info = lu_context_key_get(&restriper->mdr_env.le_ctx, &mdt_thread_key);
-	info->mti_env = &restriper->mdr_env;
+	lu_context_enter(session);
+	env->le_ses = session;
+
+	info = lu_context_key_get(&env->le_ctx, &mdt_thread_key);
+	info->mti_env = env;
 	info->mti_mdt = mdt;
 	info->mti_pill = NULL;
 	info->mti_dlm_req = NULL;
@@ -936,26 +1239,183 @@ int mdt_restriper_start(struct mdt_device *mdt)
 	uc->uc_ginfo = NULL;
 	uc->uc_identity = NULL;
 
+	return info;
+}
+
+static void mdt_restripe_env_fini(struct lu_env *env)
+{
+	lu_context_exit(env->le_ses);
+	lu_context_fini(env->le_ses);
+	lu_env_fini(env);
+}
+
+static void mdt_restripe_worker_free(struct mdt_restripe_worker *worker)
+{
+	if (worker->mrw_page)
+		__free_page(worker->mrw_page);
+	if (worker->mrw_items)
+		OBD_FREE_PTR_ARRAY_LARGE(worker->mrw_items,
+					 DIR_RESTRIPE_MIGRATE_BATCH_MAX);
+	if (worker->mrw_locks)
+		OBD_FREE_PTR_ARRAY_LARGE(worker->mrw_locks,
+					 DIR_RESTRIPE_MIGRATE_BATCH_MAX);
+	if (worker->mrw_names)
+		OBD_FREE_PTR_ARRAY_LARGE(worker->mrw_names,
+					 DIR_RESTRIPE_MIGRATE_BATCH_MAX);
+	if (worker->mrw_range)
+		OBD_FREE_PTR(worker->mrw_range);
+}
+
+static int mdt_restripe_worker_alloc(struct mdt_restripe_worker *worker)
+{
+	worker->mrw_page = alloc_page(GFP_KERNEL);
+	if (!worker->mrw_page)
+		return -ENOMEM;
+
+	OBD_ALLOC_PTR_ARRAY_LARGE(worker->mrw_items,
+				  DIR_RESTRIPE_MIGRATE_BATCH_MAX);
+	if (!worker->mrw_items)
+		return -ENOMEM;
+
+	OBD_ALLOC_PTR_ARRAY_LARGE(worker->mrw_locks,
+				  DIR_RESTRIPE_MIGRATE_BATCH_MAX);
+	if (!worker->mrw_locks)
+		return -ENOMEM;
+
+	OBD_ALLOC_PTR_ARRAY_LARGE(worker->mrw_names,
+				  DIR_RESTRIPE_MIGRATE_BATCH_MAX);
+	if (!worker->mrw_names)
+		return -ENOMEM;
+
+	return 0;
+}
+
+static void mdt_restripe_workers_stop(struct mdt_dir_restriper *restriper)
+{
+	struct mdt_restripe_worker *worker;
+	int i;
+
+	if (!restriper->mdr_workers)
+		return;
+
+	for (i = 0; i < restriper->mdr_worker_count; i++) {
+		worker = &restriper->mdr_workers[i];
+		if (worker->mrw_task) {
+			kthread_stop(worker->mrw_task);
+			worker->mrw_task = NULL;
+			mdt_restripe_env_fini(&worker->mrw_env);
+		}
+		mdt_restripe_worker_free(worker);
+	}
+
+	OBD_FREE_PTR_ARRAY(restriper->mdr_workers,
+			   restriper->mdr_worker_count);
+	restriper->mdr_workers = NULL;
+	restriper->mdr_worker_count = 0;
+}
+
+static int mdt_restripe_workers_start(struct mdt_device *mdt)
+{
+	struct mdt_dir_restriper *restriper = &mdt->mdt_restriper;
+	struct mdt_restripe_worker *worker;
+	struct mdt_thread_info *info;
+	struct task_struct *task;
+	int count;
+	int rc = 0;
+	int i;
+
+	count = clamp(dir_restripe_threads, 1, DIR_RESTRIPE_THREADS_MAX);
+	OBD_ALLOC_PTR_ARRAY(restriper->mdr_workers, count);
+	if (!restriper->mdr_workers)
+		return -ENOMEM;
+	restriper->mdr_worker_count = count;
+
+	for (i = 0; i < count; i++) {
+		worker = &restriper->mdr_workers[i];
+		worker->mrw_restriper = restriper;
+		atomic64_set(&worker->mrw_migrated, 0);
+
+		rc = mdt_restripe_worker_alloc(worker);
+		if (rc)
+			GOTO(out, rc);
+
+		info = mdt_restripe_env_init(mdt, &worker->mrw_env,
+					     &worker->mrw_session);
+		if (IS_ERR(info))
+			GOTO(out, rc = PTR_ERR(info));
+
+		task = kthread_create(mdt_restripe_worker_main, worker,
+				      "mdt_restripe_%03d_%02d",
+				      mdt_seq_site(mdt)->ss_node_id, i);
+		if (IS_ERR(task)) {
+			rc = PTR_ERR(task);
+			CERROR("%s: Can't start directory restripe thread: rc %d\n",
+			       mdt_obd_name(mdt), rc);
+			mdt_restripe_env_fini(&worker->mrw_env);
+			GOTO(out, rc);
+		}
+		worker->mrw_task = task;
+		wake_up_process(task);
+	}
+out:
+	if (rc)
+		mdt_restripe_workers_stop(restriper);
+
+	return rc;
+}
+
+int mdt_restriper_start(struct mdt_device *mdt)
+{
+	struct mdt_dir_restriper *restriper = &mdt->mdt_restriper;
+	struct task_struct *task;
+	struct mdt_thread_info *info;
+	int rc;
+
+	ENTRY;
+
+	spin_lock_init(&restriper->mdr_lock);
+	INIT_LIST_HEAD(&restriper->mdr_auto_splitting);
+	INIT_LIST_HEAD(&restriper->mdr_migrating);
+	INIT_LIST_HEAD(&restriper->mdr_updating);
+	init_waitqueue_head(&restriper->mdr_migrate_waitq);
+	restriper->mdr_dir_split_count = DIR_SPLIT_COUNT_DEFAULT;
+	restriper->mdr_dir_split_delta = DIR_SPLIT_DELTA_DEFAULT;
+	restriper->mdr_migrate_batch = DIR_RESTRIPE_MIGRATE_BATCH_DEFAULT;
+	atomic64_set(&restriper->mdr_stat_migrated, 0);
+	atomic64_set(&restriper->mdr_stat_failed, 0);
+	atomic64_set(&restriper->mdr_stat_passes, 0);
+	atomic64_set(&restriper->mdr_stat_trans, 0);
+	atomic64_set(&restriper->mdr_stat_split, 0);
+	atomic64_set(&restriper->mdr_stat_trans_overlapped, 0);
+	atomic_set(&restriper->mdr_migrate_inflight, 0);
+
+	info = mdt_restripe_env_init(mdt, &restriper->mdr_env,
+				     &restriper->mdr_session);
+	if (IS_ERR(info))
+		RETURN(PTR_ERR(info));
+
 	task = kthread_create(mdt_restriper_main, info, "mdt_restriper_%03d",
 			      mdt_seq_site(mdt)->ss_node_id);
 	if (IS_ERR(task)) {
 		rc = PTR_ERR(task);
 		CERROR("%s: Can't start directory restripe thread: rc %d\n",
 		       mdt_obd_name(mdt), rc);
-		GOTO(out_ses, rc);
+		GOTO(out_env, rc);
 	}
 	restriper->mdr_task = task;
+
+	rc = mdt_restripe_workers_start(mdt);
+	if (rc) {
+		kthread_stop(task);
+		restriper->mdr_task = NULL;
+		GOTO(out_env, rc);
+	}
 	wake_up_process(task);
 
 	RETURN(0);
 
-out_ses:
-	lu_context_exit(restriper->mdr_env.le_ses);
-	lu_context_fini(restriper->mdr_env.le_ses);
 out_env:
-	lu_env_fini(&restriper->mdr_env);
-out_page:
-	__free_page(restriper->mdr_page);
+	mdt_restripe_env_fini(&restriper->mdr_env);
 
 	return rc;
 }
@@ -964,6 +1424,8 @@ void mdt_restriper_stop(struct mdt_device *mdt)
 {
 	struct mdt_dir_restriper *restriper = &mdt->mdt_restriper;
 	struct lu_env *env = &restriper->mdr_env;
+	struct mdt_restripe_range *range, *tmp;
+	struct mdt_restripe_stripe *mrs;
 	struct mdt_object *mo, *next;
 
 	if (!restriper->mdr_task)
@@ -972,16 +1434,24 @@ void mdt_restriper_stop(struct mdt_device *mdt)
 	kthread_stop(restriper->mdr_task);
 	restriper->mdr_task = NULL;
 
+	mdt_restripe_workers_stop(restriper);
+
 	list_for_each_entry_safe(mo, next, &restriper->mdr_auto_splitting,
 				 mot_restripe_linkage) {
 		list_del_init(&mo->mot_restripe_linkage);
 		mdt_object_put(env, mo);
 	}
 
-	list_for_each_entry_safe(mo, next, &restriper->mdr_migrating,
-				 mot_restripe_linkage) {
-		list_del_init(&mo->mot_restripe_linkage);
-		mdt_object_put(env, mo);
+	list_for_each_entry_safe(range, tmp, &restriper->mdr_migrating,
+				 mrr_linkage) {
+		list_del_init(&range->mrr_linkage);
+		mrs = range->mrr_stripe;
+		OBD_FREE_PTR(range);
+		if (--mrs->mrs_ranges)
+			continue;
+
+		mdt_object_put(env, mrs->mrs_obj);
+		OBD_FREE_PTR(mrs);
 	}
 
 	list_for_each_entry_safe(mo, next, &restriper->mdr_updating,
@@ -990,9 +1460,5 @@ void mdt_restriper_stop(struct mdt_device *mdt)
 		mdt_object_put(env, mo);
 	}
 
-	__free_page(restriper->mdr_page);
-
-	lu_context_exit(env->le_ses);
-	lu_context_fini(env->le_ses);
-	lu_env_fini(env);
+	mdt_restripe_env_fini(env);
 }
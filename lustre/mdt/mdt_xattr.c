@@ -428,8 +428,8 @@ int mdt_dir_layout_update(struct mdt_thread_info *info)
 		 */
 
 		if (lum_stripe_count > 1 && lmu->lum_hash_type &&
-		    lmu->lum_hash_type !=
-		    (lmv->lmv_hash_type & cpu_to_le32(LMV_HASH_TYPE_MASK))) {
+		    !lmv_hash_type_match(le32_to_cpu(lmu->lum_hash_type),
+					 le32_to_cpu(lmv->lmv_hash_type))) {
 			CERROR("%s: "DFID" migrate mdt hash mismatch %u != %u\n",
 				mdt_obd_name(info->mti_mdt), PFID(rr->rr_fid1),
 				lmv->lmv_hash_type, lmu->lum_hash_type);
@@ -453,8 +453,8 @@ int mdt_dir_layout_update(struct mdt_thread_info *info)
 		}
 
 		if (lmu->lum_hash_type &&
-		    lmu->lum_hash_type !=
-		    (lmv->lmv_hash_type & cpu_to_le32(LMV_HASH_TYPE_MASK))) {
+		    !lmv_hash_type_match(le32_to_cpu(lmu->lum_hash_type),
+					 le32_to_cpu(lmv->lmv_hash_type))) {
 			CERROR("%s: "DFID" split hash mismatch %u != %u\n",
 				mdt_obd_name(info->mti_mdt), PFID(rr->rr_fid1),
 				lmv->lmv_hash_type, lmu->lum_hash_type);
@@ -476,8 +476,8 @@ int mdt_dir_layout_update(struct mdt_thread_info *info)
 		}
 
 		if (lmu->lum_hash_type &&
-		    (lmu->lum_hash_type & cpu_to_le32(LMV_HASH_TYPE_MASK)) !=
-		    (lmv->lmv_merge_hash & cpu_to_le32(LMV_HASH_TYPE_MASK))) {
+		    !lmv_hash_type_match(le32_to_cpu(lmu->lum_hash_type),
+					 le32_to_cpu(lmv->lmv_merge_hash))) {
 			CERROR("%s: "DFID" merge hash mismatch %u != %u\n",
 				mdt_obd_name(info->mti_mdt), PFID(rr->rr_fid1),
 				lmv->lmv_merge_hash, lmu->lum_hash_type);
@@ -486,6 +486,20 @@ int mdt_dir_layout_update(struct mdt_thread_info *info)
 
 		if (lum_stripe_count < lmv->lmv_stripe_count)
 			shrink = true;
+	} else if (lmv_is_rebalancing(lmv)) {
+		if (lmv->lmv_stripe_count != lum_stripe_count) {
+			CERROR("%s: "DFID" stripe count mismatch %u != %u\n",
+				mdt_obd_name(info->mti_mdt), PFID(rr->rr_fid1),
+				lmv->lmv_stripe_count, lmu->lum_stripe_count);
+			GOTO(unlock_obj, rc = -EINVAL);
+		}
+
+		if (lmu->lum_stripe_offset != LMV_OFFSET_DEFAULT) {
+			CERROR("%s: "DFID" dir rebalance offset %u != -1\n",
+				mdt_obd_name(info->mti_mdt), PFID(rr->rr_fid1),
+				lmu->lum_stripe_offset);
+			GOTO(unlock_obj, rc = -EINVAL);
+		}
 	}
 
 	if (shrink) {
@@ -497,7 +511,15 @@ int mdt_dir_layout_update(struct mdt_thread_info *info)
 		struct lu_buf *buf = &info->mti_buf;
 		u32 version = le32_to_cpu(lmv->lmv_layout_version);
 
-		lmv->lmv_hash_type &= ~LMV_HASH_FLAG_LAYOUT_CHANGE;
+		/* merge may change hash type only */
+		if (lmv_is_merging(lmv))
+			lmv->lmv_hash_type = (lmv->lmv_merge_hash &
+				cpu_to_le32(LMV_HASH_TYPE_MASK)) |
+				(lmv->lmv_hash_type &
+				 cpu_to_le32(LMV_HASH_FLAG_FIXED));
+		lmv->lmv_hash_type &= ~cpu_to_le32(LMV_HASH_FLAG_LAYOUT_CHANGE);
+		if (!lmv_hash_is_bucket(le32_to_cpu(lmv->lmv_hash_type)))
+			lmv->lmv_bucket_weights = 0;
 		lmv->lmv_layout_version = cpu_to_le32(++version);
 		lmv->lmv_migrate_offset = 0;
 		lmv->lmv_migrate_hash = 0;
@@ -237,6 +237,18 @@ lprocfs_exp_print_export_seq(struct obd_export *exp, void *cb_data)
 			fed->fed_ted.ted_dirty);
 		seq_printf(m, "       pending: %ld\n",
 			fed->fed_ted.ted_pending);
+		seq_printf(m, "       write_rate: %llu\n",
+			fed->fed_ted.ted_write_rate);
+		seq_printf(m, "       given: %llu\n",
+			fed->fed_ted.ted_grant_given);
+		seq_printf(m, "       used: %llu\n",
+			fed->fed_ted.ted_grant_used);
+		seq_printf(m, "       efficiency: %llu%%\n",
+			fed->fed_ted.ted_grant_given ?
+			div64_u64(fed->fed_ted.ted_grant_used * 100,
+				  fed->fed_ted.ted_grant_given) : 0);
+		seq_printf(m, "       reclaims: %u\n",
+			fed->fed_ted.ted_grant_reclaims);
 	}
 
 out:
@@ -217,11 +217,26 @@ static inline __u64 tgt_statfs_iavail(struct lu_tgt_desc *tgt)
 	return tgt->ltd_statfs.os_ffree;
 }
 
+/*
+ * Expected time for a new I/O to be serviced by the tgt: the average service
+ * time multiplied by the I/Os queued ahead of it.  Zero if the tgt does not
+ * report its load.
+ */
+static inline __u64 tgt_statfs_load(struct lu_tgt_desc *tgt)
+{
+	struct obd_statfs *statfs = &tgt->ltd_statfs;
+
+	/* clamp to keep the sum over all tgts from overflowing */
+	return min_t(__u64, (__u64)statfs->os_io_latency *
+			    (statfs->os_io_inflight + 1), 1ULL << 40);
+}
+
 /**
  * Calculate weight for a given tgt.
  *
  * The final tgt weight is bavail >> 16 * iavail >> 8 minus the tgt and server
- * penalties.  See ltd_qos_penalties_calc() for how penalties are calculated.
+ * penalties, reduced by the load penalty of a tgt busier than the average.
+ * See ltd_qos_penalties_calc() for how penalties are calculated.
  *
  * \param[in] tgt	target descriptor
  */
@@ -237,6 +252,10 @@ void lu_tgt_qos_weight_calc(struct lu_tgt_desc *tgt)
 		ltq->ltq_weight = 0;
 	else
 		ltq->ltq_weight = ltq->ltq_avail - penalty;
+
+	if (ltq->ltq_load_penalty)
+		ltq->ltq_weight -= (ltq->ltq_weight >> 8) *
+				   ltq->ltq_load_penalty;
 }
 EXPORT_SYMBOL(lu_tgt_qos_weight_calc);
 
@@ -288,6 +307,7 @@ int lu_tgt_descs_init(struct lu_tgt_descs *ltd, bool is_mdt)
 		ltd->ltd_qos.lq_prio_free = LOV_QOS_DEF_PRIO_FREE * 256 / 100;
 		ltd->ltd_qos.lq_threshold_rr =
 			LOV_QOS_DEF_THRESHOLD_RR_PCT * 256 / 100;
+		ltd->ltd_qos.lq_prio_load = LOV_QOS_DEF_PRIO_LOAD * 256 / 100;
 	}
 
 	return 0;
@@ -447,7 +467,9 @@ int ltd_qos_penalties_calc(struct lu_tgt_descs *ltd)
 	struct lu_svr_qos *svr;
 	__u64 ba_max, ba_min, ba;
 	__u64 ia_max, ia_min, ia = 1;
-	__u32 num_active;
+	__u64 load, load_avg, load_sum = 0;
+	__u32 num_active, load_count = 0;
+	bool load_hot = false;
 	int prio_wide;
 	time64_t now, age;
 	int rc;
@@ -487,6 +509,11 @@ int ltd_qos_penalties_calc(struct lu_tgt_descs *ltd)
 		if (!tgt->ltd_active)
 			continue;
 
+		if (!ltd->ltd_is_mdt && qos->lq_prio_load) {
+			load_sum += tgt_statfs_load(tgt);
+			load_count++;
+		}
+
 		/* when inode is counted, bavail >> 16 to avoid overflow */
 		ba = tgt_statfs_bavail(tgt);
 		if (ltd->ltd_is_mdt)
@@ -569,16 +596,37 @@ int ltd_qos_penalties_calc(struct lu_tgt_descs *ltd)
 			svr->lsq_penalty >>= age / desc->ld_qos_maxage;
 	}
 
+	/*
+	 * Per-tgt load penalty is the share of the tgt load above the average
+	 * load, scaled by prio_load.  Loads under 256us are not worth avoiding.
+	 */
+	load_avg = load_count ? div64_u64(load_sum, load_count) : 0;
+	ltd_foreach_tgt(ltd, tgt) {
+		tgt->ltd_qos.ltq_load_penalty = 0;
+		if (!load_sum || !tgt->ltd_active)
+			continue;
+
+		load = tgt_statfs_load(tgt);
+		if (load <= load_avg || load < 256)
+			continue;
+
+		load = min_t(__u64, div64_u64(load - load_avg, load >> 8), 256);
+		if (load > qos->lq_threshold_rr)
+			load_hot = true;
+		tgt->ltd_qos.ltq_load_penalty = (load * qos->lq_prio_load) >> 8;
+	}
+
 	clear_bit(LQ_DIRTY, &qos->lq_flags);
 	clear_bit(LQ_RESET, &qos->lq_flags);
 
 	/*
-	 * If each tgt has almost same free space, do rr allocation for better
-	 * creation performance
+	 * If each tgt has almost same free space and none is much busier than
+	 * the others, do rr allocation for better creation performance
 	 */
 	clear_bit(LQ_SAME_SPACE, &qos->lq_flags);
 	if ((ba_max * (256 - qos->lq_threshold_rr)) >> 8 < ba_min &&
-	    (ia_max * (256 - qos->lq_threshold_rr)) >> 8 < ia_min) {
+	    (ia_max * (256 - qos->lq_threshold_rr)) >> 8 < ia_min &&
+	    !load_hot) {
 		set_bit(LQ_SAME_SPACE, &qos->lq_flags);
 		/* Reset weights for the next time we enter qos mode */
 		set_bit(LQ_RESET, &qos->lq_flags);
@@ -674,6 +722,10 @@ int ltd_qos_update(struct lu_tgt_descs *ltd, struct lu_tgt_desc *tgt,
 			  ltq->ltq_svr->lsq_penalty_per_obj >> 10,
 			  ltq->ltq_svr->lsq_penalty >> 10,
 			  ltq->ltq_weight >> 10);
+		if (ltq->ltq_load_penalty)
+			CDEBUG(D_OTHER, "tgt %d load=%llu load penalty=%u\n",
+			       tgt->ltd_index, tgt_statfs_load(tgt),
+			       ltq->ltq_load_penalty);
 	}
 
 	RETURN(0);
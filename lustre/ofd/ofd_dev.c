@@ -76,6 +76,7 @@
 #include <lustre_quota.h>
 #include <lustre_nodemap.h>
 #include <lustre_log.h>
+#include <llog_swab.h>
 #include <linux/falloc.h>
 
 #include "ofd_internal.h"
@@ -1611,6 +1612,28 @@ static int ofd_create_hdl(struct tgt_session_info *tsi)
 			GOTO(out_nolock, rc = -ENOTCONN);
 		}
 
+		/* OSP may have several precreate requests in flight, and the
+		 * objects of this one may be created by a later one already.
+		 * Reply the same as "MDS LAST_ID behind OST" below, but don't
+		 * wait for the precreate in progress.
+		 */
+		diff = oid - ofd_seq_last_oid(oseq);
+		if (oseq->os_last_id_synced && oid != 0 && diff <= 0 &&
+		    -diff < OST_MAX_PRECREATE &&
+		    (fid_seq_is_mdt(seq) || fid_seq_is_norm(seq) ||
+		     fid_seq_is_idif(seq)) &&
+		    lustre_msg_get_conn_cnt(tgt_ses_req(tsi)->rq_reqmsg) ==
+		    exp->exp_conn_cnt) {
+			CDEBUG(D_HA, "%s: precreate "DOSTID" is %lld behind "
+			       "LAST_ID %llu\n", ofd_name(ofd),
+			       POSTID(&oa->o_oi), -diff,
+			       ofd_seq_last_oid(oseq));
+			if (diff < 0)
+				rc = ostid_set_id(&rep_oa->o_oi,
+						  oid - diff + 1);
+			GOTO(out_nolock, rc);
+		}
+
 		mutex_lock(&oseq->os_create_lock);
 		if (lustre_msg_get_conn_cnt(tgt_ses_req(tsi)->rq_reqmsg) <
 		    exp->exp_conn_cnt) {
@@ -1766,6 +1789,93 @@ out_sem:
 	return rc;
 }
 
+/**
+ * Destroy the array of objects sent by OSP in a single OST_DESTROY RPC.
+ *
+ * The objects are destroyed in one transaction per OFD_DESTROY_BATCH_MAX
+ * objects, which OSP never exceeds, see OSP_SYNC_BATCH_MAX. Processing stops
+ * at the first error other than -ENOENT. The number of objects handled, i.e.
+ * destroyed or found missing, is returned in o_misc, so that OSP cancels the
+ * llog records of just these once the reply transno is committed. The reply
+ * transno is the one of the last transaction, so it covers all the previous
+ * ones. The RPC fails only if no object was destroyed, with -ENOENT if none
+ * of them existed.
+ *
+ * \param[in] tsi	target session environment for this request
+ * \param[in] ofd	OFD device
+ * \param[out] repbody	reply body
+ *
+ * \retval		0 if some object was destroyed
+ * \retval		negative value on error
+ */
+static int ofd_destroy_array(struct tgt_session_info *tsi,
+			     struct ofd_device *ofd, struct ost_body *repbody)
+{
+	struct lu_fid *fids;
+	struct ost_id *oi;
+	int destroyed = 0;
+	int handled = 0;
+	int count;
+	int valid;
+	int rc = 0;
+	int n;
+	int i;
+
+	ENTRY;
+
+	count = req_capsule_get_size(tsi->tsi_pill, &RMF_OST_ID_ARRAY,
+				     RCL_CLIENT) / sizeof(*oi);
+	oi = req_capsule_client_get(tsi->tsi_pill, &RMF_OST_ID_ARRAY);
+	if (oi == NULL || count == 0)
+		RETURN(-EPROTO);
+
+	CDEBUG(D_HA, "%s: destroy %d objects from "DOSTID"\n", ofd_name(ofd),
+	       count, POSTID(&oi[0]));
+
+	OBD_ALLOC_PTR_ARRAY_LARGE(fids, count);
+	if (fids == NULL)
+		RETURN(-ENOMEM);
+
+	for (valid = 0; valid < count; valid++) {
+		if (req_capsule_req_need_swab(tsi->tsi_pill))
+			lustre_swab_ost_id(&oi[valid]);
+
+		rc = ostid_to_fid(&fids[valid], &oi[valid],
+				  ofd->ofd_lut.lut_lsd.lsd_osd_index);
+		if (rc != 0)
+			break;
+	}
+
+	for (i = 0; i < valid; i += n) {
+		int rc2;
+
+		n = min(valid - i, OFD_DESTROY_BATCH_MAX);
+		rc2 = ofd_destroy_by_fids(tsi->tsi_env, ofd, fids + i, n);
+		if (rc2 < 0 && rc2 != -ENOENT) {
+			CERROR("%s: error destroying objects from "DFID
+			       ": rc = %d\n", ofd_name(ofd), PFID(&fids[i]),
+			       rc2);
+			rc = rc2;
+			break;
+		}
+		if (rc2 > 0)
+			destroyed += rc2;
+		else if (rc == 0)
+			rc = rc2;
+		handled += n;
+	}
+	OBD_FREE_PTR_ARRAY_LARGE(fids, count);
+
+	repbody->oa.o_oi = oi[0];
+	repbody->oa.o_misc = handled;
+	repbody->oa.o_valid |= OBD_MD_FLOBJCOUNT;
+
+	if (destroyed > 0)
+		RETURN(0);
+
+	RETURN(rc);
+}
+
 /**
  * OFD request handler for OST_DESTROY RPC.
  *
@@ -1806,12 +1916,22 @@ static int ofd_destroy_hdl(struct tgt_session_info *tsi)
 		ldlm_request_cancel(tgt_ses_req(tsi), dlm, 0, LATF_SKIP);
 	}
 
+	repbody = req_capsule_server_get(tsi->tsi_pill, &RMF_OST_BODY);
+
+	/* batch of objects from OSP sync, see osp_sync_batch_send() */
+	if (req_capsule_field_present(tsi->tsi_pill, &RMF_OST_ID_ARRAY,
+				      RCL_CLIENT)) {
+		rc = ofd_destroy_array(tsi, ofd, repbody);
+		ofd_counter_incr(tsi->tsi_exp, LPROC_OFD_STATS_DESTROY,
+				 tsi->tsi_jobid,
+				 ktime_us_delta(ktime_get(), kstart));
+		RETURN(rc);
+	}
+
 	*fid = body->oa.o_oi.oi_fid;
 	oid = ostid_id(&body->oa.o_oi);
 	LASSERT(oid != 0);
 
-	repbody = req_capsule_server_get(tsi->tsi_pill, &RMF_OST_BODY);
-
 	/* check that o_misc makes sense */
 	if (body->oa.o_valid & OBD_MD_FLOBJCOUNT)
 		count = body->oa.o_misc;
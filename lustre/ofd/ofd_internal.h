@@ -47,6 +47,9 @@
 #define OFD_PRECREATE_SMALL_FS		(1024ULL * 1024 * 1024)
 #define OFD_PRECREATE_BATCH_SMALL	8
 
+/* max objects destroyed in one transaction, see ofd_destroy_batch() */
+#define OFD_DESTROY_BATCH_MAX		64
+
 /* Limit the returned fields marked valid to those that we actually might set */
 #define OFD_VALID_FLAGS (LA_TYPE | LA_MODE | LA_SIZE | LA_BLOCKS | \
 			 LA_BLKSIZE | LA_ATIME | LA_MTIME | LA_CTIME)
@@ -159,8 +162,46 @@ struct ofd_device {
 	struct attribute	*ofd_read_cache_max_filesize;
 	struct attribute	*ofd_write_cache_enable;
 	time64_t		 ofd_atime_diff;
+	/* bulk I/O load, reported in statfs for the MDS QoS allocator */
+	atomic_t		 ofd_io_inflight;
+	unsigned int		 ofd_io_latency; /* EWMA of service time, usec */
+	time64_t		 ofd_io_time;	/* last I/O completion */
 };
 
+#define OFD_IO_LATENCY_SHIFT	3
+
+/* start of the disk phase of a bulk I/O */
+static inline ktime_t ofd_io_start(struct ofd_device *ofd)
+{
+	atomic_inc(&ofd->ofd_io_inflight);
+	return ktime_get();
+}
+
+/* account the service time of a bulk I/O started at \a kstart */
+static inline void ofd_io_end(struct ofd_device *ofd, ktime_t kstart)
+{
+	unsigned int lat = READ_ONCE(ofd->ofd_io_latency);
+	s64 delta = ktime_us_delta(ktime_get(), kstart);
+
+	atomic_dec(&ofd->ofd_io_inflight);
+	/* racy update is fine, this is only a hint for the allocator */
+	lat = lat - (lat >> OFD_IO_LATENCY_SHIFT) +
+	      (min_t(s64, delta, INT_MAX) >> OFD_IO_LATENCY_SHIFT);
+	WRITE_ONCE(ofd->ofd_io_latency, lat);
+	ofd->ofd_io_time = ktime_get_seconds();
+}
+
+/* average I/O service time, halved for every second the OST was idle */
+static inline __u32 ofd_io_latency(struct ofd_device *ofd)
+{
+	time64_t idle = ktime_get_seconds() - ofd->ofd_io_time;
+
+	if (atomic_read(&ofd->ofd_io_inflight) || idle <= 0)
+		return READ_ONCE(ofd->ofd_io_latency);
+
+	return idle >= 32 ? 0 : READ_ONCE(ofd->ofd_io_latency) >> idle;
+}
+
 static inline struct ofd_device *ofd_dev(struct lu_device *d)
 {
 	return container_of_safe(d, struct ofd_device, ofd_dt_dev.dd_lu_dev);
@@ -316,6 +357,8 @@ int ofd_fiemap_get(const struct lu_env *env, struct ofd_device *ofd,
 extern const struct obd_ops ofd_obd_ops;
 int ofd_destroy_by_fid(const struct lu_env *env, struct ofd_device *ofd,
 		       const struct lu_fid *fid, int orphan);
+int ofd_destroy_by_fids(const struct lu_env *env, struct ofd_device *ofd,
+			const struct lu_fid *fids, int count);
 int ofd_statfs(const struct lu_env *env,  struct obd_export *exp,
 	       struct obd_statfs *osfs, time64_t max_age, __u32 flags);
 int ofd_obd_disconnect(struct obd_export *exp);
@@ -398,6 +441,8 @@ int ofd_object_fallocate(const struct lu_env *env, struct ofd_object *fo,
 			 __u64 start, __u64 end, int mode, struct lu_attr *la,
 			 struct obdo *oa);
 int ofd_destroy(const struct lu_env *, struct ofd_object *, int);
+int ofd_destroy_batch(const struct lu_env *env, struct ofd_object **fos,
+		      int count);
 int ofd_attr_get(const struct lu_env *env, struct ofd_object *fo,
 		 struct lu_attr *la);
 int ofd_attr_handle_id(const struct lu_env *env, struct ofd_object *fo,
@@ -578,6 +578,7 @@ static int ofd_preprw_read(const struct lu_env *env, struct obd_export *exp,
 	int maxlnb = *nr_local;
 	__u64 begin, end;
 	ktime_t kstart = ktime_get();
+	ktime_t kio;
 
 	ENTRY;
 	LASSERT(env != NULL);
@@ -629,7 +630,9 @@ static int ofd_preprw_read(const struct lu_env *env, struct obd_export *exp,
 	}
 
 	LASSERT(*nr_local > 0 && *nr_local <= PTLRPC_MAX_BRW_PAGES);
+	kio = ofd_io_start(ofd);
 	rc = dt_read_prep(env, ofd_object_child(fo), lnb, *nr_local);
+	ofd_io_end(ofd, kio);
 	if (unlikely(rc))
 		GOTO(buf_put, rc);
 
@@ -1247,6 +1250,7 @@ ofd_commitrw_write(const struct lu_env *env, struct obd_export *exp,
 	bool cb_registered = false;
 	bool fake_write = false;
 	struct range_lock *range = &ofd_info(env)->fti_write_range;
+	ktime_t kio;
 
 	ENTRY;
 
@@ -1355,7 +1359,9 @@ retry:
 	if (likely(!fake_write)) {
 		OBD_FAIL_TIMEOUT_ORSET(OBD_FAIL_OST_WR_ATTR_DELAY,
 				       OBD_FAIL_ONCE, cfs_fail_val);
+		kio = ofd_io_start(ofd);
 		rc = dt_write_commit(env, o, lnb, niocount, th, oa->o_size);
+		ofd_io_end(ofd, kio);
 		if (rc) {
 			restart = th->th_restart_tran;
 			GOTO(out_unlock, rc);
@@ -125,6 +125,7 @@ out:
  *				client/target pair
  * \param[in] data		stores data for this connect request
  * \param[in] new_connection	is this connection new or not
+ * \param[in] client_nid	client NID, may be NULL
  *
  * \retval		0 if success
  * \retval		-EPROTO client and server feature requirements are
@@ -135,7 +136,8 @@ out:
 static int ofd_parse_connect_data(const struct lu_env *env,
 				  struct obd_export *exp,
 				  struct obd_connect_data *data,
-				  bool new_connection)
+				  bool new_connection,
+				  lnet_nid_t *client_nid)
 {
 	struct ofd_device *ofd = ofd_exp(exp);
 	struct filter_export_data *fed = &exp->exp_filter_data;
@@ -162,6 +164,11 @@ static int ofd_parse_connect_data(const struct lu_env *env,
 	if (data->ocd_connect_flags & OBD_CONNECT_FLAGS2)
 		data->ocd_connect_flags2 &= OST_CONNECT_SUPPORTED2;
 
+	/* bulk MDs over LNET_MTU only if both LNets agree on a larger MTU */
+	if (data->ocd_connect_flags2 & OBD_CONNECT2_LARGE_BULK &&
+	    (!client_nid || LNetPeerMaxPayload(*client_nid) <= LNET_MTU))
+		data->ocd_connect_flags2 &= ~OBD_CONNECT2_LARGE_BULK;
+
 	/* Kindly make sure the SKIP_ORPHAN flag is from MDS. */
 	if (data->ocd_connect_flags & OBD_CONNECT_MDS)
 		CDEBUG(D_HA, "%s: Received MDS connection for group %u\n",
@@ -313,7 +320,7 @@ static int ofd_obd_reconnect(const struct lu_env *env, struct obd_export *exp,
 
 	ofd = ofd_dev(obd->obd_lu_dev);
 
-	rc = ofd_parse_connect_data(env, exp, data, false);
+	rc = ofd_parse_connect_data(env, exp, data, false, client_nid);
 	if (rc == 0)
 		ofd_export_stats_init(ofd, exp, client_nid);
 	else
@@ -372,7 +379,7 @@ static int ofd_obd_connect(const struct lu_env *env, struct obd_export **_exp,
 		       obd->obd_name, cluuid->uuid);
 	}
 
-	rc = ofd_parse_connect_data(env, exp, data, true);
+	rc = ofd_parse_connect_data(env, exp, data, true, localdata);
 	if (rc)
 		GOTO(out, rc);
 
@@ -776,6 +783,9 @@ int ofd_statfs(const struct lu_env *env,  struct obd_export *exp,
 	if (ofd->ofd_no_precreate)
 		osfs->os_state |= OS_STATFS_NOPRECREATE;
 
+	osfs->os_io_inflight = atomic_read(&ofd->ofd_io_inflight);
+	osfs->os_io_latency = ofd_io_latency(ofd);
+
 	if (obd->obd_self_export != exp && !exp_grant_param_supp(exp) &&
 	    current_blockbits > COMPAT_BSIZE_SHIFT) {
 		/*
@@ -896,6 +906,37 @@ out:
 	return rc;
 }
 
+/**
+ * Discard the data cached by clients for an object about to be destroyed.
+ *
+ * Tell the clients that the object is gone now and that they should
+ * throw away any cached pages.
+ *
+ * \param[in] env	execution environment
+ * \param[in] ofd	OFD device
+ * \param[in] fid	FID of the object
+ */
+static void ofd_discard_cached_data(const struct lu_env *env,
+				    struct ofd_device *ofd,
+				    const struct lu_fid *fid)
+{
+	struct ofd_thread_info *info = ofd_info(env);
+	struct lustre_handle lockh;
+	union ldlm_policy_data policy = { .l_extent = { 0, OBD_OBJECT_EOF } };
+	__u64 flags = LDLM_FL_AST_DISCARD_DATA;
+	int rc;
+
+	ost_fid_build_resid(fid, &info->fti_resid);
+	rc = ldlm_cli_enqueue_local(env, ofd->ofd_namespace, &info->fti_resid,
+				    LDLM_EXTENT, &policy, LCK_PW, &flags,
+				    ldlm_blocking_ast, ldlm_completion_ast,
+				    NULL, NULL, 0, LVB_T_NONE, NULL, &lockh);
+
+	/* We only care about the side-effects, just drop the lock. */
+	if (rc == ELDLM_OK)
+		ldlm_lock_decref(&lockh, LCK_PW);
+}
+
 /**
  * Destroy OFD object by its FID.
  *
@@ -914,11 +955,7 @@ out:
 int ofd_destroy_by_fid(const struct lu_env *env, struct ofd_device *ofd,
 		       const struct lu_fid *fid, int orphan)
 {
-	struct ofd_thread_info *info = ofd_info(env);
-	struct lustre_handle lockh;
-	union ldlm_policy_data policy = { .l_extent = { 0, OBD_OBJECT_EOF } };
 	struct ofd_object *fo;
-	__u64 flags = LDLM_FL_AST_DISCARD_DATA;
 	__u64 rc = 0;
 
 	ENTRY;
@@ -927,19 +964,7 @@ int ofd_destroy_by_fid(const struct lu_env *env, struct ofd_device *ofd,
 	if (IS_ERR(fo))
 		RETURN(PTR_ERR(fo));
 
-	/*
-	 * Tell the clients that the object is gone now and that they should
-	 * throw away any cached pages.
-	 */
-	ost_fid_build_resid(fid, &info->fti_resid);
-	rc = ldlm_cli_enqueue_local(env, ofd->ofd_namespace, &info->fti_resid,
-				    LDLM_EXTENT, &policy, LCK_PW, &flags,
-				    ldlm_blocking_ast, ldlm_completion_ast,
-				    NULL, NULL, 0, LVB_T_NONE, NULL, &lockh);
-
-	/* We only care about the side-effects, just drop the lock. */
-	if (rc == ELDLM_OK)
-		ldlm_lock_decref(&lockh, LCK_PW);
+	ofd_discard_cached_data(env, ofd, fid);
 
 	LASSERT(fo != NULL);
 
@@ -950,6 +975,66 @@ int ofd_destroy_by_fid(const struct lu_env *env, struct ofd_device *ofd,
 	RETURN(rc);
 }
 
+/**
+ * Destroy a batch of OFD objects by their FIDs.
+ *
+ * Same as ofd_destroy_by_fid() for each object, except that all the objects
+ * are destroyed in a single transaction. Objects which don't exist are
+ * skipped.
+ *
+ * \param[in] env	execution environment
+ * \param[in] ofd	OFD device
+ * \param[in] fids	FIDs of the objects to destroy
+ * \param[in] count	number of FIDs, at most OFD_DESTROY_BATCH_MAX
+ *
+ * etval		number of objects destroyed
+ * etval		-ENOENT if none of the objects exists
+ * etval		other negative value on error
+ */
+int ofd_destroy_by_fids(const struct lu_env *env, struct ofd_device *ofd,
+			const struct lu_fid *fids, int count)
+{
+	struct ofd_object **fos;
+	int found = 0;
+	int rc;
+	int i;
+
+	ENTRY;
+
+	LASSERT(count > 0 && count <= OFD_DESTROY_BATCH_MAX);
+
+	OBD_ALLOC_PTR_ARRAY(fos, count);
+	if (fos == NULL)
+		RETURN(-ENOMEM);
+
+	for (i = 0; i < count; i++) {
+		struct ofd_object *fo;
+
+		fo = ofd_object_find_exists(env, ofd, &fids[i]);
+		if (IS_ERR(fo)) {
+			if (PTR_ERR(fo) != -ENOENT)
+				GOTO(out, rc = PTR_ERR(fo));
+
+			CDEBUG(D_INODE,
+			       "%s: destroying non-existent object "DFID"\n",
+			       ofd_name(ofd), PFID(&fids[i]));
+			continue;
+		}
+
+		ofd_discard_cached_data(env, ofd, &fids[i]);
+		fos[found++] = fo;
+	}
+
+	rc = found > 0 ? ofd_destroy_batch(env, fos, found) : -ENOENT;
+	EXIT;
+out:
+	for (i = 0; i < found; i++)
+		ofd_object_put(env, fos[i]);
+	OBD_FREE_PTR_ARRAY(fos, count);
+
+	return rc;
+}
+
 /**
  * Implementation of obd_ops::o_destroy.
  *
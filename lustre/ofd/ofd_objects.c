@@ -1044,6 +1044,78 @@ out:
 	RETURN(rc);
 }
 
+/**
+ * Destroy a batch of OFD objects in one transaction.
+ *
+ * Used for the object arrays sent by OSP, see ofd_destroy_array(), so that
+ * a batch costs one transaction instead of one per object. Objects which
+ * were destroyed meanwhile are skipped.
+ *
+ * \param[in] env	execution environment
+ * \param[in] fos	OFD objects to destroy
+ * \param[in] count	number of objects
+ *
+ * \retval		number of objects destroyed
+ * \retval		negative value on error
+ */
+int ofd_destroy_batch(const struct lu_env *env, struct ofd_object **fos,
+		      int count)
+{
+	struct ofd_device	*ofd = ofd_obj2dev(fos[0]);
+	struct thandle		*th;
+	int			destroyed = 0;
+	int			rc = 0;
+	int			rc2;
+	int			i;
+
+	ENTRY;
+
+	th = ofd_trans_create(env, ofd);
+	if (IS_ERR(th))
+		RETURN(PTR_ERR(th));
+
+	for (i = 0; i < count; i++) {
+		if (!ofd_object_exists(fos[i]))
+			continue;
+
+		rc = dt_declare_ref_del(env, ofd_object_child(fos[i]), th);
+		if (rc < 0)
+			GOTO(stop, rc);
+
+		rc = dt_declare_destroy(env, ofd_object_child(fos[i]), th);
+		if (rc < 0)
+			GOTO(stop, rc);
+	}
+
+	rc = ofd_trans_start(env, ofd, NULL, th);
+	if (rc)
+		GOTO(stop, rc);
+
+	for (i = 0; i < count; i++) {
+		struct ofd_object *fo = fos[i];
+
+		ofd_write_lock(env, fo);
+		if (ofd_object_exists(fo)) {
+			tgt_fmd_drop(ofd_info(env)->fti_exp,
+				     &fo->ofo_header.loh_fid);
+			dt_ref_del(env, ofd_object_child(fo), th);
+			dt_destroy(env, ofd_object_child(fo), th);
+			destroyed++;
+		}
+		ofd_write_unlock(env, fo);
+	}
+	EXIT;
+stop:
+	rc2 = ofd_trans_stop(env, ofd, th, rc);
+	if (rc2)
+		CERROR("%s failed to stop transaction: %d\n",
+		       ofd_name(ofd), rc2);
+	if (!rc)
+		rc = rc2;
+
+	return rc < 0 ? rc : destroyed;
+}
+
 /**
  * Get OFD object attributes.
  *
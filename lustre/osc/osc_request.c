@@ -778,6 +778,19 @@ static void osc_update_grant(struct client_obd *cli, struct ost_body *body)
 		CDEBUG(D_CACHE, "got %llu extra grant\n", body->oa.o_grant);
                 __osc_update_grant(cli, body->oa.o_grant);
         }
+
+	/* the target is short of space and we hold more grant than we
+	 * use, return it now rather than at the next shrink interval,
+	 * unless there is nothing left to return, see osc_shrink_grant() */
+	if ((body->oa.o_valid & OBD_MD_FLFLAGS) &&
+	    (body->oa.o_flags & OBD_FL_GRANT_RECLAIM) &&
+	    cli->cl_avail_grant > cli->cl_max_pages_per_rpc << PAGE_SHIFT &&
+	    cli->cl_next_shrink_grant > ktime_get_seconds()) {
+		CDEBUG(D_CACHE, "%s: target asks to shrink grant\n",
+		       cli_name(cli));
+		cli->cl_next_shrink_grant = ktime_get_seconds();
+		osc_schedule_grant_work();
+	}
 }
 
 /**
@@ -1391,7 +1404,7 @@ static inline void osc_release_bounce_pages(struct brw_page **pga,
 static int
 osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
 		     u32 page_count, struct brw_page **pga,
-		     struct ptlrpc_request **reqp, int resend)
+		     struct ptlrpc_request **reqp, int resend, bool large_bulk)
 {
 	struct ptlrpc_request *req;
 	struct ptlrpc_bulk_desc *desc;
@@ -1624,6 +1637,17 @@ retry_encrypt:
         if (desc == NULL)
                 GOTO(out, rc = -ENOMEM);
         /* NB request now owns desc and will free it when it gets freed */
+
+	/* use fewer, larger bulk MDs when both LNets allow it */
+	if (large_bulk && imp_connect_large_bulk(cli->cl_import)) {
+		struct obd_import *imp = cli->cl_import;
+		unsigned int md_size;
+
+		md_size = LNetPeerMaxPayload(
+			lnet_nid_to_nid4(&imp->imp_connection->c_peer.nid));
+		if (md_size > LNET_MTU)
+			ptlrpc_bulk_set_md_size(desc, md_size);
+	}
 no_bulk:
         body = req_capsule_client_get(pill, &RMF_OST_BODY);
         ioobj = req_capsule_client_get(pill, &RMF_OBD_IOOBJ);
@@ -1652,6 +1676,8 @@ no_bulk:
 		ioobj_max_brw_set(ioobj, desc->bd_md_max_brw);
 	else /* short io */
 		ioobj_max_brw_set(ioobj, 0);
+	if (desc != NULL && desc->bd_md_size > LNET_MTU)
+		ioobj_md_bits_set(ioobj, ilog2(desc->bd_md_size));
 
 	if (short_io_size != 0) {
 		if ((body->oa.o_valid & OBD_MD_FLFLAGS) == 0) {
@@ -2259,16 +2285,23 @@ static int osc_brw_redo_request(struct ptlrpc_request *request,
 	struct ptlrpc_request *new_req;
 	struct osc_brw_async_args *new_aa;
 	struct osc_async_page *oap;
+	bool large_bulk;
 	ENTRY;
 
 	/* The below message is checked in replay-ost-single.sh test_8ae*/
 	DEBUG_REQ(rc == -EINPROGRESS ? D_RPCTRACE : D_ERROR, request,
 		  "redo for recoverable error %d", rc);
 
+	/* The OST refuses bulk MDs larger than what it can currently receive
+	 * with -EAGAIN, e.g. after a route change, fall back to LNET_MTU ones.
+	 */
+	large_bulk = !(rc == -EAGAIN && request->rq_bulk != NULL &&
+		       request->rq_bulk->bd_md_size > LNET_MTU);
+
 	rc = osc_brw_prep_request(lustre_msg_get_opc(request->rq_reqmsg) ==
 				OST_WRITE ? OBD_BRW_WRITE : OBD_BRW_READ,
 				  aa->aa_cli, aa->aa_oa, aa->aa_page_count,
-				  aa->aa_ppga, &new_req, 1);
+				  aa->aa_ppga, &new_req, 1, large_bulk);
         if (rc)
                 RETURN(rc);
 
@@ -2614,7 +2647,7 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 	}
 
 	sort_brw_pages(pga, page_count);
-	rc = osc_brw_prep_request(cmd, cli, oa, page_count, pga, &req, 0);
+	rc = osc_brw_prep_request(cmd, cli, oa, page_count, pga, &req, 0, true);
 	if (rc != 0) {
 		CERROR("prep_req failed: %d\n", rc);
 		GOTO(out, rc);
@@ -2716,7 +2749,7 @@ void osc_send_empty_rpc(struct osc_object *osc, pgoff_t start)
 	oa.o_flags = OBD_FL_NORPC;
 
 	rc = osc_brw_prep_request(OBD_BRW_READ, osc_cli(osc), &oa, 1, &pga,
-				  &req, 0);
+				  &req, 0, false);
 
 	/* If we succeeded we ship it off, if not there's no point in doing
 	 * anything. Also no resends.
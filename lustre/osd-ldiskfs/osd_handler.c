@@ -2157,6 +2157,228 @@ static int osd_trans_cb_add(struct thandle *th, struct dt_txn_commit_cb *dcb)
 	return 0;
 }
 
+struct osd_deferred_inode {
+	struct list_head	 odi_list;
+	struct inode		*odi_inode;
+};
+
+struct osd_stream_trim {
+	struct list_head	 ost_list;
+	struct lu_fid		 ost_fid;
+	loff_t			 ost_resv;
+};
+
+/**
+ * Release the stream reservations queued by osd_stream_release().
+ *
+ * The object may be back in the cache by now, so it is trimmed under its
+ * write lock, which excludes writes. A reservation made since by the new
+ * object covers the old one and is left to that object.
+ */
+static void osd_stream_trim_list(const struct lu_env *env,
+				 struct osd_device *osd,
+				 struct list_head *list)
+{
+	struct osd_stream_trim *ost, *tmp;
+
+	list_for_each_entry_safe(ost, tmp, list, ost_list) {
+		struct dt_object *dt;
+		struct osd_object *obj;
+		bool trim = true;
+
+		list_del(&ost->ost_list);
+		if (!env)
+			goto next;
+
+		dt = lu2dt(lu_object_find_slice(env, osd2lu_dev(osd),
+						&ost->ost_fid, NULL));
+		if (IS_ERR_OR_NULL(dt))
+			goto next;
+
+		obj = osd_dt_obj(dt);
+		if (dt_object_exists(dt)) {
+			dt_write_lock(env, dt, 0);
+			spin_lock(&obj->oo_guard);
+			if (obj->oo_stream_resv) {
+				obj->oo_stream_resv = max(obj->oo_stream_resv,
+							  ost->ost_resv);
+				trim = false;
+			}
+			spin_unlock(&obj->oo_guard);
+			if (trim)
+				osd_stream_trim(env, obj, ost->ost_resv);
+			dt_write_unlock(env, dt);
+		}
+		dt_object_put(env, dt);
+next:
+		OBD_FREE_PTR(ost);
+	}
+}
+
+/**
+ * Release the inodes of destroyed objects queued by osd_deferred_free().
+ *
+ * The last iput() of an unlinked inode frees its blocks in ldiskfs. Doing
+ * this for a batch of inodes in a row puts the freed extents into the same
+ * journal transaction, so the block bitmap updates and the discards issued
+ * on its commit are merged.
+ */
+static void osd_deferred_free_work(struct work_struct *work)
+{
+	struct osd_device *osd = container_of(to_delayed_work(work),
+					      struct osd_device,
+					      od_deferred_free_work);
+	struct osd_deferred_inode *odi, *tmp;
+	struct qsd_instance *qsd;
+	union lquota_id qid;
+	struct lu_env env;
+	LIST_HEAD(list);
+	LIST_HEAD(trims);
+	int rc;
+
+	spin_lock(&osd->od_deferred_free_lock);
+	list_splice_init(&osd->od_deferred_free_list, &list);
+	list_splice_init(&osd->od_stream_trim_list, &trims);
+	spin_unlock(&osd->od_deferred_free_lock);
+
+	if (list_empty(&list) && list_empty(&trims))
+		return;
+
+	rc = lu_env_init(&env, LCT_DT_THREAD);
+	if (rc)
+		CERROR("%s: can't init env to adjust quota: rc = %d\n",
+		       osd_name(osd), rc);
+
+	list_for_each_entry_safe(odi, tmp, &list, odi_list) {
+		struct inode *inode = odi->odi_inode;
+		blkcnt_t blocks = inode->i_blocks;
+		qid_t uid = i_uid_read(inode);
+		qid_t gid = i_gid_read(inode);
+		__u64 projid = i_projid_read(inode);
+
+		list_del(&odi->odi_list);
+		OBD_FREE_PTR(odi);
+		iput(inode);
+
+		atomic_dec(&osd->od_deferred_free_objs);
+		atomic64_sub(blocks, &osd->od_deferred_free_blocks);
+		atomic64_inc(&osd->od_deferred_freed);
+
+		/* release granted quota as osd_object_delete() would do */
+		qsd = osd_def_qsd(osd);
+		if (rc || !qsd)
+			continue;
+
+		qid.qid_uid = uid;
+		qsd_op_adjust(&env, qsd, &qid, USRQUOTA);
+		qid.qid_uid = gid;
+		qsd_op_adjust(&env, qsd, &qid, GRPQUOTA);
+		qid.qid_uid = projid;
+		qsd_op_adjust(&env, qsd, &qid, PRJQUOTA);
+	}
+
+	osd_stream_trim_list(rc ? NULL : &env, osd, &trims);
+
+	if (!rc)
+		lu_env_fini(&env);
+}
+
+/**
+ * Queue inode of a destroyed object to free its blocks in the background.
+ *
+ * The object is already removed from the OI, so nothing can find it, and
+ * the inode reference is handed over to osd_deferred_free_work().
+ *
+ * \retval 0		the inode is queued
+ * \retval negative	negated errno, the caller is to release it inline
+ */
+static int osd_deferred_free(struct osd_device *osd, struct inode *inode)
+{
+	struct osd_deferred_inode *odi;
+	int count;
+
+	OBD_ALLOC_PTR(odi);
+	if (!odi)
+		return -ENOMEM;
+
+	odi->odi_inode = inode;
+	spin_lock(&osd->od_deferred_free_lock);
+	if (osd->od_deferred_free_stop) {
+		spin_unlock(&osd->od_deferred_free_lock);
+		OBD_FREE_PTR(odi);
+		return -ESHUTDOWN;
+	}
+	list_add_tail(&odi->odi_list, &osd->od_deferred_free_list);
+	spin_unlock(&osd->od_deferred_free_lock);
+
+	count = atomic_inc_return(&osd->od_deferred_free_objs);
+	atomic64_add(inode->i_blocks, &osd->od_deferred_free_blocks);
+
+	if (count >= OSD_DEFERRED_FREE_BATCH)
+		mod_delayed_work(system_long_wq, &osd->od_deferred_free_work, 0);
+	else
+		queue_delayed_work(system_long_wq, &osd->od_deferred_free_work,
+				   OSD_DEFERRED_FREE_DELAY);
+
+	return 0;
+}
+
+/* free the queued inodes now and stop queueing if \a stop is set */
+static void osd_deferred_free_flush(struct osd_device *osd, bool stop)
+{
+	if (stop) {
+		spin_lock(&osd->od_deferred_free_lock);
+		osd->od_deferred_free_stop = true;
+		spin_unlock(&osd->od_deferred_free_lock);
+	}
+	flush_delayed_work(&osd->od_deferred_free_work);
+}
+
+/*
+ * Give back the blocks reserved ahead of the write stream of an object
+ * which leaves the cache, as nothing uses or refills them any more.
+ */
+static void osd_stream_release(const struct lu_env *env,
+			       struct osd_object *obj)
+{
+	struct osd_device *osd = osd_obj2dev(obj);
+	struct osd_stream_trim *ost;
+	loff_t resv = obj->oo_stream_resv;
+
+	obj->oo_stream_len = 0;
+	obj->oo_stream_resv = 0;
+	if (unlikely(!osd->od_mnt))
+		return;
+
+	/* punching starts a transaction, which is not possible in memory
+	 * reclaim (LU-12178) nor inside another one, leave it to the
+	 * deferred free work then
+	 */
+	if (!(current->flags & (PF_MEMALLOC | PF_KSWAPD)) &&
+	    !ldiskfs_journal_current_handle()) {
+		osd_stream_trim(env, obj, resv);
+		return;
+	}
+
+	OBD_ALLOC_PTR(ost);
+	if (!ost)
+		return;
+
+	ost->ost_fid = *lu_object_fid(&obj->oo_dt.do_lu);
+	ost->ost_resv = resv;
+	spin_lock(&osd->od_deferred_free_lock);
+	if (osd->od_deferred_free_stop) {
+		spin_unlock(&osd->od_deferred_free_lock);
+		OBD_FREE_PTR(ost);
+		return;
+	}
+	list_add_tail(&ost->ost_list, &osd->od_stream_trim_list);
+	spin_unlock(&osd->od_deferred_free_lock);
+
+	queue_delayed_work(system_long_wq, &osd->od_deferred_free_work,
+			   OSD_DEFERRED_FREE_DELAY);
+}
+
 /*
  * Called just before object is freed. Releases all resources except for
  * object itself (that is released by osd_object_free()).
@@ -2167,7 +2389,8 @@ static int osd_trans_cb_add(struct thandle *th, struct dt_txn_commit_cb *dcb)
 static void osd_object_delete(const struct lu_env *env, struct lu_object *l)
 {
 	struct osd_object *obj = osd_obj(l);
-	struct qsd_instance *qsd = osd_def_qsd(osd_obj2dev(obj));
+	struct osd_device *osd = osd_obj2dev(obj);
+	struct qsd_instance *qsd = osd_def_qsd(osd);
 	struct inode *inode = obj->oo_inode;
 	__u64 projid;
 	qid_t uid;
@@ -2187,6 +2410,20 @@ static void osd_object_delete(const struct lu_env *env, struct lu_object *l)
 	if (osd_has_index(obj) &&  obj->oo_dt.do_index_ops == &osd_index_iam_ops)
 		ldiskfs_set_inode_flag(inode, LDISKFS_INODE_JOURNAL_DATA);
 
+	/* large destroyed objects free their blocks in the background, so
+	 * mass deletes don't stall the service threads on block freeing */
+	if (osd->od_deferred_free_min && obj->oo_destroyed &&
+	    !obj->oo_header && S_ISREG(inode->i_mode) && !inode->i_nlink &&
+	    (inode->i_blocks << 9) >= osd->od_deferred_free_min &&
+	    !(current->flags & (PF_MEMALLOC | PF_KSWAPD)) &&
+	    osd_deferred_free(osd, inode) == 0) {
+		obj->oo_inode = NULL;
+		return;
+	}
+
+	if (obj->oo_stream_resv && !obj->oo_destroyed && inode->i_nlink)
+		osd_stream_release(env, obj);
+
 	uid = i_uid_read(inode);
 	gid = i_gid_read(inode);
 	projid = i_projid_read(inode);
@@ -7770,6 +8007,9 @@ static void osd_key_fini(const struct lu_context *ctx,
 	lu_buf_free(&info->oti_iobuf.dr_pg_buf);
 	lu_buf_free(&info->oti_iobuf.dr_bl_buf);
 	lu_buf_free(&info->oti_iobuf.dr_lnb_buf);
+	if (info->oti_iobuf.dr_bio_ctx)
+		OBD_FREE_PTR_ARRAY(info->oti_iobuf.dr_bio_ctx,
+				   OSD_BIO_CTX_MAX);
 	lu_buf_free(&info->oti_big_buf);
 	if (idc != NULL) {
 		LASSERT(info->oti_ins_cache_size > 0);
@@ -7859,6 +8099,9 @@ static int osd_shutdown(const struct lu_env *env, struct osd_device *o)
 {
 	ENTRY;
 
+	/* release the queued objects while quota can be adjusted */
+	osd_deferred_free_flush(o, true);
+
 	/* shutdown quota slave instance associated with the device */
 	if (o->od_quota_slave_md != NULL) {
 		struct qsd_instance *qsd = o->od_quota_slave_md;
@@ -7885,6 +8128,7 @@ static void osd_umount(const struct lu_env *env, struct osd_device *o)
 	ENTRY;
 
 	if (o->od_mnt != NULL) {
+		osd_deferred_free_flush(o, true);
 		shrink_dcache_sb(osd_sb(o));
 		osd_sync(env, &o->od_dt_dev);
 		wait_event(o->od_commit_cb_done,
@@ -8166,6 +8410,21 @@ static int osd_device_init0(const struct lu_env *env,
 	o->od_readcache_max_filesize = OSD_MAX_CACHE_SIZE;
 	o->od_readcache_max_iosize = OSD_READCACHE_MAX_IO_MB << 20;
 	o->od_writethrough_max_iosize = OSD_WRITECACHE_MAX_IO_MB << 20;
+	o->od_writelog_max_iosize = 0;
+	atomic64_set(&o->od_writelog_ios, 0);
+	atomic64_set(&o->od_writelog_pages, 0);
+	atomic64_set(&o->od_writelog_aliases, 0);
+	o->od_stream_prealloc_max = 0;
+	o->od_bio_submit_contexts = 0;
+	o->od_deferred_free_min = 0;
+	spin_lock_init(&o->od_deferred_free_lock);
+	INIT_LIST_HEAD(&o->od_deferred_free_list);
+	INIT_LIST_HEAD(&o->od_stream_trim_list);
+	INIT_DELAYED_WORK(&o->od_deferred_free_work, osd_deferred_free_work);
+	o->od_deferred_free_stop = false;
+	atomic_set(&o->od_deferred_free_objs, 0);
+	atomic64_set(&o->od_deferred_free_blocks, 0);
+	atomic64_set(&o->od_deferred_freed, 0);
 	o->od_scrub.os_scrub.os_auto_scrub_interval = AS_DEFAULT;
 	/* default fallocate to unwritten extents: LU-14326/LU-14333 */
 	o->od_fallocate_zero_blocks = 0;
@@ -8610,9 +8869,18 @@ static int __init osd_init(void)
 	if (rc)
 		return rc;
 
+	/* bound to the CPU it is queued on, see osd_bio_spread() */
+	osd_bio_wq = alloc_workqueue("osd_bio", WQ_HIGHPRI | WQ_MEM_RECLAIM,
+				     0);
+	if (!osd_bio_wq) {
+		lu_kmem_fini(ldiskfs_caches);
+		return -ENOMEM;
+	}
+
 	rc = class_register_type(&osd_obd_device_ops, NULL, true,
 				 LUSTRE_OSD_LDISKFS_NAME, &osd_device_type);
 	if (rc) {
+		destroy_workqueue(osd_bio_wq);
 		lu_kmem_fini(ldiskfs_caches);
 		return rc;
 	}
@@ -8642,6 +8910,7 @@ static void __exit osd_exit(void)
 		kobject_put(kobj);
 	}
 	class_unregister_type(LUSTRE_OSD_LDISKFS_NAME);
+	destroy_workqueue(osd_bio_wq);
 	lu_kmem_fini(ldiskfs_caches);
 }
 
@@ -157,6 +157,11 @@ struct osd_object {
 	struct list_head	oo_xattr_list;
 	struct lu_object_header *oo_header;
 	__u64			oo_dirent_count;
+
+	/* sequential write stream of the object, protected by oo_guard */
+	loff_t			oo_stream_next;	/* where the stream goes on */
+	loff_t			oo_stream_len;	/* bytes written in stream */
+	loff_t			oo_stream_resv;	/* reserved up to offset */
 };
 
 struct osd_obj_seq {
@@ -307,6 +312,34 @@ struct osd_device {
 	 * served bypassing pagecache unless already cached */
 	unsigned long		od_writethrough_max_iosize;
 
+	/* overwrites of allocated blocks <= od_writelog_max_iosize are
+	 * written through the journal instead of in place, 0 disables */
+	unsigned long		od_writelog_max_iosize;
+	atomic64_t		od_writelog_ios;
+	atomic64_t		od_writelog_pages;
+	atomic64_t		od_writelog_aliases;
+
+	/* max unwritten extent reserved ahead of a sequential write stream
+	 * of an object, 0 disables the preallocation */
+	unsigned long		od_stream_prealloc_max;
+
+	/* number of CPUs the bios of one IO are submitted from */
+	unsigned int		od_bio_submit_contexts;
+
+	/* destroyed objects with at least od_deferred_free_min bytes of
+	 * blocks are released by od_deferred_free_work, 0 disables */
+	unsigned long		od_deferred_free_min;
+	spinlock_t		od_deferred_free_lock;
+	struct list_head	od_deferred_free_list;
+	/* stream reservations of objects evicted in memory reclaim, also
+	 * released by od_deferred_free_work */
+	struct list_head	od_stream_trim_list;
+	struct delayed_work	od_deferred_free_work;
+	bool			od_deferred_free_stop;
+	atomic_t		od_deferred_free_objs;
+	atomic64_t		od_deferred_free_blocks;
+	atomic64_t		od_deferred_freed;
+
 	struct brw_stats	od_brw_stats;
 	atomic_t		od_r_in_flight;
 	atomic_t		od_w_in_flight;
@@ -425,6 +458,9 @@ struct osd_thandle {
 	struct lu_ref_link      ot_dev_link;
 	unsigned int		ot_credits;
 	unsigned int		oh_declared_ext;
+	/* blocks to reserve ahead of a write stream, from oh_stream_lblk */
+	unsigned int		oh_stream_blocks;
+	__u32			oh_stream_lblk;
 
 	/* quota IDs related to the transaction */
 	unsigned short		ot_id_cnt;
@@ -433,7 +469,8 @@ struct osd_thandle {
 	uid_t			ot_id_array[OSD_MAX_UGID_CNT];
 	struct lquota_trans    *ot_quota_trans;
 
-	unsigned int		ot_remove_agents:1;
+	unsigned int		ot_remove_agents:1,
+				ot_writelog:1;
 #if OSD_THANDLE_STATS
         /** time when this handle was allocated */
 	ktime_t oth_alloced;
@@ -475,6 +512,10 @@ enum {
         LPROC_OSD_CACHE_ACCESS  = 4,
         LPROC_OSD_CACHE_HIT     = 5,
         LPROC_OSD_CACHE_MISS    = 6,
+	LPROC_OSD_ALLOC_EXTENT	= 7,
+	LPROC_OSD_ALLOC_FRAGMENT = 8,
+	LPROC_OSD_STREAM_PREALLOC = 9,
+	LPROC_OSD_STREAM_TRIM	= 10,
 
 #if OSD_THANDLE_STATS
         LPROC_OSD_THANDLE_STARTING,
@@ -564,6 +605,17 @@ struct osd_it_quota {
 
 #define MAX_BLOCKS_PER_PAGE (PAGE_SIZE / 512)
 
+/* a batch of bios submitted on another CPU, see osd_bio_spread() */
+struct osd_bio_ctx {
+	struct work_struct	obc_work;
+	struct bio_list		obc_bios;
+	int			obc_rw;
+};
+
+#define OSD_BIO_CTX_MAX		8
+
+extern struct workqueue_struct *osd_bio_wq;
+
 struct osd_iobuf {
 	wait_queue_head_t  dr_wait;
 	atomic_t       dr_numreqs;  /* number of reqs being processed */
@@ -583,6 +635,7 @@ struct osd_iobuf {
 	ktime_t		   dr_elapsed;	/* how long io took */
 	struct osd_device *dr_dev;
 	unsigned int	   dr_init_at;	/* the line iobuf was initialized */
+	struct osd_bio_ctx *dr_bio_ctx; /* OSD_BIO_CTX_MAX contexts */
 };
 
 #define osd_dirty_inode(inode, flag)  (inode)->i_sb->s_op->dirty_inode((inode), flag)
@@ -1048,6 +1101,17 @@ static inline int osd_invariant(const struct osd_object *obj)
 #define OSD_MAX_CACHE_SIZE OBD_OBJECT_EOF
 #define OSD_READCACHE_MAX_IO_MB		8
 #define OSD_WRITECACHE_MAX_IO_MB	8
+#define OSD_WRITELOG_MAX_IO_KB		1024
+/* a write within the window from the end of the stream goes on with it,
+ * as RPCs in flight from the same client may be handled out of order */
+#define OSD_STREAM_WINDOW		(32 << 20)
+/* the stream is long enough to predict it goes on */
+#define OSD_STREAM_MIN			(4 << 20)
+#define OSD_STREAM_PREALLOC_MAX_MB	64
+/* destroyed objects are collected for this long before freeing a batch */
+#define OSD_DEFERRED_FREE_DELAY		cfs_time_seconds(1)
+/* or until that many are pending */
+#define OSD_DEFERRED_FREE_BATCH		512
 
 extern const struct dt_index_operations osd_otable_ops;
 
@@ -1571,6 +1635,8 @@ int osd_trunc_lock(struct osd_object *obj, struct osd_thandle *oh,
 void osd_trunc_unlock_all(const struct lu_env *env, struct list_head *list);
 int osd_process_truncates(const struct lu_env *env, struct list_head *list);
 void osd_execute_truncate(struct osd_object *obj);
+void osd_stream_trim(const struct lu_env *env, struct osd_object *obj,
+		     loff_t resv);
 
 #ifdef HAVE_BIO_ENDIO_USES_ONE_ARG
 #define osd_dio_complete_routine(bio, error) dio_complete_routine(bio)
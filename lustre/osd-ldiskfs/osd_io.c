@@ -265,6 +265,72 @@ static void osd_submit_bio(int rw, struct bio *bio)
 #endif
 }
 
+struct workqueue_struct *osd_bio_wq;
+
+static void osd_bio_submit_work(struct work_struct *work)
+{
+	struct osd_bio_ctx *ctx = container_of(work, struct osd_bio_ctx,
+					       obc_work);
+	struct blk_plug plug;
+	struct bio *bio;
+
+	blk_start_plug(&plug);
+	while ((bio = bio_list_pop(&ctx->obc_bios)) != NULL)
+		osd_submit_bio(ctx->obc_rw, bio);
+	blk_finish_plug(&plug);
+}
+
+/**
+ * Submit \a bios of one IO from several CPUs.
+ *
+ * A single service thread submitting all bios of a large BRW reaches only
+ * one hardware queue of a multi-queue device. The list is cut in \a nr
+ * contiguous batches, each one is submitted under its own plug from other
+ * CPUs of the current CPT, the last batch from the calling thread. This
+ * waits for the submission only, the completion is waited for by the
+ * caller as usual.
+ */
+static void osd_bio_spread(struct osd_iobuf *iobuf, struct bio_list *bios,
+			   int nr)
+{
+	struct osd_bio_ctx *ctx = iobuf->dr_bio_ctx;
+	cpumask_var_t *mask;
+	int count = bio_list_size(bios);
+	int per_ctx;
+	int cpu;
+	int i, j;
+
+	nr = min(nr, count);
+	per_ctx = DIV_ROUND_UP(count, nr);
+	mask = cfs_cpt_cpumask(cfs_cpt_tab,
+			       cfs_cpt_current(cfs_cpt_tab, 0));
+	cpu = raw_smp_processor_id();
+
+	for (i = 0; i < nr; i++) {
+		bio_list_init(&ctx[i].obc_bios);
+		ctx[i].obc_rw = iobuf->dr_rw;
+		for (j = 0; j < per_ctx && !bio_list_empty(bios); j++)
+			bio_list_add(&ctx[i].obc_bios, bio_list_pop(bios));
+
+		/* the last batch is submitted by this thread */
+		if (i == nr - 1 || bio_list_empty(bios)) {
+			osd_bio_submit_work(&ctx[i].obc_work);
+			nr = i;
+			break;
+		}
+
+		if (mask)
+			cpu = cpumask_next(cpu, *mask);
+		if (!mask || cpu >= nr_cpu_ids)
+			cpu = mask ? cpumask_first(*mask) : WORK_CPU_UNBOUND;
+		INIT_WORK(&ctx[i].obc_work, osd_bio_submit_work);
+		queue_work_on(cpu, osd_bio_wq, &ctx[i].obc_work);
+	}
+
+	for (i = 0; i < nr; i++)
+		flush_work(&ctx[i].obc_work);
+}
+
 static int can_be_merged(struct bio *bio, sector_t sector)
 {
 	if (bio == NULL)
@@ -476,6 +542,43 @@ static void osd_mark_page_io_done(struct osd_iobuf *iobuf,
 	}
 }
 
+/*
+ * Blocks written through the write log may be newer in the journal than
+ * in place until jbd2 checkpoints them, the buffer cache has the newest
+ * copy then. See osd_writelog_commit().
+ */
+static inline bool osd_writelog_pending(struct buffer_head *bh)
+{
+	return buffer_uptodate(bh) &&
+	       (buffer_dirty(bh) || (buffer_jbd(bh) && buffer_jbddirty(bh)));
+}
+
+static bool osd_writelog_read_block(struct inode *inode, sector_t block,
+				    struct page *page, unsigned int offset)
+{
+	struct super_block *sb = inode->i_sb;
+	struct buffer_head *bh;
+	bool found = false;
+
+	if (!test_bit(LDISKFS_INODE_JOURNAL_DATA, &LDISKFS_I(inode)->i_flags))
+		return false;
+
+	bh = __find_get_block(sb->s_bdev, block, sb->s_blocksize);
+	if (!bh)
+		return false;
+
+	lock_buffer(bh);
+	if (osd_writelog_pending(bh)) {
+		memcpy(kmap(page) + offset, bh->b_data, sb->s_blocksize);
+		kunmap(page);
+		found = true;
+	}
+	unlock_buffer(bh);
+	brelse(bh);
+
+	return found;
+}
+
 static int osd_do_bio(struct osd_device *osd, struct inode *inode,
 		      struct osd_iobuf *iobuf, sector_t start_blocks,
 		      sector_t count)
@@ -502,13 +605,25 @@ static int osd_do_bio(struct osd_device *osd, struct inode *inode,
 	bool fault_inject;
 	bool integrity_enabled;
 	struct blk_plug plug;
+	struct bio_list bios;
 	int blocks_left_page;
+	int nr_ctx;
 
 	ENTRY;
 
 	fault_inject = OBD_FAIL_CHECK(OBD_FAIL_OST_INTEGRITY_FAULT);
 	LASSERT(iobuf->dr_npages == npages);
 
+	/* bios are queued and spread over CPUs once all are built */
+	bio_list_init(&bios);
+	nr_ctx = min_t(unsigned int, osd->od_bio_submit_contexts,
+		       OSD_BIO_CTX_MAX);
+	if (nr_ctx > 1 && !iobuf->dr_bio_ctx) {
+		OBD_ALLOC_PTR_ARRAY(iobuf->dr_bio_ctx, OSD_BIO_CTX_MAX);
+		if (!iobuf->dr_bio_ctx)
+			nr_ctx = 0;
+	}
+
 	integrity_enabled = bdev_integrity_enabled(bdev, iobuf->dr_rw);
 
 	osd_brw_stats_update(osd, iobuf);
@@ -557,6 +672,12 @@ static int osd_do_bio(struct osd_device *osd, struct inode *inode,
 				continue;
 			}
 
+			if (iobuf->dr_rw == 0 &&
+			    osd_writelog_read_block(inode,
+						    blocks[block_idx + i],
+						    page, page_offset))
+				continue;
+
 			sector = (sector_t)blocks[block_idx + i] << sector_bits;
 
 			/* Additional contiguous file blocks? */
@@ -592,7 +713,10 @@ static int osd_do_bio(struct osd_device *osd, struct inode *inode,
 				}
 
 				record_start_io(iobuf, bi_size);
-				osd_submit_bio(iobuf->dr_rw, bio);
+				if (nr_ctx > 1)
+					bio_list_add(&bios, bio);
+				else
+					osd_submit_bio(iobuf->dr_rw, bio);
 			}
 
 			bio_start_page_idx = page_idx;
@@ -635,11 +759,19 @@ static int osd_do_bio(struct osd_device *osd, struct inode *inode,
 		}
 
 		record_start_io(iobuf, bio_sectors(bio) << 9);
-		osd_submit_bio(iobuf->dr_rw, bio);
+		if (nr_ctx > 1)
+			bio_list_add(&bios, bio);
+		else
+			osd_submit_bio(iobuf->dr_rw, bio);
 		rc = 0;
 	}
 
 out:
+	/* the bios are counted in dr_numreqs already, submit them even if
+	 * building the rest failed
+	 */
+	if (!bio_list_empty(&bios))
+		osd_bio_spread(iobuf, &bios, nr_ctx);
 	blk_finish_plug(&plug);
 
 	/* in order to achieve better IO throughput, we don't wait for writes
@@ -1017,10 +1149,8 @@ static int osd_extend_restart_trans(handle_t *handle, int needed,
 }
 #endif /* HAVE_LDISKFS_JOURNAL_ENSURE_CREDITS */
 
-static int osd_ldiskfs_map_write(struct inode *inode, struct osd_iobuf *iobuf,
-				 struct osd_device *osd, sector_t start_blocks,
-				 sector_t count, loff_t *disk_size,
-				 __u64 user_size)
+static void osd_ldiskfs_update_size(struct inode *inode, loff_t *disk_size,
+				    __u64 user_size)
 {
 	/* if file has grown, take user_size into account */
 	if (user_size && *disk_size > user_size)
@@ -1035,6 +1165,110 @@ static int osd_ldiskfs_map_write(struct inode *inode, struct osd_iobuf *iobuf,
 	} else {
 		spin_unlock(&inode->i_lock);
 	}
+}
+
+/* journal the new content of block \a bh, which is fully overwritten */
+static int osd_writelog_block(handle_t *handle, struct buffer_head *bh,
+			      const void *data)
+{
+	int rc;
+
+	/* a buffer which is not uptodate can't be part of any transaction,
+	 * fill it before jbd2 looks at the content
+	 */
+	if (!buffer_uptodate(bh)) {
+		lock_buffer(bh);
+		memcpy(bh->b_data, data, bh->b_size);
+		set_buffer_uptodate(bh);
+		unlock_buffer(bh);
+	}
+
+	rc = ldiskfs_journal_get_write_access(handle, bh);
+	if (rc)
+		return rc;
+
+	lock_buffer(bh);
+	memcpy(bh->b_data, data, bh->b_size);
+	unlock_buffer(bh);
+
+	return ldiskfs_handle_dirty_metadata(handle, NULL, bh);
+}
+
+/**
+ * Keep the blocks still pending in the write log coherent with an in-place
+ * write of the same blocks.
+ *
+ * Once the bio is submitted, the journal would otherwise put the older
+ * logged content back on checkpoint or on replay. The new content is
+ * logged as well for such blocks, other cached copies are just updated.
+ *
+ * \retval 0		on success
+ * \retval negative	negated errno on error
+ */
+static int osd_writelog_sync_aliases(struct inode *inode,
+				     struct osd_iobuf *iobuf,
+				     struct osd_device *osd,
+				     sector_t start_blocks, sector_t count)
+{
+	int blocks_per_page = PAGE_SIZE >> inode->i_blkbits;
+	struct super_block *sb = inode->i_sb;
+	handle_t *handle = ldiskfs_journal_current_handle();
+	struct buffer_head *bh;
+	struct page *page;
+	sector_t i;
+	void *data;
+	int rc = 0;
+
+	if (!test_bit(LDISKFS_INODE_JOURNAL_DATA, &LDISKFS_I(inode)->i_flags))
+		return 0;
+
+	if (!count)
+		count = iobuf->dr_npages * blocks_per_page;
+
+	for (i = start_blocks; i < start_blocks + count && rc == 0; i++) {
+		if (iobuf->dr_blocks[i] == 0)
+			continue;
+
+		bh = __find_get_block(sb->s_bdev, iobuf->dr_blocks[i],
+				      sb->s_blocksize);
+		if (!bh)
+			continue;
+
+		page = iobuf->dr_pages[i / blocks_per_page];
+		data = kmap(page) + (i % blocks_per_page) * sb->s_blocksize;
+		if (osd_writelog_pending(bh)) {
+			/* credits are declared for logged objects, but the
+			 * object could be logged by a racing write since
+			 */
+			rc = osd_extend_restart_trans(handle, 1, inode);
+			if (rc == 0)
+				rc = osd_writelog_block(handle, bh, data);
+		} else {
+			lock_buffer(bh);
+			memcpy(bh->b_data, data, sb->s_blocksize);
+			set_buffer_uptodate(bh);
+			unlock_buffer(bh);
+		}
+		kunmap(page);
+		brelse(bh);
+		atomic64_inc(&osd->od_writelog_aliases);
+	}
+
+	return rc;
+}
+
+static int osd_ldiskfs_map_write(struct inode *inode, struct osd_iobuf *iobuf,
+				 struct osd_device *osd, sector_t start_blocks,
+				 sector_t count, loff_t *disk_size,
+				 __u64 user_size)
+{
+	int rc;
+
+	osd_ldiskfs_update_size(inode, disk_size, user_size);
+
+	rc = osd_writelog_sync_aliases(inode, iobuf, osd, start_blocks, count);
+	if (rc)
+		return rc;
 
 	/*
 	 * We don't do stats here as in read path because
@@ -1076,6 +1310,27 @@ static void osd_decay_extent_bytes(struct osd_device *osd,
 		 EXTENT_BYTES_DECAY - 1) / EXTENT_BYTES_DECAY;
 }
 
+/*
+ * Account a new allocation of the object as an extent, and also as a
+ * fragment unless it continues the blocks of the previous logical block.
+ */
+static void osd_alloc_stats(struct osd_device *osd, struct inode *inode,
+			    struct ldiskfs_map_blocks *new)
+{
+	struct ldiskfs_map_blocks prev = { 0 };
+
+	lprocfs_counter_add(osd->od_stats, LPROC_OSD_ALLOC_EXTENT, new->m_len);
+	if (new->m_lblk == 0)
+		return;
+
+	prev.m_lblk = new->m_lblk - 1;
+	prev.m_len = 1;
+	if (ldiskfs_map_blocks(NULL, inode, &prev, 0) <= 0 ||
+	    prev.m_pblk + 1 != new->m_pblk)
+		lprocfs_counter_add(osd->od_stats, LPROC_OSD_ALLOC_FRAGMENT,
+				    new->m_len);
+}
+
 static int osd_ldiskfs_map_inode_pages(struct inode *inode,
 				       struct osd_iobuf *iobuf,
 				       struct osd_device *osd,
@@ -1174,6 +1429,8 @@ cont_map:
 				oh->oh_declared_ext--;
 		}
 		rc = ldiskfs_map_blocks(handle, inode, &map, create);
+		if (rc > 0 && create && (map.m_flags & LDISKFS_MAP_NEW))
+			osd_alloc_stats(osd, inode, &map);
 		if (rc >= 0) {
 			int c = 0;
 
@@ -1385,6 +1642,146 @@ static int osd_is_mapped(struct dt_object *dt, __u64 offset,
 	return cached_extent->mapped;
 }
 
+/**
+ * Check if the write can go to the write log.
+ *
+ * Small overwrites of allocated blocks are written through the journal,
+ * which may be on a fast external device, and destaged in place by the
+ * jbd2 checkpoint. New blocks are never logged, so block allocation and
+ * object layout on disk are unchanged by the write log.
+ */
+static bool osd_writelog_eligible(const struct osd_device *osd,
+				  struct niobuf_local *lnb, int npages)
+{
+	unsigned long bytes = 0;
+	int i;
+
+	if (!osd->od_writelog_max_iosize || !osd->od_is_ost)
+		return false;
+
+	/* the journal doesn't carry the T10-PI guards of the client */
+	if (bdev_integrity_enabled(osd_sb(osd)->s_bdev, WRITE))
+		return false;
+
+	for (i = 0; i < npages; i++) {
+		if (!(lnb[i].lnb_flags & OBD_BRW_MAPPED) ||
+		    (lnb[i].lnb_flags & OBD_BRW_DONE))
+			return false;
+		bytes += lnb[i].lnb_len;
+		if (bytes > osd->od_writelog_max_iosize)
+			return false;
+	}
+
+	return bytes > 0;
+}
+
+/**
+ * Track the sequential write stream of the object.
+ *
+ * Interleaved streams of many objects get interleaved blocks from the
+ * allocator, so a stream which is long enough to be expected to go on
+ * gets an unwritten extent reserved ahead of it, sized after what was
+ * written so far, as the OST doesn't know the final size of the object.
+ *
+ * \retval	number of blocks to reserve from \a lblk, 0 for none
+ */
+static unsigned int osd_stream_update(const struct osd_device *osd,
+				      struct osd_object *obj,
+				      struct niobuf_local *lnb, int npages,
+				      __u32 *lblk)
+{
+	struct inode *inode = obj->oo_inode;
+	struct ldiskfs_sb_info *sbi = LDISKFS_SB(inode->i_sb);
+	loff_t start = lnb[0].lnb_file_offset;
+	loff_t end = lnb[npages - 1].lnb_file_offset +
+		     lnb[npages - 1].lnb_len;
+	loff_t want = 0;
+	loff_t from;
+	loff_t resv;
+
+	/* a restarted write was accounted already */
+	if (!osd->od_is_ost || (lnb[0].lnb_flags & OBD_BRW_DONE))
+		return 0;
+
+	spin_lock(&obj->oo_guard);
+	if (obj->oo_stream_len &&
+	    start <= obj->oo_stream_next + OSD_STREAM_WINDOW &&
+	    end + OSD_STREAM_WINDOW >= obj->oo_stream_next) {
+		obj->oo_stream_len += end - start;
+		if (end > obj->oo_stream_next)
+			obj->oo_stream_next = end;
+	} else {
+		obj->oo_stream_len = end - start;
+		obj->oo_stream_next = end;
+		obj->oo_stream_resv = 0;
+	}
+
+	/* refill once half of the reservation is used */
+	if (osd->od_stream_prealloc_max &&
+	    obj->oo_stream_len >= OSD_STREAM_MIN) {
+		want = min_t(loff_t, obj->oo_stream_len >> 2,
+			     osd->od_stream_prealloc_max);
+		if (obj->oo_stream_resv >= obj->oo_stream_next + want / 2)
+			want = 0;
+	}
+	from = max(obj->oo_stream_resv, obj->oo_stream_next);
+	if (want)
+		obj->oo_stream_resv = obj->oo_stream_next + want;
+	resv = obj->oo_stream_resv;
+	spin_unlock(&obj->oo_guard);
+
+	if (!want || from >= resv)
+		return 0;
+
+	/* leave the space to writes when the filesystem fills up */
+	if (percpu_counter_read_positive(&sbi->s_freeclusters_counter) <
+	    ldiskfs_blocks_count(sbi->s_es) >> 3)
+		return 0;
+
+	*lblk = from >> inode->i_blkbits;
+	return min_t(loff_t, (resv - from) >> inode->i_blkbits,
+		     EXT_UNWRITTEN_MAX_LEN);
+}
+
+/*
+ * Reserve the blocks declared by osd_stream_update() as unwritten extent
+ * beyond the object size, like fallocate(FALLOC_FL_KEEP_SIZE) does.
+ * This is a hint only, errors are ignored.
+ */
+static void osd_stream_prealloc(struct osd_device *osd, struct inode *inode,
+				struct osd_thandle *oh)
+{
+	struct ldiskfs_map_blocks map = { 0 };
+	handle_t *handle = ldiskfs_journal_current_handle();
+	int flags = LDISKFS_GET_BLOCKS_CREATE_UNWRIT_EXT |
+		    LDISKFS_GET_BLOCKS_NO_NORMALIZE;
+	int rc;
+
+#ifndef HAVE_LDISKFS_GET_BLOCKS_KEEP_SIZE
+	flags |= LDISKFS_GET_BLOCKS_KEEP_SIZE;
+#endif
+	map.m_lblk = oh->oh_stream_lblk;
+	map.m_len = oh->oh_stream_blocks;
+	rc = ldiskfs_map_blocks(handle, inode, &map, flags);
+	if (rc <= 0) {
+		CDEBUG(D_INODE,
+		       "%s: inode #%lu: can't reserve %u blocks at %u: rc = %d\n",
+		       osd_name(osd), inode->i_ino, oh->oh_stream_blocks,
+		       oh->oh_stream_lblk, rc);
+		return;
+	}
+
+	if (map.m_flags & LDISKFS_MAP_NEW)
+		lprocfs_counter_add(osd->od_stats, LPROC_OSD_STREAM_PREALLOC,
+				    rc);
+#ifndef HAVE_LDISKFS_GET_BLOCKS_KEEP_SIZE
+	if (((loff_t)(map.m_lblk + rc) << inode->i_blkbits) >
+	    i_size_read(inode))
+		ldiskfs_set_inode_flag(inode, LDISKFS_INODE_EOFBLOCKS);
+#endif
+	ldiskfs_mark_inode_dirty(handle, inode);
+}
+
 #define MAX_EXTENTS_PER_WRITE 100
 static int osd_declare_write_commit(const struct lu_env *env,
 				    struct dt_object *dt,
@@ -1398,6 +1795,7 @@ static int osd_declare_write_commit(const struct lu_env *env,
 	int			depth, new_blocks = 0;
 	int			i;
 	int			dirty_groups = 0;
+	int			mapped_pages = 0;
 	int			rc = 0;
 	int			credits = 0;
 	long long		quota_space = 0;
@@ -1432,6 +1830,10 @@ static int osd_declare_write_commit(const struct lu_env *env,
 		    !(lnb[i].lnb_flags & OBD_BRW_SYNC))
 			declare_flags |= OSD_QID_FORCE;
 
+		/* the flag is stale if the write is restarted */
+		if (!(lnb[i].lnb_flags & OBD_BRW_DONE))
+			lnb[i].lnb_flags &= ~OBD_BRW_MAPPED;
+
 		/*
 		 * Convert unwritten extent might need split extents, could
 		 * not skip it.
@@ -1439,6 +1841,7 @@ static int osd_declare_write_commit(const struct lu_env *env,
 		if (osd_is_mapped(dt, lnb[i].lnb_file_offset, &mapped) &&
 		    !(mapped.flags & FIEMAP_EXTENT_UNWRITTEN)) {
 			lnb[i].lnb_flags |= OBD_BRW_MAPPED;
+			mapped_pages++;
 			continue;
 		}
 
@@ -1462,6 +1865,27 @@ static int osd_declare_write_commit(const struct lu_env *env,
 		quota_space += PAGE_SIZE;
 	}
 
+	/*
+	 * every block of a logged write goes to the journal, as do the
+	 * overwritten blocks of a logged object still pending in the log
+	 */
+	if (osd_writelog_eligible(osd, lnb, npages)) {
+		oh->ot_writelog = 1;
+		credits += npages * (PAGE_SIZE >> inode->i_blkbits);
+	} else if (test_bit(LDISKFS_INODE_JOURNAL_DATA,
+			    &LDISKFS_I(inode)->i_flags)) {
+		credits += mapped_pages * (PAGE_SIZE >> inode->i_blkbits);
+	}
+
+	/* an unwritten extent is reserved ahead of a stream */
+	if (!oh->ot_writelog)
+		oh->oh_stream_blocks = osd_stream_update(osd, osd_dt_obj(dt),
+							 lnb, npages,
+							 &oh->oh_stream_lblk);
+	if (oh->oh_stream_blocks)
+		credits += osd_chunk_trans_blocks(inode,
+						  oh->oh_stream_blocks);
+
 	credits++; /* inode */
 	/*
 	 * overwrite case, no need to modify tree and
@@ -1549,6 +1973,27 @@ out_declare:
 	/* make sure the over quota flags were not set */
 	lnb[0].lnb_flags &= ~OBD_BRW_OVER_ALLQUOTA;
 
+	/*
+	 * the blocks reserved ahead of a stream are charged to the owner of
+	 * the object, skip the reservation rather than get close to the limit
+	 */
+	if (oh->oh_stream_blocks) {
+		enum osd_quota_local_flags stream_flags = 0;
+		long long stream_space;
+
+		stream_space = toqb((long long)oh->oh_stream_blocks <<
+				    inode->i_blkbits);
+		rc = osd_declare_inode_qid(env, i_uid_read(inode),
+					   i_gid_read(inode),
+					   i_projid_read(inode), stream_space,
+					   oh, osd_dt_obj(dt), &stream_flags,
+					   OSD_QID_BLK);
+		if (rc || (stream_flags & (QUOTA_FL_OVER_USRQUOTA |
+					   QUOTA_FL_OVER_GRPQUOTA |
+					   QUOTA_FL_OVER_PRJQUOTA)))
+			oh->oh_stream_blocks = 0;
+	}
+
 	rc = osd_declare_inode_qid(env, i_uid_read(inode), i_gid_read(inode),
 				   i_projid_read(inode), quota_space, oh,
 				   osd_dt_obj(dt), &local_flags, declare_flags);
@@ -1570,6 +2015,89 @@ out_declare:
 	RETURN(rc);
 }
 
+/**
+ * Write the pages of \a iobuf through the write log.
+ *
+ * The object is flagged for data journaling, so that its blocks are
+ * revoked in the journal when they are freed, and the handle is made
+ * synchronous: the write is acknowledged once it is persistent in the
+ * journal, the same as an in-place write is once it is on disk.
+ *
+ * \retval 0		on success
+ * \retval -ENODATA	if some block is no longer allocated
+ * \retval negative	negated errno on other error
+ */
+static int osd_writelog_commit(struct inode *inode, struct osd_iobuf *iobuf,
+			       struct osd_device *osd, __u64 user_size,
+			       struct thandle *thandle)
+{
+	int blocks_per_page = PAGE_SIZE >> inode->i_blkbits;
+	unsigned int blocksize = inode->i_sb->s_blocksize;
+	handle_t *handle = ldiskfs_journal_current_handle();
+	struct niobuf_local *lnb;
+	struct buffer_head *bh;
+	loff_t disk_size;
+	void *addr;
+	int i, j;
+	int rc;
+
+	LASSERT(handle != NULL);
+
+	rc = osd_ldiskfs_map_inode_pages(inode, iobuf, osd, 0, 0, 0, NULL);
+	if (rc)
+		return rc;
+
+	for (i = 0; i < iobuf->dr_npages * blocks_per_page; i++)
+		if (iobuf->dr_blocks[i] == 0)
+			return -ENODATA;
+
+	/* only the first flag-set matters */
+	if (!test_and_set_bit(LDISKFS_INODE_JOURNAL_DATA,
+			      &LDISKFS_I(inode)->i_flags))
+		osd_dirty_inode(inode, I_DIRTY_DATASYNC);
+
+	disk_size = i_size_read(inode);
+	if (disk_size > user_size)
+		user_size = 0;
+
+	for (i = 0; i < iobuf->dr_npages && rc == 0; i++) {
+		lnb = iobuf->dr_lnbs[i];
+		addr = kmap(iobuf->dr_pages[i]);
+		for (j = 0; j < blocks_per_page && rc == 0; j++) {
+			bh = sb_getblk(inode->i_sb,
+				       iobuf->dr_blocks[i * blocks_per_page + j]);
+			if (!bh) {
+				rc = -ENOMEM;
+				break;
+			}
+			rc = osd_writelog_block(handle, bh,
+						addr + j * blocksize);
+			brelse(bh);
+		}
+		kunmap(iobuf->dr_pages[i]);
+		if (rc)
+			break;
+
+		lnb->lnb_flags |= OBD_BRW_DONE;
+		if (lnb->lnb_file_offset + lnb->lnb_len > disk_size)
+			disk_size = lnb->lnb_file_offset + lnb->lnb_len;
+	}
+
+	if (rc) {
+		CERROR("%s: can't log write of inode %lu: rc = %d\n",
+		       osd_name(osd), inode->i_ino, rc);
+		return rc;
+	}
+
+	osd_ldiskfs_update_size(inode, &disk_size, user_size);
+	thandle->th_sync = 1;
+
+	atomic64_inc(&osd->od_writelog_ios);
+	atomic64_add(iobuf->dr_npages, &osd->od_writelog_pages);
+
+	return 0;
+}
+
 /* Check if a block is allocated or not */
 static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
 			    struct niobuf_local *lnb, int npages,
@@ -1579,6 +2107,8 @@ static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
 	struct osd_iobuf *iobuf = &oti->oti_iobuf;
 	struct inode *inode = osd_dt_obj(dt)->oo_inode;
 	struct osd_device  *osd = osd_obj2dev(osd_dt_obj(dt));
+	struct osd_thandle *oh = container_of(thandle, struct osd_thandle,
+					      ot_super);
 	int rc = 0, i, check_credits = 0;
 
 	LASSERT(inode);
@@ -1633,10 +2163,24 @@ static int osd_write_commit(const struct lu_env *env, struct dt_object *dt,
 	if (OBD_FAIL_CHECK(OBD_FAIL_OST_MAPBLK_ENOSPC)) {
 		rc = -ENOSPC;
 	} else if (iobuf->dr_npages > 0) {
-		rc = osd_ldiskfs_map_inode_pages(inode, iobuf, osd,
-						 1, user_size,
-						 check_credits,
+		if (oh->ot_writelog) {
+			rc = osd_writelog_commit(inode, iobuf, osd, user_size,
 						 thandle);
+			/* no allocation is declared for a logged write,
+			 * restart it if some block is not allocated anymore
+			 */
+			if (rc == -ENODATA) {
+				thandle->th_restart_tran = 1;
+				rc = -EAGAIN;
+			}
+		} else {
+			rc = osd_ldiskfs_map_inode_pages(inode, iobuf, osd,
+							 1, user_size,
+							 check_credits,
+							 thandle);
+			if (rc == 0 && oh->oh_stream_blocks)
+				osd_stream_prealloc(osd, inode, oh);
+		}
 	} else {
 		/* no pages to write, no transno is needed */
 		thandle->th_local = 1;
@@ -2528,6 +3072,13 @@ static int osd_punch(const struct lu_env *env, struct dt_object *dt,
 		grow = true;
 	i_size_write(inode, start);
 	spin_unlock(&inode->i_lock);
+
+	/* truncate frees the blocks reserved ahead of the stream */
+	spin_lock(&obj->oo_guard);
+	obj->oo_stream_len = 0;
+	obj->oo_stream_resv = 0;
+	spin_unlock(&obj->oo_guard);
+
 	/* if object holds encrypted content, we need to make sure we truncate
 	 * on an encryption unit boundary, or subsequent reads will get
 	 * corrupted content
@@ -2898,3 +3449,38 @@ int osd_process_truncates(const struct lu_env *env, struct list_head *list)
 
 	return rc;
 }
+
+/**
+ * Free the blocks reserved ahead of the write stream of \a obj.
+ *
+ * The reservation beyond the object size up to \a resv is punched rather
+ * than the object truncated, so blocks fallocated beyond the size are kept.
+ * The caller excludes writes to the object and holds no journal handle.
+ */
+void osd_stream_trim(const struct lu_env *env, struct osd_object *obj,
+		     loff_t resv)
+{
+	struct osd_device *osd = osd_obj2dev(obj);
+	struct inode *inode = obj->oo_inode;
+	blkcnt_t blocks = inode->i_blocks;
+	loff_t start;
+	int rc;
+
+	start = round_up(i_size_read(inode), 1 << inode->i_blkbits);
+	if (start >= resv)
+		return;
+
+	rc = osd_execute_punch(env, obj, start, resv,
+			       FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE);
+	if (rc) {
+		CDEBUG(D_INODE,
+		       "%s: inode #%lu: can't trim [%lld, %lld): rc = %d\n",
+		       osd_name(osd), inode->i_ino, start, resv, rc);
+		return;
+	}
+
+	if (inode->i_blocks < blocks)
+		lprocfs_counter_add(osd->od_stats, LPROC_OSD_STREAM_TRIM,
+				    (blocks - inode->i_blocks) >>
+				    (inode->i_blkbits - 9));
+}
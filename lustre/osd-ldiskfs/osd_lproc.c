@@ -99,6 +99,18 @@ static int osd_stats_init(struct osd_device *osd)
                 lprocfs_counter_init(osd->od_stats, LPROC_OSD_CACHE_MISS,
                                      LPROCFS_CNTR_AVGMINMAX,
                                      "cache_miss", "pages");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_ALLOC_EXTENT,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "alloc_extent", "blocks");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_ALLOC_FRAGMENT,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "alloc_fragment", "blocks");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_STREAM_PREALLOC,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "stream_prealloc", "blocks");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_STREAM_TRIM,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "stream_trim", "blocks");
 #if OSD_THANDLE_STATS
                 lprocfs_counter_init(osd->od_stats, LPROC_OSD_THANDLE_STARTING,
                                      LPROCFS_CNTR_AVGMINMAX,
@@ -483,6 +495,126 @@ static ssize_t extent_bytes_allocation_show(struct kobject *kobj,
 }
 LUSTRE_RO_ATTR(extent_bytes_allocation);
 
+static ssize_t stream_prealloc_max_mb_show(struct kobject *kobj,
+					   struct attribute *attr, char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *osd = osd_dt_dev(dt);
+
+	LASSERT(osd);
+	if (unlikely(!osd->od_mnt))
+		return -EINPROGRESS;
+
+	return sprintf(buf, "%lu\n", osd->od_stream_prealloc_max >> 20);
+}
+
+static ssize_t stream_prealloc_max_mb_store(struct kobject *kobj,
+					    struct attribute *attr,
+					    const char *buffer, size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *osd = osd_dt_dev(dt);
+	unsigned long val;
+	int rc;
+
+	LASSERT(osd);
+	if (unlikely(!osd->od_mnt))
+		return -EINPROGRESS;
+
+	rc = kstrtoul(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val > OSD_STREAM_PREALLOC_MAX_MB)
+		return -ERANGE;
+
+	osd->od_stream_prealloc_max = val << 20;
+	return count;
+}
+LUSTRE_RW_ATTR(stream_prealloc_max_mb);
+
+static ssize_t bio_submit_contexts_show(struct kobject *kobj,
+					struct attribute *attr, char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *osd = osd_dt_dev(dt);
+
+	LASSERT(osd);
+	if (unlikely(!osd->od_mnt))
+		return -EINPROGRESS;
+
+	return sprintf(buf, "%u\n", osd->od_bio_submit_contexts);
+}
+
+static ssize_t bio_submit_contexts_store(struct kobject *kobj,
+					 struct attribute *attr,
+					 const char *buffer, size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *osd = osd_dt_dev(dt);
+	unsigned int val;
+	int rc;
+
+	LASSERT(osd);
+	if (unlikely(!osd->od_mnt))
+		return -EINPROGRESS;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val > OSD_BIO_CTX_MAX)
+		return -ERANGE;
+
+	osd->od_bio_submit_contexts = val;
+	return count;
+}
+LUSTRE_RW_ATTR(bio_submit_contexts);
+
+static ssize_t deferred_free_min_kb_show(struct kobject *kobj,
+					 struct attribute *attr, char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *osd = osd_dt_dev(dt);
+
+	LASSERT(osd);
+	if (unlikely(!osd->od_mnt))
+		return -EINPROGRESS;
+
+	return sprintf(buf, "%lu\n", osd->od_deferred_free_min >> 10);
+}
+
+static ssize_t deferred_free_min_kb_store(struct kobject *kobj,
+					  struct attribute *attr,
+					  const char *buffer, size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osd_device *osd = osd_dt_dev(dt);
+	unsigned long val;
+	int rc;
+
+	LASSERT(osd);
+	if (unlikely(!osd->od_mnt))
+		return -EINPROGRESS;
+
+	rc = kstrtoul(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val > ULONG_MAX >> 10)
+		return -ERANGE;
+
+	osd->od_deferred_free_min = val << 10;
+	return count;
+}
+LUSTRE_RW_ATTR(deferred_free_min_kb);
+
 static int ldiskfs_osd_oi_scrub_seq_show(struct seq_file *m, void *data)
 {
 	struct osd_device *dev = osd_dt_dev((struct dt_device *)m->private);
@@ -637,6 +769,111 @@ ldiskfs_osd_writethrough_max_io_seq_write(struct file *file,
 
 LDEBUGFS_SEQ_FOPS(ldiskfs_osd_writethrough_max_io);
 
+static int ldiskfs_osd_writelog_max_io_seq_show(struct seq_file *m,
+						void *data)
+{
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)m->private);
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	seq_printf(m, "%lu\n", osd->od_writelog_max_iosize >> 10);
+	return 0;
+}
+
+static ssize_t
+ldiskfs_osd_writelog_max_io_seq_write(struct file *file,
+				      const char __user *buffer,
+				      size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct dt_device *dt = m->private;
+	struct osd_device *osd = osd_dt_dev(dt);
+	char kernbuf[22] = "";
+	u64 val;
+	int rc;
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	if (count >= sizeof(kernbuf))
+		return -EINVAL;
+
+	if (copy_from_user(kernbuf, buffer, count))
+		return -EFAULT;
+	kernbuf[count] = 0;
+
+	rc = sysfs_memparse(kernbuf, count, &val, "KiB");
+	if (rc < 0)
+		return rc;
+
+	if (val > OSD_WRITELOG_MAX_IO_KB << 10)
+		return -ERANGE;
+	osd->od_writelog_max_iosize = val;
+	return count;
+}
+
+LDEBUGFS_SEQ_FOPS(ldiskfs_osd_writelog_max_io);
+
+static int ldiskfs_osd_writelog_stats_seq_show(struct seq_file *m,
+					       void *data)
+{
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)m->private);
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	seq_printf(m, "ios: %lld\n", atomic64_read(&osd->od_writelog_ios));
+	seq_printf(m, "pages: %lld\n",
+		   atomic64_read(&osd->od_writelog_pages));
+	seq_printf(m, "aliases: %lld\n",
+		   atomic64_read(&osd->od_writelog_aliases));
+	return 0;
+}
+
+static ssize_t
+ldiskfs_osd_writelog_stats_seq_write(struct file *file,
+				     const char __user *buffer,
+				     size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)m->private);
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	atomic64_set(&osd->od_writelog_ios, 0);
+	atomic64_set(&osd->od_writelog_pages, 0);
+	atomic64_set(&osd->od_writelog_aliases, 0);
+	return count;
+}
+
+LDEBUGFS_SEQ_FOPS(ldiskfs_osd_writelog_stats);
+
+static int ldiskfs_osd_deferred_free_stats_seq_show(struct seq_file *m,
+						    void *data)
+{
+	struct osd_device *osd = osd_dt_dev((struct dt_device *)m->private);
+
+	LASSERT(osd != NULL);
+	if (unlikely(osd->od_mnt == NULL))
+		return -EINPROGRESS;
+
+	seq_printf(m, "pending_objects: %d\n",
+		   atomic_read(&osd->od_deferred_free_objs));
+	seq_printf(m, "pending_kb: %lld\n",
+		   atomic64_read(&osd->od_deferred_free_blocks) >> 1);
+	seq_printf(m, "freed_objects: %lld\n",
+		   atomic64_read(&osd->od_deferred_freed));
+	return 0;
+}
+
+LDEBUGFS_SEQ_FOPS_RO(ldiskfs_osd_deferred_free_stats);
+
 #if LUSTRE_VERSION_CODE < OBD_OCD_VERSION(3, 0, 52, 0)
 static ssize_t index_in_idif_show(struct kobject *kobj, struct attribute *attr,
 				  char *buf)
@@ -756,6 +993,12 @@ struct ldebugfs_vars ldebugfs_osd_obd_vars[] = {
 	  .fops	=	&ldiskfs_osd_readcache_max_io_fops	},
 	{ .name	=	"writethrough_max_io_mb",
 	  .fops	=	&ldiskfs_osd_writethrough_max_io_fops	},
+	{ .name	=	"writelog_max_io_kb",
+	  .fops	=	&ldiskfs_osd_writelog_max_io_fops	},
+	{ .name	=	"writelog_stats",
+	  .fops	=	&ldiskfs_osd_writelog_stats_fops	},
+	{ .name	=	"deferred_free_stats",
+	  .fops	=	&ldiskfs_osd_deferred_free_stats_fops	},
 	{ NULL }
 };
 
@@ -773,6 +1016,9 @@ static struct attribute *ldiskfs_attrs[] = {
 	&lustre_attr_full_scrub_ratio.attr,
 	&lustre_attr_full_scrub_threshold_rate.attr,
 	&lustre_attr_extent_bytes_allocation.attr,
+	&lustre_attr_stream_prealloc_max_mb.attr,
+	&lustre_attr_bio_submit_contexts.attr,
+	&lustre_attr_deferred_free_min_kb.attr,
 	NULL,
 };
 
@@ -276,6 +276,45 @@ static ssize_t max_rpcs_in_flight_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(max_rpcs_in_flight);
 
+static ssize_t max_sync_batch_show(struct kobject *kobj,
+				   struct attribute *attr,
+				   char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+
+	return sprintf(buf, "%d\n", osp->opd_sync_max_batch);
+}
+
+/**
+ * Change maximum number of unlink records destroyed by one RPC
+ *
+ * 1 disables batching, each record is sent by its own OST_DESTROY RPC.
+ */
+static ssize_t max_sync_batch_store(struct kobject *kobj,
+				    struct attribute *attr,
+				    const char *buffer,
+				    size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val == 0 || val > OSP_SYNC_BATCH_MAX)
+		return -ERANGE;
+
+	osp->opd_sync_max_batch = val;
+	return count;
+}
+LUSTRE_RW_ATTR(max_sync_batch);
+
 /**
  * Show maximum number of RPCs in processing allowed
  *
@@ -472,6 +511,127 @@ static ssize_t max_create_count_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(max_create_count);
 
+/**
+ * Show average object creation rate, used to size the precreate batch
+ *
+ * \param[in] kobj	kobject of the OSP device
+ * \param[in] attr	unused
+ * \param[out] buf	output buffer
+ * \retval		length of the output on success
+ * \retval		negative number on error
+ */
+static ssize_t create_rate_show(struct kobject *kobj, struct attribute *attr,
+				char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+
+	if (!osp->opd_pre)
+		return -EINVAL;
+
+	return sprintf(buf, "%d\n", osp->opd_pre_create_rate);
+}
+LUSTRE_RO_ATTR(create_rate);
+
+/**
+ * Show the number of bulk I/Os in service on the OST, from the last statfs
+ *
+ * \param[in] kobj	kobject of the OSP device
+ * \param[in] attr	unused
+ * \param[out] buf	output buffer
+ * \retval		length of the output
+ */
+static ssize_t io_inflight_show(struct kobject *kobj, struct attribute *attr,
+				char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+
+	return sprintf(buf, "%u\n", osp->opd_statfs.os_io_inflight);
+}
+LUSTRE_RO_ATTR(io_inflight);
+
+/**
+ * Show average bulk I/O service time on the OST in usec, from the last statfs
+ *
+ * \param[in] kobj	kobject of the OSP device
+ * \param[in] attr	unused
+ * \param[out] buf	output buffer
+ * \retval		length of the output
+ */
+static ssize_t io_latency_us_show(struct kobject *kobj, struct attribute *attr,
+				  char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+
+	return sprintf(buf, "%u\n", osp->opd_statfs.os_io_latency);
+}
+LUSTRE_RO_ATTR(io_latency_us);
+
+/**
+ * Show maximum number of precreate RPCs in flight
+ *
+ * \param[in] kobj	kobject of the OSP device
+ * \param[in] attr	unused
+ * \param[out] buf	output buffer
+ * \retval		length of the output on success
+ * \retval		negative number on error
+ */
+static ssize_t max_create_rpcs_in_flight_show(struct kobject *kobj,
+					      struct attribute *attr,
+					      char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+
+	if (!osp->opd_pre)
+		return -EINVAL;
+
+	return sprintf(buf, "%d\n", osp->opd_pre_max_rpcs_in_flight);
+}
+
+/**
+ * Change maximum number of precreate RPCs in flight
+ *
+ * \param[in] kobj	kobject of the OSP device
+ * \param[in] attr	unused
+ * \param[in] buffer	string which represents maximum number
+ * \param[in] count	\a buffer length
+ * \retval		\a count on success
+ * \retval		negative number on error
+ */
+static ssize_t max_create_rpcs_in_flight_store(struct kobject *kobj,
+					       struct attribute *attr,
+					       const char *buffer,
+					       size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+	unsigned int val;
+	int rc;
+
+	if (!osp->opd_pre)
+		return -EINVAL;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1 || val > OSP_PRECREATE_RPCS_IN_FLIGHT_MAX)
+		return -ERANGE;
+
+	osp->opd_pre_max_rpcs_in_flight = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(max_create_rpcs_in_flight);
+
 /**
  * Show last id to assign in creation
  *
@@ -836,6 +996,96 @@ LDEBUGFS_SEQ_FOPS_RO_TYPE(osp, timeouts);
 LDEBUGFS_SEQ_FOPS_RW_TYPE(osp, import);
 LDEBUGFS_SEQ_FOPS_RO_TYPE(osp, state);
 
+/**
+ * Show maximum number of transactions sent in one OUT RPC
+ *
+ * \param[in] kobj	kobject of the OSP dt_device
+ * \param[in] attr	unused
+ * \param[in] buf	buffer to print into
+ * \retval		length of the output on success
+ * \retval		negative number on error
+ */
+static ssize_t out_batch_max_show(struct kobject *kobj, struct attribute *attr,
+				  char *buf)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+
+	if (!osp->opd_update)
+		return -ENODEV;
+
+	return sprintf(buf, "%u\n", osp->opd_update->ou_batch_max);
+}
+
+/**
+ * Change maximum number of transactions sent in one OUT RPC,
+ * 0 or 1 disables batching.
+ *
+ * \param[in] kobj	kobject of the OSP dt_device
+ * \param[in] attr	unused
+ * \param[in] buffer	string which represents the maximum number
+ * \param[in] count	\a buffer length
+ * \retval		\a count on success
+ * \retval		negative number on error
+ */
+static ssize_t out_batch_max_store(struct kobject *kobj,
+				   struct attribute *attr,
+				   const char *buffer, size_t count)
+{
+	struct dt_device *dt = container_of(kobj, struct dt_device,
+					    dd_kobj);
+	struct osp_device *osp = dt2osp_dev(dt);
+	unsigned int val;
+	int rc;
+
+	if (!osp->opd_update)
+		return -ENODEV;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val > OSP_OUT_BATCH_MAX)
+		return -ERANGE;
+
+	osp->opd_update->ou_batch_max = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(out_batch_max);
+
+/**
+ * Show statistics of the OUT RPCs carrying several transactions
+ *
+ * \param[in] m		seq_file handle
+ * \param[in] data	unused for single entry
+ * \retval		0 on success
+ * \retval		negative number on error
+ */
+static int osp_out_batch_stats_seq_show(struct seq_file *m, void *data)
+{
+	struct obd_device *dev = m->private;
+	struct osp_device *osp = lu2osp_dev(dev->obd_lu_dev);
+	struct osp_updates *ou;
+	__u64 rpcs;
+	__u64 trans;
+
+	if (osp == NULL || osp->opd_update == NULL)
+		return -EINVAL;
+
+	ou = osp->opd_update;
+	spin_lock(&ou->ou_lock);
+	rpcs = ou->ou_batch_rpcs;
+	trans = ou->ou_batch_trans;
+	spin_unlock(&ou->ou_lock);
+
+	seq_printf(m, "batch_rpcs: %llu\nbatch_transactions: %llu\n",
+		   rpcs, trans);
+	return 0;
+}
+LDEBUGFS_SEQ_FOPS_RO(osp_out_batch_stats);
+
 /**
  * Show high watermark (in megabytes). If available free space at OST is grater
  * than high watermark and object allocation for OST is disabled, enable it.
@@ -1020,6 +1270,8 @@ static struct ldebugfs_vars ldebugfs_osp_md_vars[] = {
 	  .fops =	&osp_import_fops		},
 	{ .name =	"state",
 	  .fops =	&osp_state_fops			},
+	{ .name =	"out_batch_stats",
+	  .fops =	&osp_out_batch_stats_fops	},
 	{ NULL }
 };
 
@@ -1043,10 +1295,15 @@ static struct attribute *osp_obd_attrs[] = {
 	&lustre_attr_sync_in_progress.attr,
 	&lustre_attr_sync_changes.attr,
 	&lustre_attr_max_sync_changes.attr,
+	&lustre_attr_max_sync_batch.attr,
 	&lustre_attr_force_sync.attr,
 	&lustre_attr_old_sync_processed.attr,
 	&lustre_attr_create_count.attr,
 	&lustre_attr_max_create_count.attr,
+	&lustre_attr_create_rate.attr,
+	&lustre_attr_max_create_rpcs_in_flight.attr,
+	&lustre_attr_io_inflight.attr,
+	&lustre_attr_io_latency_us.attr,
 	NULL,
 };
 
@@ -1061,6 +1318,7 @@ static struct attribute *osp_md_attrs[] = {
 	&lustre_attr_mdt_conn_uuid.attr,
 	&lustre_attr_ping.attr,
 	&lustre_attr_prealloc_status.attr,
+	&lustre_attr_out_batch_max.attr,
 	NULL,
 };
 
@@ -530,6 +530,7 @@ static int osp_update_init(struct osp_device *osp)
 	osp->opd_update->ou_rpc_version = 1;
 	osp->opd_update->ou_version = 1;
 	osp->opd_update->ou_generation = 0;
+	osp->opd_update->ou_batch_max = OSP_OUT_BATCH_MAX_DEFAULT;
 
 	rc = lu_env_init(&osp->opd_update->ou_env,
 			 osp->opd_dt_dev.dd_lu_dev.ld_type->ldt_ctx_tags);
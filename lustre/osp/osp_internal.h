@@ -62,6 +62,11 @@ struct osp_id_tracker {
 	atomic_t		 otr_refcount;
 };
 
+/* default number of precreate RPCs in flight to one target */
+#define OSP_PRECREATE_RPCS_IN_FLIGHT	2
+/* the limit of osp.*.max_create_rpcs_in_flight */
+#define OSP_PRECREATE_RPCS_IN_FLIGHT_MAX	8
+
 struct osp_precreate {
 	/*
 	 * Precreation pool
@@ -71,6 +76,9 @@ struct osp_precreate {
 	struct lu_fid			 osp_pre_used_fid;
 	/* last created id OST reported, next-created - available id's */
 	struct lu_fid			 osp_pre_last_created_fid;
+	/* last id requested by precreate RPCs, same as last created if no
+	 * precreate RPC in flight */
+	struct lu_fid			 osp_pre_sent_fid;
 	/* how many ids are reserved in declare, we shouldn't block in create */
 	__u64				 osp_pre_reserved;
 	/* consumers (who needs new ids) wait here */
@@ -85,6 +93,18 @@ struct osp_precreate {
 	int				 osp_pre_create_slow;
 	/* cleaning up orphans or recreating missing objects */
 	int				 osp_pre_recovering;
+	/* objects reserved in total, to measure the create rate */
+	__u64				 osp_pre_reserved_total;
+	/* osp_pre_reserved_total and time when the rate was sampled */
+	__u64				 osp_pre_rate_reserved;
+	ktime_t				 osp_pre_rate_time;
+	/* average object reservation rate, objects per second */
+	int				 osp_pre_create_rate;
+	/* duration of the last precreate RPC, in milliseconds */
+	int				 osp_pre_rpc_ms;
+	/* precreate RPCs in flight and the limit of them */
+	int				 osp_pre_rpcs_in_flight;
+	int				 osp_pre_max_rpcs_in_flight;
 };
 
 struct osp_update_request_sub {
@@ -116,11 +136,25 @@ struct osp_update_request {
 	spinlock_t			our_list_lock;
 	/* linked to the list(ou_list) in osp_updates */
 	struct list_head		our_list;
+	/* requests sent in the same OUT RPC behind this one, linked by
+	 * their our_list, see osp_batch_requests() */
+	struct list_head		our_batch_list;
 	__u32				our_batchid;
 	__u32				our_req_ready:1;
 
 };
 
+/* max unlink records destroyed by one OST_DESTROY RPC, the OST destroys
+ * them in one transaction, so keep it within OFD_DESTROY_BATCH_MAX */
+#define OSP_SYNC_BATCH_MAX		64
+
+/* default max number of transactions sent in one OUT RPC */
+#define OSP_OUT_BATCH_MAX_DEFAULT	16
+#define OSP_OUT_BATCH_MAX		64
+/* max updates of transactions batched in one OUT RPC, the remote target
+ * executes them in one transaction, so this bounds the credits it needs */
+#define OSP_OUT_BATCH_UPDATES_MAX	128
+
 struct osp_updates {
 	struct list_head	ou_list;
 	spinlock_t		ou_lock;
@@ -142,6 +176,13 @@ struct osp_updates {
 	 * will cause update lllog corruption */
 	__u64			ou_generation;
 
+	/* max number of transactions packed into one OUT RPC */
+	unsigned int		ou_batch_max;
+	/* OUT RPCs carrying more than one transaction */
+	__u64			ou_batch_rpcs;
+	/* transactions sent in such RPCs */
+	__u64			ou_batch_trans;
+
 	/* dedicate update thread */
 	struct task_struct	*ou_update_task;
 	struct lu_env		ou_env;
@@ -154,6 +195,8 @@ struct osp_rpc_lock {
 	unsigned int		rpcl_fakes;
 };
 
+struct osp_sync_batch;
+
 struct osp_device {
 	struct dt_device		 opd_dt_dev;
 	/* corresponded OST index */
@@ -241,6 +284,9 @@ struct osp_device {
 	int                              opd_sync_last_catalog_idx;
 	/* number of processed records */
 	atomic64_t			 opd_sync_processed_recs;
+	/* unlink records to send in one OST_DESTROY RPC */
+	struct osp_sync_batch		*opd_sync_batch;
+	int				 opd_sync_max_batch;
 	/* stop processing new requests until barrier=0 */
 	atomic_t			 opd_sync_barrier;
 	wait_queue_head_t		 opd_sync_barrier_waitq;
@@ -289,6 +335,14 @@ struct osp_device {
 #define opd_pre_max_create_count	opd_pre->osp_pre_max_create_count
 #define opd_pre_create_slow		opd_pre->osp_pre_create_slow
 #define opd_pre_recovering		opd_pre->osp_pre_recovering
+#define opd_pre_reserved_total		opd_pre->osp_pre_reserved_total
+#define opd_pre_rate_reserved		opd_pre->osp_pre_rate_reserved
+#define opd_pre_rate_time		opd_pre->osp_pre_rate_time
+#define opd_pre_create_rate		opd_pre->osp_pre_create_rate
+#define opd_pre_rpc_ms			opd_pre->osp_pre_rpc_ms
+#define opd_pre_sent_fid		opd_pre->osp_pre_sent_fid
+#define opd_pre_rpcs_in_flight		opd_pre->osp_pre_rpcs_in_flight
+#define opd_pre_max_rpcs_in_flight	opd_pre->osp_pre_max_rpcs_in_flight
 
 extern struct kmem_cache *osp_object_kmem;
 
@@ -331,7 +331,17 @@ static inline int osp_objs_precreated(const struct lu_env *env,
 static inline int osp_precreate_near_empty_nolock(const struct lu_env *env,
 						  struct osp_device *d)
 {
-	int window = osp_objs_precreated(env, d);
+	/* objects requested by precreate RPCs in flight count as well */
+	int window = osp_fid_diff(&d->opd_pre_sent_fid, &d->opd_pre_used_fid);
+
+	/* wait for the replies if sequence is used up, see
+	 * osp_precreate_rollover_new_seq(), or the objects requested would
+	 * exceed max_create_count, which limits orphan cleanup as well */
+	if (d->opd_pre_rpcs_in_flight &&
+	    (d->opd_pre_rpcs_in_flight >= d->opd_pre_max_rpcs_in_flight ||
+	     window + d->opd_pre_create_count > d->opd_pre_max_create_count ||
+	     osp_fid_end_seq(env, &d->opd_pre_sent_fid)))
+		return 0;
 
 	/* don't consider new precreation till OST is healty and
 	 * has free space */
@@ -524,6 +534,7 @@ static int osp_precreate_rollover_new_seq(struct lu_env *env,
 	osp->opd_gap_start_fid = *fid;
 	osp->opd_pre_used_fid = *fid;
 	osp->opd_pre_last_created_fid = *fid;
+	osp->opd_pre_sent_fid = *fid;
 	spin_unlock(&osp->opd_pre_lock);
 
 	RETURN(rc);
@@ -560,7 +571,7 @@ static int osp_precreate_fids(const struct lu_env *env, struct osp_device *osp,
 		int rc;
 
 		spin_lock(&osp->opd_pre_lock);
-		last_fid = &osp->opd_pre_last_created_fid;
+		last_fid = &osp->opd_pre_sent_fid;
 		fid_to_ostid(last_fid, oi);
 		end = min(ostid_id(oi) + *grow, IDIF_MAX_OID);
 		*grow = end - ostid_id(oi);
@@ -575,7 +586,7 @@ static int osp_precreate_fids(const struct lu_env *env, struct osp_device *osp,
 	}
 
 	spin_lock(&osp->opd_pre_lock);
-	*fid = osp->opd_pre_last_created_fid;
+	*fid = osp->opd_pre_sent_fid;
 	end = fid->f_oid;
 	end = min((end + *grow), (__u64)LUSTRE_DATA_SEQ_MAX_WIDTH);
 	*grow = end - fid->f_oid;
@@ -583,19 +594,245 @@ static int osp_precreate_fids(const struct lu_env *env, struct osp_device *osp,
 	spin_unlock(&osp->opd_pre_lock);
 
 	CDEBUG(D_INFO, "Expect %d, actual %d ["DFID" -- "DFID"]\n",
-	       *grow, i, PFID(fid), PFID(&osp->opd_pre_last_created_fid));
+	       *grow, i, PFID(fid), PFID(&osp->opd_pre_sent_fid));
 
 	return *grow > 0 ? 0 : 1;
 }
 
+/* shortest interval to sample the object reservation rate over */
+#define OSP_PRECREATE_RATE_MIN_MS	100
+/* precreate RPC times the precreate batch should last at the current rate */
+#define OSP_PRECREATE_RATE_RPCS		2
+
+/**
+ * Adapt the number of objects to precreate to the object consumption rate
+ *
+ * The OSP refills the pool when half of the batch is left, so the batch has
+ * to cover the objects consumed while the precreate RPC is in flight, or
+ * the creates stall in osp_precreate_reserve() during a create storm on
+ * wide-striped layouts. The reservation rate is averaged over the intervals
+ * between precreate RPCs and the batch is grown so it lasts for
+ * OSP_PRECREATE_RATE_RPCS times the last precreate RPC duration. The batch
+ * isn't grown while the OST can't keep up with it, see opd_pre_create_slow.
+ * Notice this function relies on the caller holding opd_pre_lock.
+ *
+ * \param[in] d		OSP device
+ */
+static void osp_precreate_adapt_nolock(struct osp_device *d)
+{
+	ktime_t now = ktime_get();
+	s64 ms = ktime_ms_delta(now, d->opd_pre_rate_time);
+	__u64 used;
+	__u64 want;
+
+	if (ms < OSP_PRECREATE_RATE_MIN_MS)
+		return;
+
+	used = d->opd_pre_reserved_total - d->opd_pre_rate_reserved;
+	d->opd_pre_create_rate = (d->opd_pre_create_rate +
+				  div64_s64(used * MSEC_PER_SEC, ms)) / 2;
+	d->opd_pre_rate_reserved = d->opd_pre_reserved_total;
+	d->opd_pre_rate_time = now;
+
+	if (d->opd_pre_create_slow)
+		return;
+
+	want = (__u64)d->opd_pre_create_rate * OSP_PRECREATE_RATE_RPCS *
+	       max_t(int, d->opd_pre_rpc_ms, OSP_PRECREATE_RATE_MIN_MS);
+	want = min_t(__u64, div_u64(want, MSEC_PER_SEC),
+		     d->opd_pre_max_create_count / 2);
+	if (want <= d->opd_pre_create_count)
+		return;
+
+	/* keep the rounding done by create_count_store() */
+	if (want > 256)
+		want = round_up(want, 256);
+	else
+		want = roundup_pow_of_two(want);
+
+	CDEBUG(D_HA, "%s: create rate %d/s, create count %d -> %llu\n",
+	       d->opd_obd->obd_name, d->opd_pre_create_rate,
+	       d->opd_pre_create_count, want);
+	d->opd_pre_create_count = want;
+}
+
+struct osp_precreate_args {
+	struct osp_device	*opa_dev;
+	/* the last FID requested and the number of objects */
+	struct lu_fid		 opa_fid;
+	int			 opa_grow;
+	ktime_t			 opa_start;
+};
+
+/**
+ * Add objects precreated by the target to the precreated pool
+ *
+ * The target creates all the objects up to the FID requested, and precreate
+ * RPCs in flight may be handled by the target in any order, so the reply to
+ * a later RPC may cover the objects of an earlier one, whose reply is then
+ * ignored. The target replies with its LAST_ID + 1 if the objects requested
+ * exist already, which is trusted only if it is beyond all the FIDs that
+ * have been requested, otherwise the objects up to its LAST_ID were created
+ * for this OSP. If the target wasn't able to create all the objects
+ * requested, then the next precreate will be asking for fewer objects
+ * (i.e. slow precreate down).
+ *
+ * \param[in] d		OSP device
+ * \param[in] fid	FID the target replied, the highest FID of the pool
+ *			on return
+ * \param[in] opa	precreate request
+ *
+ * \retval 0		on success
+ * \retval -ESTALE	if the target has fewer objects than used already
+ */
+static int osp_precreate_update_pool(struct osp_device *d, struct lu_fid *fid,
+				     struct osp_precreate_args *opa)
+{
+	struct ost_id oi;
+	int diff;
+
+	spin_lock(&d->opd_pre_lock);
+	if (osp_fid_diff(fid, &opa->opa_fid) > 0 &&
+	    osp_fid_diff(fid, &d->opd_pre_sent_fid) <= 1) {
+		fid_to_ostid(fid, &oi);
+		if (ostid_set_id(&oi, ostid_id(&oi) - 1) == 0)
+			ostid_to_fid(fid, &oi, d->opd_index);
+	}
+
+	/* covered by the reply to another precreate RPC */
+	if (osp_fid_diff(&opa->opa_fid, &d->opd_pre_last_created_fid) <= 0) {
+		spin_unlock(&d->opd_pre_lock);
+		return 0;
+	}
+	spin_unlock(&d->opd_pre_lock);
+
+	if (osp_fid_diff(fid, &d->opd_pre_used_fid) <= 0) {
+		CERROR("%s: precreate fid "DFID" <= local used fid "DFID
+		       ": rc = %d\n", d->opd_obd->obd_name,
+		       PFID(fid), PFID(&d->opd_pre_used_fid), -ESTALE);
+		return -ESTALE;
+	}
+
+	spin_lock(&d->opd_pre_lock);
+	diff = osp_fid_diff(fid, &opa->opa_fid);
+	if (diff < 0) {
+		/* the OST has not managed to create all the
+		 * objects we asked for */
+		d->opd_pre_create_count = max(opa->opa_grow + diff,
+					      OST_MIN_PRECREATE);
+		d->opd_pre_create_slow = 1;
+	} else {
+		/* the OST is able to keep up with the work,
+		 * we could consider increasing create_count
+		 * next time if needed */
+		d->opd_pre_create_slow = 0;
+	}
+
+	/* the pool never shrinks while other precreate RPCs are in flight,
+	 * the target creates objects in order
+	 */
+	if (osp_fid_diff(fid, &d->opd_pre_last_created_fid) > 0 ||
+	    d->opd_pre_rpcs_in_flight == 1)
+		d->opd_pre_last_created_fid = *fid;
+	/* the target is ahead of all the requests, see above */
+	if (osp_fid_diff(fid, &d->opd_pre_sent_fid) > 0)
+		d->opd_pre_sent_fid = *fid;
+	spin_unlock(&d->opd_pre_lock);
+
+	CDEBUG(D_HA, "%s: current precreated pool: "DFID"-"DFID"\n",
+	       d->opd_obd->obd_name, PFID(&d->opd_pre_used_fid),
+	       PFID(&d->opd_pre_last_created_fid));
+
+	return 0;
+}
+
+/**
+ * Finish precreate RPC
+ *
+ * Wakes up the threads waiting for the new objects on this target, and the
+ * precreate thread to send the next precreate RPC.
+ *
+ * \param[in] d		OSP device
+ * \param[in] rc	result of the precreate RPC
+ */
+static void osp_precreate_done(struct osp_device *d, int rc)
+{
+	spin_lock(&d->opd_pre_lock);
+	LASSERT(d->opd_pre_rpcs_in_flight > 0);
+	if (--d->opd_pre_rpcs_in_flight == 0)
+		d->opd_pre_sent_fid = d->opd_pre_last_created_fid;
+	spin_unlock(&d->opd_pre_lock);
+
+	/* osp_pre_update_status() sets opd_pre_status in case of error,
+	 * that prevent the using of failed device.
+	 */
+	if (rc < 0 && rc != -ENOSPC && rc != -ETIMEDOUT && rc != -ENOTCONN)
+		CERROR("%s: cannot precreate objects: rc = %d\n",
+		       d->opd_obd->obd_name, rc);
+
+	/* now we can wakeup all users awaiting for objects */
+	osp_pre_update_status(d, rc);
+	wake_up(&d->opd_pre_user_waitq);
+	wake_up(&d->opd_pre_waitq);
+}
+
+/**
+ * RPC interpret callback for OST_CREATE RPC
+ *
+ * \param[in] env	LU environment provided by the caller
+ * \param[in] req	RPC replied
+ * \param[in] args	callback data
+ * \param[in] rc	RPC result
+ *
+ * \retval 0		on success
+ * \retval negative	negated errno on error
+ */
+static int osp_precreate_interpret(const struct lu_env *env,
+				   struct ptlrpc_request *req, void *args,
+				   int rc)
+{
+	struct osp_precreate_args *opa = args;
+	struct osp_device *d = opa->opa_dev;
+	struct ost_body *body;
+	struct lu_fid fid;
+
+	ENTRY;
+
+	d->opd_pre_rpc_ms = ktime_ms_delta(ktime_get(), opa->opa_start);
+	if (rc) {
+		CERROR("%s: can't precreate: rc = %d\n", d->opd_obd->obd_name,
+		       rc);
+		if (req->rq_net_err)
+			/* have osp_precreate_reserve() to wait for repeat */
+			rc = -ENOTCONN;
+		GOTO(out, rc);
+	}
+	LASSERT(req->rq_transno == 0);
+
+	body = req_capsule_server_get(&req->rq_pill, &RMF_OST_BODY);
+	if (body == NULL)
+		GOTO(out, rc = -EPROTO);
+
+	ostid_to_fid(&fid, &body->oa.o_oi, d->opd_index);
+	rc = osp_precreate_update_pool(d, &fid, opa);
+	if (rc == 0) {
+		body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
+		fid_to_ostid(&fid, &body->oa.o_oi);
+	}
+out:
+	osp_precreate_done(d, rc);
+
+	RETURN(rc);
+}
+
 /**
  * Prepare and send precreate RPC
  *
- * The function finds how many objects should be precreated.  Then allocates,
- * prepares and schedules precreate RPC synchronously. Upon reply the function
- * wakes up the threads waiting for the new objects on this target. If the
- * target wasn't able to create all the objects requested, then the next
- * precreate will be asking for fewer objects (i.e. slow precreate down).
+ * The function finds how many objects should be precreated. Then allocates,
+ * prepares and schedules precreate RPC asynchronously, the reply is handled
+ * by osp_precreate_interpret(). Up to opd_pre_max_rpcs_in_flight precreate
+ * RPCs are in flight, each asks for the objects following the ones asked
+ * for by the previous RPC.
  *
  * \param[in] env	LU environment provided by the caller
  * \param[in] d		OSP device
@@ -606,10 +843,11 @@ static int osp_precreate_fids(const struct lu_env *env, struct osp_device *osp,
 static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 {
 	struct osp_thread_info	*oti = osp_env_info(env);
+	struct osp_precreate_args *opa;
 	struct ptlrpc_request	*req;
 	struct obd_import	*imp;
 	struct ost_body		*body;
-	int			 rc, grow, diff;
+	int			 rc, grow;
 	struct lu_fid		*fid = &oti->osi_fid;
 	ENTRY;
 
@@ -641,6 +879,7 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 	}
 
 	spin_lock(&d->opd_pre_lock);
+	osp_precreate_adapt_nolock(d);
 	if (d->opd_pre_create_count > d->opd_pre_max_create_count / 2)
 		d->opd_pre_create_count = d->opd_pre_max_create_count / 2;
 	grow = d->opd_pre_create_count;
@@ -649,11 +888,30 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
 	LASSERT(body);
 
-	*fid = d->opd_pre_last_created_fid;
+	*fid = d->opd_pre_sent_fid;
 	rc = osp_precreate_fids(env, d, fid, &grow);
-	if (rc == 1)
+	if (rc == 1) {
 		/* Current seq has been used up*/
-		GOTO(out_req, rc = -ENOSPC);
+		ptlrpc_req_finished(req);
+		osp_pre_update_status(d, -ENOSPC);
+		wake_up(&d->opd_pre_user_waitq);
+		RETURN(-ENOSPC);
+	}
+
+	opa = ptlrpc_req_async_args(opa, req);
+	opa->opa_dev = d;
+	opa->opa_fid = *fid;
+	opa->opa_grow = grow;
+	opa->opa_start = ktime_get();
+
+	spin_lock(&d->opd_pre_lock);
+	d->opd_pre_sent_fid = *fid;
+	d->opd_pre_rpcs_in_flight++;
+	spin_unlock(&d->opd_pre_lock);
+
+	CDEBUG(D_HA, "%s: precreate %d objects up to "DFID", %d RPCs in flight\n",
+	       d->opd_obd->obd_name, grow, PFID(fid),
+	       d->opd_pre_rpcs_in_flight);
 
 	if (!osp_is_fid_client(d)) {
 		/* Non-FID client will always send seq 0 because of
@@ -667,67 +925,19 @@ static int osp_precreate_send(const struct lu_env *env, struct osp_device *d)
 
 	ptlrpc_request_set_replen(req);
 
-	if (OBD_FAIL_CHECK(OBD_FAIL_OSP_FAKE_PRECREATE))
-		GOTO(ready, rc = 0);
-
-	rc = ptlrpc_queue_wait(req);
-	if (rc) {
-		CERROR("%s: can't precreate: rc = %d\n", d->opd_obd->obd_name,
-		       rc);
-		if (req->rq_net_err)
-			/* have osp_precreate_reserve() to wait for repeat */
-			rc = -ENOTCONN;
-		GOTO(out_req, rc);
-	}
-	LASSERT(req->rq_transno == 0);
-
-	body = req_capsule_server_get(&req->rq_pill, &RMF_OST_BODY);
-	if (body == NULL)
-		GOTO(out_req, rc = -EPROTO);
-
-	ostid_to_fid(fid, &body->oa.o_oi, d->opd_index);
-
-ready:
-	if (osp_fid_diff(fid, &d->opd_pre_used_fid) <= 0) {
-		CERROR("%s: precreate fid "DFID" <= local used fid "DFID
-		       ": rc = %d\n", d->opd_obd->obd_name,
-		       PFID(fid), PFID(&d->opd_pre_used_fid), -ESTALE);
-		GOTO(out_req, rc = -ESTALE);
-	}
-
-	diff = osp_fid_diff(fid, &d->opd_pre_last_created_fid);
-
-	spin_lock(&d->opd_pre_lock);
-	if (diff < grow) {
-		/* the OST has not managed to create all the
-		 * objects we asked for */
-		d->opd_pre_create_count = max(diff, OST_MIN_PRECREATE);
-		d->opd_pre_create_slow = 1;
+	if (OBD_FAIL_CHECK(OBD_FAIL_OSP_FAKE_PRECREATE)) {
+		*fid = opa->opa_fid;
+		rc = osp_precreate_update_pool(d, fid, opa);
+		osp_precreate_done(d, rc);
+		ptlrpc_req_finished(req);
 	} else {
-		/* the OST is able to keep up with the work,
-		 * we could consider increasing create_count
-		 * next time if needed */
-		d->opd_pre_create_slow = 0;
+		req->rq_interpret_reply = osp_precreate_interpret;
+		ptlrpcd_add_req(req);
 	}
 
-	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
-	fid_to_ostid(fid, &body->oa.o_oi);
-
-	d->opd_pre_last_created_fid = *fid;
-	spin_unlock(&d->opd_pre_lock);
-
-	CDEBUG(D_HA, "%s: current precreated pool: "DFID"-"DFID"\n",
-	       d->opd_obd->obd_name, PFID(&d->opd_pre_used_fid),
-	       PFID(&d->opd_pre_last_created_fid));
-out_req:
-	/* now we can wakeup all users awaiting for objects */
-	osp_pre_update_status(d, rc);
-	wake_up(&d->opd_pre_user_waitq);
-
 	/* pause to let osp_precreate_reserve to go first */
 	CFS_FAIL_TIMEOUT(OBD_FAIL_OSP_PRECREATE_PAUSE, 2);
 
-	ptlrpc_req_finished(req);
 	RETURN(rc);
 }
 
@@ -854,7 +1064,7 @@ static int osp_precreate_cleanup_orphans(struct lu_env *env,
 	 * used. also can't we allow new reservations because they may
 	 * end up getting orphans being cleaned up below. so we block
 	 * new reservations and wait till all reserved objects either
-	 * user or released.
+	 * user or released, and all precreate RPCs are finished.
 	 */
 	spin_lock(&d->opd_pre_lock);
 	d->opd_pre_recovering = 1;
@@ -865,7 +1075,8 @@ static int osp_precreate_cleanup_orphans(struct lu_env *env,
 	 * "!opd_pre_recovering".
 	 */
 	wait_event_idle(d->opd_pre_waitq,
-			(!d->opd_pre_reserved && d->opd_recovery_completed) ||
+			(!d->opd_pre_reserved && !d->opd_pre_rpcs_in_flight &&
+			 d->opd_recovery_completed) ||
 			!d->opd_pre_task || d->opd_got_disconnected);
 	if (!d->opd_pre_task || d->opd_got_disconnected)
 		GOTO(out, rc = -EAGAIN);
@@ -945,6 +1156,7 @@ static int osp_precreate_cleanup_orphans(struct lu_env *env,
 	LASSERT(fid_oid(&d->opd_pre_last_created_fid) <=
 		LUSTRE_DATA_SEQ_MAX_WIDTH);
 	d->opd_pre_used_fid = d->opd_pre_last_created_fid;
+	d->opd_pre_sent_fid = d->opd_pre_last_created_fid;
 	d->opd_pre_create_slow = 0;
 	spin_unlock(&d->opd_pre_lock);
 
@@ -1170,6 +1382,7 @@ int osp_init_pre_fid(struct osp_device *osp)
 	osp->opd_last_used_fid = *last_fid;
 	osp->opd_pre_used_fid = *last_fid;
 	osp->opd_pre_last_created_fid = *last_fid;
+	osp->opd_pre_sent_fid = *last_fid;
 	spin_unlock(&osp->opd_pre_lock);
 	rc = osp_write_last_oid_seq_files(&env, osp, last_fid, 1);
 	if (rc != 0) {
@@ -1341,6 +1554,11 @@ static int osp_precreate_thread(void *_args)
 		}
 	}
 
+	/* precreate RPCs in flight refer to the device */
+	if (d->opd_pre)
+		wait_event_idle(d->opd_pre_waitq,
+				d->opd_pre_rpcs_in_flight == 0);
+
 	lu_env_fini(env);
 	OBD_FREE_PTR(args);
 
@@ -1462,6 +1680,7 @@ int osp_precreate_reserve(const struct lu_env *env, struct osp_device *d,
 		if (precreated > d->opd_pre_reserved &&
 		    !d->opd_pre_recovering) {
 			d->opd_pre_reserved++;
+			d->opd_pre_reserved_total++;
 			spin_unlock(&d->opd_pre_lock);
 			rc = 0;
 
@@ -1732,6 +1951,7 @@ int osp_init_precreate(struct osp_device *d)
 	d->opd_pre_used_fid.f_oid = 1;
 	fid_zero(&d->opd_pre_last_created_fid);
 	d->opd_pre_last_created_fid.f_oid = 1;
+	d->opd_pre_sent_fid = d->opd_pre_last_created_fid;
 	d->opd_last_id = 0;
 	d->opd_pre_reserved = 0;
 	d->opd_got_disconnected = 1;
@@ -1739,6 +1959,8 @@ int osp_init_precreate(struct osp_device *d)
 	d->opd_pre_create_count = OST_MIN_PRECREATE;
 	d->opd_pre_min_create_count = OST_MIN_PRECREATE;
 	d->opd_pre_max_create_count = OST_MAX_PRECREATE;
+	d->opd_pre_rate_time = ktime_get();
+	d->opd_pre_max_rpcs_in_flight = OSP_PRECREATE_RPCS_IN_FLIGHT;
 	d->opd_reserved_mb_high = 0;
 	d->opd_reserved_mb_low = 0;
 
@@ -94,8 +94,25 @@ struct osp_job_req_args {
 	struct list_head		jra_in_flight_link;
 	struct llog_cookie		jra_lcookie;
 	__u32				jra_magic;
+	/* records handled by the RPC, NULL for a single record */
+	struct osp_sync_batch		*jra_batch;
 };
 
+/* unlink records destroyed by one OST_DESTROY RPC */
+struct osp_sync_batch {
+	int				osb_count;
+	struct llog_cookie		osb_cookies[OSP_SYNC_BATCH_MAX];
+	struct ost_id			osb_oids[OSP_SYNC_BATCH_MAX];
+	/* llog indexes to cancel, see osp_sync_batch_cancel() */
+	int				osb_index[OSP_SYNC_BATCH_MAX];
+};
+
+static inline void osp_sync_batch_free(struct osp_sync_batch *osb)
+{
+	if (osb != NULL)
+		OBD_FREE_LARGE(osb, sizeof(*osb));
+}
+
 static int osp_sync_add_commit_cb(const struct lu_env *env,
 				  struct osp_device *d, struct thandle *th);
 
@@ -166,6 +183,21 @@ static inline int osp_sync_in_flight_conflict(struct osp_device *d,
 			conflict = 1;
 			break;
 		}
+
+		if (jra->jra_batch) {
+			struct osp_sync_batch *osb = jra->jra_batch;
+			int i;
+
+			for (i = 1; i < osb->osb_count; i++) {
+				if (memcmp(&ostid, &osb->osb_oids[i],
+					   sizeof(ostid)) == 0) {
+					conflict = 1;
+					break;
+				}
+			}
+			if (conflict)
+				break;
+		}
 	}
 	spin_unlock(&d->opd_sync_lock);
 
@@ -594,6 +626,9 @@ static int osp_sync_interpret(const struct lu_env *env,
 			 * will be called at some point */
 			LASSERT(atomic_read(&d->opd_sync_rpcs_in_progress) > 0);
 			atomic_dec(&d->opd_sync_rpcs_in_progress);
+			/* the records stay in llog till next boot */
+			osp_sync_batch_free(jra->jra_batch);
+			jra->jra_batch = NULL;
 		}
 
 		wake_up(&d->opd_sync_waitq);
@@ -629,14 +664,14 @@ static int osp_sync_interpret(const struct lu_env *env,
  * This is just a tiny helper function to put the request on the sending list
  *
  * \param[in] d		OSP device
- * \param[in] llh	llog handle where the record is stored
- * \param[in] h		llog record
+ * \param[in] cookie	llog cookie of the (first) record
+ * \param[in] osb	batch of records, NULL for a single record
  * \param[in] req	request
  */
-static void osp_sync_send_new_rpc(struct osp_device *d,
-				  struct llog_handle *llh,
-				  struct llog_rec_hdr *h,
-				  struct ptlrpc_request *req)
+static void osp_sync_send_rpc(struct osp_device *d,
+			      const struct llog_cookie *cookie,
+			      struct osp_sync_batch *osb,
+			      struct ptlrpc_request *req)
 {
 	struct osp_job_req_args *jra;
 
@@ -645,9 +680,8 @@ static void osp_sync_send_new_rpc(struct osp_device *d,
 
 	jra = ptlrpc_req_async_args(jra, req);
 	jra->jra_magic = OSP_JOB_MAGIC;
-	jra->jra_lcookie.lgc_lgl = llh->lgh_id;
-	jra->jra_lcookie.lgc_subsys = LLOG_MDS_OST_ORIG_CTXT;
-	jra->jra_lcookie.lgc_index = h->lrh_index;
+	jra->jra_lcookie = *cookie;
+	jra->jra_batch = osb;
 	INIT_LIST_HEAD(&jra->jra_committed_link);
 	spin_lock(&d->opd_sync_lock);
 	list_add_tail(&jra->jra_in_flight_link, &d->opd_sync_in_flight_list);
@@ -656,6 +690,20 @@ static void osp_sync_send_new_rpc(struct osp_device *d,
 	ptlrpcd_add_req(req);
 }
 
+static void osp_sync_send_new_rpc(struct osp_device *d,
+				  struct llog_handle *llh,
+				  struct llog_rec_hdr *h,
+				  struct ptlrpc_request *req)
+{
+	struct llog_cookie cookie = {
+		.lgc_lgl	= llh->lgh_id,
+		.lgc_subsys	= LLOG_MDS_OST_ORIG_CTXT,
+		.lgc_index	= h->lrh_index,
+	};
+
+	osp_sync_send_rpc(d, &cookie, NULL, req);
+}
+
 
 /**
  * Allocate and prepare RPC for a new change.
@@ -668,13 +716,15 @@ static void osp_sync_send_new_rpc(struct osp_device *d,
  * \param[in] d		OSP device
  * \param[in] op	type of the change
  * \param[in] format	request format to be used
+ * \param[in] osb	batch of records to destroy, or NULL
  *
  * \retval pointer		new request on success
  * \retval ERR_PTR(errno)	on error
  */
 static struct ptlrpc_request *osp_sync_new_job(struct osp_device *d,
 					       enum ost_cmd op,
-					       const struct req_format *format)
+					       const struct req_format *format,
+					       struct osp_sync_batch *osb)
 {
 	struct ptlrpc_request	*req;
 	struct obd_import	*imp;
@@ -691,6 +741,11 @@ static struct ptlrpc_request *osp_sync_new_job(struct osp_device *d,
 	if (req == NULL)
 		RETURN(ERR_PTR(-ENOMEM));
 
+	if (osb != NULL)
+		req_capsule_set_size(&req->rq_pill, &RMF_OST_ID_ARRAY,
+				     RCL_CLIENT,
+				     osb->osb_count * sizeof(struct ost_id));
+
 	rc = ptlrpc_request_pack(req, LUSTRE_OST_VERSION, op);
 	if (rc) {
 		ptlrpc_req_finished(req);
@@ -744,7 +799,7 @@ static int osp_sync_new_setattr_job(struct osp_device *d,
 		RETURN(1);
 	}
 
-	req = osp_sync_new_job(d, OST_SETATTR, &RQF_OST_SETATTR);
+	req = osp_sync_new_job(d, OST_SETATTR, &RQF_OST_SETATTR, NULL);
 	if (IS_ERR(req))
 		RETURN(PTR_ERR(req));
 
@@ -805,7 +860,7 @@ static int osp_sync_new_unlink_job(struct osp_device *d,
 	ENTRY;
 	LASSERT(h->lrh_type == MDS_UNLINK_REC);
 
-	req = osp_sync_new_job(d, OST_DESTROY, &RQF_OST_DESTROY);
+	req = osp_sync_new_job(d, OST_DESTROY, &RQF_OST_DESTROY, NULL);
 	if (IS_ERR(req))
 		RETURN(PTR_ERR(req));
 
@@ -853,7 +908,7 @@ static int osp_sync_new_unlink64_job(struct osp_device *d,
 
 	ENTRY;
 	LASSERT(h->lrh_type == MDS_UNLINK64_REC);
-	req = osp_sync_new_job(d, OST_DESTROY, &RQF_OST_DESTROY);
+	req = osp_sync_new_job(d, OST_DESTROY, &RQF_OST_DESTROY, NULL);
 	if (IS_ERR(req))
 		RETURN(PTR_ERR(req));
 
@@ -870,6 +925,184 @@ static int osp_sync_new_unlink64_job(struct osp_device *d,
 	RETURN(0);
 }
 
+/**
+ * Check whether unlink records can be destroyed in batches.
+ *
+ * \param[in] d		OSP device
+ *
+ * \retval		true if the OST supports an array of objects in
+ *			OST_DESTROY and batching isn't disabled
+ */
+static inline bool osp_sync_batch_enabled(struct osp_device *d)
+{
+	return d->opd_sync_max_batch > 1 &&
+	       imp_connect_batch_destroy(d->opd_obd->u.cli.cl_import);
+}
+
+/**
+ * Give up the batch of unlink records not sent.
+ *
+ * The records stay in the llog till next boot, like a single record which
+ * could not be sent.
+ *
+ * \param[in] d		OSP device
+ */
+static void osp_sync_batch_drop(struct osp_device *d)
+{
+	struct osp_sync_batch *osb = d->opd_sync_batch;
+
+	if (osb == NULL)
+		return;
+
+	d->opd_sync_batch = NULL;
+	atomic_dec(&d->opd_sync_rpcs_in_flight);
+	atomic_dec(&d->opd_sync_rpcs_in_progress);
+	osp_sync_batch_free(osb);
+	if (unlikely(atomic_read(&d->opd_sync_barrier) > 0))
+		wake_up(&d->opd_sync_barrier_waitq);
+}
+
+/**
+ * Send the batch of unlink records collected so far.
+ *
+ * One OST_DESTROY RPC carries the objects of all the records, see
+ * ofd_destroy_array() for the handling on the OST.
+ *
+ * \param[in] d		OSP device
+ */
+static void osp_sync_batch_send(struct osp_device *d)
+{
+	struct osp_sync_batch *osb = d->opd_sync_batch;
+	struct ptlrpc_request *req;
+	struct ost_body *body;
+	struct ost_id *oids;
+
+	if (osb == NULL)
+		return;
+
+	req = osp_sync_new_job(d, OST_DESTROY, &RQF_OST_DESTROY, osb);
+	if (IS_ERR(req)) {
+		CERROR("%s: can't send %d destroys: rc = %ld\n",
+		       d->opd_obd->obd_name, osb->osb_count, PTR_ERR(req));
+		osp_sync_batch_drop(d);
+		return;
+	}
+	d->opd_sync_batch = NULL;
+
+	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
+	LASSERT(body);
+	body->oa.o_oi = osb->osb_oids[0];
+	body->oa.o_valid = OBD_MD_FLGROUP | OBD_MD_FLID;
+
+	oids = req_capsule_client_get(&req->rq_pill, &RMF_OST_ID_ARRAY);
+	LASSERT(oids);
+	memcpy(oids, osb->osb_oids, osb->osb_count * sizeof(*oids));
+
+	CDEBUG(D_HA, "%s: destroy %d objects from "DOSTID"\n",
+	       d->opd_obd->obd_name, osb->osb_count, POSTID(&osb->osb_oids[0]));
+
+	osp_sync_send_rpc(d, &osb->osb_cookies[0], osb, req);
+}
+
+/**
+ * Add unlink record to the batch destroyed by one OST_DESTROY RPC.
+ *
+ * The caller has accounted the record as a new RPC in flight and in
+ * progress. The first record of a batch keeps this for the batch RPC,
+ * the others give it back. The batch is sent when it is full, or by
+ * osp_sync_process_queues() when no more records can be processed now.
+ *
+ * \param[in] d		OSP device
+ * \param[in] llh	llog handle where the record is stored
+ * \param[in] h		llog record
+ *
+ * \retval 0		on success
+ * \retval negative	negated errno, the record is to be sent alone
+ */
+static int osp_sync_batch_add(struct osp_device *d, struct llog_handle *llh,
+			      struct llog_rec_hdr *h)
+{
+	struct llog_unlink64_rec *rec = (struct llog_unlink64_rec *)h;
+	struct osp_sync_batch *osb = d->opd_sync_batch;
+	struct llog_cookie *cookie;
+	struct ost_id oi;
+	int rc;
+
+	/* a range of objects is destroyed with OBD_MD_FLOBJCOUNT */
+	if (rec->lur_count > 1)
+		return -EOPNOTSUPP;
+
+	rc = fid_to_ostid(&rec->lur_fid, &oi);
+	if (rc < 0)
+		return rc;
+
+	if (osb == NULL) {
+		OBD_ALLOC_LARGE(osb, sizeof(*osb));
+		if (osb == NULL)
+			return -ENOMEM;
+		d->opd_sync_batch = osb;
+	} else {
+		atomic_dec(&d->opd_sync_rpcs_in_flight);
+		atomic_dec(&d->opd_sync_rpcs_in_progress);
+	}
+
+	cookie = &osb->osb_cookies[osb->osb_count];
+	cookie->lgc_lgl = llh->lgh_id;
+	cookie->lgc_subsys = LLOG_MDS_OST_ORIG_CTXT;
+	cookie->lgc_index = h->lrh_index;
+	osb->osb_oids[osb->osb_count++] = oi;
+
+	if (osb->osb_count >= min(d->opd_sync_max_batch, OSP_SYNC_BATCH_MAX))
+		osp_sync_batch_send(d);
+
+	return 0;
+}
+
+/**
+ * Cancel the llog records of a batch destroyed by the target.
+ *
+ * The target reports how many objects it handled before an error, the
+ * records of the others stay in the llog till next boot. The records are
+ * cancelled in runs from the same plain llog, with one llog update each.
+ *
+ * \param[in] env	LU environment provided by the caller
+ * \param[in] d		OSP device
+ * \param[in] llh	catalog handle
+ * \param[in] req	committed (or -ENOENT) OST_DESTROY request
+ * \param[in] osb	batch of the request
+ */
+static void osp_sync_batch_cancel(const struct lu_env *env,
+				  struct osp_device *d,
+				  struct llog_handle *llh,
+				  struct ptlrpc_request *req,
+				  struct osp_sync_batch *osb)
+{
+	struct ost_body *body;
+	int count = osb->osb_count;
+	int rc, i, j, n;
+
+	if (req->rq_transno != 0) {
+		body = req_capsule_server_get(&req->rq_pill, &RMF_OST_BODY);
+		if (body != NULL && body->oa.o_valid & OBD_MD_FLOBJCOUNT)
+			count = min_t(int, count, body->oa.o_misc);
+	}
+
+	for (i = 0; i < count; i = j) {
+		struct llog_logid *lgid = &osb->osb_cookies[i].lgc_lgl;
+
+		for (j = i, n = 0; j < count &&
+		     !memcmp(&osb->osb_cookies[j].lgc_lgl, lgid,
+			     sizeof(*lgid)); j++)
+			osb->osb_index[n++] = osb->osb_cookies[j].lgc_index;
+
+		rc = llog_cat_cancel_arr_rec(env, llh, lgid, n,
+					     osb->osb_index);
+		if (rc)
+			CERROR("%s: can't cancel %d records: rc = %d\n",
+			       d->opd_obd->obd_name, n, rc);
+	}
+}
+
 /**
  * Process llog records.
  *
@@ -918,6 +1151,7 @@ static void osp_sync_process_record(const struct lu_env *env,
 		rc = llog_cat_cancel_records(env, cathandle, 1, &cookie);
 
 		/* flush all pending records ASAP */
+		osp_sync_batch_send(d);
 		osp_sync_force(env, d);
 
 		RETURN_EXIT;
@@ -939,9 +1173,14 @@ static void osp_sync_process_record(const struct lu_env *env,
 		rc = osp_sync_new_unlink_job(d, llh, rec);
 		break;
 	case MDS_UNLINK64_REC:
+		if (osp_sync_batch_enabled(d) &&
+		    osp_sync_batch_add(d, llh, rec) == 0)
+			break;
 		rc = osp_sync_new_unlink64_job(d, llh, rec);
 		break;
 	case MDS_SETATTR64_REC:
+		/* keep the order of the records to the same object */
+		osp_sync_batch_send(d);
 		rc = osp_sync_new_setattr_job(d, llh, rec);
 		break;
 	default:
@@ -1073,8 +1312,11 @@ static void osp_sync_process_committed(const struct lu_env *env,
 		/* import can be closing, thus all commit cb's are
 		 * called we can check committness directly */
 		if (req->rq_import_generation == imp->imp_generation) {
-			if (arr && (!i ||
-				    !memcmp(&jra->jra_lcookie.lgc_lgl, &lgid,
+			if (jra->jra_batch) {
+				osp_sync_batch_cancel(env, d, llh, req,
+						      jra->jra_batch);
+			} else if (arr && (!i ||
+				   !memcmp(&jra->jra_lcookie.lgc_lgl, &lgid,
 					   sizeof(lgid)))) {
 				if (unlikely(!i))
 					lgid = jra->jra_lcookie.lgc_lgl;
@@ -1091,6 +1333,8 @@ static void osp_sync_process_committed(const struct lu_env *env,
 			DEBUG_REQ(D_OTHER, req, "imp_committed = %llu",
 				  imp->imp_peer_committed_transno);
 		}
+		osp_sync_batch_free(jra->jra_batch);
+		jra->jra_batch = NULL;
 		ptlrpc_req_finished(req);
 		done++;
 		if (arr &&
@@ -1183,6 +1427,10 @@ static int osp_sync_process_queues(const struct lu_env *env,
 			    cfs_fail_val != 1)
 			msleep(1 * MSEC_PER_SEC);
 
+		/* don't hold the batch while waiting for new records */
+		if (d->opd_sync_batch && !osp_sync_can_process_new(d, rec))
+			osp_sync_batch_send(d);
+
 		wait_event_idle(d->opd_sync_waitq,
 				!d->opd_sync_task ||
 				osp_sync_can_process_new(d, rec) ||
@@ -1278,6 +1526,12 @@ next:
 	} while (rc == 0 && (wrapped ||
 			     d->opd_sync_last_catalog_idx == LLOG_CAT_FIRST));
 
+	/* send the batched records, or leave them in llog if stopping */
+	if (d->opd_sync_task)
+		osp_sync_batch_send(d);
+	else
+		osp_sync_batch_drop(d);
+
 	if (rc < 0) {
 		if (rc == -EINPROGRESS) {
 			/* can't access the llog now - OI scrub is trying to fix
@@ -1528,6 +1782,7 @@ int osp_sync_init(const struct lu_env *env, struct osp_device *d)
 	ENTRY;
 
 	d->opd_sync_max_rpcs_in_flight = OSP_MAX_RPCS_IN_FLIGHT;
+	d->opd_sync_max_batch = OSP_SYNC_BATCH_MAX;
 	d->opd_sync_max_rpcs_in_progress = OSP_MAX_RPCS_IN_PROGRESS;
 	d->opd_sync_max_changes = OSP_MAX_SYNC_CHANGES;
 	spin_lock_init(&d->opd_sync_lock);
@@ -189,6 +189,7 @@ struct osp_update_request *osp_update_request_create(struct dt_device *dt)
 	INIT_LIST_HEAD(&our->our_req_list);
 	INIT_LIST_HEAD(&our->our_cb_items);
 	INIT_LIST_HEAD(&our->our_list);
+	INIT_LIST_HEAD(&our->our_batch_list);
 	INIT_LIST_HEAD(&our->our_invalidate_cb_list);
 	spin_lock_init(&our->our_list_lock);
 
@@ -205,10 +206,20 @@ void osp_update_request_destroy(const struct lu_env *env,
 {
 	struct osp_update_request_sub *ours;
 	struct osp_update_request_sub *tmp;
+	struct osp_update_request *batched;
+	struct osp_update_request *next;
 
 	if (our == NULL)
 		return;
 
+	/* drop the requests sent together with this one, their references
+	 * were taken in osp_check_and_set_rpc_version() */
+	list_for_each_entry_safe(batched, next, &our->our_batch_list,
+				 our_list) {
+		list_del_init(&batched->our_list);
+		osp_thandle_put(env, batched->our_th);
+	}
+
 	list_for_each_entry_safe(ours, tmp, &our->our_req_list, ours_list) {
 		list_del(&ours->ours_list);
 		if (ours->ours_req != NULL)
@@ -243,6 +254,37 @@ void osp_update_request_destroy(const struct lu_env *env,
 	OBD_FREE_PTR(our);
 }
 
+/**
+ * Get the next request in the batch led by \a leader
+ *
+ * \param[in] leader	the first request of the OUT RPC
+ * \param[in] our	current request in the batch
+ *
+ * \retval		the request after \a our in the batch
+ * \retval		NULL if \a our is the last one
+ */
+static struct osp_update_request *
+osp_batch_next(struct osp_update_request *leader,
+	       struct osp_update_request *our)
+{
+	struct list_head *next;
+
+	if (our == leader)
+		next = leader->our_batch_list.next;
+	else
+		next = our->our_list.next;
+
+	if (next == &leader->our_batch_list)
+		return NULL;
+
+	return list_entry(next, struct osp_update_request, our_list);
+}
+
+/* walk through the sub requests of all the requests in the batch */
+#define osp_batch_for_each_sub(leader, our, ours)			\
+	for (our = leader; our != NULL; our = osp_batch_next(leader, our)) \
+		list_for_each_entry(ours, &our->our_req_list, ours_list)
+
 static void
 object_update_request_dump(const struct object_update_request *ourq,
 			   unsigned int mask)
@@ -343,6 +385,7 @@ int osp_prep_update_req(const struct lu_env *env, struct obd_import *imp,
 	struct ptlrpc_request		*req;
 	struct ptlrpc_bulk_desc		*desc;
 	struct osp_update_request_sub	*ours;
+	struct osp_update_request	*batched;
 	const struct object_update_request *ourq;
 	struct out_update_header	*ouh;
 	struct out_update_buffer	*oub;
@@ -354,7 +397,7 @@ int osp_prep_update_req(const struct lu_env *env, struct obd_import *imp,
 	int				total = 0;
 	ENTRY;
 
-	list_for_each_entry(ours, &our->our_req_list, ours_list) {
+	osp_batch_for_each_sub(our, batched, ours) {
 		object_update_request_dump(ours->ours_req, D_INFO);
 
 		ourq = ours->ours_req;
@@ -416,7 +459,7 @@ int osp_prep_update_req(const struct lu_env *env, struct obd_import *imp,
 	ouh->ouh_inline_length = 0;
 	ouh->ouh_reply_size = repsize;
 	oub = req_capsule_client_get(&req->rq_pill, &RMF_OUT_UPDATE_BUF);
-	list_for_each_entry(ours, &our->our_req_list, ours_list) {
+	osp_batch_for_each_sub(our, batched, ours) {
 		oub->oub_size = ours->ours_req_size;
 		oub++;
 		/* First *and* last might be partial pages, hence +1 */
@@ -432,7 +475,7 @@ int osp_prep_update_req(const struct lu_env *env, struct obd_import *imp,
 		GOTO(out_req, rc = -ENOMEM);
 
 	/* NB req now owns desc and will free it when it gets freed */
-	list_for_each_entry(ours, &our->our_req_list, ours_list) {
+	osp_batch_for_each_sub(our, batched, ours) {
 		desc->bd_frag_ops->add_iov_frag(desc, ours->ours_req,
 						ours->ours_req_size);
 		total += ours->ours_req_size;
@@ -590,11 +633,69 @@ static void osp_update_callback_fini(const struct lu_env *env,
 	OBD_FREE_PTR(ouc);
 }
 
+/**
+ * Call the registered interpreters of one request in the OUT RPC.
+ *
+ * \param[in] env	pointer to the thread context
+ * \param[in] req	pointer to the RPC
+ * \param[in] reply	the update reply, or NULL if there is none
+ * \param[in] our	the request whose interpreters will be called
+ * \param[in] count	number of results in \a reply
+ * \param[in] index	index of the first result of \a our in \a reply
+ * \param[in] rc	the RPC return value
+ *
+ * \retval		the result of the last update of \a our
+ */
+static int osp_update_interpret_one(const struct lu_env *env,
+				    struct ptlrpc_request *req,
+				    struct object_update_reply *reply,
+				    struct osp_update_request *our,
+				    int count, int index, int rc)
+{
+	struct osp_update_callback *ouc;
+	struct osp_update_callback *next;
+	int rc1 = 0;
+
+	list_for_each_entry_safe(ouc, next, &our->our_cb_items, ouc_list) {
+		list_del_init(&ouc->ouc_list);
+
+		/* The peer may only have handled some requests (indicated
+		 * by the 'count') in the packaged OUT RPC, we can only get
+		 * results for the handled part. */
+		if (index < count && reply->ourp_lens[index] > 0 && rc >= 0) {
+			struct object_update_result *result;
+
+			result = object_update_result_get(reply, index, NULL);
+			if (result == NULL)
+				rc1 = rc = -EPROTO;
+			else
+				rc1 = rc = result->our_rc;
+		} else if (rc1 >= 0) {
+			/* The peer did not handle these request, let's return
+			 * -EINVAL to update interpret for now */
+			if (rc >= 0)
+				rc1 = -EINVAL;
+			else
+				rc1 = rc;
+		}
+
+		if (ouc->ouc_interpreter != NULL)
+			ouc->ouc_interpreter(env, reply, req, ouc->ouc_obj,
+					     ouc->ouc_data, index, rc1);
+
+		osp_update_callback_fini(env, ouc);
+		index++;
+	}
+
+	return rc;
+}
+
 /**
  * Interpret the packaged OUT RPC results.
  *
  * For every packaged sub-request, call its registered interpreter function.
- * Then destroy the sub-request.
+ * Then destroy the sub-request. The requests batched behind the first one
+ * get their results from their own part of the reply.
  *
  * \param[in] env	pointer to the thread context
  * \param[in] req	pointer to the RPC
@@ -610,12 +711,12 @@ static int osp_update_interpret(const struct lu_env *env,
 	struct object_update_reply *reply = NULL;
 	struct osp_update_args *oaua = args;
 	struct osp_update_request *our = oaua->oaua_update;
+	struct osp_update_request *batched;
 	struct osp_thandle *oth;
-	struct osp_update_callback *ouc;
-	struct osp_update_callback *next;
 	int count = 0;
-	int index = 0;
-	int rc1 = 0;
+	int index;
+	int rpc_rc;
+	int rc1;
 
 	ENTRY;
 
@@ -656,35 +757,19 @@ static int osp_update_interpret(const struct lu_env *env,
 		}
 	}
 
-	list_for_each_entry_safe(ouc, next, &our->our_cb_items, ouc_list) {
-		list_del_init(&ouc->ouc_list);
-
-		/* The peer may only have handled some requests (indicated
-		 * by the 'count') in the packaged OUT RPC, we can only get
-		 * results for the handled part. */
-		if (index < count && reply->ourp_lens[index] > 0 && rc >= 0) {
-			struct object_update_result *result;
-
-			result = object_update_result_get(reply, index, NULL);
-			if (result == NULL)
-				rc1 = rc = -EPROTO;
-			else
-				rc1 = rc = result->our_rc;
-		} else if (rc1 >= 0) {
-			/* The peer did not handle these request, let's return
-			 * -EINVAL to update interpret for now */
-			if (rc >= 0)
-				rc1 = -EINVAL;
-			else
-				rc1 = rc;
-		}
-
-		if (ouc->ouc_interpreter != NULL)
-			ouc->ouc_interpreter(env, reply, req, ouc->ouc_obj,
-					     ouc->ouc_data, index, rc1);
-
-		osp_update_callback_fini(env, ouc);
-		index++;
+	rpc_rc = rc;
+	rc = osp_update_interpret_one(env, req, reply, our, count, 0, rpc_rc);
+
+	index = our->our_update_nr;
+	list_for_each_entry(batched, &our->our_batch_list, our_list) {
+		rc1 = osp_update_interpret_one(env, req, reply, batched,
+					       count, index, rpc_rc);
+		osp_trans_stop_cb(env, batched->our_th, rc1);
+		index += batched->our_update_nr;
+		/* all of them were executed in the same remote transaction,
+		 * so the failure of any one fails the whole batch */
+		if (rc1 < 0 && rc >= 0)
+			rc = rc1;
 	}
 
 	if (oaua->oaua_count != NULL && atomic_dec_and_test(oaua->oaua_count))
@@ -1022,6 +1107,7 @@ static void osp_request_commit_cb(struct ptlrpc_request *req)
 {
 	struct thandle		*th = req->rq_cb_data;
 	struct osp_thandle	*oth;
+	struct osp_update_request *batched;
 	__u64			last_committed_transno = 0;
 	int			result = req->rq_status;
 	ENTRY;
@@ -1049,6 +1135,9 @@ static void osp_request_commit_cb(struct ptlrpc_request *req)
 		result = 1;
 
 	osp_trans_commit_cb(oth, result);
+	/* the batched transactions are committed together */
+	list_for_each_entry(batched, &oth->ot_our->our_batch_list, our_list)
+		osp_trans_commit_cb(batched->our_th, result);
 	req->rq_committed = 1;
 	osp_thandle_put(NULL, oth);
 	EXIT;
@@ -1087,6 +1176,26 @@ void osp_trans_callback(const struct lu_env *env,
 	osp_trans_commit_cb(oth, rc);
 }
 
+/**
+ * callback of the osp transactions sent in one OUT RPC
+ *
+ * Same as osp_trans_callback(), but for \a our and all the requests
+ * batched behind it.
+ *
+ * \param [in] env	execution environment
+ * \param [in] our	the first update request of the OUT RPC
+ * \param [in] rc	result of the osp thandles
+ */
+static void osp_trans_batch_callback(const struct lu_env *env,
+				     struct osp_update_request *our, int rc)
+{
+	struct osp_update_request *batched;
+
+	osp_trans_callback(env, our->our_th, rc);
+	list_for_each_entry(batched, &our->our_batch_list, our_list)
+		osp_trans_callback(env, batched->our_th, rc);
+}
+
 /**
  * Send the request for remote updates.
  *
@@ -1120,7 +1229,7 @@ static int osp_send_update_req(const struct lu_env *env,
 		const struct lnet_processid *peer;
 
 		rc = -ESTALE;
-		osp_trans_callback(env, oth, rc);
+		osp_trans_batch_callback(env, our, rc);
 		peer = &osp->opd_obd->u.cli.cl_import->imp_connection->c_peer;
 		CDEBUG(D_HA, "%s: stale tx to %s: gen %llu != %llu: rc = %d\n",
 		       osp->opd_obd->obd_name, libcfs_nidstr(&peer->nid),
@@ -1131,7 +1240,7 @@ static int osp_send_update_req(const struct lu_env *env,
 	rc = osp_prep_update_req(env, osp->opd_obd->u.cli.cl_import,
 				 our, &req);
 	if (rc != 0) {
-		osp_trans_callback(env, oth, rc);
+		osp_trans_batch_callback(env, our, rc);
 		RETURN(rc);
 	}
 
@@ -1144,14 +1253,14 @@ static int osp_send_update_req(const struct lu_env *env,
 	req->rq_interpret_reply = osp_update_interpret;
 	if (!oth->ot_super.th_wait_submit && !oth->ot_super.th_sync) {
 		if (!osp->opd_imp_active || !osp->opd_imp_connected) {
-			osp_trans_callback(env, oth, rc);
+			osp_trans_batch_callback(env, our, rc);
 			osp_thandle_put(env, oth);
 			GOTO(out, rc = -ENOTCONN);
 		}
 
 		rc = obd_get_request_slot(&osp->opd_obd->u.cli);
 		if (rc != 0) {
-			osp_trans_callback(env, oth, rc);
+			osp_trans_batch_callback(env, our, rc);
 			osp_thandle_put(env, oth);
 			GOTO(out, rc = -ENOTCONN);
 		}
@@ -1204,7 +1313,7 @@ static int osp_send_update_req(const struct lu_env *env,
 
 			req->rq_cb_data = NULL;
 			rc = rc == 0 ? req->rq_status : rc;
-			osp_trans_callback(env, oth, rc);
+			osp_trans_batch_callback(env, our, rc);
 			osp_thandle_put(env, oth);
 			GOTO(out, rc);
 		}
@@ -1357,6 +1466,113 @@ osp_get_next_request(struct osp_updates *ou, struct osp_update_request **ourp)
 	return got_req;
 }
 
+/* number of bulk pages needed to send the updates of \a our */
+static int osp_update_request_pages(struct osp_update_request *our)
+{
+	struct osp_update_request_sub *ours;
+	int pages = 0;
+
+	list_for_each_entry(ours, &our->our_req_list, ours_list)
+		pages += DIV_ROUND_UP(ours->ours_req_size, PAGE_SIZE) + 1;
+
+	return pages;
+}
+
+/**
+ * Batch the following update requests behind \a leader
+ *
+ * Move the ready requests whose versions follow the one of \a leader
+ * from the sending list to the batch list of \a leader, so they are sent
+ * to the remote MDT in the same OUT RPC and executed there in one remote
+ * transaction, i.e. with one journal commit. Since only consecutive
+ * versions are batched, the update llog records still reach the remote
+ * target in the version order, and the RPC is replayed as a whole
+ * during recovery.
+ *
+ * The batch stops at the first request which is not ready yet, belongs
+ * to another generation or has failed, is sync while \a leader is not,
+ * would take the batch over OSP_OUT_BATCH_UPDATES_MAX updates, or if the
+ * bulk could not hold it.
+ *
+ * \param[in] ou	osp update structure
+ * \param[in] leader	the first request of the OUT RPC
+ *
+ * \retval		the version of the last request in the batch
+ */
+static __u64 osp_batch_requests(struct osp_updates *ou,
+				struct osp_update_request *leader)
+{
+	struct thandle *lth = &leader->our_th->ot_super;
+	struct osp_update_request *our;
+	struct osp_update_request *tmp;
+	__u64 version = leader->our_version;
+	unsigned int count = 1;
+	int updates;
+	int pages;
+	bool found;
+
+	if (ou->ou_batch_max <= 1)
+		return version;
+
+	pages = osp_update_request_pages(leader);
+	updates = leader->our_update_nr;
+
+	spin_lock(&ou->ou_lock);
+	do {
+		found = false;
+		list_for_each_entry_safe(our, tmp, &ou->ou_list, our_list) {
+			struct thandle *th;
+
+			if (our->our_version != version + 1)
+				continue;
+
+			th = &our->our_th->ot_super;
+			spin_lock(&our->our_list_lock);
+			/* The remote target makes the batch sync only if the
+			 * leader is, and the leader decides how the RPC is
+			 * sent, so a sync transaction can't follow an async
+			 * one. The whole batch is executed in one remote
+			 * transaction, keep it within its credits.
+			 */
+			if (!our->our_req_ready ||
+			    our->our_generation != leader->our_generation ||
+			    th->th_result != 0 ||
+			    (th->th_sync && !lth->th_sync) ||
+			    (our->our_flags & ~leader->our_flags &
+			     UPDATE_FL_SYNC) ||
+			    (th->th_wait_submit && !lth->th_wait_submit) ||
+			    updates + our->our_update_nr >
+			    OSP_OUT_BATCH_UPDATES_MAX ||
+			    pages + osp_update_request_pages(our) >
+			    LNET_MAX_IOV) {
+				spin_unlock(&our->our_list_lock);
+				break;
+			}
+			list_move_tail(&our->our_list, &leader->our_batch_list);
+			spin_unlock(&our->our_list_lock);
+
+			updates += our->our_update_nr;
+			pages += osp_update_request_pages(our);
+			version = our->our_version;
+			count++;
+			found = true;
+			break;
+		}
+	} while (found && count < ou->ou_batch_max);
+
+	if (count > 1) {
+		ou->ou_batch_rpcs++;
+		ou->ou_batch_trans += count;
+	}
+	spin_unlock(&ou->ou_lock);
+
+	if (count > 1)
+		CDEBUG(D_INFO, "batch %u updates requests, version %llu-%llu\n",
+		       count, leader->our_version, version);
+
+	return version;
+}
+
 /**
  * Invalidate update request
  *
@@ -1454,6 +1670,7 @@ int osp_send_update_thread(void *arg)
 	struct osp_device	*osp = arg;
 	struct osp_updates	*ou = osp->opd_update;
 	struct osp_update_request *our = NULL;
+	__u64			version;
 	int			rc;
 	ENTRY;
 
@@ -1475,6 +1692,7 @@ int osp_send_update_thread(void *arg)
 		}
 
 		LASSERT(our->our_th != NULL);
+		version = our->our_version;
 		if (our->our_th->ot_super.th_result != 0) {
 			osp_trans_callback(env, our->our_th,
 				our->our_th->ot_super.th_result);
@@ -1483,13 +1701,14 @@ int osp_send_update_thread(void *arg)
 			rc = -EIO;
 			osp_trans_callback(env, our->our_th, rc);
 		} else {
+			version = osp_batch_requests(ou, our);
 			rc = osp_send_update_req(env, osp, our);
 		}
 
 		/* Update the rpc version */
 		spin_lock(&ou->ou_lock);
 		if (our->our_version == ou->ou_rpc_version)
-			ou->ou_rpc_version++;
+			ou->ou_rpc_version = version + 1;
 		spin_unlock(&ou->ou_lock);
 
 		/* If one update request fails, let's fail all of the requests
@@ -1499,7 +1718,8 @@ int osp_send_update_thread(void *arg)
 		if (rc < 0)
 			osp_invalidate_request(osp);
 
-		/* Balanced for thandle_get in osp_check_and_set_rpc_version */
+		/* Balanced for thandle_get in osp_check_and_set_rpc_version,
+		 * the batched requests are released with this one */
 		osp_thandle_put(env, our->our_th);
 	}
 
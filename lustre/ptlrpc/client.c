@@ -191,6 +191,8 @@ struct ptlrpc_bulk_desc *ptlrpc_new_bulk(unsigned int nfrags,
 	desc->bd_type = type;
 	desc->bd_md_count = 0;
 	desc->bd_nob_last = LNET_MTU;
+	desc->bd_md_size = LNET_MTU;
+	desc->bd_md_max_iov = LNET_MAX_IOV;
 	desc->bd_frag_ops = ops;
 	LASSERT(max_brw > 0);
 	desc->bd_md_max_brw = min(max_brw, PTLRPC_BULK_OPS_COUNT);
@@ -259,8 +261,8 @@ void __ptlrpc_prep_bulk_page(struct ptlrpc_bulk_desc *desc,
 
 	kiov = &desc->bd_vec[desc->bd_iov_count];
 
-	if (((desc->bd_iov_count % LNET_MAX_IOV) == 0) ||
-	     ((desc->bd_nob_last + len) > LNET_MTU)) {
+	if (((desc->bd_iov_count % desc->bd_md_max_iov) == 0) ||
+	     ((desc->bd_nob_last + len) > desc->bd_md_size)) {
 		desc->bd_mds_off[desc->bd_md_count] = desc->bd_iov_count;
 		desc->bd_md_count++;
 		desc->bd_nob_last = 0;
@@ -281,6 +283,25 @@ void __ptlrpc_prep_bulk_page(struct ptlrpc_bulk_desc *desc,
 }
 EXPORT_SYMBOL(__ptlrpc_prep_bulk_page);
 
+/**
+ * Split the pages of bulk descriptor \a desc into MDs of up to \a md_size
+ * bytes, instead of LNET_MTU. Both sides of the transfer must use the same
+ * size, the client tells it to the server with ioobj_md_bits_set().
+ * Must be called before the first page is added.
+ */
+void ptlrpc_bulk_set_md_size(struct ptlrpc_bulk_desc *desc,
+			     unsigned int md_size)
+{
+	LASSERT(desc->bd_iov_count == 0);
+	LASSERTF(is_power_of_2(md_size) && md_size >= LNET_MTU &&
+		 md_size <= LNET_MTU_LARGE, "md_size %u\n", md_size);
+
+	desc->bd_md_size = md_size;
+	desc->bd_md_max_iov = LNET_MAX_IOV * (md_size >> LNET_MTU_BITS);
+	desc->bd_nob_last = md_size;
+}
+EXPORT_SYMBOL(ptlrpc_bulk_set_md_size);
+
 void ptlrpc_free_bulk(struct ptlrpc_bulk_desc *desc)
 {
 	ENTRY;
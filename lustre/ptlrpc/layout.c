@@ -628,10 +628,11 @@ static const struct req_msg_field *ost_body_capa[] = {
 };
 
 static const struct req_msg_field *ost_destroy_client[] = {
-        &RMF_PTLRPC_BODY,
-        &RMF_OST_BODY,
-        &RMF_DLM_REQ,
-        &RMF_CAPA1
+	&RMF_PTLRPC_BODY,
+	&RMF_OST_BODY,
+	&RMF_DLM_REQ,
+	&RMF_CAPA1,
+	&RMF_OST_ID_ARRAY
 };
 
 
@@ -1224,6 +1225,11 @@ struct req_msg_field RMF_OST_ID =
 		    sizeof(struct ost_id), lustre_swab_ost_id, NULL);
 EXPORT_SYMBOL(RMF_OST_ID);
 
+/* variable size, so OST_DESTROY doesn't carry it unless the size is set */
+struct req_msg_field RMF_OST_ID_ARRAY =
+	DEFINE_MSGF("ost_id_array", 0, -1, NULL, NULL);
+EXPORT_SYMBOL(RMF_OST_ID_ARRAY);
+
 struct req_msg_field RMF_FIEMAP_KEY =
 	DEFINE_MSGF("fiemap_key", 0, sizeof(struct ll_fiemap_info_key),
 		    lustre_swab_fiemap_info_key, NULL);
@@ -1847,8 +1847,8 @@ void lustre_swab_obd_statfs(struct obd_statfs *os)
 	__swab32s(&os->os_state);
 	__swab32s(&os->os_fprecreated);
 	__swab32s(&os->os_granted);
-	BUILD_BUG_ON(offsetof(typeof(*os), os_spare3) == 0);
-	BUILD_BUG_ON(offsetof(typeof(*os), os_spare4) == 0);
+	__swab32s(&os->os_io_inflight);
+	__swab32s(&os->os_io_latency);
 	BUILD_BUG_ON(offsetof(typeof(*os), os_spare5) == 0);
 	BUILD_BUG_ON(offsetof(typeof(*os), os_spare6) == 0);
 	BUILD_BUG_ON(offsetof(typeof(*os), os_spare7) == 0);
@@ -2222,6 +2222,7 @@ static void lustre_swab_lmv_mds_md_v1(struct lmv_mds_md_v1 *lmm1)
 	__swab32s(&lmm1->lmv_master_mdt_index);
 	__swab32s(&lmm1->lmv_hash_type);
 	__swab32s(&lmm1->lmv_layout_version);
+	__swab64s(&lmm1->lmv_bucket_weights);
 	for (i = 0; i < lmm1->lmv_stripe_count; i++)
 		lustre_swab_lu_fid(&lmm1->lmv_stripe_fids[i]);
 }
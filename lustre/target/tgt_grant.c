@@ -136,6 +136,109 @@ static inline u64 tgt_grant_chunk(struct obd_export *exp,
 	return chunk;
 }
 
+/* Check whether the target is short of grant space, i.e. there is less
+ * ungranted space left than the connected clients would need to keep their
+ * usual grant. Then grant is sized by the client write rate, and unused
+ * grant is asked back. */
+static inline bool tgt_grant_space_short(struct tg_grants_data *tgd,
+					 struct obd_export *exp, u64 left)
+{
+	return left < tgd->tgd_tot_granted_clients *
+		      TGT_GRANT_SHRINK_LIMIT(exp);
+}
+
+/**
+ * Update the write rate of a client.
+ *
+ * The rate is an EWMA folded at most once per second. The weight of the new
+ * sample grows with the time it covers, so the rate of a client which has
+ * stopped writing decays to 0 after 8 seconds.
+ * Caller must hold tgd_grant_lock spinlock.
+ *
+ * \param[in] ted	export data of the client
+ * \param[in] bytes	bytes just written, 0 to only decay the rate
+ */
+static void tgt_grant_rate_update(struct tg_export_data *ted, u64 bytes)
+{
+	ktime_t now = ktime_get();
+	s64 ms;
+	u64 rate;
+	int weight;
+
+	ted->ted_write_bytes += bytes;
+	ms = ktime_ms_delta(now, ted->ted_rate_time);
+	if (ms < MSEC_PER_SEC)
+		return;
+
+	rate = div64_u64(ted->ted_write_bytes * MSEC_PER_SEC, ms);
+	weight = min_t(s64, ms / MSEC_PER_SEC, 8);
+	ted->ted_write_rate = (ted->ted_write_rate * (8 - weight) +
+			       rate * weight) >> 3;
+	ted->ted_write_bytes = 0;
+	ted->ted_rate_time = now;
+}
+
+/* Grant a client needs for its dirty data and what it writes at its current
+ * rate in tgd_grant_rate_window seconds, at least one grant chunk. */
+static inline u64 tgt_grant_rate_want(struct tg_grants_data *tgd,
+				      struct tg_export_data *ted, long chunk)
+{
+	return max_t(u64, chunk, ted->ted_dirty +
+		     ted->ted_write_rate * tgd->tgd_grant_rate_window);
+}
+
+/**
+ * Ask the client to release the grant it doesn't need at its write rate.
+ *
+ * When the target is short of space, a client holding more grant than its
+ * rate justifies, and more than the single RPC it keeps anyway, gets
+ * OBD_FL_GRANT_RECLAIM in the I/O reply, and returns its unused grant
+ * through the usual shrink request. Clients not aware of the flag ignore it.
+ * Caller must hold tgd_grant_lock spinlock.
+ *
+ * \param[in] exp	export of the client
+ * \param[in,out] oa	obdo to be returned in the reply
+ * \param[in] left	remaining free space with granted space taken out
+ * \param[in] chunk	grant allocation unit
+ */
+static void tgt_grant_reclaim(struct obd_export *exp, struct obdo *oa,
+			      u64 left, long chunk)
+{
+	struct tg_export_data *ted = &exp->exp_target_data;
+	struct tg_grants_data *tgd = &exp->exp_obd->u.obt.obt_lut->lut_tgd;
+	u64 floor;
+
+	assert_spin_locked(&tgd->tgd_grant_lock);
+
+	if (oa->o_valid & OBD_MD_FLFLAGS)
+		oa->o_flags &= ~OBD_FL_GRANT_RECLAIM;
+
+	if (!tgd->tgd_grant_rate_window ||
+	    !OCD_HAS_FLAG(&exp->exp_connect_data, GRANT_SHRINK) ||
+	    !tgt_grant_space_short(tgd, exp, left))
+		return;
+
+	/* The client keeps one RPC worth of grant on top of its dirty data
+	 * when it shrinks, see osc_shrink_grant_to_target(). Don't ask for
+	 * less, or the client would be asked again on every reply.
+	 */
+	floor = ted->ted_dirty + exp_max_brw_size(exp);
+	if (ted->ted_grant <= max(tgt_grant_rate_want(tgd, ted, chunk), floor) +
+			      chunk)
+		return;
+
+	if (!(oa->o_valid & OBD_MD_FLFLAGS)) {
+		oa->o_valid |= OBD_MD_FLFLAGS;
+		oa->o_flags = 0;
+	}
+	oa->o_flags |= OBD_FL_GRANT_RECLAIM;
+	ted->ted_grant_reclaims++;
+
+	CDEBUG(D_CACHE, "%s: cli %s/%p grant %ld rate %llu, ask to shrink\n",
+	       exp->exp_obd->obd_name, exp->exp_client_uuid.uuid, exp,
+	       ted->ted_grant, ted->ted_write_rate);
+}
+
 static int tgt_check_export_grants(struct obd_export *exp, u64 *dirty,
 				   u64 *pending, u64 *granted, u64 maxsize)
 {
@@ -608,8 +711,7 @@ static void tgt_grant_shrink(struct obd_export *exp, struct obdo *oa,
 
 	assert_spin_locked(&tgd->tgd_grant_lock);
 	LASSERT(exp);
-	if (left_space >= tgd->tgd_tot_granted_clients *
-			  TGT_GRANT_SHRINK_LIMIT(exp))
+	if (!tgt_grant_space_short(tgd, exp, left_space))
 		return;
 
 	grant_shrink = oa->o_grant;
@@ -850,6 +952,9 @@ static void tgt_grant_check(const struct lu_env *env, struct obd_export *exp,
 	ted->ted_pending += oa->o_grant_used;
 	tgd->tgd_tot_granted += ungranted;
 	tgd->tgd_tot_pending += oa->o_grant_used;
+	ted->ted_grant_used += granted;
+	if (!obd->obd_recovering)
+		tgt_grant_rate_update(ted, oa->o_grant_used);
 
 	CDEBUG(D_CACHE,
 	       "%s: cli %s/%p granted: %lu ungranted: %lu grant: %lu dirty: %lu"
@@ -945,6 +1050,16 @@ static long tgt_grant_alloc(struct obd_export *exp, u64 curgrant,
 	if (obd->obd_recovering)
 		conservative = false;
 
+	/* When short of space, don't let clients which write little keep
+	 * the space busy writers need: grant by the client write rate. */
+	if (conservative && tgd->tgd_grant_rate_window &&
+	    obd->obd_self_export != exp &&
+	    tgt_grant_space_short(tgd, exp, left)) {
+		want = min(want, tgt_grant_rate_want(tgd, ted, chunk));
+		if (curgrant >= want)
+			RETURN(0);
+	}
+
 	if (conservative)
 		/* don't grant more than 1/8th of the remaining free space in
 		 * one chunk */
@@ -973,6 +1088,7 @@ static long tgt_grant_alloc(struct obd_export *exp, u64 curgrant,
 
 	tgd->tgd_tot_granted += grant;
 	ted->ted_grant += grant;
+	ted->ted_grant_given += grant;
 
 	if (unlikely(ted->ted_grant < 0 || ted->ted_grant > want + chunk)) {
 		CERROR("%s: cli %s/%p grant %ld want %llu current %llu\n",
@@ -1162,6 +1278,7 @@ void tgt_grant_prepare_read(const struct lu_env *env,
 {
 	struct lu_target	*lut = exp->exp_obd->u.obt.obt_lut;
 	struct tg_grants_data	*tgd = &lut->lut_tgd;
+	long			 chunk = tgt_grant_chunk(exp, lut, NULL);
 	int			 do_shrink;
 	u64			 left = 0;
 
@@ -1203,14 +1320,20 @@ void tgt_grant_prepare_read(const struct lu_env *env,
 
 	/* extract incoming grant information provided by the client and
 	 * inflate grant counters if required */
-	tgt_grant_incoming(env, exp, oa, tgt_grant_chunk(exp, lut, NULL));
+	tgt_grant_incoming(env, exp, oa, chunk);
+	tgt_grant_rate_update(&exp->exp_target_data, 0);
 
 	/* unlike writes, we don't return grants back on reads unless a grant
 	 * shrink request was packed and we decided to turn it down. */
-	if (do_shrink)
+	if (do_shrink) {
 		tgt_grant_shrink(exp, oa, left);
-	else
+	} else {
 		oa->o_grant = 0;
+		/* a reading client may hold grant it hasn't used for long */
+		if (tgd->tgd_grant_rate_window)
+			tgt_grant_reclaim(exp, oa, tgt_grant_space_left(exp),
+					  chunk);
+	}
 
 	if (!exp_grant_param_supp(exp))
 		oa->o_grant = tgt_grant_deflate(tgd, oa->o_grant);
@@ -1313,12 +1436,15 @@ refresh:
 	/* if OBD_FL_SHRINK_GRANT is set, the client is willing to release some
 	 * grant space. */
 	if ((oa->o_valid & OBD_MD_FLFLAGS) &&
-	    (oa->o_flags & OBD_FL_SHRINK_GRANT))
+	    (oa->o_flags & OBD_FL_SHRINK_GRANT)) {
 		tgt_grant_shrink(exp, oa, left);
-	else
+	} else {
 		/* grant more space back to the client if possible */
 		oa->o_grant = tgt_grant_alloc(exp, oa->o_grant, oa->o_undirty,
 					      left, chunk, true);
+		if (!oa->o_grant)
+			tgt_grant_reclaim(exp, oa, left, chunk);
+	}
 
 	if (!exp_grant_param_supp(exp))
 		oa->o_grant = tgt_grant_deflate(tgd, oa->o_grant);
@@ -1702,3 +1828,60 @@ ssize_t grant_compat_disable_store(struct kobject *kobj,
 	return count;
 }
 EXPORT_SYMBOL(grant_compat_disable_store);
+
+/**
+ * Show the window of rate-based grant.
+ *
+ * When the target is short of space, clients are granted what they write
+ * at their current rate in that many seconds, on top of their dirty data,
+ * and clients holding more are asked to release it. 0 disables it.
+ *
+ * @kobj		kobject embedded in obd_device
+ * @attr		unused
+ * @buf			buf used by sysfs to print out data
+ *
+ * Return:		string length of @buf output on success
+ */
+ssize_t grant_rate_window_show(struct kobject *kobj, struct attribute *attr,
+			       char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct tg_grants_data *tgd = &obd->u.obt.obt_lut->lut_tgd;
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n", tgd->tgd_grant_rate_window);
+}
+EXPORT_SYMBOL(grant_rate_window_show);
+
+/**
+ * Change the window of rate-based grant.
+ *
+ * @kobj	kobject embedded in obd_device
+ * @attr	unused
+ * @buffer	string which represents the window in seconds
+ * @count	@buffer length
+ *
+ * Return:	@count on success
+ *		negative number on error
+ */
+ssize_t grant_rate_window_store(struct kobject *kobj, struct attribute *attr,
+				const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct tg_grants_data *tgd = &obd->u.obt.obt_lut->lut_tgd;
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val > 3600)
+		return -ERANGE;
+
+	tgd->tgd_grant_rate_window = val;
+
+	return count;
+}
+EXPORT_SYMBOL(grant_rate_window_store);
@@ -188,6 +188,7 @@ EXPORT_SYMBOL(tgt_validate_obdo);
 static int tgt_io_data_unpack(struct tgt_session_info *tsi, struct ost_id *oi)
 {
 	unsigned		 max_brw;
+	unsigned int		 md_bits;
 	struct niobuf_remote	*rnb;
 	struct obd_ioobj	*ioo;
 	int			 obj_count;
@@ -210,6 +211,32 @@ static int tgt_io_data_unpack(struct tgt_session_info *tsi, struct ost_id *oi)
 		       POSTID(oi), -EPROTO);
 		RETURN(-EPROTO);
 	}
+
+	md_bits = ioobj_md_bits_get(ioo);
+	if (unlikely(md_bits != 0 && (md_bits <= LNET_MTU_BITS ||
+				      md_bits > LNET_MTU_LARGE_BITS))) {
+		CERROR("%s: client %s sent bad ioobj md bits %u for "DOSTID
+		       ": rc = %d\n", tgt_name(tsi->tsi_tgt),
+		       obd_export_nid2str(tsi->tsi_exp), md_bits,
+		       POSTID(oi), -EPROTO);
+		RETURN(-EPROTO);
+	}
+	/* The client may only use large bulk MDs if negotiated at connect,
+	 * and the path to it may carry smaller messages since then, e.g. a
+	 * router or peer NI with a smaller MTU is used now. Have the client
+	 * rebuild the request, it falls back to LNET_MTU sized MDs on -EAGAIN,
+	 * see osc_brw_redo_request().
+	 */
+	if (unlikely(md_bits != 0 &&
+		     (!exp_connect_large_bulk(tsi->tsi_exp) ||
+		      LNetPeerMaxPayload(tgt_ses_req(tsi)->rq_peer.nid) <
+		      (1U << md_bits)))) {
+		CDEBUG(D_HA, "%s: client %s bulk MD size %u too large for "
+		       DOSTID": rc = %d\n", tgt_name(tsi->tsi_tgt),
+		       obd_export_nid2str(tsi->tsi_exp), 1U << md_bits,
+		       POSTID(oi), -EAGAIN);
+		RETURN(-EAGAIN);
+	}
 	ioo->ioo_oid = *oi;
 
 	obj_count = req_capsule_get_size(tsi->tsi_pill, &RMF_OBD_IOOBJ,
@@ -1302,13 +1329,49 @@ EXPORT_SYMBOL(tgt_sync);
  * Unified target DLM handlers.
  */
 
+/**
+ * Check whether the sync upon cancel of a cross-MDT lock can be skipped.
+ *
+ * The global rename lock protects no data on this target. For other locks,
+ * the updates made under the lock by the MDT holding it came through its
+ * export here, and if all transactions of that export are committed, the
+ * updates are committed, and so are their update llog records on this
+ * target, from which recovery of the other MDTs can redo them.
+ *
+ * \param tgt	target
+ * \param lock	server side cross-MDT IBITS lock
+ *
+ * \retval	true if the sync can be skipped
+ * \retval	false if the sync is needed
+ */
+static bool tgt_lock_cancel_nosync(struct lu_target *tgt,
+				   struct ldlm_lock *lock)
+{
+	/* LUSTRE_BFL_FID, fid module isn't available to target code */
+	const struct lu_fid bfl_fid = { .f_seq = FID_SEQ_SPECIAL,
+					.f_oid = FID_OID_SPECIAL_BFL };
+	struct obd_export *exp = lock->l_export;
+	bool committed;
+
+	if (fid_res_name_eq(&bfl_fid, &lock->l_resource->lr_name))
+		return true;
+
+	spin_lock(&tgt->lut_translock);
+	committed = exp->exp_target_data.ted_last_transno <=
+		    tgt->lut_obd->obd_last_committed;
+	spin_unlock(&tgt->lut_translock);
+
+	return committed;
+}
+
 /**
  * Unified target BAST
  *
  * Ensure data and metadata are synced to disk when lock is canceled if Sync on
  * Cancel (SOC) is enabled. If it's extent lock, normally sync obj is enough,
  * but if it's cross-MDT lock, because remote object version is not set, a
- * filesystem sync is needed.
+ * filesystem sync is needed, unless the updates under it are committed
+ * already, see tgt_lock_cancel_nosync().
  *
  * \param lock server side lock
  * \param desc lock desc
@@ -1346,6 +1409,13 @@ static int tgt_blocking_ast(struct ldlm_lock *lock, struct ldlm_lock_desc *desc,
 		__u64 start = 0;
 		__u64 end = OBD_OBJECT_EOF;
 
+		if (lock->l_resource->lr_type == LDLM_IBITS &&
+		    tgt_lock_cancel_nosync(tgt, lock)) {
+			LDLM_DEBUG(lock, "updates committed, skip sync");
+			atomic_inc(&tgt->lut_slc_skip_count);
+			GOTO(err, rc = 0);
+		}
+
 		rc = lu_env_init(&env, LCT_DT_THREAD);
 		if (unlikely(rc != 0))
 			GOTO(err, rc);
@@ -2264,6 +2334,7 @@ int tgt_brw_read(struct tgt_session_info *tsi)
 				 npages_read;
 	struct tgt_thread_big_cache *tbc = req->rq_svc_thread->t_data;
 	const char *obd_name = exp->exp_obd->obd_name;
+	bool reclaim;
 
 	ENTRY;
 
@@ -2377,6 +2448,9 @@ int tgt_brw_read(struct tgt_session_info *tsi)
 					    &ptlrpc_bulk_kiov_nopin_ops);
 		if (desc == NULL)
 			GOTO(out_commitrw, rc = -ENOMEM);
+		if (ioobj_md_bits_get(ioo) != 0)
+			ptlrpc_bulk_set_md_size(desc,
+						1U << ioobj_md_bits_get(ioo));
 	}
 
 	nob = 0;
@@ -2409,6 +2483,10 @@ int tgt_brw_read(struct tgt_session_info *tsi)
 		}
 	}
 
+	/* the grant reclaim request of tgt_grant_prepare_read() */
+	reclaim = (repbody->oa.o_valid & OBD_MD_FLFLAGS) &&
+		  (repbody->oa.o_flags & OBD_FL_GRANT_RECLAIM);
+
 	if (body->oa.o_valid & OBD_MD_FLCKSUM) {
 		u32 flag = body->oa.o_valid & OBD_MD_FLFLAGS ?
 			   body->oa.o_flags : 0;
@@ -2442,6 +2520,13 @@ int tgt_brw_read(struct tgt_session_info *tsi)
 	}
 	if (body->oa.o_valid & OBD_MD_FLGRANT)
 		repbody->oa.o_valid |= OBD_MD_FLGRANT;
+	if (reclaim) {
+		if (!(repbody->oa.o_valid & OBD_MD_FLFLAGS)) {
+			repbody->oa.o_valid |= OBD_MD_FLFLAGS;
+			repbody->oa.o_flags = 0;
+		}
+		repbody->oa.o_flags |= OBD_FL_GRANT_RECLAIM;
+	}
 	/* We're finishing using body->oa as an input variable */
 
 	/* Check if client was evicted while we were doing i/o before touching
@@ -2776,6 +2861,9 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 					    &ptlrpc_bulk_kiov_nopin_ops);
 		if (desc == NULL)
 			GOTO(skip_transfer, rc = -ENOMEM);
+		if (ioobj_md_bits_get(ioo) != 0)
+			ptlrpc_bulk_set_md_size(desc,
+						1U << ioobj_md_bits_get(ioo));
 
 		/* NB Having prepped, we must commit... */
 		for (i = 0; i < npages; i++)
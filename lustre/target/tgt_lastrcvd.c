@@ -1411,6 +1411,8 @@ static int tgt_last_rcvd_update(const struct lu_env *env, struct lu_target *tgt,
 		if (tti->tti_transno > tgt->lut_last_transno)
 			tgt->lut_last_transno = tti->tti_transno;
 	}
+	if (th->th_result == 0 && tti->tti_transno > ted->ted_last_transno)
+		ted->ted_last_transno = tti->tti_transno;
 	spin_unlock(&tgt->lut_translock);
 
 	/** VBR: set new versions */
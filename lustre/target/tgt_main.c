@@ -126,6 +126,50 @@ ssize_t sync_lock_cancel_store(struct kobject *kobj, struct attribute *attr,
 EXPORT_SYMBOL(sync_lock_cancel_store);
 LUSTRE_RW_ATTR(sync_lock_cancel);
 
+/**
+ * Show the number of syncs skipped upon lock cancel, because the updates
+ * under the lock were committed already, see tgt_blocking_ast().
+ *
+ * \param[in] kobj	kobject
+ * \param[in] attr	attribute to show
+ * \param[in] buf	buffer for data
+ *
+ * \retval		0 and buffer filled with data on success
+ * \retval		negative value on error
+ */
+static ssize_t sync_lock_cancel_skip_count_show(struct kobject *kobj,
+						struct attribute *attr,
+						char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct lu_target *tgt = obd->u.obt.obt_lut;
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n",
+			 atomic_read(&tgt->lut_slc_skip_count));
+}
+
+static ssize_t sync_lock_cancel_skip_count_store(struct kobject *kobj,
+						 struct attribute *attr,
+						 const char *buffer,
+						 size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct lu_target *tgt = obd->u.obt.obt_lut;
+	int val;
+	int rc;
+
+	rc = kstrtoint(buffer, 10, &val);
+	if (rc)
+		return rc;
+
+	atomic_set(&tgt->lut_slc_skip_count, val);
+
+	return count;
+}
+LUSTRE_RW_ATTR(sync_lock_cancel_skip_count);
+
 /**
  * Show maximum number of Filter Modification Data (FMD) maintained.
  *
@@ -247,6 +291,7 @@ static struct lustre_attr tgt_fmd_seconds_compat = __ATTR(client_cache_seconds,
 
 static const struct attribute *tgt_attrs[] = {
 	&lustre_attr_sync_lock_cancel.attr,
+	&lustre_attr_sync_lock_cancel_skip_count.attr,
 	&lustre_attr_tgt_fmd_count.attr,
 	&lustre_attr_tgt_fmd_seconds.attr,
 	&tgt_fmd_count_compat.attr,
@@ -489,6 +534,7 @@ int tgt_init(const struct lu_env *env, struct lu_target *lut,
 	lut->lut_last_rcvd = NULL;
 	lut->lut_client_bitmap = NULL;
 	atomic_set(&lut->lut_num_clients, 0);
+	atomic_set(&lut->lut_bucket_unaware_clients, 0);
 	atomic_set(&lut->lut_client_generation, 0);
 	lut->lut_reply_data = NULL;
 	lut->lut_reply_bitmap = NULL;
@@ -506,6 +552,7 @@ int tgt_init(const struct lu_env *env, struct lu_target *lut,
 
 	spin_lock_init(&lut->lut_flags_lock);
 	lut->lut_sync_lock_cancel = SYNC_LOCK_CANCEL_NEVER;
+	atomic_set(&lut->lut_slc_skip_count, 0);
 	lut->lut_cksum_t10pi_enforce = 0;
 	lut->lut_cksum_types_supported =
 		obd_cksum_types_supported_server(obd->obd_name);
@@ -533,6 +580,7 @@ int tgt_init(const struct lu_env *env, struct lu_target *lut,
 	tgd->tgd_tot_granted = 0;
 	tgd->tgd_tot_pending = 0;
 	tgd->tgd_grant_compat_disable = 0;
+	tgd->tgd_grant_rate_window = TGT_GRANT_RATE_WINDOW;
 
 	/* populate cached statfs data */
 	osfs = &tgt_th_info(env)->tti_u.osfs;
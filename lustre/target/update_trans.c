@@ -759,6 +759,74 @@ static int prepare_multiple_node_trans(const struct lu_env *env,
 	RETURN(rc);
 }
 
+/**
+ * Check whether we need write updates record
+ *
+ * Check if the updates for the top_thandle needs to be writen
+ * to all targets. Only if the transaction succeeds and the updates
+ * number > 2, it will write the updates,
+ *
+ * \params [in] top_th	top thandle.
+ *
+ * \retval		true if it needs to write updates
+ * \retval		false if it does not need to write updates
+ **/
+static bool top_check_write_updates(struct top_thandle *top_th)
+{
+	struct top_multiple_thandle	*tmt;
+	struct thandle_update_records	*tur;
+
+	/* Do not write updates to records if the transaction fails */
+	if (top_th->tt_super.th_result != 0)
+		return false;
+
+	tmt = top_th->tt_multiple_thandle;
+	if (tmt == NULL)
+		return false;
+
+	tur = tmt->tmt_update_records;
+	if (tur == NULL)
+		return false;
+
+	/* Hmm, false update records, since the cross-MDT operation
+	 * should includes both local and remote updates, so the
+	 * updates count should >= 2 */
+	if (tur->tur_update_records == NULL ||
+	    tur->tur_update_records->lur_update_rec.ur_update_count <= 1)
+		return false;
+
+	return true;
+}
+
+/**
+ * Check whether the sub transactions on other targets can commit async
+ *
+ * The updates of a distributed transaction are written to the update llog
+ * on the master target within the master sub transaction, and the recovery
+ * of the other targets replays them from there, so only the master sub
+ * transaction has to be committed before replying when the top transaction
+ * is sync, the other sub transactions are committed with their journal.
+ *
+ * \params [in] top_th	top thandle.
+ *
+ * \retval		true if only the master sub transaction needs sync
+ * \retval		false if all sub transactions need sync
+ **/
+static bool top_check_async_commit(struct top_thandle *top_th)
+{
+	struct top_multiple_thandle *tmt = top_th->tt_multiple_thandle;
+	struct target_distribute_txn_data *tdtd;
+
+	if (!top_th->tt_super.th_sync || tmt == NULL)
+		return false;
+
+	tdtd = dt2lu_dev(tmt->tmt_master_sub_dt)->ld_site->ls_tgt->lut_tdtd;
+	if (tdtd == NULL || !tdtd->tdtd_async_commit)
+		return false;
+
+	return top_check_write_updates(top_th);
+}
+
 /**
  * start the top transaction.
  *
@@ -778,6 +846,7 @@ int top_trans_start(const struct lu_env *env, struct dt_device *master_dev,
 						       tt_super);
 	struct sub_thandle		*st;
 	struct top_multiple_thandle	*tmt = top_th->tt_multiple_thandle;
+	bool				async_commit;
 	int				rc = 0;
 	ENTRY;
 
@@ -796,10 +865,12 @@ int top_trans_start(const struct lu_env *env, struct dt_device *master_dev,
 	if (rc < 0)
 		RETURN(rc);
 
+	async_commit = top_check_async_commit(top_th);
 	list_for_each_entry(st, &tmt->tmt_sub_thandle_list, st_sub_list) {
 		if (st->st_sub_th == NULL)
 			continue;
-		if (th->th_sync)
+		if (th->th_sync &&
+		    (!async_commit || st->st_dt == tmt->tmt_master_sub_dt))
 			st->st_sub_th->th_sync = th->th_sync;
 		if (th->th_local)
 			st->st_sub_th->th_local = th->th_local;
@@ -817,44 +888,6 @@ out:
 }
 EXPORT_SYMBOL(top_trans_start);
 
-/**
- * Check whether we need write updates record
- *
- * Check if the updates for the top_thandle needs to be writen
- * to all targets. Only if the transaction succeeds and the updates
- * number > 2, it will write the updates,
- *
- * \params [in] top_th	top thandle.
- *
- * \retval		true if it needs to write updates
- * \retval		false if it does not need to write updates
- **/
-static bool top_check_write_updates(struct top_thandle *top_th)
-{
-	struct top_multiple_thandle	*tmt;
-	struct thandle_update_records	*tur;
-
-	/* Do not write updates to records if the transaction fails */
-	if (top_th->tt_super.th_result != 0)
-		return false;
-
-	tmt = top_th->tt_multiple_thandle;
-	if (tmt == NULL)
-		return false;
-
-	tur = tmt->tmt_update_records;
-	if (tur == NULL)
-		return false;
-
-	/* Hmm, false update records, since the cross-MDT operation
-	 * should includes both local and remote updates, so the
-	 * updates count should >= 2 */
-	if (tur->tur_update_records == NULL ||
-	    tur->tur_update_records->lur_update_rec.ur_update_count <= 1)
-		return false;
-
-	return true;
-}
 
 /**
  * Check if top transaction is stopped
@@ -928,6 +961,7 @@ int top_trans_stop(const struct lu_env *env, struct dt_device *master_dev,
 	struct top_multiple_thandle	*tmt;
 	struct thandle_update_records	*tur;
 	bool				write_updates = false;
+	bool				async_commit;
 	int			rc = 0;
 	ENTRY;
 
@@ -953,6 +987,7 @@ int top_trans_stop(const struct lu_env *env, struct dt_device *master_dev,
 	/* get the master sub thandle */
 	master_st = lookup_sub_thandle(tmt, tmt->tmt_master_sub_dt);
 	write_updates = top_check_write_updates(top_th);
+	async_commit = top_check_async_commit(top_th);
 
 	/* Step 1: write the updates log on Master MDT */
 	if (master_st != NULL && master_st->st_sub_th != NULL &&
@@ -1072,7 +1107,9 @@ stop_other_trans:
 		if (st == master_st || st->st_sub_th == NULL)
 			continue;
 
-		if (th->th_sync)
+		/* recovery of this target will replay the updates from the
+		 * update llog committed on the master */
+		if (th->th_sync && !async_commit)
 			st->st_sub_th->th_sync = th->th_sync;
 		if (th->th_local)
 			st->st_sub_th->th_local = th->th_local;
@@ -1662,6 +1699,10 @@ int distribute_txn_init(const struct lu_env *env,
 	spin_lock_init(&tdtd->tdtd_replay_list_lock);
 	tdtd->tdtd_replay_handler = distribute_txn_replay_handle;
 	tdtd->tdtd_replay_ready = 0;
+	/* off until sync-on-lock-cancel of striped mkdir and cross-MDT
+	 * rename, which commits every involved MDT, is handled the same way
+	 */
+	tdtd->tdtd_async_commit = 0;
 
 	tdtd->tdtd_batchid = lut->lut_last_transno + 1;
 
@@ -36,6 +36,8 @@ lst_TESTS=${lst_TESTS:-"write read ping"}
 # "full" -> LST_BRW_CHECK_FULL
 # "simple" -> LST_BRW_CHECK_SIMPLE
 lst_CHECK=${lst_CHECK:-"full"}
+# extra options of "lst stat", e.g. --lat for latency percentiles
+lst_STAT=${lst_STAT:-""}
 
 lst_FROM=${lst_FROM:-"cs"}
 
@@ -138,6 +140,8 @@ test_smoke_sub () {
 							" $check size=$s";;
 						ping)
 							echo -n $t;;
+						rr)
+							echo -n "rr req=$s rep=$s";;
 						*) error Unknonwn LST test;;
 					esac
 					echo
@@ -148,7 +152,7 @@ test_smoke_sub () {
 
 	echo $LST run b
 	echo sleep 1
-	echo "$LST stat --delay 10 --timeout 10 c s &"
+	echo "$LST stat $lst_STAT --delay 10 --timeout 10 c s &"
 	echo 'pid=$!'
 	echo 'trap "cleanup $pid" INT TERM'
 	echo sleep $smoke_DURATION
@@ -202,6 +206,82 @@ test_smoke () {
 }
 run_test smoke "lst regression test"
 
+test_stripe () {
+	[[ "$NETTYPE" =~ ^tcp ]] || skip "bulk striping is socklnd only"
+
+	local param=/sys/module/ksocklnd/parameters/stripe_min
+	local nodes=$(comma_list $(all_nodes))
+
+	do_nodes $nodes "[[ -f $param ]]" ||
+		skip "ksocklnd has no stripe_min parameter"
+
+	# 1M brw bulk is split over the bulk connections to each peer
+	# and verified with check=full
+	do_nodes $nodes "echo 65536 > $param"
+	stack_trap "do_nodes $nodes 'echo 0 > $param'" EXIT
+
+	# striping needs several bulk connections per peer.  The connection
+	# count is fixed when a peer is added, so drop the socklnd peers to
+	# reconnect them with the new conns_per_peer
+	do_nodes $nodes "$LNETCTL net set --all --conns-per-peer 4" ||
+		error "failed to set conns-per-peer"
+	stack_trap "do_nodes $nodes '$LNETCTL net set --all \
+		--conns-per-peer -1; $LCTL --net $NETTYPE del_peer'" EXIT
+	do_nodes $nodes "$LCTL --net $NETTYPE del_peer"
+
+	lst_SIZES="1M" lst_TESTS="write read" test_smoke
+
+	# "stripe tx/rx" of each connection counts the stripes queued on
+	# and received from it
+	local stripes=($(do_nodes $nodes "$LCTL --net $NETTYPE conn_list" |
+		awk '{ for (i = 1; i < NF; i++) if ($i == "stripe") {
+			split($(i + 1), s, "/"); tx += s[1]; rx += s[2] } }
+		END { print tx + 0, rx + 0 }'))
+
+	echo "stripes sent ${stripes[0]} received ${stripes[1]}"
+	(( ${stripes[0]} > 0 )) || error "no bulk stripes sent"
+	(( ${stripes[1]} > 0 )) || error "no bulk stripes received"
+}
+run_test stripe "lst with bulk striped across socklnd connections"
+
+test_msgrate () {
+	local param=/sys/module/lnet/parameters/lnet_obj_cache_size
+	local nodes=$(comma_list $(all_nodes))
+	local size
+	local rate
+	local s
+
+	do_nodes $nodes "[[ -f $param ]]" ||
+		skip "lnet has no lnet_obj_cache_size parameter"
+
+	size=$(cat $param)
+	stack_trap "do_nodes $nodes 'echo $size > $param'" EXIT
+
+	# small message rate with msg/MD recycling disabled, then enabled
+	for s in 0 $size; do
+		do_nodes $nodes "echo $s > $param"
+		lst_TESTS="ping" lst_CONCR="8" test_smoke
+		rate=$(awk '/^\[R\] Avg: .* RPC\/s/ { sum += $3; n++ }
+			    END { if (n) print int(sum / n); else print 0 }' \
+			$TMP/$tfile.log)
+		echo "lnet_obj_cache_size=$s: $rate RPC/s"
+	done
+}
+run_test msgrate "lst ping rate with and without msg/MD recycling"
+
+test_rr () {
+	$LST help stat 2>&1 | grep -q -- --lat ||
+		skip "lst has no latency histogram support"
+
+	# small request-reply RPCs, padded to the given sizes on the wire
+	lst_TESTS="rr" lst_SIZES="0 1k 4k" lst_CONCR="1 8" lst_STAT="--lat" \
+		test_smoke
+
+	grep "^RPCs: .* p99: " $TMP/$tfile.log ||
+		error "no latency percentiles reported"
+}
+run_test rr "lst request-reply test with latency percentiles"
+
 complete $SECONDS
 _restore_mount
 check_and_cleanup_lustre
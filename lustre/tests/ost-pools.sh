@@ -1802,6 +1802,69 @@ test_31() {
 }
 run_test 31 "OST pool spilling chained"
 
+test_32() {
+	local pool1=${TESTNAME}-1
+	local pool2=${TESTNAME}-2
+	local prefix="lod.$FSNAME-MDT0000-mdtlov.pool.$pool1"
+	local mdt=mdt.$FSNAME-MDT0000
+	local file=$DIR/$tdir/$tfile
+	local fid
+	local i
+
+	(( $OSTCOUNT >= 2 )) || skip "needs >= 2 OSTs"
+	do_facet mds1 $LCTL get_param -n $mdt.pool_tier_enable &>/dev/null ||
+		skip "MDS doesn't support pool tiering"
+
+	mkdir_on_mdt0 $DIR/$tdir
+	stack_trap "rm -rf $DIR/$tdir"
+
+	pool_add $pool1 || error "Pool creation failed"
+	pool_add_targets $pool1 0 0 || error "pool_add_targets failed"
+	pool_add $pool2 || error "Pool creation failed"
+	pool_add_targets $pool2 1 1 || error "pool_add_targets failed"
+
+	# cold files of $pool1 go to $pool2, hot ones of $pool2 come back
+	do_facet mds1 $LCTL set_param $prefix.tier_target=$pool2 \
+		$prefix.tier_heat=1
+	[[ $(do_facet mds1 $LCTL get_param -n $prefix.tier_target) == \
+	   "$pool2" ]] || error "tier target wasn't set"
+	do_facet mds1 $LCTL set_param $prefix.tier_target=$pool1 &&
+		error "tier target of a pool must not be the pool itself"
+	do_facet mds1 $LCTL set_param $mdt.pool_tier_enable=1
+	stack_trap "do_facet mds1 $LCTL set_param $mdt.pool_tier_enable=0"
+
+	$LFS setstripe -p $pool2 -c 1 $file || error "setstripe failed"
+	dd if=/dev/zero of=$file bs=4k count=1 || error "write $file failed"
+	fid=$($LFS path2fid $file | tr -d '[]')
+
+	for ((i = 0; i < 10; i++)); do
+		cat $file > /dev/null || error "read $file failed"
+	done
+
+	do_facet mds1 $LCTL get_param -n $mdt.dom_tier_queue
+	do_facet mds1 $LCTL get_param -n $mdt.dom_tier_queue | grep "$fid" |
+		grep "pool_promote" | grep -q "pool: $pool1" ||
+		error "$fid is not queued for promotion to $pool1"
+
+	# the queue is on the MDS, hand it over to the mover on the client
+	do_facet mds1 $LCTL get_param -n $mdt.dom_tier_queue > $TMP/$tfile.queue
+	stack_trap "rm -f $TMP/$tfile.queue"
+	$LFS_TIER_MIGRATE -Q $TMP/$tfile.queue $MOUNT ||
+		error "lfs_tier_migrate failed"
+	[[ $($LFS getstripe -p $file) == "$pool1" ]] ||
+		error "$file was not moved to $pool1"
+	[[ $($LFS getstripe -c $file) == 1 ]] ||
+		error "$file stripe count changed"
+	cmp -n 4096 /dev/zero $file || error "$file data changed"
+
+	# the layout swap drops the file from the queue
+	do_facet mds1 $LCTL get_param -n $mdt.dom_tier_queue |
+		grep -q "$fid" && error "$fid is still queued"
+
+	return 0
+}
+run_test 32 "OST pool tiering moves hot files to the faster pool"
+
 cd $ORIG_PWD
 
 complete $SECONDS
@@ -4020,6 +4020,54 @@ test_110g() {
 }
 run_test 110g "DNE: create striped dir, uncommit on MDT1, fail client/MDT1/MDT2"
 
+test_110h() {
+	[ $MDSCOUNT -lt 2 ] && skip "needs >= 2 MDTs" && return 0
+	[[ "$MDS1_VERSION" -ge $(version_code 2.14.57) ]] ||
+		skip "Need MDS version at least 2.14.57"
+
+	([ $FAILURE_MODE == "HARD" ] &&
+		[ "$(facet_host mds1)" == "$(facet_host mds2)" ]) &&
+		skip "MDTs needs to be on diff hosts for HARD fail mode" &&
+		return 0
+
+	local async=$(do_facet mds1 $LCTL get_param -n \
+		      mdt.$FSNAME-MDT0000.dne_async_commit)
+	local sync_perm=$(do_facet mds1 $LCTL get_param -n \
+			  mdd.$FSNAME-MDT0000.sync_permission)
+	local fid
+	local mode
+
+	do_facet mds1 $LCTL set_param mdt.$FSNAME-MDT0000.dne_async_commit=1 \
+		mdd.$FSNAME-MDT0000.sync_permission=1
+	stack_trap "do_facet mds1 $LCTL set_param \
+		    mdt.$FSNAME-MDT0000.dne_async_commit=$async \
+		    mdd.$FSNAME-MDT0000.sync_permission=$sync_perm"
+
+	mkdir -p $DIR/$tdir
+	$LFS mkdir -i0 -c$MDSCOUNT $DIR/$tdir/striped_dir
+	sync
+	replay_barrier mds2
+	# sync on MDT1 only, the stripe update on MDT2 is lost
+	chmod 0700 $DIR/$tdir/striped_dir || error "chmod failed"
+	umount $MOUNT
+	fail mds2
+	zconf_mount $(hostname) $MOUNT
+	client_up || return 1
+
+	for fid in $($LFS getdirstripe $DIR/$tdir/striped_dir |
+		     awk '/\[0x/ { print $2 }'); do
+		mode=$(stat -c %a $MOUNT/.lustre/fid/$fid) ||
+			error "stat stripe $fid failed"
+		[ "$mode" == "700" ] ||
+			error "stripe $fid mode $mode not replayed"
+	done
+
+	rm -rf $DIR/$tdir || error "rmdir failed"
+
+	return 0
+}
+run_test 110h "DNE: sync setattr striped dir, fail MDT2, replay from update log"
+
 test_111a() {
 	[ $MDSCOUNT -lt 2 ] && skip "needs >= 2 MDTs" && return 0
 	[[ "$MDS1_VERSION" -ge $(version_code 2.7.56) ]] ||
@@ -2385,6 +2385,644 @@ test_230() {
 }
 run_test 230 "Test setting conns-per-peer"
 
+# print the sum of the "zcmsg sent/done" counters of the tcp connections
+zc_msg_counts() {
+	printf 'network tcp\nconn_list\n' | $LCTL |
+		awk '{ for (i = 1; i < NF; i++) if ($i == "zcmsg") {
+			split($(i + 1), c, "/"); sent += c[1]; done += c[2] } }
+		END { print sent + 0, done + 0 }'
+}
+
+test_231() {
+	local param=/sys/module/ksocklnd/parameters/tx_zerocopy
+	local rnodes=$(remote_nodes_list)
+	local log=$TMP/$tfile.log
+	local rloaded=false
+	local my_nid
+	local rnode
+	local rnid
+	local zc
+	local i
+
+	[[ $NETTYPE == tcp* ]] || skip "Need tcp NETTYPE"
+	[[ -z $rnodes ]] && skip "Need at least 1 remote node"
+	[[ -n $LST ]] || skip "Need lst"
+
+	cleanup_lnet || error "Failed to cleanup before test execution"
+
+	# connections pick the mode up when they are created
+	MODOPTS_KSOCKLND="tx_zerocopy=1" load_modules ||
+		error "Failed to load modules"
+
+	[[ -f $param ]] || skip "ksocklnd has no tx_zerocopy parameter"
+	(( $(cat $param) == 1 )) || skip "MSG_ZEROCOPY is not supported"
+
+	my_nid=$($LCTL list_nids | head -n 1)
+	[[ -z $my_nid ]] &&
+		error "Failed to get primary NID for local host $HOSTNAME"
+
+	rnode=$(awk '{print $1}' <<<$rnodes)
+	rnid=$(do_node $rnode $LCTL list_nids | head -n 1)
+	if [[ -z $rnid ]]; then
+		do_rpc_nodes $rnode load_modules_local
+		rloaded=true
+		rnid=$(do_node $rnode $LCTL list_nids | head -n 1)
+	fi
+	[[ -z $rnid ]] && error "Failed to get primary NID for $rnode"
+
+	lst_setup
+	do_rpc_nodes $rnode lst_setup
+
+	# bulk writes from this node send their payload with MSG_ZEROCOPY
+	export LST_SESSION=$$
+	$LST new_session --timeo 100 $tfile || error "lst new_session failed"
+	$LST add_group c $my_nid
+	$LST add_group s $rnid
+	$LST add_batch b
+	$LST add_test --batch b --loop 100 --concurrency 8 \
+		--distribute 1:1 --from c --to s brw write check=full \
+		size=1M || error "lst add_test failed"
+	$LST run b || error "lst run failed"
+	sleep 10
+	lst_end_session --verbose | tee $log
+	grep ^Total $log
+	awk '/^Total.*nodes/ {print $2}' $log | grep -vq '^0$' &&
+		error "lst reported errors with MSG_ZEROCOPY"
+
+	# each connection reports zero-copy/copied tx and rx bytes, stripes
+	# and MSG_ZEROCOPY txs sent and completed:
+	# 12345-1.1.1.1@tcp O[0]host01->host02:988 2626560/1061296 nonagle zc 104857600/0 copy 224 rx 0 stripe 0/0 zcmsg 100/100
+	printf 'network tcp\nconn_list\n' | $LCTL | tee $log
+	grep "$rnid" $log |
+		grep -q "zc [0-9]*/[0-9]* copy [0-9]* rx [0-9]* stripe [0-9]*/[0-9]* zcmsg [0-9]*/[0-9]*$" ||
+		error "conn_list does not report zero-copy stats"
+
+	# the stack releases the pages of the last txs asynchronously
+	for ((i = 0; i < 10; i++)); do
+		zc=( $(zc_msg_counts) )
+		(( ${zc[0]} == ${zc[1]} )) && break
+		sleep 1
+	done
+	echo "MSG_ZEROCOPY txs sent ${zc[0]} completed ${zc[1]}"
+	(( ${zc[0]} > 0 )) || error "no bulk was sent with MSG_ZEROCOPY"
+	(( ${zc[0]} == ${zc[1]} )) ||
+		error "${zc[0]} MSG_ZEROCOPY txs but ${zc[1]} completions"
+
+	rm -f $log
+	lst_cleanup
+	do_rpc_nodes $rnode lst_cleanup
+	unload_modules || error "Failed to unload modules"
+	if $rloaded; then
+		do_rpc_nodes $rnode unload_modules_local ||
+			error "Failed to unload modules on $rnode"
+	fi
+
+	return 0
+}
+run_test 231 "socklnd MSG_ZEROCOPY transmit and per-connection stats"
+
+# sends over each local NI while pinging $1 $2 times
+rtt_ping_sends() {
+	local rnid=$1
+	local count=$2
+	local pre0 pre1
+	local i
+
+	pre0=$(get_ni_stat ${LNIDS[0]} send_count)
+	pre1=$(get_ni_stat ${LNIDS[1]} send_count)
+	for ((i = 0; i < count; i++)); do
+		$LNETCTL ping $rnid > /dev/null ||
+			error "failed to ping $rnid"
+	done
+	echo $(($(get_ni_stat ${LNIDS[0]} send_count) - pre0)) \
+	     $(($(get_ni_stat ${LNIDS[1]} send_count) - pre1))
+}
+
+test_232() {
+	local param=/sys/module/lnet/parameters/lnet_rtt_threshold
+	local sends
+
+	setup_health_test true || return $?
+	stack_trap "cleanup_health_test" EXIT
+
+	[[ -f $param ]] || skip "lnet has no lnet_rtt_threshold parameter"
+	stack_trap "echo $(cat $param) > $param" EXIT
+
+	do_lnetctl ping ${RNIDS[0]} || error "failed to ping ${RNIDS[0]}"
+
+	# estimates are reported in the health stats of local and peer NIs
+	$LNETCTL net show -v 2 | grep -q "rtt_us:" ||
+		error "net show does not report rtt_us"
+	$LNETCTL peer show -v 2 | grep -q "rtt_us:" ||
+		error "peer show does not report rtt_us"
+
+	# every send over the first local NI now takes a second longer
+	stack_trap "$LCTL net_delay_del -a" EXIT
+	$LCTL net_delay_add -s ${LNIDS[0]} -d "*@${LNIDS[0]##*@}" -r 1 -l 1 ||
+		error "failed to add delay rule"
+
+	# round-robin while latency is ignored
+	echo 0 > $param || error "failed to set lnet_rtt_threshold"
+	sends=( $(rtt_ping_sends ${RNIDS[0]} 10) )
+	echo "threshold 0: ${LNIDS[0]} ${sends[0]}, ${LNIDS[1]} ${sends[1]}"
+	(( sends[0] >= 3 )) ||
+		error "${LNIDS[0]} got ${sends[0]} of 10 sends without RTT"
+
+	# the slow NI has an estimate now, traffic moves off it
+	echo 50 > $param || error "failed to set lnet_rtt_threshold"
+	sends=( $(rtt_ping_sends ${RNIDS[0]} 20) )
+	echo "threshold 50: ${LNIDS[0]} ${sends[0]}, ${LNIDS[1]} ${sends[1]}"
+	(( sends[0] * 4 < sends[1] )) ||
+		error "${LNIDS[0]} got ${sends[0]} sends, ${LNIDS[1]} ${sends[1]}"
+}
+run_test 232 "Round trip time estimates for Multi-Rail selection"
+
+# print the sum of the "grow" and "shrink" counters of the router pools
+rtrpool_resizes() {
+	$LCTL get_param -n buffers |
+		awk 'NR > 1 { grow += $6; shrink += $7 }
+		     END { print grow + 0, shrink + 0 }'
+}
+
+test_233() {
+	local param=/sys/module/lnet/parameters/router_buffers_auto
+	local rnodes=$(remote_nodes_list)
+	local rloaded=""
+	local rnode1
+	local rnode2
+	local rnode
+	local rnid1
+	local rnid2
+	local gw
+	local gw1
+	local rif
+	local base
+	local resizes
+	local i
+
+	[[ $NETTYPE == tcp* ]] || skip "Need tcp NETTYPE"
+	(( $(wc -w <<<$rnodes) >= 2 )) || skip "Need at least 2 remote nodes"
+	[[ -n $LST ]] || skip "Need lst"
+
+	rnode1=$(awk '{print $1}' <<<$rnodes)
+	rnode2=$(awk '{print $2}' <<<$rnodes)
+
+	cleanup_lnet || error "Failed to cleanup before test execution"
+	# the remote nodes are reconfigured, reload them as they were after
+	for rnode in $rnode1 $rnode2; do
+		[[ -n $(do_node $rnode $LCTL list_nids 2>/dev/null) ]] &&
+			rloaded+="${rloaded:+,}$rnode"
+	done
+	do_rpc_nodes $rnode1,$rnode2 unload_modules_local
+
+	# this node routes between tcp, where $rnode1 is, and tcp1, where
+	# $rnode2 is.  Give $rnode1 enough router buffer credits, and enough
+	# send credits, to use up a whole large buffer pool
+	reinit_dlc || return $?
+	add_net "tcp1" "${INTERFACES[0]}" || return $?
+	do_lnetctl net add --net tcp --if ${INTERFACES[0]} \
+		--peer-buffer-credits 1024 || error "failed to add tcp"
+	gw=$($LCTL list_nids | grep "@tcp$")
+	gw1=$($LCTL list_nids | grep "@tcp1$")
+
+	[[ -f $param ]] || skip "lnet has no router_buffers_auto parameter"
+	echo 4 > $param || error "failed to set router_buffers_auto"
+	do_lnetctl set routing 1 || error "failed to enable routing"
+
+	do_rpc_nodes $rnode1,$rnode2 load_modules_local
+	rif=$(do_rpc_nodes --quiet $rnode1 lnet_if_list | awk '{print $1}')
+	do_node $rnode1 "$LNETCTL net del --net tcp; \
+		$LNETCTL net add --net tcp --if $rif --credits 1024 \
+		--peer-credits 512 && \
+		$LNETCTL route add --net tcp1 --gateway $gw" ||
+		error "failed to configure $rnode1"
+	rif=$(do_rpc_nodes --quiet $rnode2 lnet_if_list | awk '{print $1}')
+	do_node $rnode2 "$LNETCTL net del --net tcp; \
+		$LNETCTL net add --net tcp1 --if $rif && \
+		$LNETCTL route add --net tcp --gateway $gw1" ||
+		error "failed to configure $rnode2"
+	rnid1=$(do_node $rnode1 $LCTL list_nids | head -n 1)
+	rnid2=$(do_node $rnode2 $LCTL list_nids | head -n 1)
+	[[ -n $rnid1 && -n $rnid2 ]] || error "Failed to get remote NIDs"
+
+	lst_setup
+	do_rpc_nodes $rnode1,$rnode2 lst_setup
+
+	$LCTL get_param -n buffers | head -n 1 |
+		grep -Eq "blocked +grow +shrink$" ||
+		error "buffers does not report resize counters"
+	resizes=( $(rtrpool_resizes) )
+	base=( ${resizes[@]} )
+
+	# the bulk of a write is a 1M REPLY from $rnode1 to $rnode2.  While
+	# $rnode2 holds back each of them for a second the REPLYs pile up
+	# here, each holding a large router buffer
+	do_node $rnode2 "$LCTL net_delay_add -s '*@tcp' -d '*@tcp1' -r 1 \
+		-m REPLY -l 1" || error "failed to add delay rule on $rnode2"
+
+	export LST_SESSION=$$
+	$LST new_session --timeo 100 $tfile || error "lst new_session failed"
+	$LST add_group c $rnid1
+	$LST add_group s $rnid2
+	$LST add_batch b
+	$LST add_test --batch b --concurrency 512 --distribute 1:1 \
+		--from c --to s brw write size=1M ||
+		error "lst add_test failed"
+	$LST run b || error "lst run failed"
+
+	# the monitor thread grows a pool messages had to wait for
+	for ((i = 0; i < 30; i++)); do
+		sleep 1
+		resizes=( $(rtrpool_resizes) )
+		(( ${resizes[0]} > ${base[0]} )) && break
+	done
+	$LCTL get_param -n buffers
+
+	lst_end_session
+	do_node $rnode2 "$LCTL net_delay_del -a"
+	(( ${resizes[0]} > ${base[0]} )) ||
+		error "exhausted router buffer pools were not grown"
+
+	# and trims it back after it has been idle for a while
+	base=( ${resizes[@]} )
+	for ((i = 0; i < 60; i++)); do
+		sleep 1
+		resizes=( $(rtrpool_resizes) )
+		(( ${resizes[1]} > ${base[1]} )) && break
+	done
+	$LCTL get_param -n buffers
+	(( ${resizes[1]} > ${base[1]} )) ||
+		error "idle router buffer pools were not shrunk"
+
+	lst_cleanup
+	do_rpc_nodes $rnode1,$rnode2 lst_cleanup
+	do_lnetctl set routing 0
+	echo 0 > $param
+	unload_modules || error "Failed to unload modules"
+	do_rpc_nodes $rnode1,$rnode2 unload_modules_local ||
+		error "Failed to unload modules on $rnode1,$rnode2"
+	if [[ -n $rloaded ]]; then
+		do_rpc_nodes $rloaded load_modules_local ||
+			error "Failed to reload modules on $rloaded"
+	fi
+
+	return 0
+}
+run_test 233 "Automatic router buffer pool resizing"
+
+test_234() {
+	local param=/sys/module/lnet/parameters/lnet_coalesce_size
+	local rnodes=$(remote_nodes_list)
+	local log=$TMP/$tfile.log
+	local rloaded=false
+	local my_nid
+	local rnode
+	local rnid
+	local n
+
+	[[ $NETTYPE == tcp* ]] || skip "Need tcp NETTYPE"
+	[[ -z $rnodes ]] && skip "Need at least 1 remote node"
+	[[ -n $LST ]] || skip "Need lst"
+
+	cleanup_lnet || error "Failed to cleanup before test execution"
+
+	# with two peer credits most of the pings below wait on lpni_txq,
+	# which is where bundles are made from
+	MODOPTS_KSOCKLND="peer_credits=2" load_modules ||
+		error "Failed to load modules"
+
+	[[ -f $param ]] || skip "lnet has no lnet_coalesce_size parameter"
+
+	# coalescing is off unless asked for
+	(( $(cat $param) == 0 )) || error "coalescing enabled by default"
+	echo 1024 > $param || error "failed to set lnet_coalesce_size"
+
+	my_nid=$($LCTL list_nids | head -n 1)
+	[[ -z $my_nid ]] &&
+		error "Failed to get primary NID for local host $HOSTNAME"
+
+	rnode=$(awk '{print $1}' <<<$rnodes)
+	rnid=$(do_node $rnode $LCTL list_nids | head -n 1)
+	if [[ -z $rnid ]]; then
+		do_rpc_nodes $rnode load_modules_local
+		rloaded=true
+		rnid=$(do_node $rnode $LCTL list_nids | head -n 1)
+	fi
+	[[ -z $rnid ]] && error "Failed to get primary NID for $rnode"
+
+	lst_setup
+	do_rpc_nodes $rnode lst_setup
+
+	$LCTL set_param debug=+net
+	$LCTL clear
+	do_node $rnode "$LCTL set_param debug=+net; $LCTL clear"
+
+	export LST_SESSION=$$
+	$LST new_session --timeo 100 $tfile || error "lst new_session failed"
+	$LST add_group c $my_nid
+	$LST add_group s $rnid
+	$LST add_batch b
+	$LST add_test --batch b --loop 1000 --concurrency 64 \
+		--distribute 1:1 --from c --to s ping ||
+		error "lst add_test failed"
+	$LST run b || error "lst run failed"
+	sleep 10
+	lst_end_session --verbose | tee $log
+	grep ^Total $log
+	awk '/^Total.*nodes/ {print $2}' $log | grep -vq '^0$' &&
+		error "lst reported errors with coalescing enabled"
+
+	n=$($LCTL dk | grep -c "coalesced [0-9]* messages to $rnid")
+	echo "$n bundles sent to $rnid"
+	(( n > 0 )) || error "no bundle was sent to $rnid"
+
+	do_node $rnode "$LCTL dk" > $log
+	n=$(grep -c "split [0-9]* messages from $my_nid" $log)
+	echo "$n bundles received by $rnode"
+	(( n > 0 )) || error "no bundle was received by $rnode"
+	grep "bad bundle" $log && error "$rnode received bad bundles"
+
+	rm -f $log
+	echo 0 > $param
+	lst_cleanup
+	do_rpc_nodes $rnode lst_cleanup
+	unload_modules || error "Failed to unload modules"
+	if $rloaded; then
+		do_rpc_nodes $rnode unload_modules_local ||
+			error "Failed to unload modules on $rnode"
+	fi
+
+	return 0
+}
+run_test 234 "Coalescing of tiny messages to a peer NI"
+
+test_235() {
+	local rnodes=$(remote_nodes_list)
+	local rloaded=false
+	local param
+	local rnode
+	local rnid
+	local hits
+	local lnd
+	local i
+
+	case $NETTYPE in
+	tcp*)	lnd=ksocklnd;;
+	o2ib*)	lnd=ko2iblnd;;
+	*)	skip "busy polling is socklnd and o2iblnd only";;
+	esac
+	[[ -z $rnodes ]] && skip "Need at least 1 remote node"
+
+	cleanup_lnet || error "Failed to cleanup before test execution"
+	load_modules || error "Failed to load modules"
+
+	param=/sys/module/$lnd/parameters/busy_poll
+	[[ -f $param ]] || skip "$lnd has no busy_poll parameter"
+
+	# busy polling is off unless asked for
+	(( $(cat $param) == 0 )) || error "busy polling enabled by default"
+	echo 1000 > $param || error "failed to set busy_poll"
+
+	rnode=$(awk '{print $1}' <<<$rnodes)
+	rnid=$(do_node $rnode $LCTL list_nids | head -n 1)
+	if [[ -z $rnid ]]; then
+		do_rpc_nodes $rnode load_modules_local
+		rloaded=true
+		rnid=$(do_node $rnode $LCTL list_nids | head -n 1)
+	fi
+	[[ -z $rnid ]] && error "Failed to get primary NID for $rnode"
+
+	# a ping to ourselves would only go through the loopback NI
+	for i in {1..100}; do
+		$LNETCTL ping $rnid > /dev/null ||
+			error "failed to ping $rnid with busy polling"
+	done
+
+	if [[ $lnd == ko2iblnd ]]; then
+		# each connection reports the completions its CQ had when
+		# busy polled:
+		# 192.168.1.2@o2ib mtu 4096 poll 97 lkey 0
+		printf "network $NETTYPE\nconn_list\n" | $LCTL
+		hits=$(printf "network $NETTYPE\nconn_list\n" | $LCTL |
+		       awk '$4 == "poll" { hits += $5 } END { print hits + 0 }')
+		(( hits > 0 )) || error "busy polling found no completion"
+	fi
+
+	echo 0 > $param
+	unload_modules || error "Failed to unload modules"
+	if $rloaded; then
+		do_rpc_nodes $rnode unload_modules_local ||
+			error "Failed to unload modules on $rnode"
+	fi
+
+	return 0
+}
+run_test 235 "socklnd and o2iblnd scheduler busy polling"
+
+test_236() {
+	local param=/sys/module/lnet/parameters/lnet_large_mtu
+	local osc="osc.$FSNAME-OST0000-osc-[^M]*"
+	local log=$TMP/$tfile.log
+	local setup="Setup %d bulk get-source buffers: [0-9]* pages 4194304 bytes"
+	local lnid
+	local n
+
+	[[ $NETTYPE == tcp* ]] || skip "Need tcp NETTYPE"
+	[[ $(facet_active_host ost1) != $HOSTNAME ]] ||
+		skip "Need OST on a remote node"
+
+	cleanup_lnet || exit 1
+	load_lnet "lnet_large_mtu=1"
+	stack_trap "cleanup_lnet" EXIT
+
+	[[ -f $param ]] || skip "lnet has no lnet_large_mtu parameter"
+	(( $(cat $param) == 1 )) || error "lnet_large_mtu was not set"
+
+	do_lnetctl lnet configure || error "lnetctl lnet configure failed"
+	add_net "tcp" "${INTERFACES[0]}" || return $?
+
+	# pings carry the per-NI MTU to peers supporting large messages
+	lnid="$(lctl list_nids | head -n 1)"
+	do_lnetctl ping "$lnid" ||
+		error "failed to ping myself with large MTU enabled"
+
+	$LNETCTL peer show -v 2 --nid "$lnid" ||
+		error "failed to show peer $lnid"
+
+	cleanup_lnet || error "Failed to cleanup LNet"
+
+	# now move 4MiB bulks between a client and a remote OST
+	MODOPTS_LNET="lnet_large_mtu=1" setupall ||
+		error "Failed to setup Lustre with lnet_large_mtu=1"
+	stack_trap "cleanupall -f" EXIT
+
+	$LCTL get_param -n $osc.import | grep -q large_bulk ||
+		error "import did not negotiate large_bulk"
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	$LCTL set_param $osc.max_pages_per_rpc=4M ||
+		error "failed to set max_pages_per_rpc"
+	(( $($LCTL get_param -n $osc.max_pages_per_rpc) * PAGE_SIZE ==
+	   4194304 )) || skip "OST does not allow 4MiB RPCs"
+
+	$LCTL set_param debug=+net
+	$LCTL clear
+	dd if=/dev/zero of=$DIR/$tfile bs=4M count=4 oflag=direct ||
+		error "dd failed"
+	$LCTL dk > $log
+
+	# one MD per RPC instead of one per LNET_MTU
+	n=$(grep -c "$(printf "$setup" 1)" $log)
+	(( n == 4 )) || error "expected 4 single MD bulks, found $n"
+	! grep -q "$(printf "$setup" 4)" $log ||
+		error "4MiB bulk was split over LNET_MTU sized MDs"
+	rm -f $DIR/$tfile $log
+}
+run_test 236 "Large LNet messages"
+
+test_237() {
+	local param=/sys/module/ko2iblnd/parameters/use_srq
+	local rnodes=$(remote_nodes_list)
+	local rloaded=false
+	local my_nid
+	local rnode
+	local rnid
+	local pids
+	local i
+
+	[[ $NETTYPE == o2ib* ]] || skip "Need o2ib NETTYPE"
+	[[ -z $rnodes ]] && skip "Need at least 1 remote node"
+
+	cleanup_lnet || error "Failed to cleanup before test execution"
+
+	# a tiny queue so the pings below run it dry
+	MODOPTS_KO2IBLND="use_srq=1 srq_size=4 srq_shrink_interval=1" \
+		load_modules || error "Failed to load modules"
+
+	[[ -f $param ]] || skip "ko2iblnd has no use_srq parameter"
+	(( $(cat $param) == 1 )) || error "use_srq was not set"
+
+	$LCTL set_param debug=+net
+	$LCTL clear
+
+	my_nid=$($LCTL list_nids | head -n 1)
+	[[ -z $my_nid ]] &&
+		error "Failed to get primary NID for local host $HOSTNAME"
+
+	rnode=$(awk '{print $1}' <<<$rnodes)
+	rnid=$(do_node $rnode $LCTL list_nids | head -n 1)
+	if [[ -z $rnid ]]; then
+		do_rpc_nodes $rnode load_modules_local
+		rloaded=true
+		rnid=$(do_node $rnode $LCTL list_nids | head -n 1)
+	fi
+	[[ -z $rnid ]] && error "Failed to get primary NID for $rnode"
+
+	do_lnetctl ping $rnid || error "failed to ping $rnid"
+
+	# everything the peer sends lands in the shared queue, more at once
+	# than it holds, so some of it is only delivered on RNR retries
+	for i in {1..32}; do
+		do_node $rnode "$LNETCTL ping $my_nid" > /dev/null &
+		pids+=" $!"
+	done
+	for i in $pids; do
+		wait $i || error "$rnode failed to ping $my_nid"
+	done
+
+	$LCTL dk > $TMP/$tfile.log
+	grep "shared receive queue for CPT" $TMP/$tfile.log ||
+		error "no shared receive queue was set up"
+	grep "per-connection buffers" $TMP/$tfile.log &&
+		error "fell back to per-connection buffers"
+	rm -f $TMP/$tfile.log
+
+	unload_modules || error "Failed to unload modules"
+	if $rloaded; then
+		do_rpc_nodes $rnode unload_modules_local ||
+			error "Failed to unload modules on $rnode"
+	fi
+
+	return 0
+}
+run_test 237 "o2iblnd connections receiving into a shared receive queue"
+
+test_238() {
+	local param=/sys/module/ko2iblnd/parameters/use_local_dma_lkey
+	local rnodes=$(remote_nodes_list)
+	local log=$TMP/$tfile.log
+	local rloaded=false
+	local my_nid
+	local rnode
+	local rnid
+	local n
+
+	[[ $NETTYPE == o2ib* ]] || skip "Need o2ib NETTYPE"
+	[[ -z $rnodes ]] && skip "Need at least 1 remote node"
+	[[ -z $LST ]] && skip "lst not found LST=$LST"
+
+	cleanup_lnet || error "Failed to cleanup before test execution"
+	MODOPTS_KO2IBLND="use_local_dma_lkey=1" load_modules ||
+		error "Failed to load modules"
+
+	[[ -f $param ]] || skip "ko2iblnd has no use_local_dma_lkey parameter"
+	(( $(cat $param) == 1 )) || error "use_local_dma_lkey was not set"
+
+	my_nid=$($LCTL list_nids | head -n 1)
+	[[ -z $my_nid ]] &&
+		error "Failed to get primary NID for local host $HOSTNAME"
+
+	rnode=$(awk '{print $1}' <<<$rnodes)
+	rnid=$(do_node $rnode $LCTL list_nids | head -n 1)
+	if [[ -z $rnid ]]; then
+		do_rpc_nodes $rnode load_modules_local
+		rloaded=true
+		rnid=$(do_node $rnode $LCTL list_nids | head -n 1)
+	fi
+	[[ -z $rnid ]] && error "Failed to get primary NID for $rnode"
+
+	lst_setup
+	do_rpc_nodes $rnode lst_setup
+
+	# the server GETs the written pages, so this node is the RDMA
+	# source for writes and the sink for reads, both checked
+	export LST_SESSION=$$
+	$LST new_session --timeo 100 $tfile || error "lst new_session failed"
+	$LST add_group c $my_nid
+	$LST add_group s $rnid
+	$LST add_batch b
+	$LST add_test --batch b --loop 100 --concurrency 8 \
+		--distribute 1:1 --from c --to s brw write check=full size=1M ||
+		error "lst add_test brw write failed"
+	$LST add_test --batch b --loop 100 --concurrency 8 \
+		--distribute 1:1 --from c --to s brw read check=full size=1M ||
+		error "lst add_test brw read failed"
+	$LST run b || error "lst run failed"
+	sleep 10
+	lst_end_session --verbose | tee $log
+	grep ^Total $log
+	awk '/^Total.*nodes/ {print $2}' $log | grep -vq '^0$' &&
+		error "lst reported errors with the local DMA lkey"
+	rm -f $log
+
+	# 192.168.1.2@o2ib mtu 4096 poll 0 lkey 800
+	printf "network $NETTYPE\nconn_list\n" | $LCTL
+	n=$(printf "network $NETTYPE\nconn_list\n" | $LCTL |
+	    awk '$6 == "lkey" { n += $7 } END { print n + 0 }')
+	(( n > 0 )) || error "no RDMA was sent from the local DMA lkey"
+
+	lst_cleanup
+	do_rpc_nodes $rnode lst_cleanup
+	unload_modules || error "Failed to unload modules"
+	if $rloaded; then
+		do_rpc_nodes $rnode unload_modules_local ||
+			error "Failed to unload modules on $rnode"
+	fi
+
+	return 0
+}
+run_test 238 "o2iblnd RDMA sources from the local DMA lkey"
+
 ### Test that linux route is added for each ni
 test_250() {
 	reinit_dlc || return $?
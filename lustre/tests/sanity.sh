@@ -13945,6 +13945,110 @@ test_130g() {
 }
 run_test 130g "FIEMAP (overstripe file)"
 
+# write 32MB into each of $2 files in $1 in interleaved 1MB chunks
+write_130h_streams() {
+	local dir=$1
+	local nfiles=$2
+	local i j
+
+	rm -rf $dir
+	mkdir_on_mdt0 $dir || error "mkdir $dir failed"
+	$LFS setstripe -c 1 -i 0 $dir || error "setstripe failed"
+	for ((i = 0; i < 32; i++)); do
+		for ((j = 0; j < nfiles; j++)); do
+			dd if=/dev/zero of=$dir/f$j bs=1M count=1 seek=$i \
+				conv=notrunc oflag=sync 2>/dev/null ||
+				error "write f$j at ${i}M failed"
+		done
+	done
+	sync
+}
+
+# total number of extents of the files in $1
+extents_130h() {
+	local f
+	local n=0
+
+	for f in $1/*; do
+		n=$((n + $(filefrag $f | awk '{ print $(NF - 2) }')))
+	done
+	echo $n
+}
+
+# total 512-byte blocks used by the files in $1 on the OST
+blocks_130h() {
+	cancel_lru_locks osc
+	stat -c %b $1/* | awk '{ sum += $1 } END { print sum }'
+}
+
+test_130h() {
+	[ "$ost1_FSTYPE" == "ldiskfs" ] || skip "ldiskfs only test"
+	remote_ost_nodsh && skip "remote OST with nodsh"
+
+	local osd="osd-ldiskfs.$(facet_svc ost1)"
+	local max=$(do_facet ost1 $LCTL get_param -n \
+		    $osd.stream_prealloc_max_mb 2>/dev/null)
+	local nfiles=4
+	local size=$((nfiles * 32 * 1048576 / 512))
+	local base
+	local extents
+	local prealloc
+	local trim
+	local blocks
+	local j
+
+	[ -n "$max" ] || skip "no stream preallocation on OST"
+	stack_trap "do_facet ost1 $LCTL set_param \
+		    $osd.stream_prealloc_max_mb=$max"
+
+	# the interleaved streams without preallocation as reference
+	do_facet ost1 $LCTL set_param $osd.stream_prealloc_max_mb=0
+	write_130h_streams $DIR/$tdir $nfiles
+	base=$(extents_130h $DIR/$tdir)
+
+	do_facet ost1 $LCTL set_param $osd.stream_prealloc_max_mb=16 \
+		$osd.stats=clear
+	write_130h_streams $DIR/$tdir $nfiles
+
+	do_facet ost1 $LCTL get_param $osd.stats | grep -E "alloc|stream"
+	prealloc=$(do_facet ost1 $LCTL get_param -n $osd.stats |
+		   awk '/^stream_prealloc/ { print $2 }')
+	(( ${prealloc:-0} > 0 )) || error "no extent reserved for streams"
+
+	for ((j = 0; j < nfiles; j++)); do
+		(( $(stat -c %s $DIR/$tdir/f$j) == 32 * 1048576 )) ||
+			error "f$j has wrong size $(stat -c %s $DIR/$tdir/f$j)"
+	done
+
+	# a stream keeps at least 1/8 of its length reserved ahead
+	blocks=$(blocks_130h $DIR/$tdir)
+	echo "blocks used $blocks for $size written"
+	(( blocks > size )) || error "no blocks reserved beyond the size"
+
+	# evicting the objects from the OST cache gives the reservation back
+	do_facet ost1 "sync; echo 3 > /proc/sys/vm/drop_caches"
+	do_facet ost1 $LCTL get_param $osd.stats | grep -E "stream"
+	trim=$(do_facet ost1 $LCTL get_param -n $osd.stats |
+	       awk '/^stream_trim/ { print $2 }')
+	(( ${trim:-0} > 0 )) || error "reserved blocks were not trimmed"
+
+	blocks=$(blocks_130h $DIR/$tdir)
+	echo "blocks used $blocks for $size written after eviction"
+	(( blocks <= size + nfiles * 2048 )) ||
+		error "$((blocks - size)) reserved blocks were not freed"
+
+	extents=$(extents_130h $DIR/$tdir)
+	echo "$extents extents with preallocation, $base without"
+	(( extents <= base )) ||
+		error "preallocation made $extents extents, more than $base"
+
+	# truncate frees the reserved blocks too
+	$TRUNCATE $DIR/$tdir/f0 1048576 || error "truncate f0 failed"
+	(( $(stat -c %s $DIR/$tdir/f0) == 1048576 )) ||
+		error "f0 has wrong size after truncate"
+}
+run_test 130h "OST extent preallocation for interleaved write streams"
+
 # Test for writev/readv
 test_131a() {
 	rwv -f $DIR/$tfile -w -n 3 524288 1048576 1572864 ||
@@ -15671,6 +15775,83 @@ test_155h() {
 }
 run_test 155h "Verify big file correctness: read cache:off write_cache:off"
 
+test_155i() {
+	[ "$ost1_FSTYPE" == "ldiskfs" ] || skip "ldiskfs only test"
+	remote_ost_nodsh && skip "remote OST with nodsh"
+
+	local temp=$TMP/$tfile
+	local file=$DIR/$tfile
+	local osd="osd-ldiskfs.$(facet_svc ost1)"
+	local max=$(do_facet ost1 $LCTL get_param -n $osd.writelog_max_io_kb)
+	local ios
+
+	[ -n "$max" ] || skip "no write log on OST"
+	stack_trap "do_facet ost1 $LCTL set_param $osd.writelog_max_io_kb=$max"
+	stack_trap "rm -f $temp $file"
+
+	$LFS setstripe -c 1 -i 0 $file || error "setstripe $file failed"
+	dd if=/dev/urandom of=$temp bs=1M count=4 || error "dd $temp failed"
+	cp $temp $file || error "cp $temp $file failed"
+	sync
+
+	do_facet ost1 $LCTL set_param $osd.writelog_max_io_kb=64 \
+		$osd.writelog_stats=clear
+	# small overwrites go through the log
+	for off in 3 17 101 555 1000; do
+		dd if=/dev/urandom of=$temp bs=4k count=2 seek=$off \
+			conv=notrunc 2>/dev/null
+		dd if=$temp of=$file bs=4k count=2 skip=$off seek=$off \
+			conv=notrunc oflag=sync 2>/dev/null ||
+			error "overwrite at $off failed"
+	done
+	do_facet ost1 $LCTL get_param $osd.writelog_stats
+	ios=$(do_facet ost1 $LCTL get_param -n $osd.writelog_stats |
+	      awk '/^ios:/ { print $2 }')
+	(( ios > 0 )) || error "no write logged"
+
+	# logged blocks are read back before and after they are destaged
+	cancel_lru_locks osc
+	do_facet ost1 $LCTL set_param -n $osd.read_cache_enable=0
+	stack_trap "do_facet ost1 $LCTL set_param -n $osd.read_cache_enable=1"
+	cmp $temp $file || error "$file differs after logged writes"
+
+	# large write over logged blocks is not overwritten by the log
+	dd if=/dev/urandom of=$temp bs=1M count=4 conv=notrunc ||
+		error "dd $temp failed"
+	dd if=$temp of=$file bs=1M count=4 conv=notrunc oflag=direct ||
+		error "rewrite $file failed"
+	do_facet ost1 "sync; echo 3 > /proc/sys/vm/drop_caches"
+	cancel_lru_locks osc
+	cmp $temp $file || error "$file differs after rewrite"
+}
+run_test 155i "small overwrites through OST write log"
+
+test_155j() {
+	[ "$ost1_FSTYPE" == "ldiskfs" ] || skip "ldiskfs only test"
+	remote_ost_nodsh && skip "remote OST with nodsh"
+
+	local temp=$TMP/$tfile
+	local file=$DIR/$tfile
+	local osd="osd-ldiskfs.$(facet_svc ost1)"
+	local nr=$(do_facet ost1 $LCTL get_param -n \
+		   $osd.bio_submit_contexts 2>/dev/null)
+
+	[ -n "$nr" ] || skip "no bio_submit_contexts on OST"
+	stack_trap "do_facet ost1 $LCTL set_param $osd.bio_submit_contexts=$nr"
+	stack_trap "rm -f $temp $file"
+	do_facet ost1 $LCTL set_param $osd.bio_submit_contexts=4
+
+	$LFS setstripe -c 1 -i 0 $file || error "setstripe $file failed"
+	dd if=/dev/urandom of=$temp bs=1M count=64 || error "dd $temp failed"
+	dd if=$temp of=$file bs=16M oflag=direct ||
+		error "write $file failed"
+	cancel_lru_locks osc
+	dd if=$file of=/dev/null bs=16M iflag=direct ||
+		error "read $file failed"
+	cmp $temp $file || error "$temp $file differ"
+}
+run_test 155j "large BRW with bios submitted from several CPUs"
+
 test_156() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
 	remote_ost_nodsh && skip "remote OST with nodsh"
@@ -18907,10 +19088,11 @@ test_215() { # for bugs 18102, 21079, 21517
 	remove_lnet_proc_files "peers"
 
 	# lnet.buffers  should look like this:
-	# pages count credits min
-	# where pages >=0, count >=0, credits and min are numeric (0 or >0 or <0)
-	L1="^pages +count +credits +min$"
-	BR="^ +$N +$N +$I +$I$"
+	# pages count credits min blocked grow shrink
+	# where pages >=0, count >=0, credits and min are numeric (0 or >0 or <0),
+	# blocked, grow and shrink >= 0
+	L1="^pages +count +credits +min +blocked +grow +shrink$"
+	BR="^ +$N +$N +$I +$I +$N +$N +$N$"
 	create_lnet_proc_files "buffers"
 	check_lnet_proc_entry "buffers.sys" "lnet.buffers" "$BR" "$L1"
 	remove_lnet_proc_files "buffers"
@@ -20542,6 +20724,135 @@ test_230w() {
 }
 run_test 230w "non-recursive mode dir migration"
 
+test_230x() {
+	(( MDSCOUNT > 1 )) || skip "needs >= 2 MDTs"
+	(( MDS1_VERSION >= $(version_code 2.14.57) )) ||
+		skip "Need MDS version at least 2.14.57"
+
+	local mdts=$(comma_list $(mdts_nodes))
+	local stats="mdt.*MDT0000.dir_restripe_stats"
+	local timeout=100
+	local restripe_status
+	local batch
+	local migrated
+	local trans
+	local overlapped
+	local before
+	local after
+	local busy=0
+	local i
+
+	[[ $mds1_FSTYPE == zfs ]] && timeout=300
+
+	do_nodes $mdts "$LCTL set_param lod.*.mdt_hash=crush"
+
+	restripe_status=$(do_facet mds1 $LCTL get_param -n \
+			   mdt.*MDT0000.enable_dir_restripe)
+	batch=$(do_facet mds1 $LCTL get_param -n \
+		mdt.*MDT0000.dir_restripe_migrate_batch)
+	do_nodes $mdts "$LCTL set_param mdt.*.enable_dir_restripe=1"
+	do_nodes $mdts "$LCTL set_param mdt.*.dir_restripe_migrate_batch=8"
+	stack_trap "do_nodes $mdts $LCTL set_param \
+		    mdt.*.enable_dir_restripe=$restripe_status \
+		    mdt.*.dir_restripe_migrate_batch=$batch"
+
+	(( $(do_facet mds1 $LCTL get_param -n $stats |
+	     awk '/^threads:/ { print $2 }') > 1 )) ||
+		skip "needs more than one restripe thread"
+
+	# the source of the split is a single stripe on MDT0000
+	test_mkdir -i 0 -c 1 $DIR/$tdir
+	createmany -m $DIR/$tdir/f 2000 ||
+		error "create files under $tdir failed"
+
+	before=($(do_facet mds1 $LCTL get_param -n $stats |
+		  awk '/^thread_entries_migrated:/ { $1 = ""; print }'))
+	trans=$(do_facet mds1 $LCTL get_param -n $stats |
+		awk '/^migrate_transactions:/ { print $2 }')
+	migrated=$(do_facet mds1 $LCTL get_param -n $stats |
+		   awk '/^entries_migrated:/ { print $2 }')
+	overlapped=$(do_facet mds1 $LCTL get_param -n $stats |
+		     awk '/^migrate_transactions_overlapped:/ { print $2 }')
+
+	# hold the locks of each batch for 50ms, batches of other threads
+	# run meanwhile unless they are serialized by a directory lock
+	#define OBD_FAIL_MIGRATE_BATCH_DELAY	0x1810
+	do_facet mds1 $LCTL set_param fail_loc=0x1810 fail_val=50
+	stack_trap "do_facet mds1 $LCTL set_param fail_loc=0 fail_val=0"
+
+	$LFS setdirstripe -c $MDSCOUNT $DIR/$tdir ||
+		error "split $tdir failed"
+	wait_update $HOSTNAME "$LFS getdirstripe -H $DIR/$tdir" \
+		"crush" $timeout || error "dir split not finished"
+	do_facet mds1 $LCTL set_param fail_loc=0 fail_val=0
+
+	do_facet mds1 $LCTL get_param $stats
+	after=($(do_facet mds1 $LCTL get_param -n $stats |
+		 awk '/^thread_entries_migrated:/ { $1 = ""; print }'))
+	trans=$(($(do_facet mds1 $LCTL get_param -n $stats |
+		   awk '/^migrate_transactions:/ { print $2 }') - trans))
+	migrated=$(($(do_facet mds1 $LCTL get_param -n $stats |
+		      awk '/^entries_migrated:/ { print $2 }') - migrated))
+	(( migrated > 0 )) || error "no sub file migrated"
+	(( trans > 0 && trans < migrated )) ||
+		error "$migrated sub files migrated in $trans transactions"
+
+	for ((i = 0; i < ${#after[@]}; i++)); do
+		(( ${after[i]} > ${before[i]} )) && busy=$((busy + 1))
+	done
+	echo "$busy threads migrated sub files of one stripe"
+	(( busy > 1 )) || error "only $busy thread migrated one stripe"
+
+	overlapped=$(($(do_facet mds1 $LCTL get_param -n $stats |
+		awk '/^migrate_transactions_overlapped:/ { print $2 }') -
+		overlapped))
+	echo "$overlapped of $trans transactions overlapped another one"
+	(( overlapped > 0 )) || error "migration transactions serialized"
+
+	(( $(ls $DIR/$tdir | wc -l) == 2000 )) ||
+		error "sub file count mismatch after split"
+}
+run_test 230x "dir split migrates one stripe in parallel and batches"
+
+test_230y() {
+	(( MDSCOUNT > 1 )) || skip "needs >= 2 MDTs"
+	(( MDS1_VERSION >= $(version_code 2.14.57) )) ||
+		skip "Need MDS version at least 2.14.57"
+
+	local mdts=$(comma_list $(mdts_nodes))
+	local batch
+	local i
+	local j
+
+	batch=$(do_facet mds1 $LCTL get_param -n \
+		osp.*MDT0001-osp-MDT0000.out_batch_max)
+	do_nodes $mdts "$LCTL set_param osp.*-osp-MDT*.out_batch_max=16"
+	stack_trap "do_nodes $mdts $LCTL set_param \
+		    osp.*-osp-MDT*.out_batch_max=$batch"
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir
+	for i in $(seq 8); do
+		mkdir $DIR/$tdir/d$i
+		$LFS setdirstripe -i 0 -c $MDSCOUNT $DIR/$tdir/d$i/s &
+		(for j in $(seq 20); do
+			$LFS mkdir -i 1 $DIR/$tdir/d$i/r$j
+		done) &
+	done
+	wait
+
+	for i in $(seq 8); do
+		(( $($LFS getdirstripe -c $DIR/$tdir/d$i/s) == MDSCOUNT )) ||
+			error "bad stripe count of $tdir/d$i/s"
+		(( $(ls $DIR/$tdir/d$i | wc -l) == 21 )) ||
+			error "remote dirs under $tdir/d$i missing"
+	done
+	do_facet mds1 $LCTL get_param osp.*-osp-MDT0000.out_batch_stats
+
+	do_nodes $mdts "$LCTL set_param osp.*-osp-MDT*.out_batch_max=0"
+	rm -rf $DIR/$tdir || error "rm $tdir failed"
+}
+run_test 230y "batch cross-MDT updates in one OUT RPC"
+
 test_231a()
 {
 	# For simplicity this test assumes that max_pages_per_rpc
@@ -22876,6 +23187,68 @@ test_272f() {
 }
 run_test 272f "DoM migration: OST-striped file to DOM file"
 
+test_272g() {
+	[ $MDS1_VERSION -lt $(version_code 2.14.57) ] &&
+		skip "Need MDS version at least 2.14.57"
+
+	local dom=$DIR/$tdir/$tfile
+	local mdt=mdt.$FSNAME-MDT0000
+	local queue=$TMP/$tfile.queue
+	local fid
+
+	mkdir -p $DIR/$tdir
+	$LFS setstripe -i 0 -c 1 $dom
+	dd if=/dev/urandom of=$TMP/$tfile bs=4k count=1 ||
+		error "write $TMP/$tfile failed"
+	stack_trap "rm -f $TMP/$tfile $queue"
+	cp $TMP/$tfile $dom || error "write $dom failed"
+	fid=$($LFS path2fid $dom | tr -d '[]')
+
+	do_facet mds1 $LCTL set_param $mdt.dom_tier_heat_threshold=1
+	do_facet mds1 $LCTL set_param $mdt.dom_tier_enable=1
+	stack_trap "do_facet mds1 $LCTL set_param $mdt.dom_tier_enable=0 \
+		$mdt.dom_tier_heat_threshold=16" EXIT
+
+	for i in {1..10}; do
+		cat $dom > /dev/null || error "read $dom failed"
+	done
+
+	do_facet mds1 $LCTL get_param -n $mdt.dom_tier_queue > $queue
+	cat $queue
+	grep "$fid" $queue | grep -q promote ||
+		error "$fid is not queued for promotion"
+
+	# the mover migrates the file into DoM, which drops it from the queue
+	$LFS_TIER_MIGRATE -Q $queue $MOUNT || error "lfs_tier_migrate failed"
+	[[ $($LFS getstripe -L --component-start=0 $dom) == 'mdt' ]] ||
+		error "$dom was not moved into DoM"
+	cmp $TMP/$tfile $dom || error "$dom data changed"
+	do_facet mds1 $LCTL get_param -n $mdt.dom_tier_queue |
+		grep -q "$fid" && error "$fid is still queued"
+
+	# a cold file grown past its DoM component goes back to OSTs
+	dd if=/dev/urandom of=$TMP/$tfile bs=1M count=2 ||
+		error "write $TMP/$tfile failed"
+	do_facet mds1 $LCTL set_param $mdt.dom_tier_heat_threshold=1000000
+	cp $TMP/$tfile $dom || error "write $dom failed"
+	cat $dom > /dev/null || error "read $dom failed"
+
+	do_facet mds1 $LCTL get_param -n $mdt.dom_tier_queue > $queue
+	cat $queue
+	grep "$fid" $queue | grep -q demote ||
+		error "$fid is not queued for demotion"
+
+	$LFS_TIER_MIGRATE -Q $queue $MOUNT || error "lfs_tier_migrate failed"
+	[[ $($LFS getstripe -L --component-start=0 $dom) != 'mdt' ]] ||
+		error "$dom was not moved out of DoM"
+	cmp $TMP/$tfile $dom || error "$dom data changed"
+	do_facet mds1 $LCTL get_param -n $mdt.dom_tier_queue |
+		grep -q "$fid" && error "$fid is still queued"
+
+	return 0
+}
+run_test 272g "DoM tiering: lfs_tier_migrate promotes and demotes files"
+
 test_273a() {
 	[ $MDS1_VERSION -lt $(version_code 2.11.50) ] &&
 		skip "Need MDS version at least 2.11.50"
@@ -23836,6 +24209,110 @@ test_300t() {
 }
 run_test 300t "test max_mdt_stripecount"
 
+test_300u() {
+	(( MDSCOUNT >= 2 )) || skip "needs >= 2 MDTs"
+	(( MDS1_VERSION >= $(version_code 2.14.57) )) ||
+		skip "Need MDS version at least 2.14.57"
+
+	local dir=$DIR/$tdir/striped_dir
+	local hash
+	local count
+	local i
+
+	mkdir_on_mdt0 $DIR/$tdir
+	$LFS mkdir -i 0 -c $MDSCOUNT -H bucket $dir ||
+		error "mkdir $dir with bucket hash failed"
+	hash=$($LFS getdirstripe -H $dir)
+	[[ $hash == "bucket" ]] || error "expect hash bucket, got $hash"
+
+	createmany -o $dir/f- 500 || error "create files failed"
+	createmany -d $dir/d- 50 || error "create dirs failed"
+
+	# lookup from an empty client cache uses the weights in the LMV
+	cancel_lru_locks mdc
+	for ((i = 0; i < 500; i++)); do
+		stat $dir/f-$i > /dev/null || error "stat f-$i failed"
+	done
+	count=$(ls $dir | wc -l)
+	(( count == 550 )) || error "expect 550 entries, got $count"
+
+	# every stripe gets sub files
+	for ((i = 0; i < MDSCOUNT; i++)); do
+		count=$($LFS find -m $i --type f $dir | wc -l)
+		(( count > 0 )) || error "no file on MDT$i"
+	done
+
+	# migration target keeps bucket hash
+	$LFS migrate -m 1 -c $MDSCOUNT -H bucket $dir ||
+		error "migrate $dir failed"
+	hash=$($LFS getdirstripe -H $dir)
+	[[ $hash == "bucket" ]] || error "expect hash bucket, got $hash"
+	cancel_lru_locks mdc
+	count=$(ls $dir | wc -l)
+	(( count == 550 )) || error "expect 550 entries after migrate"
+}
+run_test 300u "striped directory with bucket hash"
+
+test_300v() {
+	(( MDSCOUNT >= 2 )) || skip "needs >= 2 MDTs"
+	(( MDS1_VERSION >= $(version_code 2.14.57) )) ||
+		skip "Need MDS version at least 2.14.57"
+
+	local mdts=$(comma_list $(mdts_nodes))
+	local dir=$DIR/$tdir/striped_dir
+	local timeout=100
+	local restripe_status
+	local count
+	local i
+
+	[[ $mds1_FSTYPE == zfs ]] && timeout=300
+
+	restripe_status=$(do_facet mds1 $LCTL get_param -n \
+			   mdt.*MDT0000.enable_dir_restripe)
+	do_nodes $mdts "$LCTL set_param mdt.*.enable_dir_restripe=1"
+	stack_trap "do_nodes $mdts $LCTL set_param \
+		    mdt.*.enable_dir_restripe=$restripe_status"
+
+	mkdir_on_mdt0 $DIR/$tdir
+	$LFS mkdir -i 0 -c 1 -H bucket $dir ||
+		error "mkdir $dir with bucket hash failed"
+	createmany -o $dir/f- 200 || error "create files failed"
+
+	# split and merge keep bucket hash
+	for i in $(seq 2 $MDSCOUNT) 1; do
+		$LFS setdirstripe -c $i -H bucket $dir ||
+			error "restripe -c $i $dir failed"
+		wait_update $HOSTNAME "$LFS getdirstripe -c $dir" $i $timeout ||
+			error "dir restripe to $i stripes not finished"
+		wait_update $HOSTNAME \
+			"$LFS getdirstripe -H $dir | cut -d, -f1" "bucket" \
+			$timeout || error "hash is not bucket"
+		cancel_lru_locks mdc
+		count=$(ls $dir | wc -l)
+		(( count == 200 )) ||
+			error "expect 200 entries with $i stripes, got $count"
+	done
+
+	# rebalance with the same stripe count reweights stripes by MDT load,
+	# and it's rejected if the weights don't change.
+	$LFS setdirstripe -c $MDSCOUNT -H bucket $dir ||
+		error "split $dir failed"
+	wait_update $HOSTNAME "$LFS getdirstripe -c $dir" $MDSCOUNT $timeout ||
+		error "dir split not finished"
+	createmany -o $DIR/$tdir/fill- 2000 || error "create fill files failed"
+	$LFS setdirstripe -c $MDSCOUNT -H bucket $dir ||
+		echo "stripe weights unchanged"
+	wait_update $HOSTNAME "$LFS getdirstripe -H $dir | cut -d, -f1" \
+		"bucket" $timeout || error "dir rebalance not finished"
+	cancel_lru_locks mdc
+	for ((i = 0; i < 200; i++)); do
+		stat $dir/f-$i > /dev/null || error "stat f-$i failed"
+	done
+	count=$(ls $dir | wc -l)
+	(( count == 200 )) || error "expect 200 entries after rebalance"
+}
+run_test 300v "bucket hash directory restripe and rebalance"
+
 prepare_remote_file() {
 	mkdir $DIR/$tdir/src_dir ||
 		error "create remote source failed"
@@ -28019,6 +28496,279 @@ test_823() {
 }
 run_test 823 "Setting create_count > OST_MAX_PRECREATE is lowered to maximum"
 
+test_824() {
+	local p="$TMP/$TESTSUITE-$TESTNAME.parameters"
+	local osp="osp.$FSNAME-OST0000*MDT0000"
+	local log=$TMP/$tfile.log
+	local inflight
+	local count
+	local rate
+
+	(( MDS1_VERSION >= $(version_code 2.14.57) )) ||
+		skip "Need MDS version at least 2.14.57"
+
+	save_lustre_params mds1 "$osp.create_count" > $p
+	save_lustre_params mds1 "$osp.max_create_rpcs_in_flight" >> $p
+	save_lustre_params mds1 "debug" >> $p
+	stack_trap "restore_lustre_params < $p; rm -f $p $log"
+
+	do_facet mds1 "$LCTL set_param -n $osp.create_count=32"
+	do_facet mds1 "$LCTL set_param -n $osp.max_create_rpcs_in_flight=4"
+	do_facet mds1 "$LCTL set_param debug=ha"
+	do_facet mds1 "$LCTL clear"
+	test_mkdir -i 0 $DIR/$tdir
+	$LFS setstripe -i 0 -c 1 $DIR/$tdir || error "setstripe failed"
+	createmany -o $DIR/$tdir/f- 5000 || error "createmany failed"
+	do_facet mds1 "$LCTL dk" > $log
+
+	rate=$(do_facet mds1 "$LCTL get_param -n $osp.create_rate")
+	count=$(do_facet mds1 "$LCTL get_param -n $osp.create_count")
+	echo "create rate $rate/s, create count $count"
+	(( rate > 0 )) || error "create rate not measured"
+
+	# only osp_precreate_adapt_nolock() grows create_count by the rate,
+	# osp_precreate_reserve() doubles it without a message
+	grep "OST0000.*create rate [0-9]*/s, create count" $log ||
+		error "create count not adapted to the create rate"
+
+	# objects are requested by more than one RPC at a time
+	inflight=$(awk '/OST0000.*precreate [0-9]* objects up to/ {
+		       if ($(NF - 3) > max) max = $(NF - 3) }
+		       END { print max + 0 }' $log)
+	echo "up to $inflight precreate RPCs in flight"
+	(( inflight > 1 )) || error "no parallel precreate RPC"
+
+	# every file got its own object
+	count=$($LFS getstripe $DIR/$tdir/f-* |
+		awk '$1 == 0 && NF == 4 { print $4, $2 }' | sort -u | wc -l)
+	(( count == 5000 )) || error "$count unique objects for 5000 files"
+}
+run_test 824 "precreate batch adapts to the create rate"
+
+test_825() {
+	local p="$TMP/$TESTSUITE-$TESTNAME.parameters"
+	local osp="osp.$FSNAME-OST0000*MDT0000"
+	local osd="osd-*.$FSNAME-OST0000"
+	local nr=1000
+	local ifree
+	local kbfree
+	local rpcs
+	local i
+
+	do_facet mds1 "$LCTL get_param -n $osp.max_sync_batch" ||
+		skip "MDS doesn't support batched destroys"
+	do_facet mds1 "$LCTL get_param -n $osp.import" |
+		grep -q batch_destroy || skip "OST doesn't support batched destroys"
+
+	save_lustre_params mds1 "$osp.max_sync_batch" > $p
+	stack_trap "restore_lustre_params < $p; rm $p"
+	do_facet mds1 "$LCTL set_param -n $osp.max_sync_batch=64"
+
+	test_mkdir -i 0 $DIR/$tdir
+	$LFS setstripe -i 0 -c 1 $DIR/$tdir || error "setstripe failed"
+	wait_delete_completed
+	ifree=$(do_facet ost1 $LCTL get_param -n $osd.filesfree)
+	kbfree=$(do_facet ost1 $LCTL get_param -n $osd.kbytesfree)
+
+	createmany -o $DIR/$tdir/f- $nr || error "createmany failed"
+	# give some of the objects blocks, so freeing them shows in kbytesfree
+	for ((i = 0; i < 16; i++)); do
+		dd if=/dev/zero of=$DIR/$tdir/f-$i bs=1M count=1 conv=notrunc \
+			2>/dev/null || error "write f-$i failed"
+	done
+	sync
+	wait_delete_completed
+
+	do_facet ost1 $LCTL set_param -n obdfilter.$FSNAME-OST0000.stats=clear
+	unlinkmany $DIR/$tdir/f- $nr || error "unlinkmany failed"
+	wait_delete_completed
+
+	rpcs=$(do_facet ost1 $LCTL get_param -n \
+		obdfilter.$FSNAME-OST0000.stats | awk '/^destroy/ { print $2 }')
+	echo "$nr objects destroyed by ${rpcs:-0} RPCs"
+	(( ${rpcs:-0} > 0 && rpcs < nr / 2 )) ||
+		error "destroys not batched"
+
+	# all the objects are gone and their space is back, allow some slack
+	# for llogs and last_rcvd updates; blocks may be freed in background
+	wait_update_facet_cond ost1 "$LCTL get_param -n $osd.filesfree" \
+		-ge $((ifree - 32)) 30 ||
+		error "objects not destroyed, filesfree $ifree before"
+	wait_update_facet_cond ost1 "$LCTL get_param -n $osd.kbytesfree" \
+		-ge $((kbfree - 4096)) 30 ||
+		error "space not freed, kbytesfree $kbfree before"
+}
+run_test 825 "OST objects are destroyed in batches"
+
+test_826() {
+	[ "$ost1_FSTYPE" == "ldiskfs" ] || skip "ldiskfs only test"
+	remote_ost_nodsh && skip "remote OST with nodsh"
+
+	local osd="osd-ldiskfs.$(facet_svc ost1)"
+	local min=$(do_facet ost1 $LCTL get_param -n \
+		    $osd.deferred_free_min_kb 2>/dev/null)
+	local nr=16
+	local before
+	local after
+	local freed
+	local i
+
+	[ -n "$min" ] || skip "no deferred block freeing on OST"
+	stack_trap "do_facet ost1 $LCTL set_param $osd.deferred_free_min_kb=$min"
+	do_facet ost1 $LCTL set_param $osd.deferred_free_min_kb=1024
+
+	test_mkdir -i 0 $DIR/$tdir
+	$LFS setstripe -c 1 -i 0 $DIR/$tdir || error "setstripe failed"
+	for ((i = 0; i < nr; i++)); do
+		dd if=/dev/zero of=$DIR/$tdir/f$i bs=1M count=4 2>/dev/null ||
+			error "write f$i failed"
+	done
+	# a small file is freed inline
+	echo data > $DIR/$tdir/small
+	sync
+
+	before=$(do_facet ost1 $LCTL get_param -n $osd.deferred_free_stats |
+		 awk '/^freed_objects/ { print $2 }')
+	rm -rf $DIR/$tdir || error "rm failed"
+	wait_delete_completed
+	wait_update_facet ost1 "$LCTL get_param -n $osd.deferred_free_stats |
+		awk '/^pending_objects/ { print \\\$2 }'" 0 10 ||
+		error "objects still pending"
+	do_facet ost1 $LCTL get_param $osd.deferred_free_stats
+	after=$(do_facet ost1 $LCTL get_param -n $osd.deferred_free_stats |
+		awk '/^freed_objects/ { print $2 }')
+	freed=$((after - before))
+	(( freed == nr )) || error "$freed objects freed deferred, not $nr"
+}
+run_test 826 "OST frees blocks of large destroyed objects in background"
+
+test_827() {
+	local ofd="obdfilter.$FSNAME-OST0000"
+	local nid=$($LCTL list_nids | head -n1)
+	local window
+	local rate
+	local i
+
+	window=$(do_facet ost1 $LCTL get_param -n $ofd.grant_rate_window \
+		 2>/dev/null) || skip "OST doesn't support rate-based grant"
+	stack_trap "do_facet ost1 $LCTL set_param $ofd.grant_rate_window=$window"
+	do_facet ost1 $LCTL set_param $ofd.grant_rate_window=8
+
+	$LFS setstripe -i 0 -c 1 $DIR/$tfile || error "setstripe failed"
+	# keep writing for a few seconds so the rate is sampled
+	for ((i = 0; i < 4; i++)); do
+		dd if=/dev/zero of=$DIR/$tfile bs=1M count=16 seek=$((i * 16)) \
+			conv=notrunc oflag=sync 2>/dev/null ||
+			error "write failed"
+		sleep 1
+	done
+
+	do_facet ost1 $LCTL get_param $ofd.exports.$nid.export |
+		grep -A8 "grant:"
+	rate=$(do_facet ost1 $LCTL get_param -n $ofd.exports.$nid.export |
+	       awk '/write_rate:/ { print $2; exit }')
+	(( ${rate:-0} > 0 )) || error "write rate of the client not measured"
+	do_facet ost1 $LCTL get_param -n $ofd.exports.$nid.export |
+		grep -q "efficiency:" || error "no grant efficiency reported"
+
+	# fill the OST until it is short of grant space, an idle client
+	# holding more than one RPC of grant is asked to return it
+	local osc="osc.$FSNAME-OST0000-osc-[^mM]*"
+	local rpc=$(($($LCTL get_param -n $osc.max_pages_per_rpc) * PAGE_SIZE))
+	local grant=$($LCTL get_param -n $osc.cur_grant_bytes)
+	local reclaims
+	local granted
+	local avail
+
+	(( grant > rpc )) || skip "client holds only $grant bytes of grant"
+	check_set_fallocate_or_skip
+
+	avail=$(do_facet ost1 $LCTL get_param -n $ofd.kbytesavail)
+	granted=$(do_facet ost1 $LCTL get_param -n $ofd.tot_granted)
+	$LFS setstripe -i 0 -c 1 $DIR/$tfile.fill || error "setstripe failed"
+	stack_trap "rm -f $DIR/$tfile.fill; wait_delete_completed"
+	fallocate -l $(((avail - granted / 1024 - 8192) * 1024)) \
+		$DIR/$tfile.fill || error "fallocate failed"
+
+	# let the write rate decay to 0, reclaim requests ride on I/O replies
+	sleep 9
+	dd if=$DIR/$tfile of=/dev/null bs=1M count=1 iflag=direct ||
+		error "read failed"
+	wait_update_cond $HOSTNAME "$LCTL get_param -n $osc.cur_grant_bytes" \
+		-le $rpc 30 || error "grant $grant not reclaimed"
+	reclaims=$(do_facet ost1 $LCTL get_param -n $ofd.exports.$nid.export |
+		   awk '/reclaims:/ { print $2; exit }')
+	(( ${reclaims:-0} > 0 )) || error "no grant reclaim requested"
+
+	# at one RPC of grant the client isn't asked again
+	for ((i = 0; i < 4; i++)); do
+		dd if=$DIR/$tfile of=/dev/null bs=1M count=1 skip=$i \
+			iflag=direct || error "read failed"
+	done
+	do_facet ost1 $LCTL get_param $ofd.exports.$nid.export |
+		grep -A8 "grant:"
+	(( $(do_facet ost1 $LCTL get_param -n $ofd.exports.$nid.export |
+	     awk '/reclaims:/ { print $2; exit }') == reclaims )) ||
+		error "client asked to reclaim grant it must keep"
+}
+run_test 827 "OST measures client write rate for grant"
+
+test_828() {
+	(( OSTCOUNT >= 2 )) || skip_env "needs >= 2 OSTs"
+
+	local lod="lod.$FSNAME-MDT0000-mdtlov"
+	local osp="osp.$FSNAME-OST0000-osc-MDT0000"
+	local prio
+	local nfiles=$((OSTCOUNT * 20))
+	local count=0
+	local maxage
+	local latency
+	local pid
+	local idx
+	local i
+
+	prio=$(do_facet mds1 $LCTL get_param -n $lod.qos_prio_load \
+	       2>/dev/null) || skip "MDS doesn't support qos_prio_load"
+	stack_trap "do_facet mds1 $LCTL set_param $lod.qos_prio_load=$prio"
+	do_facet mds1 $LCTL set_param $lod.qos_prio_load=100
+	maxage=$(do_facet mds1 $LCTL get_param -n $osp.maxage)
+	stack_trap "do_facet mds1 $LCTL set_param $osp.maxage=$maxage"
+	do_facet mds1 $LCTL set_param $osp.maxage=1
+
+	# keep OST0000 loaded and let the OSP pick up its statfs
+	$LFS setstripe -i 0 -c 1 $DIR/$tfile || error "setstripe failed"
+	(
+		while dd if=/dev/zero of=$DIR/$tfile bs=1M count=64 \
+			oflag=direct conv=notrunc status=none; do
+			:
+		done
+	) &
+	pid=$!
+	stack_trap "kill $pid 2>/dev/null; wait $pid 2>/dev/null"
+	sleep 3
+	latency=$(do_facet mds1 $LCTL get_param -n $osp.io_latency_us)
+	echo "OST0000 io_latency_us: $latency"
+	(( latency > 0 )) || error "OST0000 I/O latency not reported"
+
+	mkdir $DIR/$tdir || error "mkdir failed"
+	for ((i = 0; i < nfiles; i++)); do
+		$LFS setstripe -c 1 $DIR/$tdir/$tfile.$i ||
+			error "create $i failed"
+	done
+	kill $pid
+	wait $pid 2>/dev/null
+
+	# round-robin or free space only would give OST0000 its share
+	for ((i = 0; i < nfiles; i++)); do
+		idx=$($LFS getstripe -i $DIR/$tdir/$tfile.$i)
+		(( idx == 0 )) && (( count += 1 ))
+	done
+	echo "$count of $nfiles files on OST0000"
+	(( count < nfiles / OSTCOUNT )) ||
+		error "$count files on loaded OST0000 >= $((nfiles / OSTCOUNT))"
+}
+run_test 828 "QoS allocator sees OST I/O load"
+
 test_831() {
 	local sync_changes=$(do_facet $SINGLEMDS \
 		$LCTL get_param -n osp.$FSNAME-OST0000-osc-MDT0000.sync_changes)
@@ -1203,6 +1203,52 @@ test_33e() {
 }
 run_test 33e "DNE local operation shouldn't trigger COS"
 
+test_33f() {
+	(( MDSCOUNT >= 2 )) || skip "needs >= 2 MDTs"
+
+	local skipped
+	local sync_count
+	local pids=()
+	local pid
+	local i
+	local j
+
+	# all renames are local to MDT1, only the global rename lock is
+	# enqueued on MDT0, which protects nothing on MDT0 disk
+	$LFS mkdir -i 1 $DIR/$tdir || error "mkdir $tdir failed"
+	$LFS mkdir -i 1 $DIR/$tdir/d1 || error "mkdir d1 failed"
+	$LFS mkdir -i 1 $DIR/$tdir/d2 || error "mkdir d2 failed"
+	createmany -o $DIR/$tdir/d1/f 400 || error "create files failed"
+	sync_all_data
+
+	do_facet mds1 "$LCTL set_param -n mdt.*MDT0000.sync_count=0 \
+		mdt.*MDT0000.sync_lock_cancel_skip_count=0"
+
+	# concurrent cross-directory renames contend on the rename lock
+	for ((i = 0; i < 4; i++)); do
+		(
+			for ((j = i; j < 400; j += 4)); do
+				mv $DIR/$tdir/d1/f$j $DIR/$tdir/d2/f$j ||
+					exit 1
+			done
+		) &
+		pids+=($!)
+	done
+	for pid in ${pids[@]}; do
+		wait $pid || error "rename failed"
+	done
+
+	sync_count=$(do_facet mds1 \
+		"$LCTL get_param -n mdt.*MDT0000.sync_count")
+	skipped=$(do_facet mds1 \
+		"$LCTL get_param -n mdt.*MDT0000.sync_lock_cancel_skip_count")
+	echo "sync_count $sync_count skipped $skipped"
+	(( sync_count == 0 )) ||
+		error "rename lock cancel synced MDT0000 $sync_count times"
+	(( skipped > 0 )) || error "no contended rename lock cancel"
+}
+run_test 33f "Cancel of rename lock shouldn't trigger Sync-Lock-Cancel"
+
 # End commit on sharing tests
 
 get_ost_lock_timeouts() {
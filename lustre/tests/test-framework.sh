@@ -331,6 +331,9 @@ init_test_env() {
 	export LFS_MIGRATE=${LFS_MIGRATE:-$LUSTRE/scripts/lfs_migrate}
 	[ ! -f "$LFS_MIGRATE" ] &&
 		export LFS_MIGRATE=$(which lfs_migrate 2> /dev/null)
+	export LFS_TIER_MIGRATE=${LFS_TIER_MIGRATE:-$LUSTRE/scripts/lfs_tier_migrate}
+	[ ! -f "$LFS_TIER_MIGRATE" ] &&
+		export LFS_TIER_MIGRATE=$(which lfs_tier_migrate 2> /dev/null)
 	export LR_READER=${LR_READER:-"$LUSTRE/utils/lr_reader"}
 	[ ! -f "$LR_READER" ] &&
 		export LR_READER=$(which lr_reader 2> /dev/null)
@@ -760,6 +760,7 @@ int
 jt_ptl_print_connections(int argc, char **argv)
 {
 	struct libcfs_ioctl_data data;
+	struct ksock_conn_stats stats;
 	struct lnet_process_id id;
 	char buffer[2][HOST_NAME_MAX + 1];
 	int index;
@@ -772,6 +773,11 @@ jt_ptl_print_connections(int argc, char **argv)
 		LIBCFS_IOC_INIT(data);
 		data.ioc_net     = g_net;
 		data.ioc_count   = index;
+		if (g_net_is_compatible(NULL, SOCKLND, 0)) {
+			memset(&stats, 0, sizeof(stats));
+			data.ioc_pbuf1 = &stats;
+			data.ioc_plen1 = sizeof(stats);
+		}
 
 		rc = l_ioctl(LNET_DEV_ID, IOC_LIBCFS_GET_CONN, &data);
 		if (rc != 0)
@@ -780,7 +786,7 @@ jt_ptl_print_connections(int argc, char **argv)
 		if (g_net_is_compatible(NULL, SOCKLND, 0)) {
 			id.nid = data.ioc_nid;
 			id.pid = data.ioc_u32[6];
-			printf("%-20s %s[%d]%s->%s:%d %d/%d %s\n",
+			printf("%-20s %s[%d]%s->%s:%d %d/%d %s zc %llu/%llu copy %llu rx %llu stripe %llu/%llu zcmsg %llu/%llu\n",
 			       libcfs_id2str(id),
 			       (data.ioc_u32[3] == SOCKLND_CONN_ANY) ? "A" :
 			       (data.ioc_u32[3] == SOCKLND_CONN_CONTROL) ? "C" :
@@ -796,11 +802,23 @@ jt_ptl_print_connections(int argc, char **argv)
 			       data.ioc_u32[1],         /* remote port */
 			       data.ioc_count, /* tx buffer size */
 			       data.ioc_u32[5], /* rx buffer size */
-			       data.ioc_flags ? "nagle" : "nonagle");
+			       data.ioc_flags ? "nagle" : "nonagle",
+			       (unsigned long long)stats.kcs_tx_zc_bytes,
+			       (unsigned long long)stats.kcs_tx_zc_copied,
+			       (unsigned long long)stats.kcs_tx_copy_bytes,
+			       (unsigned long long)stats.kcs_rx_bytes,
+			       (unsigned long long)stats.kcs_tx_stripes,
+			       (unsigned long long)stats.kcs_rx_stripes,
+			       (unsigned long long)stats.kcs_tx_zc_msgs,
+			       (unsigned long long)stats.kcs_tx_zc_done);
 		} else if (g_net_is_compatible(NULL, O2IBLND, 0)) {
-			printf("%s mtu %d\n",
+			printf("%s mtu %d poll %llu lkey %u\n",
 			       libcfs_nid2str(data.ioc_nid),
-			       data.ioc_u32[0]); /* path MTU */
+			       data.ioc_u32[0], /* path MTU */
+			       /* completions found by busy polling */
+			       (unsigned long long)data.ioc_u64[0],
+			       /* RDMAs sent from the local DMA lkey */
+			       data.ioc_u32[1]);
 		} else if (g_net_is_compatible(NULL, GNILND, 0)) {
 			printf("%-20s [%d]\n",
 			       libcfs_nid2str(data.ioc_nid),
@@ -642,6 +642,9 @@ check_obd_connect_data(void)
 	CHECK_DEFINE_64X(OBD_CONNECT2_BATCH_RPC);
 	CHECK_DEFINE_64X(OBD_CONNECT2_PCCRO);
 	CHECK_DEFINE_64X(OBD_CONNECT2_ATOMIC_OPEN_LOCK);
+	CHECK_DEFINE_64X(OBD_CONNECT2_BUCKET_HASH);
+	CHECK_DEFINE_64X(OBD_CONNECT2_BATCH_DESTROY);
+	CHECK_DEFINE_64X(OBD_CONNECT2_LARGE_BULK);
 
 	CHECK_VALUE_X(OBD_CKSUM_CRC32);
 	CHECK_VALUE_X(OBD_CKSUM_ADLER);
@@ -781,6 +784,7 @@ check_obdo(void)
 	CHECK_CVALUE_X(OBD_FL_NOSPC_BLK);
 	CHECK_CVALUE_X(OBD_FL_FLUSH);
 	CHECK_CVALUE_X(OBD_FL_SHORT_IO);
+	CHECK_CVALUE_X(OBD_FL_GRANT_RECLAIM);
 }
 
 static void
@@ -894,7 +898,7 @@ check_lmv_mds_md_v1(void)
 	CHECK_MEMBER(lmv_mds_md_v1, lmv_migrate_offset);
 	CHECK_MEMBER(lmv_mds_md_v1, lmv_migrate_hash);
 	CHECK_MEMBER(lmv_mds_md_v1, lmv_padding2);
-	CHECK_MEMBER(lmv_mds_md_v1, lmv_padding3);
+	CHECK_MEMBER(lmv_mds_md_v1, lmv_bucket_weights);
 	CHECK_MEMBER(lmv_mds_md_v1, lmv_pool_name[LOV_MAXPOOLNAME + 1]);
 	CHECK_MEMBER(lmv_mds_md_v1, lmv_stripe_fids[0]);
 
@@ -928,8 +932,8 @@ check_obd_statfs(void)
 	CHECK_MEMBER(obd_statfs, os_state);
 	CHECK_MEMBER(obd_statfs, os_fprecreated);
 	CHECK_MEMBER(obd_statfs, os_granted);
-	CHECK_MEMBER(obd_statfs, os_spare3);
-	CHECK_MEMBER(obd_statfs, os_spare4);
+	CHECK_MEMBER(obd_statfs, os_io_inflight);
+	CHECK_MEMBER(obd_statfs, os_io_latency);
 	CHECK_MEMBER(obd_statfs, os_spare5);
 	CHECK_MEMBER(obd_statfs, os_spare6);
 	CHECK_MEMBER(obd_statfs, os_spare7);
@@ -954,6 +958,7 @@ check_obd_ioobj(void)
 	CHECK_MEMBER(obd_ioobj, ioo_max_brw);
 	CHECK_MEMBER(obd_ioobj, ioo_bufcnt);
 	CHECK_VALUE(IOOBJ_MAX_BRW_BITS);
+	CHECK_VALUE_X(IOOBJ_MD_BITS_MASK);
 }
 
 static void
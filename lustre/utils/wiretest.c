@@ -1426,6 +1426,12 @@ void lustre_assert_wire_constants(void)
 		 OBD_CONNECT2_PCCRO);
 	LASSERTF(OBD_CONNECT2_ATOMIC_OPEN_LOCK == 0x4000000ULL, "found 0x%.16llxULL\n",
 		 OBD_CONNECT2_ATOMIC_OPEN_LOCK);
+	LASSERTF(OBD_CONNECT2_BUCKET_HASH == 0x20000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_BUCKET_HASH);
+	LASSERTF(OBD_CONNECT2_BATCH_DESTROY == 0x40000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_BATCH_DESTROY);
+	LASSERTF(OBD_CONNECT2_LARGE_BULK == 0x80000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_LARGE_BULK);
 	LASSERTF(OBD_CKSUM_CRC32 == 0x00000001UL, "found 0x%.8xUL\n",
 		(unsigned)OBD_CKSUM_CRC32);
 	LASSERTF(OBD_CKSUM_ADLER == 0x00000002UL, "found 0x%.8xUL\n",
@@ -1716,6 +1722,7 @@ void lustre_assert_wire_constants(void)
 	BUILD_BUG_ON(OBD_FL_NOSPC_BLK != 0x00100000);
 	BUILD_BUG_ON(OBD_FL_FLUSH != 0x00200000);
 	BUILD_BUG_ON(OBD_FL_SHORT_IO != 0x00400000);
+	BUILD_BUG_ON(OBD_FL_GRANT_RECLAIM != 0x02000000);
 
 	/* Checks for struct lov_ost_data_v1 */
 	LASSERTF((int)sizeof(struct lov_ost_data_v1) == 24, "found %lld\n",
@@ -1943,10 +1950,10 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct lmv_mds_md_v1, lmv_padding2));
 	LASSERTF((int)sizeof(((struct lmv_mds_md_v1 *)0)->lmv_padding2) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct lmv_mds_md_v1 *)0)->lmv_padding2));
-	LASSERTF((int)offsetof(struct lmv_mds_md_v1, lmv_padding3) == 32, "found %lld\n",
-		 (long long)(int)offsetof(struct lmv_mds_md_v1, lmv_padding3));
-	LASSERTF((int)sizeof(((struct lmv_mds_md_v1 *)0)->lmv_padding3) == 8, "found %lld\n",
-		 (long long)(int)sizeof(((struct lmv_mds_md_v1 *)0)->lmv_padding3));
+	LASSERTF((int)offsetof(struct lmv_mds_md_v1, lmv_bucket_weights) == 32, "found %lld\n",
+		 (long long)(int)offsetof(struct lmv_mds_md_v1, lmv_bucket_weights));
+	LASSERTF((int)sizeof(((struct lmv_mds_md_v1 *)0)->lmv_bucket_weights) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct lmv_mds_md_v1 *)0)->lmv_bucket_weights));
 	LASSERTF((int)offsetof(struct lmv_mds_md_v1, lmv_pool_name[15 + 1]) == 56, "found %lld\n",
 		 (long long)(int)offsetof(struct lmv_mds_md_v1, lmv_pool_name[15 + 1]));
 	LASSERTF((int)sizeof(((struct lmv_mds_md_v1 *)0)->lmv_pool_name[15 + 1]) == 1, "found %lld\n",
@@ -2021,14 +2028,14 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct obd_statfs, os_granted));
 	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_granted) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_granted));
-	LASSERTF((int)offsetof(struct obd_statfs, os_spare3) == 116, "found %lld\n",
-		 (long long)(int)offsetof(struct obd_statfs, os_spare3));
-	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_spare3) == 4, "found %lld\n",
-		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_spare3));
-	LASSERTF((int)offsetof(struct obd_statfs, os_spare4) == 120, "found %lld\n",
-		 (long long)(int)offsetof(struct obd_statfs, os_spare4));
-	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_spare4) == 4, "found %lld\n",
-		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_spare4));
+	LASSERTF((int)offsetof(struct obd_statfs, os_io_inflight) == 116, "found %lld\n",
+		 (long long)(int)offsetof(struct obd_statfs, os_io_inflight));
+	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_io_inflight) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_io_inflight));
+	LASSERTF((int)offsetof(struct obd_statfs, os_io_latency) == 120, "found %lld\n",
+		 (long long)(int)offsetof(struct obd_statfs, os_io_latency));
+	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_io_latency) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct obd_statfs *)0)->os_io_latency));
 	LASSERTF((int)offsetof(struct obd_statfs, os_spare5) == 124, "found %lld\n",
 		 (long long)(int)offsetof(struct obd_statfs, os_spare5));
 	LASSERTF((int)sizeof(((struct obd_statfs *)0)->os_spare5) == 4, "found %lld\n",
@@ -2081,6 +2088,8 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)sizeof(((struct obd_ioobj *)0)->ioo_bufcnt));
 	LASSERTF(IOOBJ_MAX_BRW_BITS == 16, "found %lld\n",
 		 (long long)IOOBJ_MAX_BRW_BITS);
+	LASSERTF(IOOBJ_MD_BITS_MASK == 0x000000ffUL, "found 0x%.8xUL\n",
+		(unsigned)IOOBJ_MD_BITS_MASK);
 
 	/* Checks for union lquota_id */
 	LASSERTF((int)sizeof(union lquota_id) == 16, "found %lld\n",